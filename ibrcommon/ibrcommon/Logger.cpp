@@ -23,6 +23,7 @@
 #include "ibrcommon/Logger.h"
 #include <ibrcommon/thread/Mutex.h>
 #include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
 
 #include <algorithm>
 #include <sys/time.h>
@@ -59,6 +60,15 @@ namespace ibrcommon
 	{
 	}
 
+	void Logger::swap(Logger &other)
+	{
+		std::swap(_level, other._level);
+		std::swap(_debug_verbosity, other._debug_verbosity);
+		std::swap(_logtime, other._logtime);
+		_tag.swap(other._tag);
+		_data.swap(other._data);
+	}
+
 	void Logger::setMessage(const std::string &data)
 	{
 		_data = data;
@@ -456,7 +466,7 @@ namespace ibrcommon
 	void LogWriter::enableAsync()
 	{
 		try {
-			_use_queue = true;
+			ibrcommon::atomic::store(_use_queue, 1);
 			start();
 		} catch (const ibrcommon::ThreadException &ex) {
 			IBRCOMMON_LOGGER_TAG("LogWriter", error) << "enableAsync failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
@@ -506,21 +516,35 @@ namespace ibrcommon
 		return instance;
 	}
 
+	const size_t LogWriter::RING_SIZE = 256;
+
 	LogWriter::LogWriter()
-	 : _global_logmask(0), _verbosity(0), _syslog(0), _syslog_mask(0), _queue(50), _use_queue(false), _buffer_size(0), _buffer(NULL),
-	   _logfile_output(NULL), _logfile_logmask(0), _logfile_options(0), _default_tag("Core"), _android_tag_prefix("IBR-DTN/")
-	// limit queue to 50 entries
+	 : _global_logmask(0), _verbosity(0), _syslog(0), _syslog_mask(0), _use_queue(0), _inflight(0), _sequence(0), _idle(0), _shutdown(false),
+	   _buffer_size(0), _buffer(NULL), _logfile_output(NULL), _logfile_logmask(0), _logfile_options(0), _default_tag("Core"), _android_tag_prefix("IBR-DTN/")
 	{
+		::pthread_key_create(&_ring_key, &LogWriter::__release_ring);
 	}
 
 	LogWriter::~LogWriter()
 	{
 		// do cleanup only if the thread was running before
-		if (_use_queue) stop();
+		if (ibrcommon::atomic::load(_use_queue)) stop();
 
 		// join the LogWriter::run() thread
 		join();
 
+		// threads exiting from now on do not release their ring
+		::pthread_key_delete(_ring_key);
+
+		{
+			ibrcommon::MutexLock l(_rings_cond);
+			for (std::list<LogRing*>::iterator iter = _rings.begin(); iter != _rings.end(); ++iter)
+			{
+				delete (*iter);
+			}
+			_rings.clear();
+		}
+
 		// remove the ring-buffer
 		ibrcommon::MutexLock l(_buffer_mutex);
 		if (_buffer != NULL) delete _buffer;
@@ -622,58 +646,272 @@ namespace ibrcommon
 
 	void LogWriter::log(Logger &logger)
 	{
-		if (_use_queue)
+		// announce the message before checking the mode, thus the writer thread
+		// does not finish until the message is queued
+		ibrcommon::atomic::add(_inflight, 1);
+
+		if (ibrcommon::atomic::load(_use_queue))
 		{
-			_queue.push(logger);
+			LogRing &ring = __get_ring();
+			const int seq = ibrcommon::atomic::add(_sequence, 1);
+
+			while (!ring.push(logger, seq))
+			{
+				// the ring is full, wait until the writer thread made some space
+				ibrcommon::MutexLock l(_rings_cond);
+				_rings_cond.signal(true);
+
+				try {
+					_rings_cond.wait(10);
+				} catch (const ibrcommon::Conditional::ConditionalAbortException&) { };
+
+				// the writer thread has been stopped
+				if (!ibrcommon::atomic::load(_use_queue))
+				{
+					ibrcommon::atomic::add(_inflight, -1);
+					flush(logger);
+					return;
+				}
+			}
+
+			ibrcommon::atomic::add(_inflight, -1);
+
+			// wake-up the writer thread only if it is waiting
+			if (ibrcommon::atomic::load(_idle))
+			{
+				ibrcommon::MutexLock l(_rings_cond);
+				_rings_cond.signal(true);
+			}
 		}
 		else
 		{
+			ibrcommon::atomic::add(_inflight, -1);
 			flush(logger);
 		}
 	}
 
-	void LogWriter::run() throw ()
+	LogWriter::LogRing& LogWriter::__get_ring()
 	{
-		try {
-			while (true)
+		LogRing *ring = static_cast<LogRing*>(::pthread_getspecific(_ring_key));
+
+		if (ring == NULL)
+		{
+			ring = new LogRing(RING_SIZE);
+
+			ibrcommon::MutexLock l(_rings_cond);
+			_rings.push_back(ring);
+			::pthread_setspecific(_ring_key, ring);
+		}
+
+		return *ring;
+	}
+
+	void LogWriter::__release_ring(void *ring)
+	{
+		// the ring is deleted by the writer thread once it is empty
+		static_cast<LogRing*>(ring)->release();
+	}
+
+	bool LogWriter::__pending() const
+	{
+		for (std::list<LogRing*>::const_iterator iter = _rings.begin(); iter != _rings.end(); ++iter)
+		{
+			if (!(*iter)->empty()) return true;
+		}
+		return false;
+	}
+
+	size_t LogWriter::__collect(std::vector<Logger> &batch)
+	{
+		size_t count = 0;
+
+		while (count < batch.size())
+		{
+			// select the oldest message of all rings
+			LogRing *next = NULL;
+
+			for (std::list<LogRing*>::const_iterator iter = _rings.begin(); iter != _rings.end(); ++iter)
 			{
-				Logger log = _queue.poll();
-				flush(log);
+				LogRing *ring = (*iter);
+				if (ring->empty()) continue;
 
-				// add to ring-buffer
-				ibrcommon::MutexLock l(_buffer_mutex);
-				if (_buffer != NULL)
+				// compare the sequence numbers robust against overflows
+				if ((next == NULL) || (static_cast<int>(static_cast<unsigned int>(ring->sequence()) - static_cast<unsigned int>(next->sequence())) < 0))
 				{
-					_buffer->push_back(log);
-					while (_buffer->size() > _buffer_size)
-					{
-						_buffer->pop_front();
-					}
+					next = ring;
 				}
 			}
-		} catch (const std::exception&) {
-			ibrcommon::Queue<Logger>::Locked q = _queue.exclusive();
-
-			try {
-				// In this block we will write all remaining element in the queue
-				// to the logging streams. While we do this, the queue should be locked
-				// and finally we abort the queue to unblock all waiting threads.
-				while (!q.empty())
+
+			if (next == NULL) break;
+
+			// move the message out of the ring
+			batch[count++].swap(next->front());
+			next->pop();
+		}
+
+		// delete the rings of terminated threads
+		for (std::list<LogRing*>::iterator iter = _rings.begin(); iter != _rings.end();)
+		{
+			LogRing *ring = (*iter);
+
+			// check the release flag first, thus no message is pushed after the check for emptiness
+			if (ring->released() && ring->empty())
+			{
+				delete ring;
+				_rings.erase(iter++);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		// wake-up threads waiting for space in their ring
+		if (count > 0) _rings_cond.signal(true);
+
+		return count;
+	}
+
+	void LogWriter::__write(std::vector<Logger> &batch, const size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Logger &log = batch[i];
+			flush(log);
+
+			// add to ring-buffer
+			ibrcommon::MutexLock l(_buffer_mutex);
+			if (_buffer != NULL)
+			{
+				_buffer->push_back(log);
+				while (_buffer->size() > _buffer_size)
+				{
+					_buffer->pop_front();
+				}
+			}
+		}
+	}
+
+	void LogWriter::run() throw ()
+	{
+		// messages are moved out of the rings in batches, thus the rings
+		// are not locked while writing to the outputs
+		std::vector<Logger> batch(RING_SIZE, Logger(Logger::LOGGER_INFO, ""));
+		size_t count = 0;
+
+		while (true)
+		{
+			{
+				ibrcommon::MutexLock l(_rings_cond);
+
+				count = __collect(batch);
+
+				if (count == 0)
 				{
-					Logger &log = q.front();
-					try { flush(log); } catch (const std::exception&) {};
+					if (_shutdown) break;
+
+					// announce the waiting state before checking the rings again,
+					// thus a thread queueing a message never misses to signal
+					ibrcommon::atomic::store(_idle, 1);
+
+					try {
+						if (!__pending() && !_shutdown) _rings_cond.wait();
+					} catch (const ibrcommon::Conditional::ConditionalAbortException&) {
+						ibrcommon::atomic::store(_idle, 0);
+						break;
+					}
 
-					q.pop();
+					ibrcommon::atomic::store(_idle, 0);
+					continue;
 				}
-			} catch (const std::exception&) {
+			}
 
+			try { __write(batch, count); } catch (const std::exception&) { };
+		}
+
+		// log all further messages directly
+		ibrcommon::atomic::store(_use_queue, 0);
+
+		// wait until all threads which decided to queue a message are done
+		while (ibrcommon::atomic::load(_inflight) > 0) yield();
+
+		// write all remaining messages
+		while (true)
+		{
+			{
+				ibrcommon::MutexLock l(_rings_cond);
+				count = __collect(batch);
 			}
+
+			if (count == 0) break;
+
+			try { __write(batch, count); } catch (const std::exception&) { };
 		}
 	}
 
 	void LogWriter::__cancellation() throw ()
 	{
 		// cancel the main thread in here
-		_queue.abort();
+		ibrcommon::MutexLock l(_rings_cond);
+		_shutdown = true;
+		_rings_cond.signal(true);
+	}
+
+	LogWriter::LogRing::LogRing(const size_t size)
+	 : _slots(size, Logger(Logger::LOGGER_INFO, "")), _seq(size, 0), _head(0), _tail(0), _released(0)
+	{
+	}
+
+	LogWriter::LogRing::~LogRing()
+	{
+	}
+
+	bool LogWriter::LogRing::push(Logger &logger, const int seq)
+	{
+		const int tail = ibrcommon::atomic::load(_tail);
+		const int next = (tail + 1) % static_cast<int>(_slots.size());
+
+		// one slot is always left free to distinguish a full from an empty ring
+		if (next == ibrcommon::atomic::load(_head)) return false;
+
+		// move the message into the slot, the old content of the slot is
+		// released together with the given logger
+		_slots[tail].swap(logger);
+		_seq[tail] = seq;
+
+		// publish the message
+		ibrcommon::atomic::store(_tail, next);
+		return true;
+	}
+
+	bool LogWriter::LogRing::empty() const
+	{
+		return ibrcommon::atomic::load(_head) == ibrcommon::atomic::load(_tail);
+	}
+
+	Logger& LogWriter::LogRing::front()
+	{
+		return _slots[ibrcommon::atomic::load(_head)];
+	}
+
+	int LogWriter::LogRing::sequence() const
+	{
+		return _seq[ibrcommon::atomic::load(_head)];
+	}
+
+	void LogWriter::LogRing::pop()
+	{
+		const int head = ibrcommon::atomic::load(_head);
+		ibrcommon::atomic::store(_head, (head + 1) % static_cast<int>(_slots.size()));
+	}
+
+	void LogWriter::LogRing::release()
+	{
+		ibrcommon::atomic::store(_released, 1);
+	}
+
+	bool LogWriter::LogRing::released() const
+	{
+		return ibrcommon::atomic::load(_released) == 1;
 	}
 }
@@ -24,12 +24,15 @@
 
 #include <ibrcommon/thread/Queue.h>
 #include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/thread/Conditional.h>
 #include <ibrcommon/data/File.h>
 #include <fstream>
 #include <sys/time.h>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <list>
+#include <pthread.h>
 
 /**
  * @file Logger.h
@@ -121,6 +124,7 @@ namespace ibrcommon
 	 */
 	class Logger
 	{
+		friend class LogWriter;
 	public:
 		enum LogOptions
 		{
@@ -217,9 +221,9 @@ namespace ibrcommon
 
 		/**
 		 * enable the asynchronous logging
-		 * This starts a separate thread and a thread-safe queue to
-		 * queue all logging messages first and call the log routine by
-		 * the thread. This option is necessary, if the stream to log into
+		 * This starts a separate thread which writes all logging messages
+		 * to the outputs. Each thread queues its messages in its own ring
+		 * without locking. This option is necessary, if the stream to log into
 		 * are not thread-safe by itself.
 		 */
 		static void enableAsync();
@@ -281,8 +285,13 @@ namespace ibrcommon
 	private:
 		Logger(LogLevel level, const std::string &tag, int debug_verbosity = 0);
 
+		/**
+		 * Exchange the content with another Logger without copying the strings
+		 */
+		void swap(Logger &other);
+
 		LogLevel _level;
-		const std::string _tag;
+		std::string _tag;
 		int _debug_verbosity;
 		struct timeval _logtime;
 
@@ -346,9 +355,9 @@ namespace ibrcommon
 
 		/**
 		 * enable the asynchronous logging
-		 * This starts a seperate thread and a thread-safe queue to
-		 * queue all logging messages first and call the log routine by
-		 * the thread. This option is nessacary, if the stream to log into
+		 * This starts a seperate thread which drains the rings of all
+		 * logging threads and calls the log routine for each message.
+		 * This option is nessacary, if the stream to log into
 		 * are not thread-safe by itself.
 		 */
 		void enableAsync();
@@ -399,6 +408,61 @@ namespace ibrcommon
 			unsigned char _options;
 		};
 
+		/**
+		 * Single-producer single-consumer ring of log messages. Each thread
+		 * queues its messages in its own ring, thus no lock is required.
+		 */
+		class LogRing
+		{
+		public:
+			LogRing(const size_t size);
+			virtual ~LogRing();
+
+			/**
+			 * Move a message into the ring. Only called by the owning thread.
+			 * @return False, if the ring is full
+			 */
+			bool push(Logger &logger, const int seq);
+
+			/**
+			 * Returns true, if there is no queued message
+			 */
+			bool empty() const;
+
+			/**
+			 * Returns the oldest queued message
+			 */
+			Logger& front();
+
+			/**
+			 * Returns the sequence number of the oldest queued message
+			 */
+			int sequence() const;
+
+			/**
+			 * Remove the oldest queued message
+			 */
+			void pop();
+
+			/**
+			 * Mark the ring as released by the owning thread
+			 */
+			void release();
+			bool released() const;
+
+		private:
+			std::vector<Logger> _slots;
+			std::vector<int> _seq;
+
+			// position of the oldest message, modified by the writer thread
+			volatile int _head;
+
+			// position of the next free slot, modified by the owning thread
+			volatile int _tail;
+
+			volatile int _released;
+		};
+
 		/**
 		 * private constructor
 		 */
@@ -409,15 +473,60 @@ namespace ibrcommon
 		 */
 		void flush(const Logger &logger);
 
+		/**
+		 * Returns the ring of the calling thread
+		 */
+		LogRing& __get_ring();
+
+		/**
+		 * Move the queued messages of all rings in order into the batch.
+		 * Must be called with the rings locked.
+		 * @return The number of messages moved into the batch
+		 */
+		size_t __collect(std::vector<Logger> &batch);
+
+		/**
+		 * Write the first messages of the batch to the outputs.
+		 * Must be called without the rings locked.
+		 */
+		void __write(std::vector<Logger> &batch, const size_t count);
+
+		/**
+		 * Returns true, if any ring contains a message
+		 */
+		bool __pending() const;
+
+		/**
+		 * Called on the exit of a thread with a ring
+		 */
+		static void __release_ring(void *ring);
+
+		// number of messages in the ring of each thread
+		static const size_t RING_SIZE;
+
 		unsigned char _global_logmask;
 		int _verbosity;
 		bool _syslog;
 		unsigned char _syslog_mask;
 
-		ibrcommon::Queue<Logger> _queue;
-		bool _use_queue;
+		volatile int _use_queue;
+
+		// number of threads which are about to queue a message
+		volatile int _inflight;
 		std::list<LoggerOutput> _logger;
 
+		// rings of all threads, protected by the conditional
+		ibrcommon::Conditional _rings_cond;
+		std::list<LogRing*> _rings;
+		pthread_key_t _ring_key;
+
+		// global order of the queued messages
+		volatile int _sequence;
+
+		// set by the writer thread while it is waiting for messages
+		volatile int _idle;
+		bool _shutdown;
+
 		ibrcommon::Mutex _buffer_mutex;
 		size_t _buffer_size;
 		std::list<Logger> *_buffer;
@@ -29,6 +29,15 @@
 #include <cstring>
 #include <cerrno>
 #include <vector>
+#include <algorithm>
+
+#ifndef __WIN32__
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #ifdef __DEVELOPMENT_ASSERTIONS__
 #include <cassert>
@@ -60,6 +69,16 @@ namespace ibrcommon
 		_const_size = __get_size();
 	}
 
+	const ibrcommon::File& BLOB::getFile() const throw (ibrcommon::IOException)
+	{
+		throw ibrcommon::IOException("BLOB is not stored in a file");
+	}
+
+	std::streamoff BLOB::getFileOffset() const throw ()
+	{
+		return 0;
+	}
+
 	std::ostream& BLOB::copy(std::ostream &output, std::istream &input, const std::streamsize size, const size_t buffer_size)
 	{
 		// read payload
@@ -139,6 +158,11 @@ namespace ibrcommon
 		return ibrcommon::BLOB::Reference(new ibrcommon::FileBLOB(f));
 	}
 
+	ibrcommon::BLOB::Reference BLOB::range(const ibrcommon::BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length)
+	{
+		return ibrcommon::BLOB::Reference(new ibrcommon::RangeBLOB(ref, offset, length));
+	}
+
 	void BLOB::changeProvider(BLOB::Provider *p, bool auto_delete)
 	{
 		ibrcommon::BLOB::provider.change(p, auto_delete);
@@ -232,12 +256,242 @@ namespace ibrcommon
 		return *_blob;
 	}
 
+	BLOB::span::span(const BLOB::Reference &ref)
+	 : _blob(ref._blob), _lock(*_blob), _data(NULL), _size(0), _map(NULL), _map_length(0)
+	{
+#ifndef __WIN32__
+		std::string path;
+		std::streamoff offset = 0;
+
+		try {
+			path = _blob->getFile().getPath();
+			offset = _blob->getFileOffset();
+		} catch (const ibrcommon::IOException&) {
+			// the data is not held in a file
+			return;
+		}
+
+		// respect the limit of open files shared with all file BLOBs
+		BLOB::_filelimit.wait();
+
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			BLOB::_filelimit.post();
+			return;
+		}
+
+		struct stat st;
+		if ((::fstat(fd, &st) == 0) && (st.st_size > offset))
+		{
+			// the data may be a range of the file
+			const std::streamsize length = std::min<std::streamsize>(_blob->__get_size(), st.st_size - offset);
+
+			// the mapping has to start at a page boundary
+			const std::streamoff page = ::sysconf(_SC_PAGESIZE);
+			const std::streamoff align = offset % page;
+
+			int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+			// map all pages at once instead of faulting them in one by one
+			flags |= MAP_POPULATE;
+#endif
+
+			void *addr = (length > 0) ? ::mmap(NULL, length + align, PROT_READ, flags, fd, offset - align) : MAP_FAILED;
+
+			if (addr != MAP_FAILED)
+			{
+				// the data is usually read once from the beginning to the end
+				::madvise(addr, length + align, MADV_SEQUENTIAL);
+
+				_map = addr;
+				_map_length = length + align;
+				_data = static_cast<const char*>(addr) + align;
+				_size = length;
+			}
+		}
+
+		// the mapping stays valid after closing the file descriptor
+		::close(fd);
+
+		BLOB::_filelimit.post();
+#endif
+	}
+
+	BLOB::span::~span()
+	{
+#ifndef __WIN32__
+		if (_map != NULL)
+		{
+			::munmap(_map, _map_length);
+		}
+#endif
+	}
+
+	bool BLOB::span::valid() const
+	{
+		return (_data != NULL);
+	}
+
+	const char* BLOB::span::data() const
+	{
+		return _data;
+	}
+
+	std::streamsize BLOB::span::size() const
+	{
+		return _size;
+	}
+
 	BLOB::Reference MemoryBLOBProvider::StringBLOB::create()
 	{
 		BLOB::Reference ref(new MemoryBLOBProvider::StringBLOB());
 		return ref;
 	}
 
+	RangeBLOB::RangeBLOB(const BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length)
+	 : ibrcommon::BLOB(limit(ref, offset, length)), _ref(ref), _offset(offset), _length(limit(ref, offset, length)), _buf(*this), _stream(&_buf)
+	{
+	}
+
+	RangeBLOB::~RangeBLOB()
+	{
+	}
+
+	std::streamsize RangeBLOB::limit(const BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length)
+	{
+		const std::streamsize size = ref.size();
+		if (offset >= size) return 0;
+		return std::min<std::streamsize>(length, size - offset);
+	}
+
+	void RangeBLOB::clear()
+	{
+		throw ibrcommon::IOException("clear is not possible on a read only range");
+	}
+
+	void RangeBLOB::open()
+	{
+		BLOB &blob = *_ref._blob;
+
+		// the referenced BLOB is locked until the view is closed
+		blob.enter();
+
+		try {
+			blob.open();
+		} catch (...) {
+			blob.leave();
+			throw;
+		}
+
+		_buf.reset();
+		_stream.clear();
+	}
+
+	void RangeBLOB::close()
+	{
+		BLOB &blob = *_ref._blob;
+
+		_buf.reset();
+
+		blob.close();
+		blob.leave();
+	}
+
+	std::streamsize RangeBLOB::__get_size()
+	{
+		return _length;
+	}
+
+	std::iostream& RangeBLOB::__get_source()
+	{
+		return _ref._blob->__get_stream();
+	}
+
+	const ibrcommon::File& RangeBLOB::getFile() const throw (ibrcommon::IOException)
+	{
+		return (*_ref).getFile();
+	}
+
+	std::streamoff RangeBLOB::getFileOffset() const throw ()
+	{
+		return (*_ref).getFileOffset() + _offset;
+	}
+
+	RangeBLOB::rangebuf::rangebuf(RangeBLOB &blob)
+	 : _blob(blob), _position(0)
+	{
+		setg(NULL, NULL, NULL);
+	}
+
+	RangeBLOB::rangebuf::~rangebuf()
+	{
+	}
+
+	void RangeBLOB::rangebuf::reset()
+	{
+		// release the buffer, it is allocated again on the next read
+		std::vector<char>().swap(_buffer);
+		setg(NULL, NULL, NULL);
+		_position = 0;
+	}
+
+	RangeBLOB::rangebuf::int_type RangeBLOB::rangebuf::underflow()
+	{
+		if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+		const std::streamoff remain = _blob._length - _position;
+		if (remain <= 0) return traits_type::eof();
+
+		if (_buffer.empty()) _buffer.resize(0x10000);
+
+		// read the next part of the range from the referenced BLOB
+		std::iostream &source = _blob.__get_source();
+		source.clear();
+		source.seekg(_blob._offset + _position, std::ios::beg);
+		source.read(&_buffer[0], std::min<std::streamoff>(remain, _buffer.size()));
+
+		const std::streamsize len = source.gcount();
+		if (len <= 0) return traits_type::eof();
+
+		setg(&_buffer[0], &_buffer[0], &_buffer[0] + len);
+		_position += len;
+
+		return traits_type::to_int_type(*gptr());
+	}
+
+	RangeBLOB::rangebuf::pos_type RangeBLOB::rangebuf::seekoff(off_type off, std::ios_base::seekdir way, std::ios_base::openmode which)
+	{
+		// the range is read-only
+		if (which & std::ios_base::out) return pos_type(off_type(-1));
+
+		const std::streamoff current = _position - (egptr() - gptr());
+		std::streamoff target = off;
+
+		if (way == std::ios_base::cur) target += current;
+		else if (way == std::ios_base::end) target += _blob._length;
+
+		if ((target < 0) || (target > _blob._length)) return pos_type(off_type(-1));
+
+		if ((target >= _position - (egptr() - eback())) && (target <= _position))
+		{
+			// the position is within the buffered data
+			setg(eback(), egptr() - (_position - target), egptr());
+		}
+		else
+		{
+			setg(NULL, NULL, NULL);
+			_position = target;
+		}
+
+		return pos_type(target);
+	}
+
+	RangeBLOB::rangebuf::pos_type RangeBLOB::rangebuf::seekpos(pos_type pos, std::ios_base::openmode which)
+	{
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+
 	void MemoryBLOBProvider::StringBLOB::clear()
 	{
 		_stringstream.str("");
@@ -327,6 +581,11 @@ namespace ibrcommon
 		return _file.size();
 	}
 
+	const ibrcommon::File& FileBLOB::getFile() const throw (ibrcommon::IOException)
+	{
+		return _file;
+	}
+
 	void FileBLOBProvider::TmpFileBLOB::clear()
 	{
 		// close the file
@@ -385,4 +644,9 @@ namespace ibrcommon
 	{
 		return _tmpfile.size();
 	}
+
+	const ibrcommon::File& FileBLOBProvider::TmpFileBLOB::getFile() const throw (ibrcommon::IOException)
+	{
+		return _tmpfile;
+	}
 }
@@ -30,6 +30,7 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <vector>
 
 namespace ibrcommon
 {
@@ -41,8 +42,11 @@ namespace ibrcommon
 		};
 	};
 
+	class RangeBLOB;
+
 	class BLOB : public Mutex
 	{
+		friend class RangeBLOB;
 	public:
 		/**
 		 * This is the global limit for open file handles in BLOBs
@@ -70,6 +74,19 @@ namespace ibrcommon
 		// updates the const size of the BLOB
 		void update();
 
+		/**
+		 * Returns the file holding the data of this BLOB. This allows
+		 * to access the data without a stream, e.g. to send it using sendfile().
+		 * @throw IOException if the data is not held in a file
+		 */
+		virtual const ibrcommon::File& getFile() const throw (ibrcommon::IOException);
+
+		/**
+		 * Returns the position of the data of this BLOB within the file
+		 * returned by getFile().
+		 */
+		virtual std::streamoff getFileOffset() const throw ();
+
 		class iostream
 		{
 		private:
@@ -104,8 +121,54 @@ namespace ibrcommon
 			}
 		};
 
+		class Reference;
+
+		/**
+		 * A span provides read-only access to the data of a BLOB as one
+		 * contiguous block of memory. If the BLOB is held in a file, the file
+		 * is mapped into memory. The BLOB is locked as long as the span exists.
+		 * If the data can not be mapped, the span is not valid and the caller
+		 * has to fall back to the stream interface.
+		 */
+		class span
+		{
+		public:
+			span(const BLOB::Reference &ref);
+			virtual ~span();
+
+			/**
+			 * Returns true, if the data is accessible through this span
+			 */
+			bool valid() const;
+
+			/**
+			 * Returns a pointer to the first byte of the data
+			 */
+			const char* data() const;
+
+			/**
+			 * Returns the number of bytes accessible through this span
+			 */
+			std::streamsize size() const;
+
+		private:
+			span(const span&); // forbidden copy constructor
+			span& operator=(const span&); // forbidden assignment
+
+			refcnt_ptr<BLOB> _blob;
+			ibrcommon::MutexLock _lock;
+			const char *_data;
+			std::streamsize _size;
+
+			// the mapped region, it starts at a page boundary before the data
+			void *_map;
+			size_t _map_length;
+		};
+
 		class Reference
 		{
+			friend class BLOB::span;
+			friend class RangeBLOB;
 		public:
 			Reference(BLOB *blob);
 			Reference(const Reference &ref);
@@ -165,6 +228,16 @@ namespace ibrcommon
 		 */
 		static ibrcommon::BLOB::Reference open(const ibrcommon::File &f);
 
+		/**
+		 * Create a read-only view on a range of another BLOB. The view shares
+		 * the data of the referenced BLOB, thus no data is copied.
+		 * @param ref The BLOB holding the data
+		 * @param offset The position of the first byte of the range
+		 * @param length The length of the range, it is limited to the data available
+		 * @return
+		 */
+		static ibrcommon::BLOB::Reference range(const ibrcommon::BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length);
+
 		/**
 		 * Changes the BLOB provider.
 		 */
@@ -216,6 +289,8 @@ namespace ibrcommon
 		virtual void open();
 		virtual void close();
 
+		virtual const ibrcommon::File& getFile() const throw (ibrcommon::IOException);
+
 	protected:
 		std::iostream &__get_stream()
 		{
@@ -229,6 +304,76 @@ namespace ibrcommon
 		File _file;
 	};
 
+	/**
+	 * A RangeBLOB is a read only view on a range of another BLOB. The data is read
+	 * from the referenced BLOB, which is locked while the view is opened. Hence,
+	 * a thread must not open a view while it holds a stream of the referenced BLOB.
+	 */
+	class RangeBLOB : public ibrcommon::BLOB
+	{
+	public:
+		RangeBLOB(const BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length);
+		virtual ~RangeBLOB();
+
+		virtual void clear();
+
+		virtual void open();
+		virtual void close();
+
+		virtual const ibrcommon::File& getFile() const throw (ibrcommon::IOException);
+		virtual std::streamoff getFileOffset() const throw ();
+
+	protected:
+		std::iostream &__get_stream()
+		{
+			return _stream;
+		}
+
+		std::streamsize __get_size();
+
+	private:
+		/**
+		 * Stream buffer reading the range from the stream of the referenced BLOB
+		 */
+		class rangebuf : public std::streambuf
+		{
+		public:
+			rangebuf(RangeBLOB &blob);
+			virtual ~rangebuf();
+
+			/**
+			 * Move to the beginning of the range and drop all buffered data
+			 */
+			void reset();
+
+		protected:
+			virtual int_type underflow();
+			virtual pos_type seekoff(off_type off, std::ios_base::seekdir way, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+			virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+
+		private:
+			RangeBLOB &_blob;
+			std::vector<char> _buffer;
+
+			// position within the range behind the buffered data
+			std::streamoff _position;
+		};
+
+		static std::streamsize limit(const BLOB::Reference &ref, const std::streamoff offset, const std::streamsize length);
+
+		/**
+		 * Returns the stream of the referenced BLOB
+		 */
+		std::iostream& __get_source();
+
+		BLOB::Reference _ref;
+		const std::streamoff _offset;
+		const std::streamsize _length;
+
+		rangebuf _buf;
+		std::iostream _stream;
+	};
+
 	class MemoryBLOBProvider : public ibrcommon::BLOB::Provider
 	{
 	public:
@@ -292,6 +437,8 @@ namespace ibrcommon
 			virtual void open();
 			virtual void close();
 
+			virtual const ibrcommon::File& getFile() const throw (ibrcommon::IOException);
+
 		protected:
 			std::iostream &__get_stream()
 			{
@@ -20,6 +20,11 @@
  */
 
 #include "ibrcommon/data/Base64.h"
+#include <string.h>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
 
 #define _0000_0011 0x03
 #define _1111_1100 0xFC
@@ -34,6 +39,86 @@ namespace ibrcommon
 {
 	const char Base64::encodeCharacterTable[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+	// maps each character to its value, UNKOWN_CHAR or EQUAL_CHAR
+	const signed char Base64::decodeCharacterTable[256] = {
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+		52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -2, -1, -1,
+		-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+		15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+		-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+		41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+	};
+
+#ifdef __SSSE3__
+	/**
+	 * Encode four groups (12 bytes) into 16 characters. Reads 16 bytes of input.
+	 */
+	static inline __m128i __encode_ssse3__(__m128i in)
+	{
+		// spread the bytes of each group over four 8-bit lanes
+		in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+		// move each 6-bit value into its own byte
+		const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+		const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+		const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+		const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+		const __m128i indices = _mm_or_si128(t1, t3);
+
+		// translate the values into characters by adding a range specific offset
+		__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+		range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+		const __m128i offsets = _mm_setr_epi8(
+				'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+		return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+	}
+
+	/**
+	 * Decode 16 characters into 12 bytes.
+	 * @return false, if one of the characters is not part of the alphabet
+	 */
+	static inline bool __decode_ssse3__(const __m128i in, __m128i &out)
+	{
+		const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+		const __m128i lo_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+		// validate all characters, a character is invalid if both lookups share a bit
+		const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+
+		const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+		const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+
+		if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) return false;
+
+		// translate the characters into their values
+		const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+		const __m128i values = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles)));
+
+		// merge four 6-bit values into three bytes
+		const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+		out = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		return true;
+	}
+#endif
+
 	size_t Base64::getLength(size_t length)
 	{
 		// encoding = byte * (4/3)
@@ -47,6 +132,81 @@ namespace ibrcommon
 		return ret;
 	}
 
+	void Base64::encode(const char *data, size_t groups, char *b64)
+	{
+		const uint8_t *in = reinterpret_cast<const uint8_t*>(data);
+
+#ifdef __SSSE3__
+		// process four groups at once, as long as 16 bytes are readable
+		for (; groups >= 6; groups -= 4)
+		{
+			const __m128i chars = __encode_ssse3__(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(b64), chars);
+			in += 12;
+			b64 += 16;
+		}
+#endif
+
+		for (; groups > 0; --groups)
+		{
+			const uint32_t word = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+
+			b64[0] = encodeCharacterTable[(word >> 18) & 0x3f];
+			b64[1] = encodeCharacterTable[(word >> 12) & 0x3f];
+			b64[2] = encodeCharacterTable[(word >> 6) & 0x3f];
+			b64[3] = encodeCharacterTable[word & 0x3f];
+
+			in += 3;
+			b64 += 4;
+		}
+	}
+
+	size_t Base64::decode(const char *b64, size_t length, char *data)
+	{
+		const size_t groups = length / 4;
+		size_t done = 0;
+
+#ifdef __SSSE3__
+		// process four groups at once
+		for (; (groups - done) >= 4; done += 4)
+		{
+			__m128i out;
+			if (!__decode_ssse3__(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b64)), out)) break;
+
+			char tmp[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), out);
+			::memcpy(data, tmp, 12);
+
+			b64 += 16;
+			data += 12;
+		}
+#endif
+
+		for (; done < groups; ++done)
+		{
+			const uint8_t *in = reinterpret_cast<const uint8_t*>(b64);
+
+			const int v0 = decodeCharacterTable[in[0]];
+			const int v1 = decodeCharacterTable[in[1]];
+			const int v2 = decodeCharacterTable[in[2]];
+			const int v3 = decodeCharacterTable[in[3]];
+
+			// stop at padding or unknown characters
+			if ((v0 | v1 | v2 | v3) < 0) break;
+
+			const uint32_t word = (v0 << 18) | (v1 << 12) | (v2 << 6) | v3;
+
+			data[0] = static_cast<char>(word >> 16);
+			data[1] = static_cast<char>(word >> 8);
+			data[2] = static_cast<char>(word);
+
+			b64 += 4;
+			data += 3;
+		}
+
+		return done;
+	}
+
 	Base64::Group::Group()
 	{
 		zero();
@@ -137,24 +297,6 @@ namespace ibrcommon
 
 	int Base64::getCharType(int _C)
 	{
-		if(encodeCharacterTable[62] == _C)
-			return 62;
-
-		if(encodeCharacterTable[63] == _C)
-			return 63;
-
-		if((encodeCharacterTable[0] <= _C) && (encodeCharacterTable[25] >= _C))
-			return _C - encodeCharacterTable[0];
-
-		if((encodeCharacterTable[26] <= _C) && (encodeCharacterTable[51] >= _C))
-			return _C - encodeCharacterTable[26] + 26;
-
-		if((encodeCharacterTable[52] <= _C) && (encodeCharacterTable[61] >= _C))
-			return _C - encodeCharacterTable[52] + 52;
-
-		if(_C == ((int)'='))
-			return Base64::EQUAL_CHAR;
-
-		return Base64::UNKOWN_CHAR;
+		return decodeCharacterTable[static_cast<uint8_t>(_C)];
 	}
 } /* namespace dtn */
@@ -31,7 +31,7 @@ namespace ibrcommon
 	{
 	public:
 		static const char encodeCharacterTable[];
-		static const char decodeCharacterTable[];
+		static const signed char decodeCharacterTable[];
 
 		static const int EQUAL_CHAR = -2;
 		static const int UNKOWN_CHAR = -1;
@@ -45,6 +45,25 @@ namespace ibrcommon
 		 */
 		static size_t getLength(size_t length);
 
+		/**
+		 * Encode complete groups of three bytes.
+		 * @param data The data to encode, 3 * groups bytes
+		 * @param groups The number of groups to encode
+		 * @param b64 The output buffer, has to hold 4 * groups characters
+		 */
+		static void encode(const char *data, size_t groups, char *b64);
+
+		/**
+		 * Decode complete groups of four base64 characters. The decoding stops
+		 * at the first group containing a padding or unknown character, these
+		 * have to be processed character-wise by the caller.
+		 * @param b64 The characters to decode
+		 * @param length The number of characters available
+		 * @param data The output buffer, has to hold 3 * (length / 4) bytes
+		 * @return The number of decoded groups
+		 */
+		static size_t decode(const char *b64, size_t length, char *data);
+
 		class Group
 		{
 		public:
@@ -27,7 +27,7 @@
 namespace ibrcommon
 {
 	Base64Reader::Base64Reader(std::istream &stream, const size_t limit, const size_t buffer)
-	 : std::istream(this), _stream(stream), data_buf_(buffer), data_size_(buffer), _base64_state(0), _base64_padding(0), _byte_read(0), _byte_limit(limit)
+	 : std::istream(this), _stream(stream), _read_buf(buffer), data_buf_(buffer), data_size_(buffer), _base64_state(0), _base64_padding(0), _byte_read(0), _byte_limit(limit)
 	{
 		setg(0, 0, 0);
 	}
@@ -76,7 +76,7 @@ namespace ibrcommon
 		}
 
 		// read some data
-		std::vector<char> buffer(data_size_);
+		char *buffer = &_read_buf[0];
 
 		if (_byte_limit > 0)
 		{
@@ -99,11 +99,11 @@ namespace ibrcommon
 			if (bytes_to_read > data_size_) bytes_to_read = data_size_;
 
 			// read from the stream
-			_stream.read((char*)&buffer[0], bytes_to_read);
+			_stream.read(buffer, bytes_to_read);
 		}
 		else
 		{
-			_stream.read((char*)&buffer[0], data_size_);
+			_stream.read(buffer, data_size_);
 		}
 
 		size_t len = _stream.gcount();
@@ -111,9 +111,24 @@ namespace ibrcommon
 		// position in array
 		size_t decoded_bytes = 0;
 
-		for (size_t i = 0; i < len; ++i)
+		size_t i = 0;
+
+		while (i < len)
 		{
-			const int c = Base64::getCharType( buffer[i] );
+			// decode complete groups at once
+			if (_base64_state == 0)
+			{
+				const size_t groups = Base64::decode(buffer + i, len - i, &data_buf_[decoded_bytes]);
+
+				if (groups > 0)
+				{
+					decoded_bytes += groups * 3;
+					i += groups * 4;
+					continue;
+				}
+			}
+
+			const int c = Base64::getCharType( buffer[i++] );
 
 			switch (c)
 			{
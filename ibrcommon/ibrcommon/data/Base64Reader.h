@@ -44,6 +44,9 @@ namespace ibrcommon
 
 		std::istream &_stream;
 
+		// Input buffer
+		std::vector<char> _read_buf;
+
 		// Output buffer
 		std::vector<char> data_buf_;
 
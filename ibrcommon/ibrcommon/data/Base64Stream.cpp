@@ -26,7 +26,7 @@
 namespace ibrcommon
 {
 	Base64Stream::Base64Stream(std::ostream &stream, bool decode, const size_t linebreak, const size_t buffer)
-	 : std::ostream(this), _decode(decode), _stream(stream), data_buf_(buffer), data_size_(buffer), _base64_state(0), _char_counter(0), _base64_padding(0), _linebreak(linebreak)
+	 : std::ostream(this), _decode(decode), _stream(stream), data_buf_(buffer), data_size_(buffer), _block_buf(((buffer / 3) + 1) * 4), _base64_state(0), _char_counter(0), _base64_padding(0), _linebreak(linebreak)
 	{
 		setp(&data_buf_[0], &data_buf_[0] + data_size_ - 1);
 	}
@@ -91,6 +91,7 @@ namespace ibrcommon
 		if (!_decode && (_base64_state > 0))
 		{
 			__flush_encoder__();
+			_group.zero();
 		}
 
 		return ret;
@@ -118,13 +119,28 @@ namespace ibrcommon
 			return std::char_traits<char>::not_eof(c);
 		}
 
+		size_t i = 0;
+
 		// for each byte...
-		for (size_t i = 0; i < len; ++i)
+		while (i < len)
 		{
 			// do cipher stuff
 			if (_decode)
 			{
-				const int c = Base64::getCharType( ibegin[i] );
+				// decode complete groups at once
+				if (_base64_state == 0)
+				{
+					const size_t groups = Base64::decode(ibegin + i, len - i, &_block_buf[0]);
+
+					if (groups > 0)
+					{
+						_stream.write(&_block_buf[0], groups * 3);
+						i += groups * 4;
+						continue;
+					}
+				}
+
+				const int c = Base64::getCharType( ibegin[i++] );
 
 				switch (c)
 				{
@@ -196,8 +212,31 @@ namespace ibrcommon
 			}
 			else
 			{
+				// encode complete groups at once, up to the next line break
+				if ((_base64_state == 0) && ((len - i) >= 3))
+				{
+					size_t groups = (len - i) / 3;
+
+					// number of groups until the next line break
+					const size_t line = (_linebreak > _char_counter) ? (_linebreak - _char_counter + 3) / 4 : 1;
+					if (groups > line) groups = line;
+
+					Base64::encode(ibegin + i, groups, &_block_buf[0]);
+					_stream.write(&_block_buf[0], groups * 4);
+					i += groups * 3;
+
+					_char_counter += groups * 4;
+
+					if (_char_counter >= _linebreak)
+					{
+						_stream.put('\n');
+						_char_counter = 0;
+					}
+					continue;
+				}
+
 				// put char into the encode buffer
-				set_byte(ibegin[i]);
+				set_byte(ibegin[i++]);
 
 				if (_base64_state == 3)
 				{
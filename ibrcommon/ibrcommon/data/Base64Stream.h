@@ -56,6 +56,9 @@ namespace ibrcommon
 		// length of the data buffer
 		size_t data_size_;
 
+		// buffer for complete groups processed at once
+		std::vector<char> _block_buf;
+
 		uint8_t _base64_state;
 
 		size_t _char_counter;
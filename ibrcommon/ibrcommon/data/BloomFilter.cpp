@@ -64,14 +64,48 @@ namespace ibrcommon
 
 	const std::list<bloom_type> DefaultHashProvider::hash(const unsigned char* begin, std::size_t remaining_length) const
 	{
-		std::list<bloom_type> hashes;
+		bloom_type values[max_salt_count];
+		hash(begin, remaining_length, values);
 
-		for (std::vector<bloom_type>::const_iterator iter = _salt.begin(); iter != _salt.end(); ++iter)
+		return std::list<bloom_type>(values, values + _salt.size());
+	}
+
+	void DefaultHashProvider::hash(const unsigned char* begin, std::size_t remaining_length, bloom_type *hashes) const
+	{
+		const std::size_t salts = _salt.size();
+
+		// the AP hash of all salts is computed in parallel, since the
+		// rounds of the different salts do not depend on each other
+		std::copy(_salt.begin(), _salt.end(), hashes);
+
+		const unsigned char* it = begin;
+		while(remaining_length >= 2)
 		{
-			hashes.push_back(hash_ap(begin, remaining_length, (*iter)));
+			const bloom_type c1 = it[0];
+			const bloom_type c2 = it[1];
+
+			for (std::size_t i = 0; i < salts; ++i)
+			{
+				bloom_type h = hashes[i];
+				h ^=    (h <<  7) ^  c1 * (h >> 3);
+				h ^= (~((h << 11) + (c2 ^ (h >> 5))));
+				hashes[i] = h;
+			}
+
+			it += 2;
+			remaining_length -= 2;
 		}
+		if (remaining_length)
+		{
+			const bloom_type c1 = (*it);
 
-		return hashes;
+			for (std::size_t i = 0; i < salts; ++i)
+			{
+				bloom_type h = hashes[i];
+				h ^= (h <<  7) ^ c1 * (h >> 3);
+				hashes[i] = h;
+			}
+		}
 	}
 
 
@@ -98,7 +132,7 @@ namespace ibrcommon
 										  0x15B6796C, 0x1D6FDFE4, 0x63FF9092, 0xE7401432
 									};
 
-		if (salt_count_ > predef_salt_count)
+		if (salt_count_ > std::min(predef_salt_count, (unsigned int)max_salt_count))
 		{
 			throw ibrcommon::Exception("Max. 64 hash salts supported!");
 		}
@@ -191,17 +225,57 @@ namespace ibrcommon
 		std::size_t bit_index = 0;
 		std::size_t bit = 0;
 
-		std::list<bloom_type> hashes = _hashp.hash(key_begin, length);
+		bloom_type hashes[DefaultHashProvider::max_salt_count];
+		_hashp.hash(key_begin, length, hashes);
 
-		for (std::list<bloom_type>::iterator iter = hashes.begin(); iter != hashes.end(); ++iter)
+		const std::size_t salts = _hashp.count();
+		for (std::size_t i = 0; i < salts; ++i)
 		{
-			compute_indices( (*iter), bit_index, bit );
+			compute_indices( hashes[i], bit_index, bit );
 			bit_table_[bit_index / bits_per_char] |= bit_mask[bit];
 		}
 
 		if (_itemcount < std::numeric_limits<unsigned int>::max()) _itemcount++;
 	}
 
+	void BloomFilter::insert(const unsigned char * const *keys, const std::size_t *lengths, const std::size_t count)
+	{
+		// number of keys hashed before the table is touched
+		const std::size_t batch_size = 16;
+
+		const std::size_t salts = _hashp.count();
+		std::vector<std::size_t> indices(batch_size * salts);
+
+		for (std::size_t offset = 0; offset < count; offset += batch_size)
+		{
+			const std::size_t n = std::min(batch_size, count - offset);
+			std::size_t bit = 0;
+
+			// hash all keys of the batch and prefetch the affected cells
+			for (std::size_t k = 0; k < n; ++k)
+			{
+				bloom_type hashes[DefaultHashProvider::max_salt_count];
+				_hashp.hash(keys[offset + k], lengths[offset + k], hashes);
+
+				for (std::size_t i = 0; i < salts; ++i)
+				{
+					std::size_t &bit_index = indices[k * salts + i];
+					compute_indices( hashes[i], bit_index, bit );
+					__builtin_prefetch(&bit_table_[bit_index / bits_per_char], 1);
+				}
+			}
+
+			// set the bits of all keys
+			for (std::size_t j = 0; j < (n * salts); ++j)
+			{
+				bit_table_[indices[j] / bits_per_char] |= bit_mask[indices[j] % bits_per_char];
+			}
+		}
+
+		if (_itemcount < std::numeric_limits<unsigned int>::max() - count) _itemcount += static_cast<unsigned int>(count);
+		else _itemcount = std::numeric_limits<unsigned int>::max();
+	}
+
 	void BloomFilter::insert(const std::string& key)
 	{
 		insert(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
@@ -217,11 +291,13 @@ namespace ibrcommon
 		std::size_t bit_index = 0;
 		std::size_t bit = 0;
 
-		const std::list<bloom_type> hashes = _hashp.hash(key_begin, length);
+		bloom_type hashes[DefaultHashProvider::max_salt_count];
+		_hashp.hash(key_begin, length, hashes);
 
-		for (std::list<bloom_type>::const_iterator iter = hashes.begin(); iter != hashes.end(); ++iter)
+		const std::size_t salts = _hashp.count();
+		for (std::size_t i = 0; i < salts; ++i)
 		{
-			compute_indices( (*iter), bit_index, bit );
+			compute_indices( hashes[i], bit_index, bit );
 			if ((bit_table_[bit_index / bits_per_char] & bit_mask[bit]) != bit_mask[bit])
 			{
 				return false;
@@ -231,6 +307,54 @@ namespace ibrcommon
 		return true;
 	}
 
+	std::size_t BloomFilter::contains(const unsigned char * const *keys, const std::size_t *lengths, const std::size_t count, bool *results) const
+	{
+		// number of keys hashed before the table is touched
+		const std::size_t batch_size = 16;
+
+		const std::size_t salts = _hashp.count();
+		std::vector<std::size_t> indices(batch_size * salts);
+		std::size_t found = 0;
+
+		for (std::size_t offset = 0; offset < count; offset += batch_size)
+		{
+			const std::size_t n = std::min(batch_size, count - offset);
+			std::size_t bit = 0;
+
+			// hash all keys of the batch and prefetch the affected cells
+			for (std::size_t k = 0; k < n; ++k)
+			{
+				bloom_type hashes[DefaultHashProvider::max_salt_count];
+				_hashp.hash(keys[offset + k], lengths[offset + k], hashes);
+
+				for (std::size_t i = 0; i < salts; ++i)
+				{
+					std::size_t &bit_index = indices[k * salts + i];
+					compute_indices( hashes[i], bit_index, bit );
+					__builtin_prefetch(&bit_table_[bit_index / bits_per_char], 0);
+				}
+			}
+
+			// test the bits of all keys
+			for (std::size_t k = 0; k < n; ++k)
+			{
+				bool ret = true;
+
+				for (std::size_t i = 0; ret && (i < salts); ++i)
+				{
+					const std::size_t bit_index = indices[k * salts + i];
+					const unsigned char mask = bit_mask[bit_index % bits_per_char];
+					ret = ((bit_table_[bit_index / bits_per_char] & mask) == mask);
+				}
+
+				results[offset + k] = ret;
+				if (ret) found++;
+			}
+		}
+
+		return found;
+	}
+
 	bool BloomFilter::contains(const std::string& key) const
 	{
 		return contains(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
@@ -56,6 +56,9 @@ namespace ibrcommon
 	class DefaultHashProvider : public HashProvider
 	{
 	public:
+		// maximum number of hash salts
+		static const std::size_t max_salt_count = 64;
+
 		DefaultHashProvider(size_t salt_count);
 		virtual ~DefaultHashProvider();
 
@@ -65,6 +68,13 @@ namespace ibrcommon
 
 		const std::list<bloom_type> hash(const unsigned char* begin, std::size_t remaining_length) const;
 
+		/**
+		 * Computes the hashes of all salts in one pass over the key
+		 * without any allocation.
+		 * @param hashes Array to store count() hash values
+		 */
+		void hash(const unsigned char* begin, std::size_t remaining_length, bloom_type *hashes) const;
+
 	private:
 		void add(bloom_type hash);
 		void generate_salt();
@@ -115,6 +125,15 @@ namespace ibrcommon
 			}
 		}
 
+		/**
+		 * Insert a batch of keys. All keys are hashed first and then
+		 * written into the table.
+		 * @param keys Array of pointers to the keys
+		 * @param lengths Array of the key lengths
+		 * @param count Number of keys
+		 */
+		void insert(const unsigned char * const *keys, const std::size_t *lengths, const std::size_t count);
+
 		virtual bool contains(const unsigned char* key_begin, const std::size_t length) const;
 
 		template<typename T>
@@ -127,6 +146,17 @@ namespace ibrcommon
 
 		bool contains(const char* data, const std::size_t& length) const;
 
+		/**
+		 * Test a batch of keys. All keys are hashed first and then
+		 * looked up in the table.
+		 * @param keys Array of pointers to the keys
+		 * @param lengths Array of the key lengths
+		 * @param count Number of keys
+		 * @param results Array to store the result for each key
+		 * @return The number of keys contained in the filter
+		 */
+		std::size_t contains(const unsigned char * const *keys, const std::size_t *lengths, const std::size_t count, bool *results) const;
+
 		template<typename InputIterator>
 		InputIterator contains_all(const InputIterator begin, const InputIterator end) const
 		{
@@ -0,0 +1,116 @@
+/*
+ * MemoryStream.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ibrcommon/data/MemoryStream.h"
+
+namespace ibrcommon
+{
+	MemoryStream::MemoryStream(char *data, const size_t length)
+	 : std::iostream(this), _data(data), _length(length)
+	{
+		// nothing to read until something has been written
+		setg(_data, _data, _data);
+		setp(_data, _data + _length);
+	}
+
+	MemoryStream::MemoryStream(const char *data, const size_t length)
+	 : std::iostream(this), _data(const_cast<char*>(data)), _length(length)
+	{
+		setg(_data, _data, _data + _length);
+
+		// the buffer is read-only
+		setp(0, 0);
+	}
+
+	MemoryStream::~MemoryStream()
+	{
+	}
+
+	size_t MemoryStream::getWritten() const
+	{
+		return pptr() - pbase();
+	}
+
+	size_t MemoryStream::getRead() const
+	{
+		return gptr() - eback();
+	}
+
+	std::char_traits<char>::int_type MemoryStream::overflow(std::char_traits<char>::int_type)
+	{
+		// the buffer is full
+		return std::char_traits<char>::eof();
+	}
+
+	std::char_traits<char>::int_type MemoryStream::underflow()
+	{
+		// make written data available for reading
+		if ((pbase() != 0) && (egptr() < pptr()))
+		{
+			setg(eback(), gptr(), pptr());
+			return std::char_traits<char>::to_int_type(*gptr());
+		}
+
+		return std::char_traits<char>::eof();
+	}
+
+	std::streampos MemoryStream::seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode which)
+	{
+		// the end of the data is the end of the written data or the end of a read-only buffer
+		const std::streamoff end = (pbase() != 0) ? static_cast<std::streamoff>(pptr() - pbase()) : static_cast<std::streamoff>(_length);
+
+		if (which & std::ios_base::in)
+		{
+			std::streamoff pos = off;
+			if (way == std::ios_base::cur) pos += gptr() - eback();
+			else if (way == std::ios_base::end) pos += end;
+
+			if ((pos < 0) || (pos > end)) return std::streampos(std::streamoff(-1));
+
+			setg(eback(), eback() + pos, _data + end);
+
+			if (!(which & std::ios_base::out)) return std::streampos(pos);
+		}
+
+		if (which & std::ios_base::out)
+		{
+			if (pbase() == 0) return std::streampos(std::streamoff(-1));
+
+			std::streamoff pos = off;
+			if (way == std::ios_base::cur) pos += pptr() - pbase();
+			else if (way == std::ios_base::end) pos += end;
+
+			if ((pos < 0) || (pos > static_cast<std::streamoff>(_length))) return std::streampos(std::streamoff(-1));
+
+			setp(_data, _data + _length);
+			pbump(static_cast<int>(pos));
+
+			return std::streampos(pos);
+		}
+
+		return std::streampos(std::streamoff(-1));
+	}
+
+	std::streampos MemoryStream::seekpos(std::streampos pos, std::ios_base::openmode which)
+	{
+		return seekoff(std::streamoff(pos), std::ios_base::beg, which);
+	}
+}
@@ -0,0 +1,77 @@
+/*
+ * MemoryStream.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef MEMORYSTREAM_H_
+#define MEMORYSTREAM_H_
+
+#include <streambuf>
+#include <iostream>
+
+namespace ibrcommon
+{
+	/**
+	 * A MemoryStream reads from and writes to a fixed buffer owned by the caller.
+	 * In contrast to a stringstream the data is neither copied nor reallocated.
+	 * If the buffer is full, further writes fail and set the badbit of the stream.
+	 */
+	class MemoryStream : public std::basic_streambuf<char, std::char_traits<char> >, public std::iostream
+	{
+	public:
+		/**
+		 * Create a stream to write to the buffer and read from it
+		 * @param data The buffer to use
+		 * @param length The size of the buffer
+		 */
+		MemoryStream(char *data, const size_t length);
+
+		/**
+		 * Create a stream to read from the buffer only
+		 * @param data The buffer to read from
+		 * @param length The number of bytes in the buffer
+		 */
+		MemoryStream(const char *data, const size_t length);
+
+		virtual ~MemoryStream();
+
+		/**
+		 * Returns the number of bytes written to the buffer
+		 */
+		size_t getWritten() const;
+
+		/**
+		 * Returns the number of bytes read from the buffer
+		 */
+		size_t getRead() const;
+
+	protected:
+		virtual std::char_traits<char>::int_type overflow(std::char_traits<char>::int_type = std::char_traits<char>::eof());
+		virtual std::char_traits<char>::int_type underflow();
+
+		virtual std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+		virtual std::streampos seekpos(std::streampos pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+
+	private:
+		char * const _data;
+		const size_t _length;
+	};
+}
+
+#endif /* MEMORYSTREAM_H_ */
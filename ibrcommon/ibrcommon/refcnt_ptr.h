@@ -22,8 +22,7 @@
 #ifndef IBRCOMMON_refcnt_ptr_h
 #define IBRCOMMON_refcnt_ptr_h 1
 
-#include <ibrcommon/thread/Mutex.h>
-#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
 
 template <class T> class refcnt_ptr
 {
@@ -37,8 +36,9 @@ template <class T> class refcnt_ptr
 			virtual ~Holder() { delete ptr_;};
 
 			T* ptr_;
-			unsigned count_;
-			ibrcommon::Mutex lock;
+
+			// the reference count is modified using atomic operations
+			volatile int count_;
 		};
 
 		Holder* h_;
@@ -46,12 +46,7 @@ template <class T> class refcnt_ptr
 	private:
 		void down()
 		{
-			bool final = false;
-			{
-				ibrcommon::MutexLock l(h_->lock);
-				if (--h_->count_ == 0) final = true;
-			}
-			if (final) delete h_;
+			if (ibrcommon::atomic::add(h_->count_, -1) == 0) delete h_;
 		}
 
 	public:
@@ -69,8 +64,7 @@ template <class T> class refcnt_ptr
 		// copy and assignment of refcnt_ptr
 		refcnt_ptr (const refcnt_ptr<T>& right) : h_(right.h_)
 		{
-			ibrcommon::MutexLock l(h_->lock);
-			++h_->count_;
+			ibrcommon::atomic::add(h_->count_, 1);
 		}
 
 		refcnt_ptr<T>& operator= (const refcnt_ptr<T>& right)
@@ -78,8 +72,7 @@ template <class T> class refcnt_ptr
 			// ignore assignment to myself
 			if (h_ == right.h_) return *this;
 
-			ibrcommon::MutexLock l(right.h_->lock);
-			++right.h_->count_;
+			ibrcommon::atomic::add(right.h_->count_, 1);
 
 			down();
 
@@ -98,6 +91,12 @@ template <class T> class refcnt_ptr
 			return h_->ptr_ == other.h_->ptr_;
 		}
 
+		// returns true, if this is the only reference to the managed object
+		bool unique() const
+		{
+			return ibrcommon::atomic::load(h_->count_) == 1;
+		}
+
 		// access to the managed object
 		T* operator-> () { return h_->ptr_; }
 		T& operator* () { return *h_->ptr_; }
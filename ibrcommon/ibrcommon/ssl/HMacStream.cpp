@@ -36,10 +36,10 @@ namespace ibrcommon
 		HMAC_CTX_free(ctx_);
 	}
 
-	void HMacStream::update(char *buf, const size_t size)
+	void HMacStream::update(const char *buf, const size_t size)
 	{
 		// hashing
-		HMAC_Update(ctx_, (unsigned char*)buf, size);
+		HMAC_Update(ctx_, (const unsigned char*)buf, size);
 	}
 
 	void HMacStream::finalize(char * hash, unsigned int &size)
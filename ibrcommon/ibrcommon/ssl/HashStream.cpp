@@ -77,6 +77,22 @@ namespace ibrcommon
 		return std::char_traits<char>::not_eof(c);
 	}
 
+	std::streamsize HashStream::xsputn(const char *s, std::streamsize n)
+	{
+		if (n < static_cast<std::streamsize>(data_size_))
+		{
+			return std::basic_streambuf<char, std::char_traits<char> >::xsputn(s, n);
+		}
+
+		// hash the buffered data first to keep the order
+		overflow(std::char_traits<char>::eof());
+
+		// hashing
+		update(s, n);
+
+		return n;
+	}
+
 	std::char_traits<char>::int_type HashStream::underflow()
 	{
 		// TODO: add seek mechanisms to reset the istream
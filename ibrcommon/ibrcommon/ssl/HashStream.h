@@ -38,13 +38,19 @@ namespace ibrcommon
 		static std::string extract(std::istream &stream);
 
 	protected:
-		virtual void update(char *buf, const size_t size) = 0;
+		virtual void update(const char *buf, const size_t size) = 0;
 		virtual void finalize(char * hash, unsigned int &size) = 0;
 
 		virtual int sync();
 		virtual std::char_traits<char>::int_type overflow(std::char_traits<char>::int_type = std::char_traits<char>::eof());
 		virtual std::char_traits<char>::int_type underflow();
 
+		/**
+		 * Large blocks of data are hashed directly without copying
+		 * them into the buffer first.
+		 */
+		virtual std::streamsize xsputn(const char *s, std::streamsize n);
+
 	private:
 		// Output buffer
 		std::vector<char> data_buf_;
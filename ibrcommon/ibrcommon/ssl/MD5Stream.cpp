@@ -37,10 +37,10 @@ namespace ibrcommon
 		}
 	}
 
-	void MD5Stream::update(char *buf, const size_t size)
+	void MD5Stream::update(const char *buf, const size_t size)
 	{
 		// hashing
-		MD5_Update(&ctx_, (unsigned char*)buf, size);
+		MD5_Update(&ctx_, (const unsigned char*)buf, size);
 	}
 
 	void MD5Stream::finalize(char * hash, unsigned int &size)
@@ -144,10 +144,32 @@ namespace ibrcommon
 			return std::char_traits<char>::not_eof(c);
 		}
 
+		update(&out_buf_[0], iend - ibegin);
+
+		return std::char_traits<char>::not_eof(c);
+	}
+
+	std::streamsize RSASHA256Stream::xsputn(const char *s, std::streamsize n)
+	{
+		if (n < static_cast<std::streamsize>(BUFF_SIZE))
+		{
+			return std::basic_streambuf<char, std::char_traits<char> >::xsputn(s, n);
+		}
+
+		// feed the buffered data first to keep the order
+		overflow(std::char_traits<char>::eof());
+
+		update(s, n);
+
+		return n;
+	}
+
+	void RSASHA256Stream::update(const char *buf, const size_t size)
+	{
 		if (!_verify)
 			// hashing
 		{
-			if (!EVP_SignUpdate(_ctx, &out_buf_[0], iend - ibegin))
+			if (!EVP_SignUpdate(_ctx, buf, size))
 			{
 				IBRCOMMON_LOGGER_TAG("RSASHA256Stream", critical) << "failed to feed data into the signature function" << IBRCOMMON_LOGGER_ENDL;
 				ERR_print_errors_fp(stderr);
@@ -155,13 +177,11 @@ namespace ibrcommon
 		}
 		else
 		{
-			if (!EVP_VerifyUpdate(_ctx, &out_buf_[0], iend - ibegin))
+			if (!EVP_VerifyUpdate(_ctx, buf, size))
 			{
 				IBRCOMMON_LOGGER_TAG("RSASHA256Stream", critical) << "failed to feed data into the verification function" << IBRCOMMON_LOGGER_ENDL;
 				ERR_print_errors_fp(stderr);
 			}
 		}
-
-		return std::char_traits<char>::not_eof(c);
 	}
 }
@@ -94,7 +94,16 @@ namespace ibrcommon
 		*/
 		virtual traits::int_type overflow(traits::int_type = traits::eof());
 
+		/**
+		Large blocks of data are fed into the openssl context directly without
+		copying them into the buffer first.
+		*/
+		virtual std::streamsize xsputn(const char *s, std::streamsize n);
+
 	private:
+		/** feeds the data into the openssl context */
+		void update(const char *buf, const size_t size);
+
 		/** the buffer in which data will be streamed into */
 		std::vector<char> out_buf_;
 
@@ -37,10 +37,10 @@ namespace ibrcommon
 		}
 	}
 
-	void SHA256Stream::update(char *buf, const size_t size)
+	void SHA256Stream::update(const char *buf, const size_t size)
 	{
 		// hashing
-		SHA256_Update(&ctx_, (unsigned char*)buf, size);
+		SHA256_Update(&ctx_, (const unsigned char*)buf, size);
 	}
 
 	void SHA256Stream::finalize(char * hash, unsigned int &size)
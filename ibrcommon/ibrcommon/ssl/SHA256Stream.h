@@ -37,7 +37,7 @@ namespace ibrcommon
 		virtual ~SHA256Stream();
 
 	protected:
-		virtual void update(char *buf, const size_t size);
+		virtual void update(const char *buf, const size_t size);
 		virtual void finalize(char * hash, unsigned int &size);
 
 	private:
@@ -0,0 +1,95 @@
+/*
+ * Atomic.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "ibrcommon/config.h"
+#include "ibrcommon/thread/Atomic.h"
+
+#if !defined(__ATOMIC_SEQ_CST) && !defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#include "ibrcommon/thread/Mutex.h"
+#include "ibrcommon/thread/MutexLock.h"
+
+namespace ibrcommon
+{
+	namespace atomic
+	{
+		static ibrcommon::Mutex& __lock()
+		{
+			static ibrcommon::Mutex m;
+			return m;
+		}
+
+		int __locked_add(volatile int &value, const int delta)
+		{
+			ibrcommon::MutexLock l(__lock());
+			value += delta;
+			return value;
+		}
+
+		int __locked_load(const volatile int &value)
+		{
+			ibrcommon::MutexLock l(__lock());
+			return value;
+		}
+
+		void __locked_store(volatile int &value, const int v)
+		{
+			ibrcommon::MutexLock l(__lock());
+			value = v;
+		}
+
+		int __locked_exchange(volatile int &value, const int v)
+		{
+			ibrcommon::MutexLock l(__lock());
+			const int ret = value;
+			value = v;
+			return ret;
+		}
+
+		size_t __locked_add(volatile size_t &value, const size_t delta)
+		{
+			ibrcommon::MutexLock l(__lock());
+			value += delta;
+			return value;
+		}
+
+		size_t __locked_load(const volatile size_t &value)
+		{
+			ibrcommon::MutexLock l(__lock());
+			return value;
+		}
+
+		void __locked_store(volatile size_t &value, const size_t v)
+		{
+			ibrcommon::MutexLock l(__lock());
+			value = v;
+		}
+
+		size_t __locked_exchange(volatile size_t &value, const size_t v)
+		{
+			ibrcommon::MutexLock l(__lock());
+			const size_t ret = value;
+			value = v;
+			return ret;
+		}
+	}
+}
+#endif
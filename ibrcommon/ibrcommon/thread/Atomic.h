@@ -0,0 +1,173 @@
+/*
+ * Atomic.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef IBRCOMMON_ATOMIC_H_
+#define IBRCOMMON_ATOMIC_H_
+
+#include <cstddef>
+
+namespace ibrcommon
+{
+	/**
+	 * Atomic operations on integer values. The atomic builtins of the
+	 * compiler are used if available. Otherwise the operations are
+	 * serialized by a global mutex.
+	 */
+	namespace atomic
+	{
+#if !defined(__ATOMIC_SEQ_CST) && !defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+		int __locked_add(volatile int &value, const int delta);
+		int __locked_load(const volatile int &value);
+		void __locked_store(volatile int &value, const int v);
+		int __locked_exchange(volatile int &value, const int v);
+
+		size_t __locked_add(volatile size_t &value, const size_t delta);
+		size_t __locked_load(const volatile size_t &value);
+		void __locked_store(volatile size_t &value, const size_t v);
+		size_t __locked_exchange(volatile size_t &value, const size_t v);
+#endif
+
+		/**
+		 * Add a delta to the value
+		 * @return The new value
+		 */
+		inline int add(volatile int &value, const int delta)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_add_fetch(&value, delta, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			return __sync_add_and_fetch(&value, delta);
+#else
+			return __locked_add(value, delta);
+#endif
+		}
+
+		/**
+		 * @return The current value
+		 */
+		inline int load(const volatile int &value)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_load_n(&value, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_synchronize();
+			return value;
+#else
+			return __locked_load(value);
+#endif
+		}
+
+		/**
+		 * Replace the value
+		 */
+		inline void store(volatile int &value, const int v)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			__atomic_store_n(&value, v, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_lock_test_and_set(&value, v);
+			__sync_synchronize();
+#else
+			__locked_store(value, v);
+#endif
+		}
+
+		/**
+		 * Replace the value
+		 * @return The previous value
+		 */
+		inline int exchange(volatile int &value, const int v)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_exchange_n(&value, v, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_synchronize();
+			return __sync_lock_test_and_set(&value, v);
+#else
+			return __locked_exchange(value, v);
+#endif
+		}
+
+		/**
+		 * Add a delta to the value
+		 * @return The new value
+		 */
+		inline size_t add(volatile size_t &value, const size_t delta)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_add_fetch(&value, delta, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			return __sync_add_and_fetch(&value, delta);
+#else
+			return __locked_add(value, delta);
+#endif
+		}
+
+		/**
+		 * @return The current value
+		 */
+		inline size_t load(const volatile size_t &value)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_load_n(&value, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_synchronize();
+			return value;
+#else
+			return __locked_load(value);
+#endif
+		}
+
+		/**
+		 * Replace the value
+		 */
+		inline void store(volatile size_t &value, const size_t v)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			__atomic_store_n(&value, v, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_lock_test_and_set(&value, v);
+			__sync_synchronize();
+#else
+			__locked_store(value, v);
+#endif
+		}
+
+		/**
+		 * Replace the value
+		 * @return The previous value
+		 */
+		inline size_t exchange(volatile size_t &value, const size_t v)
+		{
+#if defined(__ATOMIC_SEQ_CST)
+			return __atomic_exchange_n(&value, v, __ATOMIC_SEQ_CST);
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+			__sync_synchronize();
+			return __sync_lock_test_and_set(&value, v);
+#else
+			return __locked_exchange(value, v);
+#endif
+		}
+	}
+}
+
+#endif /* IBRCOMMON_ATOMIC_H_ */
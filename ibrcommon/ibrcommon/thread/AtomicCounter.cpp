@@ -25,7 +25,7 @@
 namespace ibrcommon
 {
 	AtomicCounter::AtomicCounter(int init)
-	 : _value(init), _unblock(false)
+	 : _value(init), _waiting(0), _unblock(false)
 	{
 
 	}
@@ -37,8 +37,7 @@ namespace ibrcommon
 
 	int AtomicCounter::value()
 	{
-		ibrcommon::MutexLock l(_lock);
-		return _value;
+		return atomic::load(_value);
 	}
 
 	void AtomicCounter::unblockAll()
@@ -51,42 +50,54 @@ namespace ibrcommon
 	void AtomicCounter::wait(int until)
 	{
 		ibrcommon::MutexLock l(_lock);
-		while ((_value != until) && !_unblock)
+
+		// announce the waiting thread before the value is checked,
+		// thus a modification of the value never misses the signal
+		atomic::add(_waiting, 1);
+
+		while ((atomic::load(_value) != until) && !_unblock)
 		{
 			_lock.wait();
 		}
+
+		atomic::add(_waiting, -1);
 	}
 
-	AtomicCounter& AtomicCounter::operator++()
+	void AtomicCounter::signal()
 	{
+		// the lock is only required if there are waiting threads
+		if (atomic::load(_waiting) == 0) return;
+
 		ibrcommon::MutexLock l(_lock);
-		_value++;
 		_lock.signal(true);
+	}
+
+	AtomicCounter& AtomicCounter::operator++()
+	{
+		atomic::add(_value, 1);
+		signal();
 		return *this;
 	}
 
 	AtomicCounter AtomicCounter::operator++(int)
 	{
-		ibrcommon::MutexLock l(_lock);
-		_value++;
-		_lock.signal(true);
-		return AtomicCounter(_value - 1);
+		const int ret = atomic::add(_value, 1) - 1;
+		signal();
+		return AtomicCounter(ret);
 	}
 
 	AtomicCounter& AtomicCounter::operator--()
 	{
-		ibrcommon::MutexLock l(_lock);
-		_value--;
-		_lock.signal(true);
+		atomic::add(_value, -1);
+		signal();
 		return *this;
 	}
 
 	AtomicCounter AtomicCounter::operator--(int)
 	{
-		ibrcommon::MutexLock l(_lock);
-		_value--;
-		_lock.signal(true);
-		return AtomicCounter(_value + 1);
+		const int ret = atomic::add(_value, -1) + 1;
+		signal();
+		return AtomicCounter(ret);
 	}
 
 	AtomicCounter::Lock::Lock(AtomicCounter &counter)
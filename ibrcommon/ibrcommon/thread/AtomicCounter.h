@@ -23,6 +23,7 @@
 #define ATOMICCOUNTER_H_
 
 #include "ibrcommon/thread/Conditional.h"
+#include "ibrcommon/thread/Atomic.h"
 
 namespace ibrcommon
 {
@@ -53,8 +54,19 @@ namespace ibrcommon
 		};
 
 	private:
+		/**
+		 * Wake-up waiting threads, if there are any
+		 */
+		void signal();
+
 		ibrcommon::Conditional _lock;
-		int _value;
+
+		// the value is modified without holding the lock
+		volatile int _value;
+
+		// number of threads waiting for a value
+		volatile int _waiting;
+
 		bool _unblock;
 
 	};
@@ -23,10 +23,7 @@
 #include "ibrcommon/thread/Timer.h"
 #include "ibrcommon/thread/MutexLock.h"
 
-#include <iostream>
-#include <queue>
-#include <utility>
-#include <sstream>
+#include <time.h>
 
 namespace ibrcommon
 {
@@ -41,7 +38,7 @@ namespace ibrcommon
 	}
 
 	Timer::Timer(TimerCallback &callback, size_t timeout)
-	 : _state(TIMER_UNSET), _callback(callback), _timeout(timeout * 1000)
+	 : _wheel(TimerWheel::getInstance()), _state(TIMER_UNSET), _callback(callback), _timeout(timeout * 1000)
 	{
 	}
 
@@ -51,30 +48,45 @@ namespace ibrcommon
 		join();
 	}
 
-	void Timer::__cancellation() throw ()
+	void Timer::__arm__()
 	{
-		MutexLock l(_state);
-		_state.setState(TIMER_CANCELLED);
-		_state.abort();
+		if (_timeout > 0)
+		{
+			_state = TIMER_RUNNING;
+			_wheel.arm(*this, _timeout);
+		}
+		else
+		{
+			// a timer without timeout stops immediately
+			_state = TIMER_CANCELLED;
+			_wheel.disarm(*this);
+		}
 	}
 
 	void Timer::set(size_t timeout)
 	{
-		MutexLock l(_state);
+		MutexLock l(_lock);
 		_timeout = timeout * 1000;
-		_state.setState(TIMER_RESET);
+
+		// restart an active timer with the new timeout
+		if ((_state == TIMER_UNSET) || (_state == TIMER_CANCELLED)) return;
+		__arm__();
 	}
 
 	void Timer::reset()
 	{
-		MutexLock l(_state);
-		_state.setState(TIMER_RESET);
+		MutexLock l(_lock);
+		if ((_state == TIMER_UNSET) || (_state == TIMER_CANCELLED)) return;
+		__arm__();
 	}
 
 	void Timer::pause()
 	{
-		MutexLock l(_state);
-		_state.setState(TIMER_STOPPED);
+		MutexLock l(_lock);
+		if ((_state == TIMER_UNSET) || (_state == TIMER_CANCELLED)) return;
+
+		_state = TIMER_STOPPED;
+		_wheel.disarm(*this);
 	}
 
 	size_t Timer::getTimeout() const
@@ -82,71 +94,64 @@ namespace ibrcommon
 		return _timeout / 1000;
 	}
 
-	void Timer::run() throw ()
+	void Timer::start()
+	{
+		MutexLock l(_lock);
+		if ((_state != TIMER_UNSET) && (_state != TIMER_CANCELLED)) return;
+		__arm__();
+	}
+
+	void Timer::stop()
 	{
-		MutexLock l(_state);
-		_state.setState(TIMER_RUNNING);
+		MutexLock l(_lock);
+		_state = TIMER_CANCELLED;
+		_wheel.disarm(*this);
+	}
 
-		while (_state.ifState(TIMER_RUNNING) || _state.ifState(TIMER_STOPPED))
+	void Timer::join()
+	{
+		_wheel.cancel(*this);
+	}
+
+	bool Timer::isRunning()
+	{
+		MutexLock l(_lock);
+		return (_state != TIMER_UNSET) && (_state != TIMER_CANCELLED);
+	}
+
+	void Timer::expired() throw ()
+	{
 		{
-			try {
-				if(_state.ifState(TIMER_RUNNING))
-				{
-					if(_timeout > 0)
-					{
-						_state.wait(_timeout);
-					}
-					else
-					{
-						throw ibrcommon::Conditional::ConditionalAbortException(ibrcommon::Conditional::ConditionalAbortException::COND_ABORT);
-					}
-				}
-				else
-				{
-					_state.wait();
-				}
-
-				// got signal, check for reset request
-				if (_state.ifState(TIMER_RESET))
-				{
-					_state.setState(TIMER_RUNNING);
-				}
-				else if(!_state.ifState(TIMER_STOPPED))
-				{
-					// stop the timer
-					_state.setState(TIMER_CANCELLED);
-				}
-			}
-			catch (const ibrcommon::Conditional::ConditionalAbortException &ex)
-			{
-				switch (ex.reason)
-				{
-					case ibrcommon::Conditional::ConditionalAbortException::COND_TIMEOUT:
-					{
-						try
-						{
-							// timeout exceeded, call callback method
-							_timeout = _callback.timeout(this) * 1000;
-							_state.setState(TIMER_RUNNING);
-						}
-						catch(const StopTimerException &ex)
-						{
-							// stop the timer
-							_state.setState(TIMER_STOPPED);
-						}
-						break;
-					}
-
-					case ibrcommon::Conditional::ConditionalAbortException::COND_ABORT:
-					case ibrcommon::Conditional::ConditionalAbortException::COND_ERROR:
-					{
-						_state.setState(TIMER_CANCELLED);
-						return;
-					}
-				}
-			}
-
-			yield();
+			MutexLock l(_lock);
+			if (_state != TIMER_RUNNING) return;
+			_state = TIMER_FIRING;
 		}
+
+		size_t timeout = 0;
+		bool stopped = false;
+
+		try {
+			// timeout exceeded, call callback method
+			timeout = _callback.timeout(this);
+		} catch (const StopTimerException&) {
+			stopped = true;
+		} catch (const std::exception&) {
+			stopped = true;
+		}
+
+		MutexLock l(_lock);
+
+		// the timer has been modified by another thread meanwhile
+		if (_state != TIMER_FIRING) return;
+
+		if (stopped)
+		{
+			// stop the timer
+			_state = TIMER_STOPPED;
+			return;
+		}
+
+		_timeout = timeout * 1000;
+		__arm__();
 	}
 }
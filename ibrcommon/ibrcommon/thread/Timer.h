@@ -22,10 +22,9 @@
 #ifndef IBRCOMMON_TIMER_H_
 #define IBRCOMMON_TIMER_H_
 
-#include "ibrcommon/thread/Thread.h"
-#include "ibrcommon/thread/Conditional.h"
-#include <map>
-#include <set>
+#include "ibrcommon/thread/TimerWheel.h"
+#include "ibrcommon/thread/Mutex.h"
+#include "ibrcommon/Exceptions.h"
 
 #include <string>
 #include <iostream>
@@ -48,7 +47,11 @@ namespace ibrcommon
 		virtual size_t timeout(Timer *timer) = 0;
 	};
 
-	class Timer : public JoinableThread
+	/**
+	 * A timer calls its callback once the timeout has been expired. All timers
+	 * share the thread of the TimerWheel, thus callbacks should return quickly.
+	 */
+	class Timer : private TimerWheel::Entry
 	{
 	public:
 		typedef size_t time_t;
@@ -80,21 +83,48 @@ namespace ibrcommon
 		 */
 		size_t getTimeout() const;
 
+		/**
+		 * Start the timer. A timer with a timeout of zero does not start.
+		 */
+		void start();
+
+		/**
+		 * Stop the timer. Use start() to start it again.
+		 */
+		void stop();
+
+		/**
+		 * Wait until a running callback has been returned.
+		 */
+		void join();
+
+		/**
+		 * Returns true, if the timer has been started and not stopped since.
+		 * A paused timer is still running.
+		 */
+		bool isRunning();
+
 	protected:
-		void run() throw ();
-		void __cancellation() throw ();
+		virtual void expired() throw ();
 
 	private:
 		enum TIMER_STATE
 		{
 			TIMER_UNSET = 0,
 			TIMER_RUNNING = 1,
-			TIMER_RESET = 2,
+			TIMER_FIRING = 2,
 			TIMER_STOPPED = 3,
 			TIMER_CANCELLED = 4
 		};
 
-		StatefulConditional<Timer::TIMER_STATE, TIMER_STOPPED> _state;
+		/**
+		 * Arm the timer with the current timeout. Requires the lock.
+		 */
+		void __arm__();
+
+		TimerWheel &_wheel;
+		ibrcommon::Mutex _lock;
+		TIMER_STATE _state;
 		TimerCallback &_callback;
 		size_t _timeout;
 	public:
@@ -0,0 +1,282 @@
+/*
+ * TimerWheel.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ibrcommon/config.h"
+#include "ibrcommon/thread/TimerWheel.h"
+#include "ibrcommon/thread/MutexLock.h"
+#include "ibrcommon/MonotonicClock.h"
+#include "ibrcommon/Logger.h"
+#include <pthread.h>
+
+namespace ibrcommon
+{
+	TimerWheel::Entry::Entry()
+	 : _prev(NULL), _next(NULL), _slot(NULL), _expires(0)
+	{
+	}
+
+	TimerWheel::Entry::~Entry()
+	{
+	}
+
+	TimerWheel::TimerWheel(const size_t resolution)
+	 : _resolution(resolution), _now(0), _wakeup(NEVER), _running(NULL), _size(0), _shutdown(false)
+	{
+		MonotonicClock::gettime(_start);
+
+		for (size_t level = 0; level < LEVELS; ++level)
+		{
+			for (size_t index = 0; index < SLOTS; ++index)
+			{
+				_slots[level][index] = NULL;
+			}
+		}
+
+		try {
+			start();
+		} catch (const ibrcommon::ThreadException &ex) {
+			IBRCOMMON_LOGGER_TAG("TimerWheel", error) << "failed to start the timer thread: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+		}
+	}
+
+	TimerWheel::~TimerWheel()
+	{
+		stop();
+		join();
+	}
+
+	TimerWheel& TimerWheel::getInstance()
+	{
+		static TimerWheel instance;
+		return instance;
+	}
+
+	void TimerWheel::arm(Entry &entry, const size_t timeout)
+	{
+		MutexLock l(_cond);
+
+		if (entry._slot != NULL)
+		{
+			__unlink__(entry);
+			--_size;
+		}
+
+		// an empty wheel may skip the ticks passed while the thread was sleeping
+		if ((_size == 0) && (_running == NULL)) _now = __get_ticks__();
+
+		// round up to the next tick, thus the entry never expires too early
+		entry._expires = (__get_time__() + timeout) / _resolution + 1;
+		if (entry._expires <= _now) entry._expires = _now + 1;
+
+		__link__(entry);
+		++_size;
+
+		// wake-up the thread if the entry expires before the next planned event
+		if (entry._expires < _wakeup) _cond.signal(true);
+	}
+
+	void TimerWheel::disarm(Entry &entry)
+	{
+		MutexLock l(_cond);
+
+		if (entry._slot == NULL) return;
+
+		__unlink__(entry);
+		--_size;
+	}
+
+	void TimerWheel::cancel(Entry &entry)
+	{
+		MutexLock l(_cond);
+
+		if (entry._slot != NULL)
+		{
+			__unlink__(entry);
+			--_size;
+		}
+
+		// wait for the callback of the entry, unless we are the callback
+		while ((_running == &entry) && !equal(tid, pthread_self()))
+		{
+			_cond.wait();
+		}
+	}
+
+	size_t TimerWheel::size()
+	{
+		MutexLock l(_cond);
+		return _size;
+	}
+
+	void TimerWheel::__cancellation() throw ()
+	{
+		MutexLock l(_cond);
+		_shutdown = true;
+		_cond.signal(true);
+	}
+
+	void TimerWheel::run() throw ()
+	{
+		MutexLock l(_cond);
+
+		while (!_shutdown)
+		{
+			const uint64_t ticks = __get_ticks__();
+
+			if (_size == 0)
+			{
+				// nothing to process, just move forward
+				_now = ticks;
+			}
+			else
+			{
+				while ((_now < ticks) && !_shutdown) __tick__();
+			}
+
+			_wakeup = __next_event__();
+
+			try {
+				if (_wakeup == NEVER)
+				{
+					_cond.wait();
+				}
+				else
+				{
+					const uint64_t now = __get_ticks__();
+					if (_wakeup > now) _cond.wait(static_cast<size_t>(_wakeup - now) * _resolution);
+				}
+			} catch (const ibrcommon::Conditional::ConditionalAbortException &ex) {
+				if (ex.reason != ibrcommon::Conditional::ConditionalAbortException::COND_TIMEOUT) break;
+			}
+		}
+
+		_wakeup = NEVER;
+	}
+
+	uint64_t TimerWheel::__get_time__() const
+	{
+		struct timespec now, diff;
+		MonotonicClock::gettime(now);
+		MonotonicClock::diff(_start, now, diff);
+
+		return static_cast<uint64_t>(diff.tv_sec) * 1000 + (diff.tv_nsec / 1000000);
+	}
+
+	uint64_t TimerWheel::__get_ticks__() const
+	{
+		return __get_time__() / _resolution;
+	}
+
+	void TimerWheel::__link__(Entry &entry)
+	{
+		// cap the timeout to the range of the wheel
+		const uint64_t range = static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS);
+		if (entry._expires - _now >= range) entry._expires = _now + range - 1;
+
+		const uint64_t delta = entry._expires - _now;
+
+		// the level is the lowest one which covers the timeout
+		size_t level = 0;
+		while ((level < LEVELS - 1) && (delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1))))) ++level;
+
+		const size_t index = static_cast<size_t>(entry._expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+		Entry **head = &_slots[level][index];
+
+		entry._slot = head;
+		entry._prev = NULL;
+		entry._next = *head;
+		if (*head != NULL) (*head)->_prev = &entry;
+		*head = &entry;
+	}
+
+	void TimerWheel::__unlink__(Entry &entry)
+	{
+		if (entry._prev != NULL) entry._prev->_next = entry._next;
+		else *entry._slot = entry._next;
+
+		if (entry._next != NULL) entry._next->_prev = entry._prev;
+
+		entry._prev = NULL;
+		entry._next = NULL;
+		entry._slot = NULL;
+	}
+
+	void TimerWheel::__cascade__(const size_t level, const size_t index)
+	{
+		Entry *entry = _slots[level][index];
+		_slots[level][index] = NULL;
+
+		while (entry != NULL)
+		{
+			Entry *next = entry->_next;
+			__link__(*entry);
+			entry = next;
+		}
+	}
+
+	void TimerWheel::__tick__()
+	{
+		++_now;
+
+		// move the entries of the next revolution into the lower levels
+		for (size_t level = 1; level < LEVELS; ++level)
+		{
+			const uint64_t mask = (static_cast<uint64_t>(1) << (SLOT_BITS * level)) - 1;
+			if ((_now & mask) != 0) break;
+
+			__cascade__(level, static_cast<size_t>(_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+		}
+
+		// process all expired entries
+		Entry **head = &_slots[0][_now & (SLOTS - 1)];
+
+		while (*head != NULL)
+		{
+			Entry *entry = *head;
+			__unlink__(*entry);
+			--_size;
+
+			_running = entry;
+
+			// the callback may arm or cancel entries
+			_cond.leave();
+			entry->expired();
+			_cond.enter();
+
+			_running = NULL;
+
+			// wake-up threads waiting for the callback
+			_cond.signal(true);
+		}
+	}
+
+	uint64_t TimerWheel::__next_event__() const
+	{
+		if (_size == 0) return NEVER;
+
+		// look for the next occupied slot up to the next cascade
+		uint64_t next = _now + 1;
+		while (((next & (SLOTS - 1)) != 0) && (_slots[0][next & (SLOTS - 1)] == NULL)) ++next;
+
+		return next;
+	}
+}
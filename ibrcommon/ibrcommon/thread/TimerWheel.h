@@ -0,0 +1,162 @@
+/*
+ * TimerWheel.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IBRCOMMON_TIMERWHEEL_H_
+#define IBRCOMMON_TIMERWHEEL_H_
+
+#include "ibrcommon/thread/Thread.h"
+#include "ibrcommon/thread/Conditional.h"
+#include <stdint.h>
+#include <sys/time.h>
+
+namespace ibrcommon
+{
+	/**
+	 * Hierarchical timer wheel. All entries are processed by a single
+	 * thread, arming and cancelling an entry takes constant time.
+	 * The expiration of an entry is rounded up to the resolution of the wheel.
+	 */
+	class TimerWheel : public JoinableThread
+	{
+	public:
+		class Entry
+		{
+		public:
+			Entry();
+			virtual ~Entry();
+
+			/**
+			 * This method is called by the thread of the wheel once the entry
+			 * has been expired. It should return quickly, because all other
+			 * entries are delayed until it returns.
+			 */
+			virtual void expired() throw () = 0;
+
+		private:
+			friend class TimerWheel;
+
+			Entry *_prev;
+			Entry *_next;
+
+			// the list head of the slot, NULL if not armed
+			Entry **_slot;
+
+			// expiration in ticks of the wheel
+			uint64_t _expires;
+		};
+
+		/**
+		 * @param resolution The length of one tick in milliseconds
+		 */
+		TimerWheel(const size_t resolution = 10);
+		virtual ~TimerWheel();
+
+		/**
+		 * Returns the wheel shared by all timers of the process
+		 */
+		static TimerWheel& getInstance();
+
+		/**
+		 * Arm an entry or move an already armed entry to a new expiration.
+		 * @param entry The entry to arm
+		 * @param timeout The timeout in milliseconds
+		 */
+		void arm(Entry &entry, const size_t timeout);
+
+		/**
+		 * Disarm an entry. The callback of the entry may still be running
+		 * when this method returns.
+		 */
+		void disarm(Entry &entry);
+
+		/**
+		 * Disarm an entry and wait until a running callback of the entry
+		 * has been finished. If called by the callback itself, this method
+		 * does not wait.
+		 */
+		void cancel(Entry &entry);
+
+		/**
+		 * @return The number of armed entries
+		 */
+		size_t size();
+
+	protected:
+		void run() throw ();
+		void __cancellation() throw ();
+
+	private:
+		static const size_t LEVELS = 4;
+		static const size_t SLOT_BITS = 8;
+		static const size_t SLOTS = 1 << SLOT_BITS;
+		static const uint64_t NEVER = static_cast<uint64_t>(-1);
+
+		/**
+		 * Returns the milliseconds passed since the creation of the wheel
+		 */
+		uint64_t __get_time__() const;
+
+		/**
+		 * Returns the number of ticks passed since the creation of the wheel
+		 */
+		uint64_t __get_ticks__() const;
+
+		void __link__(Entry &entry);
+		void __unlink__(Entry &entry);
+
+		/**
+		 * Move all entries of a slot into the lower levels
+		 */
+		void __cascade__(const size_t level, const size_t index);
+
+		/**
+		 * Advance the wheel by one tick and process all expired entries
+		 */
+		void __tick__();
+
+		/**
+		 * Returns the tick of the next event to process
+		 */
+		uint64_t __next_event__() const;
+
+		const size_t _resolution;
+		struct timespec _start;
+
+		ibrcommon::Conditional _cond;
+
+		// list heads of all slots
+		Entry* _slots[LEVELS][SLOTS];
+
+		// the last processed tick
+		uint64_t _now;
+
+		// the tick the thread is going to wake up
+		uint64_t _wakeup;
+
+		// the entry whose callback is running
+		Entry *_running;
+
+		size_t _size;
+		bool _shutdown;
+	};
+}
+
+#endif /* IBRCOMMON_TIMERWHEEL_H_ */
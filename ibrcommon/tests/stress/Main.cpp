@@ -20,6 +20,7 @@
  */
 
 #include <StressBLOB.h>
+#include <StressRefcnt.h>
 #include <ibrcommon/data/BLOB.h>
 #include <list>
 
@@ -32,6 +33,7 @@ int main()
 
 	std::list<StressModule*> list;
 	list.push_back(new StressBLOB());
+	list.push_back(new StressRefcnt());
 
 	for (std::list<StressModule*>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
 	{
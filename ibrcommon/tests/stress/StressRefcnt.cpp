@@ -0,0 +1,113 @@
+/*
+ * StressRefcnt.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "StressRefcnt.h"
+#include <iostream>
+
+static const size_t REFCNT_WORKER = 8;
+static const size_t REFCNT_COUNT = 1000000;
+
+StressRefcnt::StressRefcnt()
+ : _ref(new int(42))
+{
+	for (unsigned int i = 0; i < REFCNT_WORKER; ++i)
+	{
+		_worker.push_back(new RefcntWorker(_ref, _counter, REFCNT_COUNT));
+	}
+}
+
+StressRefcnt::~StressRefcnt()
+{
+	for (std::list<RefcntWorker*>::const_iterator iter = _worker.begin(); iter != _worker.end(); ++iter)
+	{
+		delete (*iter);
+	}
+}
+
+void StressRefcnt::stage1()
+{
+	_tm.start();
+
+	for (std::list<RefcntWorker*>::const_iterator iter = _worker.begin(); iter != _worker.end(); ++iter)
+	{
+		std::cout << "+";
+		(*iter)->start();
+	}
+}
+
+void StressRefcnt::stage2()
+{
+}
+
+void StressRefcnt::stage3()
+{
+	for (std::list<RefcntWorker*>::const_iterator iter = _worker.begin(); iter != _worker.end(); ++iter)
+	{
+		(*iter)->join();
+	}
+
+	_tm.stop();
+
+	std::cout << "#" << std::endl;
+	std::cout << (REFCNT_WORKER * REFCNT_COUNT) << " copies of a shared reference in " << _tm.getMilliseconds() << " ms" << std::endl;
+}
+
+bool StressRefcnt::check()
+{
+	// all workers are holding one reference
+	if (_ref.unique())
+	{
+		std::cerr << "ERROR: reference count lost" << std::endl;
+		return false;
+	}
+
+	// every copy increments and decrements the counter once
+	if (_counter.value() != 0)
+	{
+		std::cerr << "ERROR: wrong counter value: " << _counter.value() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+StressRefcnt::RefcntWorker::RefcntWorker(const refcnt_ptr<int> &ref, ibrcommon::AtomicCounter &counter, const size_t count)
+ : _ref(ref), _counter(counter), _count(count)
+{
+}
+
+StressRefcnt::RefcntWorker::~RefcntWorker()
+{}
+
+void StressRefcnt::RefcntWorker::run() throw ()
+{
+	for (size_t i = 0; i < _count; ++i)
+	{
+		refcnt_ptr<int> copy = _ref;
+		ibrcommon::AtomicCounter::Lock l(_counter);
+		if (*copy != 42) std::cerr << "ERROR: wrong value" << std::endl;
+	}
+}
+
+void StressRefcnt::RefcntWorker::__cancellation() throw ()
+{
+}
@@ -0,0 +1,72 @@
+/*
+ * StressRefcnt.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <StressModule.h>
+#include <ibrcommon/refcnt_ptr.h>
+#include <ibrcommon/thread/AtomicCounter.h>
+#include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/TimeMeasurement.h>
+#include <list>
+
+#ifndef STRESSREFCNT_H_
+#define STRESSREFCNT_H_
+
+/**
+ * Micro-benchmark of the reference counting primitives. Several threads
+ * copy and release the same reference and modify the same counter.
+ */
+class StressRefcnt : public StressModule
+{
+public:
+	StressRefcnt();
+	virtual ~StressRefcnt();
+
+	void stage1();
+	void stage2();
+	void stage3();
+
+	bool check();
+
+private:
+	class RefcntWorker : public ibrcommon::JoinableThread
+	{
+	public:
+		RefcntWorker(const refcnt_ptr<int> &ref, ibrcommon::AtomicCounter &counter, const size_t count);
+		virtual ~RefcntWorker();
+
+		void run() throw ();
+		void __cancellation() throw ();
+
+	private:
+		refcnt_ptr<int> _ref;
+		ibrcommon::AtomicCounter &_counter;
+		size_t _count;
+	};
+
+	refcnt_ptr<int> _ref;
+	ibrcommon::AtomicCounter _counter;
+	ibrcommon::TimeMeasurement _tm;
+
+	std::list<RefcntWorker*> _worker;
+};
+
+#endif /* STRESSREFCNT_H_ */
@@ -0,0 +1,244 @@
+/*
+ * LoggerTest.cpp
+ *
+ * Copyright (C) 2011 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "thread/LoggerTest.h"
+#include <ibrcommon/Logger.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <sstream>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (LoggerTest);
+
+LoggerTest::LogSink LoggerTest::_sink;
+std::ostream LoggerTest::_stream(&LoggerTest::_sink);
+
+LoggerTest::LogSink::LogSink()
+ : _slow(false)
+{
+}
+
+LoggerTest::LogSink::~LogSink()
+{
+}
+
+size_t LoggerTest::LogSink::size()
+{
+	ibrcommon::MutexLock l(_lock);
+	return _lines.size();
+}
+
+std::vector<std::string> LoggerTest::LogSink::lines()
+{
+	ibrcommon::MutexLock l(_lock);
+	return _lines;
+}
+
+void LoggerTest::LogSink::clear()
+{
+	ibrcommon::MutexLock l(_lock);
+	_lines.clear();
+}
+
+std::streamsize LoggerTest::LogSink::xsputn(const char *s, std::streamsize n)
+{
+	if (_slow) ::usleep(100);
+
+	// the message is written at once, the line break follows separately
+	ibrcommon::MutexLock l(_lock);
+	_lines.push_back(std::string(s, n));
+	return n;
+}
+
+int LoggerTest::LogSink::overflow(int c)
+{
+	// drop the line breaks
+	return c;
+}
+
+LoggerTest::TestThread::TestThread(size_t id, size_t count)
+ : _id(id), _count(count)
+{
+}
+
+LoggerTest::TestThread::~TestThread()
+{
+	join();
+}
+
+void LoggerTest::TestThread::run() throw ()
+{
+	for (size_t i = 0; i < _count; ++i)
+	{
+		IBRCOMMON_LOGGER_TAG("LoggerTest", info) << _id << " " << i << IBRCOMMON_LOGGER_ENDL;
+	}
+}
+
+void LoggerTest::TestThread::__cancellation() throw ()
+{
+}
+
+void LoggerTest::setUp()
+{
+	static bool enabled = false;
+
+	if (!enabled)
+	{
+		ibrcommon::Logger::addStream(_stream, ibrcommon::Logger::LOGGER_ALL, ibrcommon::Logger::LOG_NONE);
+		ibrcommon::Logger::enableAsync();
+		enabled = true;
+	}
+
+	_sink.clear();
+}
+
+void LoggerTest::tearDown()
+{
+}
+
+void LoggerTest::waitFor(size_t count)
+{
+	for (size_t i = 0; i < 500; ++i)
+	{
+		if (_sink.size() >= count) return;
+		ibrcommon::Thread::sleep(10);
+	}
+}
+
+void LoggerTest::checkOrder(const std::vector<std::string> &lines, size_t producers, size_t count)
+{
+	std::vector<size_t> next(producers, 0);
+
+	for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+	{
+		std::stringstream ss(*iter);
+		size_t id = 0, seq = 0;
+		ss >> id >> seq;
+
+		// skip messages of other components
+		if (ss.fail() || (id >= producers)) continue;
+
+		// each message of a producer follows its predecessor
+		CPPUNIT_ASSERT_EQUAL(next[id], seq);
+		next[id]++;
+	}
+
+	for (size_t i = 0; i < producers; ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(count, next[i]);
+	}
+}
+
+void LoggerTest::checkComplete(const std::vector<std::string> &lines, size_t producers, size_t count)
+{
+	std::vector<std::vector<size_t> > seen(producers, std::vector<size_t>(count, 0));
+
+	for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+	{
+		std::stringstream ss(*iter);
+		size_t id = 0, seq = 0;
+		ss >> id >> seq;
+
+		// skip messages of other components
+		if (ss.fail() || (id >= producers) || (seq >= count)) continue;
+
+		seen[id][seq]++;
+	}
+
+	// each message has been written exactly once
+	for (size_t i = 0; i < producers; ++i)
+	{
+		for (size_t j = 0; j < count; ++j)
+		{
+			CPPUNIT_ASSERT_EQUAL((size_t)1, seen[i][j]);
+		}
+	}
+}
+
+void LoggerTest::logger_test01()
+{
+	// more messages than fit into the ring of a thread
+	TestThread t(0, 2000);
+	t.start();
+	t.join();
+
+	waitFor(2000);
+	checkOrder(_sink.lines(), 1, 2000);
+}
+
+void LoggerTest::logger_test02()
+{
+	std::vector<TestThread*> threads;
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		threads.push_back(new TestThread(i, 2000));
+	}
+
+	for (std::vector<TestThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+	{
+		(*iter)->start();
+	}
+
+	for (std::vector<TestThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+	{
+		(*iter)->join();
+		delete (*iter);
+	}
+
+	waitFor(8000);
+	checkOrder(_sink.lines(), 4, 2000);
+}
+
+void LoggerTest::logger_test03()
+{
+	std::vector<TestThread*> threads;
+
+	// let the writer thread fall behind the producers
+	_sink._slow = true;
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		threads.push_back(new TestThread(i, 2000));
+	}
+
+	for (std::vector<TestThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+	{
+		(*iter)->start();
+	}
+
+	// stop the writer while the producers are still logging
+	ibrcommon::Thread::sleep(20);
+	ibrcommon::Logger::stop();
+	ibrcommon::LogWriter::getInstance().join();
+
+	for (std::vector<TestThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+	{
+		(*iter)->join();
+		delete (*iter);
+	}
+
+	_sink._slow = false;
+
+	// no message is lost, neither queued nor logged during the shutdown
+	checkComplete(_sink.lines(), 4, 2000);
+
+	ibrcommon::Logger::removeStream(_stream);
+}
@@ -0,0 +1,112 @@
+/*
+ * LoggerTest.h
+ *
+ * Copyright (C) 2011 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#ifndef LOGGERTEST_H_
+#define LOGGERTEST_H_
+
+#include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+class LoggerTest : public CPPUNIT_NS :: TestFixture
+{
+	CPPUNIT_TEST_SUITE (LoggerTest);
+	CPPUNIT_TEST (logger_test01);
+	CPPUNIT_TEST (logger_test02);
+	// stops the asynchronous logging, thus it has to be the last test
+	CPPUNIT_TEST (logger_test03);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp (void);
+	void tearDown (void);
+
+	/**
+	 * Collects every written message as one line. Messages are
+	 * written by the writer thread and after the shutdown by the
+	 * logging threads directly, thus the access is locked.
+	 */
+	class LogSink : public std::streambuf
+	{
+	public:
+		LogSink();
+		virtual ~LogSink();
+
+		size_t size();
+		std::vector<std::string> lines();
+		void clear();
+
+		// slow down each write by a few microseconds
+		bool _slow;
+
+	protected:
+		virtual std::streamsize xsputn(const char *s, std::streamsize n);
+		virtual int overflow(int c);
+
+	private:
+		ibrcommon::Mutex _lock;
+		std::vector<std::string> _lines;
+	};
+
+	class TestThread : public ibrcommon::JoinableThread
+	{
+	public:
+		TestThread(size_t id, size_t count);
+		~TestThread();
+
+		void run() throw ();
+		void __cancellation() throw ();
+
+		size_t _id;
+		size_t _count;
+	};
+
+protected:
+	void logger_test01();
+	void logger_test02();
+	void logger_test03();
+
+private:
+	/**
+	 * Wait until the sink contains the given number of messages
+	 */
+	static void waitFor(size_t count);
+
+	/**
+	 * Check that all messages of each producer are complete and in order
+	 */
+	static void checkOrder(const std::vector<std::string> &lines, size_t producers, size_t count);
+
+	/**
+	 * Check that each message of each producer has been written exactly once
+	 */
+	static void checkComplete(const std::vector<std::string> &lines, size_t producers, size_t count);
+
+	static LogSink _sink;
+	static std::ostream _stream;
+};
+
+#endif /* LOGGERTEST_H_ */
@@ -20,7 +20,10 @@
  */
 
 #include "thread/TimerTest.h"
+#include <ibrcommon/thread/TimerWheel.h>
+#include <ibrcommon/MonotonicClock.h>
 #include <unistd.h>
+#include <vector>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (TimerTest);
 
@@ -49,3 +52,113 @@ void TimerTest::timer_test01()
 	timer.stop();
 	timer.join();
 }
+
+class TimerTestCounter : public ibrcommon::TimerCallback
+{
+public:
+	TimerTestCounter() : fired(0) { }
+	virtual ~TimerTestCounter() { }
+
+	virtual size_t timeout(ibrcommon::Timer*)
+	{
+		++fired;
+		return 1;
+	}
+
+	size_t fired;
+};
+
+void TimerTest::timer_test02()
+{
+	TimerTestCounter counter;
+	ibrcommon::Timer timer(counter, 1);
+	timer.start();
+
+	ibrcommon::Thread::sleep(2500);
+
+	// the timer fires once per second
+	CPPUNIT_ASSERT_EQUAL((size_t)2, counter.fired);
+	CPPUNIT_ASSERT(timer.isRunning());
+
+	timer.pause();
+	ibrcommon::Thread::sleep(1500);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, counter.fired);
+
+	timer.stop();
+	timer.join();
+	CPPUNIT_ASSERT(!timer.isRunning());
+}
+
+class TimerWheelTestEntry : public ibrcommon::TimerWheel::Entry
+{
+public:
+	TimerWheelTestEntry() : fired(0), timeout(0) { }
+	virtual ~TimerWheelTestEntry() { }
+
+	void arm(ibrcommon::TimerWheel &wheel, size_t ms)
+	{
+		ibrcommon::MonotonicClock::gettime(armed);
+		timeout = ms;
+		wheel.arm(*this, ms);
+	}
+
+	virtual void expired() throw ()
+	{
+		ibrcommon::MonotonicClock::gettime(when);
+		++fired;
+	}
+
+	size_t getDelay() const
+	{
+		struct timespec diff;
+		ibrcommon::MonotonicClock::diff(armed, when, diff);
+		return (diff.tv_sec * 1000) + (diff.tv_nsec / 1000000);
+	}
+
+	size_t fired;
+	size_t timeout;
+	struct timespec armed;
+	struct timespec when;
+};
+
+void TimerTest::timer_wheel_test()
+{
+	ibrcommon::TimerWheel wheel(10);
+
+	// a few thousand timers, the last one beyond the first level of the wheel
+	std::vector<TimerWheelTestEntry> entries(2001);
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		entries[i].arm(wheel, 50 + (i % 500));
+	}
+	entries[2000].arm(wheel, 3000);
+
+	CPPUNIT_ASSERT_EQUAL((size_t)2001, wheel.size());
+
+	// cancel every second timer
+	for (size_t i = 1; i < 2000; i += 2)
+	{
+		wheel.cancel(entries[i]);
+	}
+
+	ibrcommon::Thread::sleep(3500);
+
+	CPPUNIT_ASSERT_EQUAL((size_t)0, wheel.size());
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const TimerWheelTestEntry &e = entries[i];
+
+		if ((i < 2000) && (i % 2 == 1))
+		{
+			CPPUNIT_ASSERT_EQUAL((size_t)0, e.fired);
+		}
+		else
+		{
+			CPPUNIT_ASSERT_EQUAL((size_t)1, e.fired);
+
+			// never earlier than requested
+			CPPUNIT_ASSERT(e.getDelay() >= e.timeout);
+		}
+	}
+}
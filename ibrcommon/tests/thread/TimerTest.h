@@ -31,6 +31,8 @@ class TimerTest : public CPPUNIT_NS :: TestFixture, public ibrcommon::TimerCallb
 {
 	CPPUNIT_TEST_SUITE (TimerTest);
 	CPPUNIT_TEST (timer_test01);
+	CPPUNIT_TEST (timer_test02);
+	CPPUNIT_TEST (timer_wheel_test);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -41,6 +43,8 @@ public:
 
 protected:
 	void timer_test01();
+	void timer_test02();
+	void timer_wheel_test();
 };
 
 #endif /* TIMERTEST_H_ */
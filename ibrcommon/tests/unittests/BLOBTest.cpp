@@ -34,6 +34,10 @@
 #include <ibrcommon/data/BLOB.h>
 #include <ibrcommon/data/File.h>
 #include <ibrcommon/thread/MutexLock.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstring>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BLOBTest);
 
@@ -131,8 +135,201 @@ void BLOBTest::testTmpFileBLOBCreate()
 	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
 }
 
+void BLOBTest::testTmpFileBLOBGetFile()
+{
+	ibrcommon::File tmppath("/tmp");
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(tmppath), true);
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io) << "Hello World";
+	}
+
+	// the data has to be in the file once the stream is closed
+	const ibrcommon::File &f = (*ref).getFile();
+	CPPUNIT_ASSERT(f.exists());
+	CPPUNIT_ASSERT_EQUAL((size_t)11, (size_t)f.size());
+
+	// memory based BLOBs do not have a file
+	ibrcommon::BLOB::changeProvider(new ibrcommon::MemoryBLOBProvider(), true);
+	ibrcommon::BLOB::Reference mref = ibrcommon::BLOB::create();
+	CPPUNIT_ASSERT_THROW((*mref).getFile(), ibrcommon::IOException);
+}
+
+void BLOBTest::testTmpFileBLOBSpan()
+{
+	ibrcommon::File tmppath("/tmp");
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(tmppath), true);
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io) << "Hello World";
+	}
+
+	{
+		const ibrcommon::BLOB::span data(ref);
+		CPPUNIT_ASSERT(data.valid());
+		CPPUNIT_ASSERT_EQUAL((std::streamsize)11, data.size());
+		CPPUNIT_ASSERT_EQUAL(std::string("Hello World"), std::string(data.data(), data.size()));
+	}
+
+	// the BLOB has to be unlocked after the span is gone
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io).seekp(0, std::ios::end);
+		(*io) << "!";
+	}
+
+	{
+		const ibrcommon::BLOB::span data(ref);
+		CPPUNIT_ASSERT_EQUAL(std::string("Hello World!"), std::string(data.data(), data.size()));
+	}
+
+	// empty BLOBs can not be mapped
+	ibrcommon::BLOB::Reference eref = ibrcommon::BLOB::create();
+	CPPUNIT_ASSERT(!ibrcommon::BLOB::span(eref).valid());
+
+	// memory based BLOBs have to be accessed using the stream
+	ibrcommon::BLOB::changeProvider(new ibrcommon::MemoryBLOBProvider(), true);
+	ibrcommon::BLOB::Reference mref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream io = mref.iostream();
+		(*io) << "Hello World";
+	}
+	CPPUNIT_ASSERT(!ibrcommon::BLOB::span(mref).valid());
+}
+
+void BLOBTest::testSpanLarge()
+{
+	const size_t length = 16 * 1024 * 1024;
+
+	ibrcommon::File tmppath("/tmp");
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(tmppath), true);
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		std::vector<char> buf(4096);
+		for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<char>(i);
+
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		for (size_t i = 0; i < length; i += buf.size())
+			(*io).write(&buf[0], buf.size());
+	}
+
+	// read the data using the stream interface
+	std::string content;
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		std::stringstream ss;
+		ibrcommon::BLOB::copy(ss, *io, io.size());
+		content = ss.str();
+	}
+
+	// the mapped data has to match the data read by the stream
+	{
+		const ibrcommon::BLOB::span data(ref);
+		CPPUNIT_ASSERT(data.valid());
+		CPPUNIT_ASSERT_EQUAL((std::streamsize)length, data.size());
+		CPPUNIT_ASSERT_EQUAL(content.size(), (size_t)data.size());
+		CPPUNIT_ASSERT(::memcmp(content.data(), data.data(), content.size()) == 0);
+	}
+
+	// spans have to release the limit of open files
+	for (size_t i = 0; i < 32; ++i)
+	{
+		const ibrcommon::BLOB::span data(ref);
+		CPPUNIT_ASSERT(data.valid());
+	}
+
+	// restore the default provider
+	ibrcommon::BLOB::changeProvider(new ibrcommon::MemoryBLOBProvider(), true);
+}
+
 /*=== END   tests for class 'TmpFileBLOB' ===*/
 
+/*=== BEGIN tests for class 'RangeBLOB' ===*/
+static std::string readAll(ibrcommon::BLOB::Reference &ref)
+{
+	ibrcommon::BLOB::iostream io = ref.iostream();
+	std::stringstream ss;
+	ibrcommon::BLOB::copy(ss, *io, io.size());
+	return ss.str();
+}
+
+void BLOBTest::testRangeBLOB()
+{
+	ibrcommon::BLOB::changeProvider(new ibrcommon::MemoryBLOBProvider(), true);
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io) << "0123456789";
+	}
+
+	ibrcommon::BLOB::Reference r1 = ibrcommon::BLOB::range(ref, 3, 4);
+	CPPUNIT_ASSERT_EQUAL((std::streamsize)4, r1.size());
+	CPPUNIT_ASSERT_EQUAL(std::string("3456"), readAll(r1));
+
+	// the length is limited to the available data
+	ibrcommon::BLOB::Reference r2 = ibrcommon::BLOB::range(ref, 6, 100);
+	CPPUNIT_ASSERT_EQUAL(std::string("6789"), readAll(r2));
+
+	// a range of a range
+	ibrcommon::BLOB::Reference r3 = ibrcommon::BLOB::range(r1, 1, 2);
+	CPPUNIT_ASSERT_EQUAL(std::string("45"), readAll(r3));
+
+	// a range behind the data is empty
+	ibrcommon::BLOB::Reference r4 = ibrcommon::BLOB::range(ref, 20, 5);
+	CPPUNIT_ASSERT_EQUAL((std::streamsize)0, r4.size());
+
+	// seek within the range
+	{
+		ibrcommon::BLOB::iostream io = r1.iostream();
+		(*io).seekg(2, std::ios::beg);
+		CPPUNIT_ASSERT_EQUAL('5', (char)(*io).get());
+		(*io).seekg(0, std::ios::end);
+		CPPUNIT_ASSERT_EQUAL((std::streamoff)4, (std::streamoff)(*io).tellg());
+		CPPUNIT_ASSERT((*io).get() == std::char_traits<char>::eof());
+	}
+
+	// the view is read-only
+	CPPUNIT_ASSERT_THROW(r1.iostream().clear(), ibrcommon::IOException);
+}
+
+void BLOBTest::testRangeBLOBSpan()
+{
+	ibrcommon::File tmppath("/tmp");
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(tmppath), true);
+
+	// use data larger than a page to test the alignment of the mapping
+	std::string data;
+	for (size_t i = 0; i < 10000; ++i) data.push_back(static_cast<char>('a' + (i % 26)));
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io) << data;
+	}
+
+	ibrcommon::BLOB::Reference r = ibrcommon::BLOB::range(ref, 5000, 3000);
+
+	// the view references the file of the origin BLOB
+	CPPUNIT_ASSERT_EQUAL((*ref).getFile().getPath(), (*r).getFile().getPath());
+	CPPUNIT_ASSERT_EQUAL((std::streamoff)5000, (*r).getFileOffset());
+
+	{
+		const ibrcommon::BLOB::span s(r);
+		CPPUNIT_ASSERT(s.valid());
+		CPPUNIT_ASSERT_EQUAL((std::streamsize)3000, s.size());
+		CPPUNIT_ASSERT_EQUAL(data.substr(5000, 3000), std::string(s.data(), s.size()));
+	}
+
+	CPPUNIT_ASSERT_EQUAL(data.substr(5000, 3000), readAll(r));
+}
+/*=== END   tests for class 'RangeBLOB' ===*/
+
 void BLOBTest::setUp()
 {
 }
@@ -36,8 +36,16 @@ class BLOBTest : public CppUnit::TestFixture {
 
 		/*=== BEGIN tests for class 'TmpFileBLOB' ===*/
 		void testTmpFileBLOBCreate();
+		void testTmpFileBLOBGetFile();
+		void testTmpFileBLOBSpan();
+		void testSpanLarge();
 		/*=== END   tests for class 'TmpFileBLOB' ===*/
 
+		/*=== BEGIN tests for class 'RangeBLOB' ===*/
+		void testRangeBLOB();
+		void testRangeBLOBSpan();
+		/*=== END   tests for class 'RangeBLOB' ===*/
+
 		void setUp();
 		void tearDown();
 
@@ -50,6 +58,11 @@ class BLOBTest : public CppUnit::TestFixture {
 //			CPPUNIT_TEST(testGetSize);
 			CPPUNIT_TEST(testStringBLOBCreate);
 			CPPUNIT_TEST(testTmpFileBLOBCreate);
+			CPPUNIT_TEST(testTmpFileBLOBGetFile);
+			CPPUNIT_TEST(testTmpFileBLOBSpan);
+			CPPUNIT_TEST(testSpanLarge);
+			CPPUNIT_TEST(testRangeBLOB);
+			CPPUNIT_TEST(testRangeBLOBSpan);
 		CPPUNIT_TEST_SUITE_END();
 };
 #endif /* BLOBTEST_HH */
@@ -22,7 +22,12 @@
 #include "Base64StreamTest.h"
 #include <ibrcommon/data/Base64Stream.h>
 #include <ibrcommon/data/Base64Reader.h>
+#include <ibrcommon/data/Base64.h>
+#include <ibrcommon/TimeMeasurement.h>
 #include <sstream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Base64StreamTest);
 
@@ -132,6 +137,87 @@ void Base64StreamTest::testReader()
 	}
 }
 
+void Base64StreamTest::testBlockCodec()
+{
+	const size_t groups = 1000;
+
+	std::vector<char> data(groups * 3);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<char>(::rand());
+
+	// encode all groups at once
+	std::vector<char> encoded(groups * 4);
+	ibrcommon::Base64::encode(&data[0], groups, &encoded[0]);
+
+	// compare against the group-wise encoding
+	for (size_t i = 0; i < groups; ++i)
+	{
+		ibrcommon::Base64::Group g;
+		g.set_0(data[i * 3]);
+		g.set_1(data[i * 3 + 1]);
+		g.set_2(data[i * 3 + 2]);
+
+		CPPUNIT_ASSERT_EQUAL(ibrcommon::Base64::encodeCharacterTable[g.b64_0()], encoded[i * 4]);
+		CPPUNIT_ASSERT_EQUAL(ibrcommon::Base64::encodeCharacterTable[g.b64_1()], encoded[i * 4 + 1]);
+		CPPUNIT_ASSERT_EQUAL(ibrcommon::Base64::encodeCharacterTable[g.b64_2()], encoded[i * 4 + 2]);
+		CPPUNIT_ASSERT_EQUAL(ibrcommon::Base64::encodeCharacterTable[g.b64_3()], encoded[i * 4 + 3]);
+	}
+
+	// decode all groups at once
+	std::vector<char> decoded(groups * 3);
+	CPPUNIT_ASSERT_EQUAL(groups, ibrcommon::Base64::decode(&encoded[0], encoded.size(), &decoded[0]));
+	CPPUNIT_ASSERT(data == decoded);
+
+	// the decoding stops at the first group with an unknown or padding character
+	encoded[401] = '\n';
+	encoded[802] = '=';
+	CPPUNIT_ASSERT_EQUAL((size_t)100, ibrcommon::Base64::decode(&encoded[0], encoded.size(), &decoded[0]));
+	CPPUNIT_ASSERT_EQUAL((size_t)99, ibrcommon::Base64::decode(&encoded[404], encoded.size() - 404, &decoded[0]));
+}
+
+void Base64StreamTest::testBenchmark()
+{
+	// read the encoded reference file
+	std::fstream f("../base64-enc.dat");
+	CPPUNIT_ASSERT(f.good());
+
+	std::stringstream ss_reference;
+	ss_reference << f.rdbuf();
+	const std::string encoded = ss_reference.str();
+
+	// decode the reference once to get the plain data
+	std::stringstream ss_plain;
+	ibrcommon::Base64Stream(ss_plain, true) << encoded << std::flush;
+	const std::string plain = ss_plain.str();
+
+	const int rounds = 200;
+	ibrcommon::TimeMeasurement tm;
+
+	tm.start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		std::stringstream ss;
+		ibrcommon::Base64Stream(ss, true) << encoded << std::flush;
+		CPPUNIT_ASSERT_EQUAL(plain.length(), ss.str().length());
+	}
+	tm.stop();
+
+	const double decode_rate = (double)(plain.length() * rounds) / tm.getMicroseconds();
+
+	tm.start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		std::stringstream ss;
+		ibrcommon::Base64Stream(ss, false, 76) << plain << std::flush;
+		CPPUNIT_ASSERT(ss.str().length() > plain.length());
+	}
+	tm.stop();
+
+	const double encode_rate = (double)(plain.length() * rounds) / tm.getMicroseconds();
+
+	std::cout << " decode: " << decode_rate << " MB/s, encode: " << encode_rate << " MB/s " << std::flush;
+}
+
 void Base64StreamTest::compare(std::istream &s1, std::istream &s2)
 {
 	s1.clear(); s1.seekg(0);
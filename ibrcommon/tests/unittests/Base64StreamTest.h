@@ -35,6 +35,8 @@ class Base64StreamTest : public CppUnit::TestFixture {
 		void testDecode();
 		void testReader();
 		void testFileReference();
+		void testBlockCodec();
+		void testBenchmark();
 		/*=== END   tests for class 'Base64StreamTest' ===*/
 
 		void setUp();
@@ -46,6 +48,8 @@ class Base64StreamTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST(testDecode);
 		CPPUNIT_TEST(testReader);
 		CPPUNIT_TEST(testFileReference);
+		CPPUNIT_TEST(testBlockCodec);
+		CPPUNIT_TEST(testBenchmark);
 		CPPUNIT_TEST_SUITE_END();
 };
 
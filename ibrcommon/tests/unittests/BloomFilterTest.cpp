@@ -32,7 +32,9 @@
 
 #include "BloomFilterTest.hh"
 #include "ibrcommon/data/BloomFilter.h"
+#include <ibrcommon/TimeMeasurement.h>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <string.h>
@@ -522,6 +524,165 @@ void BloomFilterTest::testMemory()
 	CPPUNIT_ASSERT(!Filter1.contains("test"));
 
 }
+
+/**
+ * Bloom-filter using the list based hash function
+ * to compare against the allocation-free implementation
+ */
+class ListBloomFilter : public ibrcommon::BloomFilter
+{
+public:
+	ListBloomFilter(std::size_t table_size, std::size_t salt_count)
+	 : ibrcommon::BloomFilter(table_size, table_size, salt_count) { }
+
+	void insert(const std::string &key)
+	{
+		std::size_t bit_index = 0;
+		std::size_t bit = 0;
+
+		const std::list<ibrcommon::bloom_type> hashes = _hashp.hash((const unsigned char*)key.c_str(), key.length());
+		for (std::list<ibrcommon::bloom_type>::const_iterator iter = hashes.begin(); iter != hashes.end(); ++iter)
+		{
+			compute_indices( (*iter), bit_index, bit );
+			bit_table_[bit_index / bits_per_char] |= bit_mask[bit];
+		}
+	}
+
+	bool contains(const std::string &key) const
+	{
+		std::size_t bit_index = 0;
+		std::size_t bit = 0;
+
+		const std::list<ibrcommon::bloom_type> hashes = _hashp.hash((const unsigned char*)key.c_str(), key.length());
+		for (std::list<ibrcommon::bloom_type>::const_iterator iter = hashes.begin(); iter != hashes.end(); ++iter)
+		{
+			compute_indices( (*iter), bit_index, bit );
+			if ((bit_table_[bit_index / bits_per_char] & bit_mask[bit]) != bit_mask[bit]) return false;
+		}
+
+		return true;
+	}
+};
+
+static void createKeys(std::vector<std::string> &keys, const std::string &prefix, const size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::stringstream ss;
+		ss << prefix << "dtn://node" << (i % 97) << "/app " << (100000 + i) << "." << (i * 7);
+		keys.push_back(ss.str());
+	}
+}
+
+void BloomFilterTest::testBatch()
+{
+	std::vector<std::string> keys;
+	createKeys(keys, "", 1000);
+
+	std::vector<const unsigned char*> ptrs;
+	std::vector<size_t> lengths;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		ptrs.push_back((const unsigned char*)keys[i].c_str());
+		lengths.push_back(keys[i].length());
+	}
+
+	ibrcommon::BloomFilter single(512, 512, 3);
+	ibrcommon::BloomFilter batch(512, 512, 3);
+
+	// insert only the first half of the keys
+	const size_t half = keys.size() / 2;
+	for (size_t i = 0; i < half; ++i) single.insert(keys[i]);
+	batch.insert(&ptrs[0], &lengths[0], half);
+
+	CPPUNIT_ASSERT(std::equal(single.table(), single.table() + single.size(), batch.table()));
+
+	// test all keys at once
+	bool *results = new bool[keys.size()];
+	const size_t found = batch.contains(&ptrs[0], &lengths[0], keys.size(), results);
+
+	size_t expected_found = 0;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		const bool ret = single.contains(keys[i]);
+		if (i < half) CPPUNIT_ASSERT(ret);
+		CPPUNIT_ASSERT_EQUAL(ret, results[i]);
+		if (ret) expected_found++;
+	}
+	delete[] results;
+
+	CPPUNIT_ASSERT_EQUAL(expected_found, found);
+}
+
+void BloomFilterTest::testPerformance()
+{
+	const size_t count = 100000;
+	const size_t salts = 4;
+
+	std::vector<std::string> keys;
+	createKeys(keys, "", count);
+
+	std::vector<std::string> probes;
+	createKeys(probes, "x", count);
+
+	std::vector<const unsigned char*> ptrs;
+	std::vector<size_t> lengths;
+	for (size_t i = 0; i < count; ++i)
+	{
+		ptrs.push_back((const unsigned char*)probes[i].c_str());
+		lengths.push_back(probes[i].length());
+	}
+
+	ListBloomFilter list_filter(count, salts);
+	ibrcommon::BloomFilter filter(count, count, salts);
+
+	ibrcommon::TimeMeasurement tm;
+
+	// insert all keys with list based hashing
+	tm.start();
+	for (size_t i = 0; i < count; ++i) list_filter.insert(keys[i]);
+	tm.stop();
+	const double list_insert = tm.getMilliseconds();
+
+	// insert all keys allocation-free
+	tm.start();
+	for (size_t i = 0; i < count; ++i) filter.insert(keys[i]);
+	tm.stop();
+	const double insert = tm.getMilliseconds();
+
+	// both filters have to be equal, thus the false-positive rate is equal too
+	CPPUNIT_ASSERT(std::equal(filter.table(), filter.table() + filter.size(), list_filter.table()));
+
+	// probe unknown keys with list based hashing
+	size_t list_fp = 0;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) if (list_filter.contains(probes[i])) list_fp++;
+	tm.stop();
+	const double list_contains = tm.getMilliseconds();
+
+	// probe unknown keys allocation-free
+	size_t fp = 0;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) if (filter.contains(probes[i])) fp++;
+	tm.stop();
+	const double contains = tm.getMilliseconds();
+
+	// probe unknown keys in one batch
+	bool *results = new bool[count];
+	tm.start();
+	const size_t batch_fp = filter.contains(&ptrs[0], &lengths[0], count, results);
+	tm.stop();
+	const double batch_contains = tm.getMilliseconds();
+	delete[] results;
+
+	CPPUNIT_ASSERT_EQUAL(list_fp, fp);
+	CPPUNIT_ASSERT_EQUAL(list_fp, batch_fp);
+
+	std::cout << std::endl << count << " keys, " << salts << " salts, false-positive rate " << ((double)fp / (double)count) << std::endl;
+	std::cout << "insert: list " << list_insert << " ms, allocation-free " << insert << " ms" << std::endl;
+	std::cout << "contains: list " << list_contains << " ms, allocation-free " << contains << " ms, batch " << batch_contains << " ms" << std::endl;
+}
+
 /*=== END   tests for class 'BloomFilter' ===*/
 
 void BloomFilterTest::setUp()
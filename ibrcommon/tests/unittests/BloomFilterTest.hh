@@ -42,6 +42,8 @@ class BloomFilterTest : public CppUnit::TestFixture {
 		void testGrow();
 
 		void testMemory();
+		void testBatch();
+		void testPerformance();
 		/*=== END   tests for class 'BloomFilter' ===*/
 
 		void setUp();
@@ -67,6 +69,8 @@ class BloomFilterTest : public CppUnit::TestFixture {
 			CPPUNIT_TEST(testGrow);
 
 			CPPUNIT_TEST(testMemory);
+			CPPUNIT_TEST(testBatch);
+			CPPUNIT_TEST(testPerformance);
 		CPPUNIT_TEST_SUITE_END();
 };
 #endif /* BLOOMFILTERTEST_HH */
@@ -0,0 +1,103 @@
+/*
+ * MemoryStreamTest.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MemoryStreamTest.h"
+#include <ibrcommon/data/MemoryStream.h>
+#include <string>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MemoryStreamTest);
+
+void MemoryStreamTest::setUp()
+{
+}
+
+void MemoryStreamTest::tearDown()
+{
+}
+
+void MemoryStreamTest::writeTest()
+{
+	char buf[16];
+	ibrcommon::MemoryStream ms(buf, sizeof(buf));
+
+	ms << "Hello World";
+	CPPUNIT_ASSERT(ms.good());
+	CPPUNIT_ASSERT_EQUAL((size_t)11, ms.getWritten());
+	CPPUNIT_ASSERT_EQUAL(std::string("Hello World"), std::string(buf, ms.getWritten()));
+
+	// written data can be read back
+	std::string word;
+	ms >> word;
+	CPPUNIT_ASSERT_EQUAL(std::string("Hello"), word);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, ms.getRead());
+
+	// the buffer is full after five more bytes
+	ms.write("0123456789", 10);
+	CPPUNIT_ASSERT(ms.bad());
+	CPPUNIT_ASSERT_EQUAL(sizeof(buf), ms.getWritten());
+}
+
+void MemoryStreamTest::readTest()
+{
+	const std::string data("Hello World");
+	ibrcommon::MemoryStream ms(data.c_str(), data.length());
+
+	char buf[5];
+	ms.read(buf, sizeof(buf));
+	CPPUNIT_ASSERT_EQUAL(std::string("Hello"), std::string(buf, sizeof(buf)));
+
+	ms.get();
+	ms.read(buf, sizeof(buf));
+	CPPUNIT_ASSERT_EQUAL(std::string("World"), std::string(buf, sizeof(buf)));
+	CPPUNIT_ASSERT_EQUAL(data.length(), ms.getRead());
+
+	// no more data available
+	ms.get();
+	CPPUNIT_ASSERT(ms.eof());
+
+	// read-only streams can not be written
+	ms.clear();
+	ms << "test";
+	CPPUNIT_ASSERT(ms.bad());
+}
+
+void MemoryStreamTest::seekTest()
+{
+	char buf[16];
+	ibrcommon::MemoryStream ms(buf, sizeof(buf));
+
+	ms << "Hello World";
+	ms.seekp(6);
+	ms << "Earth";
+	CPPUNIT_ASSERT_EQUAL((std::streamoff)11, (std::streamoff)ms.tellp());
+	CPPUNIT_ASSERT_EQUAL(std::string("Hello Earth"), std::string(buf, ms.getWritten()));
+
+	ms.seekg(6);
+	CPPUNIT_ASSERT_EQUAL((std::streamoff)6, (std::streamoff)ms.tellg());
+	CPPUNIT_ASSERT_EQUAL('E', (char)ms.get());
+
+	ms.seekg(-2, std::ios_base::end);
+	CPPUNIT_ASSERT_EQUAL('t', (char)ms.get());
+
+	// can not seek beyond the written data
+	ms.seekg(12);
+	CPPUNIT_ASSERT(ms.fail());
+}
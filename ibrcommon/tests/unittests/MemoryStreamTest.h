@@ -0,0 +1,45 @@
+/*
+ * MemoryStreamTest.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef MEMORYSTREAMTEST_H_
+#define MEMORYSTREAMTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class MemoryStreamTest : public CppUnit::TestFixture
+{
+public:
+	void writeTest();
+	void readTest();
+	void seekTest();
+
+	void setUp();
+	void tearDown();
+
+	CPPUNIT_TEST_SUITE(MemoryStreamTest);
+	CPPUNIT_TEST(writeTest);
+	CPPUNIT_TEST(readTest);
+	CPPUNIT_TEST(seekTest);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+#endif /* MEMORYSTREAMTEST_H_ */
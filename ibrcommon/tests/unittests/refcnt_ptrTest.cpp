@@ -58,3 +58,20 @@ void refcnt_ptrTest::testSelfAssignment()
 	test = copy;
 }
 
+void refcnt_ptrTest::testUnique()
+{
+	refcnt_ptr<std::string> test(new std::string("hallo welt"));
+	CPPUNIT_ASSERT(test.unique());
+
+	{
+		refcnt_ptr<std::string> copy = test;
+		CPPUNIT_ASSERT(!test.unique());
+		CPPUNIT_ASSERT(!copy.unique());
+
+		refcnt_ptr<std::string> other(new std::string("hello world"));
+		other = copy;
+		CPPUNIT_ASSERT(!other.unique());
+	}
+
+	CPPUNIT_ASSERT(test.unique());
+}
@@ -22,6 +22,7 @@ class refcnt_ptrTest : public CppUnit::TestFixture {
 	public:
 		/*=== BEGIN tests for class 'refcnt_ptr' ===*/
 		void testSelfAssignment();
+		void testUnique();
 		/*=== END   tests for class 'refcnt_ptr' ===*/
 
 		void setUp();
@@ -30,6 +31,7 @@ class refcnt_ptrTest : public CppUnit::TestFixture {
 
 		CPPUNIT_TEST_SUITE(refcnt_ptrTest);
 		CPPUNIT_TEST(testSelfAssignment);
+		CPPUNIT_TEST(testUnique);
 		CPPUNIT_TEST_SUITE_END();
 };
 #endif /* REFCNT_PTRTEST_HH */
@@ -36,6 +36,11 @@ class DtnStats():
         self.fsock.readline()
         return self.readValueList()
 
+    def metrics(self):
+        self.sock.send("stats metrics\n")
+        self.fsock.readline()
+        return self.readValueList()
+
     def connect(self):
         ''' create a socket '''
         try:
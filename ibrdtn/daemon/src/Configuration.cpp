@@ -87,13 +87,13 @@ namespace dtn
 		 : _enabled(true), _interval(5), _announce(true), _short(false), _version(2), _crosslayer(false) {}
 
 		Configuration::Debug::Debug()
-		 : _enabled(false), _quiet(false), _level(0), _profiling(false) {}
+		 : _enabled(false), _quiet(false), _level(0), _profiling(false), _metrics_interval(10) {}
 
 		Configuration::Logger::Logger()
 		 : _quiet(false), _options(0), _timestamps(false), _verbose(false) {}
 
 		Configuration::Network::Network()
-		 : _routing("default"), _forwarding(true), _accept_nonsingleton(true), _prefer_direct(true), _tcp_nodelay(true), _tcp_chunksize(4096), _tcp_idle_timeout(0), _keepalive_timeout(60), _default_net("lo"), _use_default_net(false), _auto_connect(0), _fragmentation(false), _scheduling(false), _managed_connectivity(false), _link_request_interval(5000)
+		 : _routing("default"), _forwarding(true), _accept_nonsingleton(true), _prefer_direct(true), _tcp_nodelay(true), _tcp_chunksize(4096), _tcp_idle_timeout(0), _tcp_io_threads(0), _tcp_cut_through(0), _keepalive_timeout(60), _default_net("lo"), _use_default_net(false), _auto_connect(0), _fragmentation(false), _scheduling(false), _managed_connectivity(false), _link_request_interval(5000)
 		{}
 
 		Configuration::Security::Security()
@@ -424,6 +424,13 @@ namespace dtn
 			try {
 				_profiling = (conf.read<std::string>("profiling") == "yes");
 			} catch (const ibrcommon::ConfigFile::key_not_found&) { };
+
+			try {
+				_metrics_file = conf.read<std::string>("metrics_file");
+			} catch (const ibrcommon::ConfigFile::key_not_found&) { };
+
+			_metrics_interval = conf.read<unsigned int>("metrics_interval", 10);
+			if (_metrics_interval == 0) _metrics_interval = 1;
 		}
 
 		void Configuration::Daemon::load(const ibrcommon::ConfigFile&)
@@ -531,6 +538,17 @@ namespace dtn
 			return _profiling;
 		}
 
+		const ibrcommon::File& Configuration::Debug::getMetricsFile() const throw (ParameterNotSetException)
+		{
+			if (_metrics_file.getPath() == "") throw Configuration::ParameterNotSetException();
+			return _metrics_file;
+		}
+
+		unsigned int Configuration::Debug::getMetricsInterval() const
+		{
+			return _metrics_interval;
+		}
+
 		bool Configuration::Debug::enabled() const
 		{
 			return _enabled;
@@ -668,6 +686,26 @@ namespace dtn
 			return _conf.read<std::string>("use_persistent_bundlesets", "no") == "yes";
 		}
 
+		dtn::data::Timeout Configuration::getSQLiteGroupCommitWindow() const
+		{
+			return _conf.read<dtn::data::Timeout>("sqlite_group_commit", 0);
+		}
+
+		dtn::data::Size Configuration::getSQLiteGroupCommitLimit() const
+		{
+			return _conf.read<dtn::data::Size>("sqlite_group_commit_limit", 64);
+		}
+
+		std::string Configuration::getSQLiteJournalMode() const
+		{
+			return _conf.read<std::string>("sqlite_journal_mode", "");
+		}
+
+		std::string Configuration::getSQLiteSynchronous() const
+		{
+			return _conf.read<std::string>("sqlite_synchronous", "off");
+		}
+
 		void Configuration::Network::load(const ibrcommon::ConfigFile &conf)
 		{
 			/**
@@ -915,6 +953,8 @@ namespace dtn
 			_tcp_nodelay = (conf.read<std::string>("tcp_nodelay", "yes") == "yes");
 			_tcp_chunksize = conf.read<unsigned int>("tcp_chunksize", 4096);
 			_tcp_idle_timeout = conf.read<unsigned int>("tcp_idle_timeout", 0);
+			_tcp_io_threads = conf.read<unsigned int>("tcp_io_threads", 0);
+			_tcp_cut_through = conf.read<size_t>("tcp_cut_through", 0);
 
 			/**
 			 * Keep alive interval for network connections
@@ -1052,6 +1092,16 @@ namespace dtn
 			return _tcp_idle_timeout;
 		}
 
+		size_t Configuration::Network::getTCPIOThreads() const
+		{
+			return _tcp_io_threads;
+		}
+
+		dtn::data::Length Configuration::Network::getTCPCutThrough() const
+		{
+			return _tcp_cut_through;
+		}
+
 		dtn::data::Timeout Configuration::Network::getKeepaliveInterval() const
 		{
 			return _keepalive_timeout;
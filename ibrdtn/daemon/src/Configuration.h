@@ -141,6 +141,28 @@ namespace dtn
 
 			bool getUsePersistentBundleSets() const;
 
+			/**
+			 * returns the window in milliseconds to group stores and removes of the
+			 * sqlite storage into one transaction (zero disables the group commit)
+			 */
+			dtn::data::Timeout getSQLiteGroupCommitWindow() const;
+
+			/**
+			 * returns the max. number of operations in one group of the sqlite storage
+			 */
+			dtn::data::Size getSQLiteGroupCommitLimit() const;
+
+			/**
+			 * returns the journal mode of the sqlite storage or an empty string
+			 * if the default of sqlite should be used
+			 */
+			std::string getSQLiteJournalMode() const;
+
+			/**
+			 * returns the synchronous mode of the sqlite storage
+			 */
+			std::string getSQLiteSynchronous() const;
+
 			enum RoutingExtension
 			{
 				DEFAULT_ROUTING = 0,
@@ -203,6 +225,8 @@ namespace dtn
 				bool _quiet;
 				int _level;
 				bool _profiling;
+				ibrcommon::File _metrics_file;
+				unsigned int _metrics_interval;
 
 			public:
 				/**
@@ -226,6 +250,16 @@ namespace dtn
 				 * @return True, if profiling is activated
 				 */
 				bool profiling() const;
+
+				/**
+				 * Get a file to dump the metrics in the text format of Prometheus
+				 */
+				const ibrcommon::File& getMetricsFile() const throw (ParameterNotSetException);
+
+				/**
+				 * @return The number of seconds between two dumps of the metrics
+				 */
+				unsigned int getMetricsInterval() const;
 			};
 
 			class Logger : public Configuration::Extension
@@ -324,6 +358,8 @@ namespace dtn
 				bool _tcp_nodelay;
 				dtn::data::Length _tcp_chunksize;
 				dtn::data::Timeout _tcp_idle_timeout;
+				size_t _tcp_io_threads;
+				dtn::data::Length _tcp_cut_through;
 				dtn::data::Timeout _keepalive_timeout;
 				ibrcommon::vinterface _default_net;
 				bool _use_default_net;
@@ -389,6 +425,18 @@ namespace dtn
 				 */
 				dtn::data::Timeout getTCPIdleTimeout() const;
 
+				/**
+				 * @return The number of I/O threads driving all TCP connections or
+				 * zero, if each connection should use its own threads.
+				 */
+				size_t getTCPIOThreads() const;
+
+				/**
+				 * @return The minimum payload length of bundles forwarded while they
+				 * are still received or zero, if cut-through forwarding is disabled.
+				 */
+				dtn::data::Length getTCPCutThrough() const;
+
 				/**
 				 * @return The keep-alive interval for network connections.
 				 */
@@ -36,10 +36,12 @@
 #include "storage/BundleSeeker.h"
 #include "storage/MemoryBundleStorage.h"
 #include "storage/SimpleBundleStorage.h"
+#include "storage/LogBundleStorage.h"
 
 #include "core/BundleCore.h"
 #include "net/ConnectionManager.h"
 #include "core/FragmentManager.h"
+#include "core/MetricsWriter.h"
 #include "core/Node.h"
 #include "core/EventSwitch.h"
 #include "core/EventDispatcher.h"
@@ -1112,6 +1114,23 @@ namespace dtn
 						sbs = new dtn::storage::SQLiteBundleStorage(path, conf.getLimit("storage"), false);
 					}
 
+					// set the journal mode of the database
+					const std::string journal_mode = conf.getSQLiteJournalMode();
+					if (journal_mode.length() > 0)
+					{
+						sbs->setJournalMode(journal_mode);
+					}
+
+					sbs->setSynchronous(conf.getSQLiteSynchronous());
+
+					// group stores and removes into one transaction
+					const dtn::data::Timeout group_window = conf.getSQLiteGroupCommitWindow();
+					if (group_window > 0)
+					{
+						sbs->setGroupCommit(group_window, conf.getSQLiteGroupCommitLimit());
+						IBRCOMMON_LOGGER_TAG(NativeDaemon::TAG, info) << "using group commit with a window of " << group_window << " ms" << IBRCOMMON_LOGGER_ENDL;
+					}
+
 					_components[RUNLEVEL_STORAGE].push_back(sbs);
 					storage = sbs;
 				} catch (const dtn::daemon::Configuration::ParameterNotSetException&) {
@@ -1123,6 +1142,24 @@ namespace dtn
 
 #endif
 
+			if (conf.getStorage() == "log")
+			{
+				try {
+					ibrcommon::File path = conf.getPath("storage");
+
+					// create workdir if needed
+					if (!path.exists()) ibrcommon::File::createDirectory(path);
+
+					IBRCOMMON_LOGGER_TAG(NativeDaemon::TAG, info) << "using log-structured bundle storage in " << path.getPath() << IBRCOMMON_LOGGER_ENDL;
+					dtn::storage::LogBundleStorage *lbs = new dtn::storage::LogBundleStorage(path, conf.getLimit("storage"), conf.getLimit("storage_segment"));
+					_components[RUNLEVEL_STORAGE].push_back(lbs);
+					storage = lbs;
+				} catch (const dtn::daemon::Configuration::ParameterNotSetException&) {
+					IBRCOMMON_LOGGER_TAG(NativeDaemon::TAG, error) << "storage for bundles" << IBRCOMMON_LOGGER_ENDL;
+					throw NativeDaemonException("initialization of the bundle storage failed");
+				}
+			}
+
 			if ((conf.getStorage() == "simple") || (conf.getStorage() == "default"))
 			{
 				// default behavior if no bundle storage is set
@@ -1262,6 +1299,12 @@ namespace dtn
 				_components[RUNLEVEL_API].push_back( new dtn::core::FragmentManager() );
 			}
 
+			try {
+				// dump the metrics periodically into a file
+				const ibrcommon::File &mf = conf.getDebug().getMetricsFile();
+				_components[RUNLEVEL_API].push_back( new dtn::core::MetricsWriter(mf, conf.getDebug().getMetricsInterval()) );
+			} catch (const dtn::daemon::Configuration::ParameterNotSetException&) { };
+
 #ifndef ANDROID
 			if (conf.doAPI())
 			{
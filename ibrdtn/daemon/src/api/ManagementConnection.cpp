@@ -26,6 +26,7 @@
 #include "storage/BundleResult.h"
 #include "core/BundleCore.h"
 #include "core/Node.h"
+#include "core/Metrics.h"
 #include "routing/prophet/ProphetRoutingExtension.h"
 #include "routing/prophet/DeliveryPredictabilityMap.h"
 
@@ -485,6 +486,15 @@ namespace dtn
 								_stream << pair.first << ": " << pair.second << std::endl;
 						}
 						_stream << std::endl;
+					} else if ( cmd[1] == "metrics" ) {
+						if ((cmd.size() > 2) && (cmd[2] == "prometheus")) {
+							_stream << ClientHandler::API_STATUS_OK << " STATS METRICS PROMETHEUS" << std::endl;
+							dtn::core::Metrics::getInstance().writePrometheus(_stream);
+						} else {
+							_stream << ClientHandler::API_STATUS_OK << " STATS METRICS" << std::endl;
+							dtn::core::Metrics::getInstance().write(_stream);
+						}
+						_stream << std::endl;
 					} else if ( cmd[1] == "reset" ) {
 						dtn::core::EventDispatcher<dtn::core::BundleExpiredEvent>::resetCounter();
 						dtn::core::EventDispatcher<dtn::net::TransferCompletedEvent>::resetCounter();
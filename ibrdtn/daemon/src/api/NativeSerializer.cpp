@@ -68,6 +68,20 @@ namespace dtn
 			return std::char_traits<char>::not_eof(c);
 		}
 
+		std::streamsize NativeCallbackStream::xsputn(const char *s, std::streamsize n)
+		{
+			// small writes are collected in the output buffer
+			if (n < static_cast<std::streamsize>(_output_buf.size()))
+				return std::basic_streambuf<char, std::char_traits<char> >::xsputn(s, n);
+
+			// flush buffered data first to keep the order
+			if (pptr() != pbase()) overflow(std::char_traits<char>::eof());
+
+			// hand over large chunks like the payload to the callback without copying
+			_callback.payload(s, n);
+			return n;
+		}
+
 		NativeSerializer::NativeSerializer(NativeSerializerCallback &cb, DataMode mode)
 		 : _callback(cb), _mode(mode) {
 
@@ -41,6 +41,7 @@ namespace dtn
 		protected:
 			virtual int sync();
 			virtual std::char_traits<char>::int_type overflow(std::char_traits<char>::int_type = std::char_traits<char>::eof());
+			virtual std::streamsize xsputn(const char *s, std::streamsize n);
 
 		private:
 			// output buffer
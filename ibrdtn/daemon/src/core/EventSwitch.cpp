@@ -26,6 +26,7 @@
 #include <ibrcommon/thread/MutexLock.h>
 #include "core/GlobalEvent.h"
 #include <ibrcommon/Logger.h>
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <typeinfo>
@@ -35,8 +36,11 @@ namespace dtn
 {
 	namespace core
 	{
+		const size_t EventSwitch::Shard::POOL_LIMIT = 64;
+
 		EventSwitch::EventSwitch()
-		 : _running(true), _shutdown(false), _wd(*this, _wlist), _inprogress(false)
+		 : _running(true), _shutdown(false), _shard_count(1), _idle(0), _wd(*this, _wlist), _inprogress(false),
+		   _queued(dtn::core::Metrics::getInstance().getGauge("dtnd_event_queue_length", "", "Number of queued events"))
 		{
 		}
 
@@ -50,112 +54,192 @@ namespace dtn
 			// routine checked for throw() on 15.02.2013
 
 			// clear all queues
-			_queue = std::queue<Task*>();
-			_prio_queue = std::queue<Task*>();
-			_low_queue = std::queue<Task*>();
+			for (size_t i = 0; i < MAX_SHARDS; ++i)
+			{
+				const size_t dropped = _shards[i].clear();
+				_queued.add(-static_cast<int64_t>(dropped));
+				_shards[i].open();
+			}
+
+			// events are queued into the first shard until loop() is called
+			_shard_count = 1;
 
 			// reset component state
 			_running = true;
 			_shutdown = false;
 
 			// reset aborted conditional
-			_queue_cond.reset();
+			_idle_cond.reset();
 		}
 
 		void EventSwitch::componentDown() throw ()
 		{
-			try {
-				ibrcommon::MutexLock l(_queue_cond);
+			// stop receiving events
+			__shutdown();
 
-				// stop receiving events
-				_shutdown = true;
+			try {
+				ibrcommon::MutexLock l(_drain_cond);
 
 				// wait until all queues are empty
 				while (!this->empty())
 				{
-					_queue_cond.wait();
+					_drain_cond.wait();
 				}
+			} catch (const ibrcommon::Conditional::ConditionalAbortException&) {};
 
-				_queue_cond.abort();
+			try {
+				ibrcommon::MutexLock l(_idle_cond);
+				_idle_cond.abort();
 			} catch (const ibrcommon::Conditional::ConditionalAbortException&) {};
 		}
 
 		bool EventSwitch::empty() const
 		{
-			return (_low_queue.empty() && _queue.empty() && _prio_queue.empty());
+			for (size_t i = 0; i < _shard_count; ++i)
+			{
+				const Shard &s = _shards[i];
+				if (s.size(Shard::QUEUE_PRIO) > 0) return false;
+				if (s.size(Shard::QUEUE_NORMAL) > 0) return false;
+				if (s.size(Shard::QUEUE_LOW) > 0) return false;
+			}
+			return true;
 		}
 
-		void EventSwitch::process(ibrcommon::TimeMeasurement &tm, bool &inprogress, bool profiling)
+		EventSwitch::Task* EventSwitch::take(size_t shard)
 		{
-			EventSwitch::Task *t = NULL;
+			const size_t count = _shard_count;
+			const size_t home = shard % count;
 
-			// just look for an event to process
+			// visit the queues in order of their priority, for each class
+			// start at the home shard and steal from other shards if it is empty
+			for (int qc = Shard::QUEUE_PRIO; qc < Shard::QUEUE_CLASSES; ++qc)
 			{
-				ibrcommon::MutexLock l(_queue_cond);
-				if (!_running) return;
-
-				while (this->empty() && !_shutdown)
+				for (size_t i = 0; i < count; ++i)
 				{
-					_queue_cond.wait();
-				}
+					Shard &s = _shards[(home + i) % count];
 
-				if (!_prio_queue.empty())
-				{
-					t = _prio_queue.front();
-					_prio_queue.pop();
-				}
-				else if (!_queue.empty())
-				{
-					t = _queue.front();
-					_queue.pop();
+					// skip empty queues without locking the shard
+					if (s.size(Shard::QueueClass(qc)) == 0) continue;
+
+					Task *t = s.pop(Shard::QueueClass(qc));
+					if (t != NULL) return t;
 				}
-				else if (!_low_queue.empty())
+			}
+
+			return NULL;
+		}
+
+		void EventSwitch::process(size_t shard, ibrcommon::TimeMeasurement &tm, bool &inprogress, bool profiling, metrics_map &metrics)
+		{
+			if (!_running) return;
+
+			// just look for an event to process
+			EventSwitch::Task *t = take(shard);
+
+			if (t == NULL)
+			{
+				ibrcommon::MutexLock l(_idle_cond);
+
+				while (t == NULL)
 				{
-					t = _low_queue.front();
-					_low_queue.pop();
+					if (!_running) return;
+
+					// the shards are closed before the flag is set, so if it is set
+					// here no further event appears and empty queues are final
+					const bool shutdown = _shutdown;
+
+					// announce this worker as idle before looking into the queues again,
+					// queue() checks the number of idle workers after adding a new task
+					__sync_add_and_fetch(&_idle, 1);
+
+					t = take(shard);
+
+					if (t == NULL)
+					{
+						if (shutdown)
+						{
+							__sync_sub_and_fetch(&_idle, 1);
+
+							// if all queues are empty and shutdown is requested
+							// set running mode to false
+							_running = false;
+
+							// abort the conditional to release all blocking threads
+							_idle_cond.abort();
+
+							// notify a waiting componentDown() call
+							ibrcommon::MutexLock dl(_drain_cond);
+							_drain_cond.signal(true);
+							return;
+						}
+
+						try {
+							_idle_cond.wait();
+						} catch (const ibrcommon::Conditional::ConditionalAbortException&) {
+							__sync_sub_and_fetch(&_idle, 1);
+							throw;
+						}
+					}
+
+					__sync_sub_and_fetch(&_idle, 1);
 				}
-				else if (_shutdown)
-				{
-					// if all queues are empty and shutdown is requested
-					// set running mode to false
-					_running = false;
+			}
 
-					// abort the conditional to release all blocking threads
-					_queue_cond.abort();
+			_queued.add(-1);
 
-					return;
-				}
+			if (profiling) {
+				inprogress = true;
+				tm.start();
+			}
+
+			const dtn::core::Metrics::value_type started = dtn::core::Metrics::now();
+
+			// execute the event
+			t->processor->process(t->event);
 
-				_queue_cond.signal(true);
+			const dtn::core::Metrics::value_type finished = dtn::core::Metrics::now();
+
+			if (profiling) {
+				tm.stop();
+				inprogress = false;
 			}
 
-			if (t != NULL)
+			// record the waiting and processing time per type of event
 			{
-				if (profiling) {
-					inprogress = true;
-					tm.start();
-				}
-				// execute the event
-				t->processor.process(t->event);
+				const EventMetrics &m = getMetrics(metrics, *t->event);
+				m.wait.record(started - t->queued);
+				m.process.record(finished - started);
+			}
 
+			// log the event
+			if (t->event->isLoggable())
+			{
 				if (profiling) {
-					tm.stop();
-					inprogress = false;
+					IBRCOMMON_LOGGER_TAG(t->event->getName(), notice) << t->event->getMessage() << " (" << tm.getMilliseconds() << " ms)" << IBRCOMMON_LOGGER_ENDL;
+				} else {
+					IBRCOMMON_LOGGER_TAG(t->event->getName(), notice) << t->event->getMessage() << IBRCOMMON_LOGGER_ENDL;
 				}
+			}
 
-				// log the event
-				if (t->event->isLoggable())
-				{
-					if (profiling) {
-						IBRCOMMON_LOGGER_TAG(t->event->getName(), notice) << t->event->getMessage() << " (" << tm.getMilliseconds() << " ms)" << IBRCOMMON_LOGGER_ENDL;
-					} else {
-						IBRCOMMON_LOGGER_TAG(t->event->getName(), notice) << t->event->getMessage() << IBRCOMMON_LOGGER_ENDL;
-					}
-				}
+			// return the Task to the pool
+			_shards[shard % _shard_count].recycle(t);
+		}
 
-				// delete the Task
-				delete t;
-			}
+		const EventSwitch::EventMetrics& EventSwitch::getMetrics(metrics_map &metrics, const dtn::core::Event &evt)
+		{
+			const std::type_info *type = &typeid(evt);
+
+			metrics_map::const_iterator iter = metrics.find(type);
+			if (iter != metrics.end()) return iter->second;
+
+			// first event of this type processed by the calling thread
+			dtn::core::Metrics &m = dtn::core::Metrics::getInstance();
+			const std::string labels = dtn::core::Metrics::label("type", evt.getName());
+
+			EventMetrics &em = metrics[type];
+			em.wait = m.getHistogram("dtnd_event_wait_microseconds", labels, "Time events are waiting in the queue");
+			em.process = m.getHistogram("dtnd_event_process_microseconds", labels, "Time to process events");
+			return em;
 		}
 
 		bool EventSwitch::isStalled()
@@ -171,9 +255,14 @@ namespace dtn
 				IBRCOMMON_LOGGER_TAG("EventSwitch", warning) << "Profiling and stalled event detection enabled" << IBRCOMMON_LOGGER_ENDL;
 			}
 
+			// one shard for the calling thread and one for each worker,
+			// events queued before are still located in the first shard
+			_shard_count = std::min(threads + 1, MAX_SHARDS);
+			__sync_synchronize();
+
 			for (size_t i = 0; i < threads; ++i)
 			{
-				Worker *w = new Worker(*this, profiling);
+				Worker *w = new Worker(*this, i + 1, profiling);
 				w->start();
 				_wlist.push_back(w);
 			}
@@ -184,7 +273,7 @@ namespace dtn
 			try {
 				while (_running)
 				{
-					process(_tm, _inprogress, profiling);
+					process(0, _tm, _inprogress, profiling, _metrics);
 				}
 			} catch (const ibrcommon::Conditional::ConditionalAbortException&) { };
 
@@ -207,42 +296,52 @@ namespace dtn
 		{
 			EventSwitch &s = EventSwitch::getInstance();
 
-			ibrcommon::MutexLock l(s._queue_cond);
-
-			// do not process any event if the system is going down
+			// do not process any event if the system is going down, this is
+			// checked again by push() with the lock of the shard held
 			if (s._shutdown)
 			{
 				delete evt;
 				return;
 			}
 
-			EventSwitch::Task *t = new EventSwitch::Task(proc, evt);
+			// all events of one processor are put into the same shard, thus
+			// they are taken in the order of queuing within each priority class
+			const size_t shard = (reinterpret_cast<size_t>(&proc) >> 4) % s._shard_count;
+			if (!s._shards[shard].push(proc, evt)) return;
+			s._queued.add(1);
 
-			if (evt->prio > 0)
-			{
-				s._prio_queue.push(t);
-			}
-			else if (evt->prio < 0)
-			{
-				s._low_queue.push(t);
-			}
-			else
+			// wake-up an idle worker, the barrier pairs with the
+			// announcement of idle workers in process()
+			__sync_synchronize();
+			if (s._idle > 0)
 			{
-				s._queue.push(t);
+				ibrcommon::MutexLock l(s._idle_cond);
+				s._idle_cond.signal();
 			}
-			s._queue_cond.signal();
 		}
 
 		void EventSwitch::shutdown()
 		{
+			__shutdown();
+		}
+
+		void EventSwitch::__shutdown()
+		{
+			// reject new events, an event queued at the same time is
+			// either in one of the queues afterwards or deleted by push()
+			for (size_t i = 0; i < MAX_SHARDS; ++i)
+			{
+				_shards[i].close();
+			}
+
 			try {
-				ibrcommon::MutexLock l(_queue_cond);
+				ibrcommon::MutexLock l(_idle_cond);
 
 				// stop receiving events
 				_shutdown = true;
 
 				// signal all blocking thread to check _shutdown variable
-				_queue_cond.signal(true);
+				_idle_cond.signal(true);
 			} catch (const ibrcommon::Conditional::ConditionalAbortException&) {};
 		}
 
@@ -258,7 +357,7 @@ namespace dtn
 		}
 
 		EventSwitch::Task::Task(EventProcessor &proc, dtn::core::Event *evt)
-		 : processor(proc), event(evt)
+		 : processor(&proc), event(evt), queued(dtn::core::Metrics::now())
 		{
 		}
 
@@ -270,8 +369,129 @@ namespace dtn
 			}
 		}
 
-		EventSwitch::Worker::Worker(EventSwitch &sw, bool profiling)
-		 : _switch(sw), _running(true), _inprogress(false), _profiling(profiling)
+		EventSwitch::Shard::Shard()
+		 : _closed(false)
+		{
+			for (int qc = 0; qc < QUEUE_CLASSES; ++qc)
+			{
+				_sizes[qc] = 0;
+			}
+		}
+
+		EventSwitch::Shard::~Shard()
+		{
+			clear();
+		}
+
+		bool EventSwitch::Shard::push(EventProcessor &proc, dtn::core::Event *evt)
+		{
+			const QueueClass qc = (evt->prio > 0) ? QUEUE_PRIO : ((evt->prio < 0) ? QUEUE_LOW : QUEUE_NORMAL);
+
+			ibrcommon::MutexLock l(_lock);
+
+			// the event switch is going down
+			if (_closed)
+			{
+				delete evt;
+				return false;
+			}
+
+			EventSwitch::Task *t = NULL;
+
+			if (_pool.empty())
+			{
+				t = new EventSwitch::Task(proc, evt);
+			}
+			else
+			{
+				t = _pool.back();
+				_pool.pop_back();
+				t->processor = &proc;
+				t->event = evt;
+				t->queued = dtn::core::Metrics::now();
+			}
+
+			_queues[qc].push_back(t);
+			_sizes[qc] = _queues[qc].size();
+			return true;
+		}
+
+		void EventSwitch::Shard::open()
+		{
+			ibrcommon::MutexLock l(_lock);
+			_closed = false;
+		}
+
+		void EventSwitch::Shard::close()
+		{
+			ibrcommon::MutexLock l(_lock);
+			_closed = true;
+		}
+
+		EventSwitch::Task* EventSwitch::Shard::pop(QueueClass qc)
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			if (_queues[qc].empty()) return NULL;
+
+			EventSwitch::Task *t = _queues[qc].front();
+			_queues[qc].pop_front();
+			_sizes[qc] = _queues[qc].size();
+
+			return t;
+		}
+
+		void EventSwitch::Shard::recycle(Task *t)
+		{
+			// delete the event
+			delete t->event;
+			t->event = NULL;
+
+			ibrcommon::MutexLock l(_lock);
+
+			if (_pool.size() < POOL_LIMIT)
+			{
+				_pool.push_back(t);
+			}
+			else
+			{
+				delete t;
+			}
+		}
+
+		size_t EventSwitch::Shard::size(QueueClass qc) const
+		{
+			return _sizes[qc];
+		}
+
+		size_t EventSwitch::Shard::clear()
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			size_t dropped = 0;
+
+			for (int qc = 0; qc < QUEUE_CLASSES; ++qc)
+			{
+				for (std::deque<Task*>::iterator iter = _queues[qc].begin(); iter != _queues[qc].end(); ++iter)
+				{
+					delete (*iter);
+				}
+				dropped += _queues[qc].size();
+				_queues[qc].clear();
+				_sizes[qc] = 0;
+			}
+
+			for (std::vector<Task*>::iterator iter = _pool.begin(); iter != _pool.end(); ++iter)
+			{
+				delete (*iter);
+			}
+			_pool.clear();
+
+			return dropped;
+		}
+
+		EventSwitch::Worker::Worker(EventSwitch &sw, size_t shard, bool profiling)
+		 : _switch(sw), _shard(shard), _running(true), _inprogress(false), _profiling(profiling)
 		{}
 
 		EventSwitch::Worker::~Worker()
@@ -287,8 +507,8 @@ namespace dtn
 		void EventSwitch::Worker::run() throw ()
 		{
 			try {
-				while (_running)
-					_switch.process(_tm, _inprogress, _profiling);
+				while (_running && _switch._running)
+					_switch.process(_shard, _tm, _inprogress, _profiling, _metrics);
 			} catch (const ibrcommon::Conditional::ConditionalAbortException&) { };
 		}
 
@@ -24,14 +24,17 @@
 
 #include "Component.h"
 #include "core/Event.h"
+#include "core/Metrics.h"
 #include <ibrcommon/Exceptions.h>
 #include <ibrcommon/thread/Mutex.h>
 #include <ibrcommon/thread/Conditional.h>
 #include <ibrcommon/TimeMeasurement.h>
 
 #include <list>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <map>
+#include <typeinfo>
 
 namespace dtn
 {
@@ -44,7 +47,7 @@ namespace dtn
 			virtual ~EventSwitch();
 
 			bool _running;
-			bool _shutdown;
+			volatile bool _shutdown;
 
 			/**
 			 * @see Component::getName()
@@ -57,14 +60,97 @@ namespace dtn
 				Task(EventProcessor &proc, dtn::core::Event *evt);
 				~Task();
 
-				EventProcessor &processor;
+				EventProcessor *processor;
 				dtn::core::Event *event;
+
+				// time of queuing in microseconds
+				dtn::core::Metrics::value_type queued;
+			};
+
+			/**
+			 * Histograms of the waiting and processing time of one type of event
+			 */
+			class EventMetrics
+			{
+			public:
+				dtn::core::Metrics::Histogram wait;
+				dtn::core::Metrics::Histogram process;
+			};
+
+			// histograms of each type of event, resolved once per processing thread
+			typedef std::map<const std::type_info*, EventMetrics> metrics_map;
+
+			/**
+			 * A shard holds the queues of one worker. Each event is put into
+			 * one of the shards and idle workers steal events from other shards
+			 * to keep the load balanced. Every shard has its own lock and
+			 * a small pool of recycled Task objects.
+			 */
+			class Shard
+			{
+			public:
+				enum QueueClass
+				{
+					QUEUE_PRIO = 0,
+					QUEUE_NORMAL = 1,
+					QUEUE_LOW = 2,
+					QUEUE_CLASSES = 3
+				};
+
+				Shard();
+				~Shard();
+
+				/**
+				 * Put a new event into the queue matching its priority
+				 * @return False, if the shard is closed. The event is deleted then.
+				 */
+				bool push(EventProcessor &proc, dtn::core::Event *evt);
+
+				/**
+				 * Accept or reject new events. The state is changed with
+				 * the lock of the shard held, so after close() returns no
+				 * other thread is able to add an event.
+				 */
+				void open();
+				void close();
+
+				/**
+				 * Take the next task of the given queue class or return
+				 * NULL if the queue is empty.
+				 */
+				Task* pop(QueueClass qc);
+
+				/**
+				 * Return an executed task to the pool of this shard
+				 */
+				void recycle(Task *t);
+
+				/**
+				 * Returns the number of queued tasks of the given queue class.
+				 * This method does not lock the shard and should be used as a hint only.
+				 */
+				size_t size(QueueClass qc) const;
+
+				/**
+				 * Drop all queued tasks and pooled objects
+				 * @return The number of dropped tasks
+				 */
+				size_t clear();
+
+			private:
+				static const size_t POOL_LIMIT;
+
+				ibrcommon::Mutex _lock;
+				bool _closed;
+				std::deque<Task*> _queues[QUEUE_CLASSES];
+				volatile size_t _sizes[QUEUE_CLASSES];
+				std::vector<Task*> _pool;
 			};
 
 			class Worker : public ibrcommon::JoinableThread
 			{
 			public:
-				Worker(EventSwitch &sw, bool profiling);
+				Worker(EventSwitch &sw, size_t shard, bool profiling);
 				~Worker();
 
 				bool isStalled();
@@ -75,10 +161,12 @@ namespace dtn
 
 			private:
 				EventSwitch &_switch;
+				const size_t _shard;
 				bool _running;
 				ibrcommon::TimeMeasurement _tm;
 				bool _inprogress;
 				bool _profiling;
+				metrics_map _metrics;
 			};
 
 			class WatchDog : public ibrcommon::JoinableThread
@@ -102,10 +190,18 @@ namespace dtn
 				ibrcommon::Conditional _cond;
 			};
 
-			ibrcommon::Conditional _queue_cond;
-			std::queue<Task*> _queue;
-			std::queue<Task*> _prio_queue;
-			std::queue<Task*> _low_queue;
+			// maximum number of shards, additional workers share the existing shards
+			static const size_t MAX_SHARDS = 64;
+
+			Shard _shards[MAX_SHARDS];
+			volatile size_t _shard_count;
+
+			// idle workers wait on this conditional
+			ibrcommon::Conditional _idle_cond;
+			volatile size_t _idle;
+
+			// signaled by workers if they run out of work during a shutdown
+			ibrcommon::Conditional _drain_cond;
 
 			WatchDog _wd;
 			std::list<Worker*> _wlist;
@@ -113,7 +209,27 @@ namespace dtn
 			ibrcommon::TimeMeasurement _tm;
 			bool _inprogress;
 
-			void process(ibrcommon::TimeMeasurement &tm, bool &inprogress, bool profiling);
+			// number of queued events
+			const dtn::core::Metrics::Gauge _queued;
+			metrics_map _metrics;
+
+			void process(size_t shard, ibrcommon::TimeMeasurement &tm, bool &inprogress, bool profiling, metrics_map &metrics);
+
+			/**
+			 * Returns the histograms of the type of the event
+			 */
+			static const EventMetrics& getMetrics(metrics_map &metrics, const dtn::core::Event &evt);
+
+			/**
+			 * Take the next task out of the shards. Higher priority queues
+			 * of all shards are visited first, starting at the home shard.
+			 */
+			Task* take(size_t shard);
+
+			/**
+			 * Close all shards and announce the shutdown to the workers
+			 */
+			void __shutdown();
 
 		protected:
 			virtual void componentUp() throw ();
@@ -29,6 +29,7 @@
 #include <ibrdtn/utils/Clock.h>
 #include <ibrcommon/Logger.h>
 #include <ibrcommon/thread/MutexLock.h>
+#include <algorithm>
 
 #include <ibrdtn/ibrdtn.h>
 #ifdef IBRDTN_SUPPORT_BSP
@@ -76,93 +77,131 @@ namespace dtn
 			// get reference to the storage
 			dtn::storage::BundleStorage &storage = dtn::core::BundleCore::getInstance().getStorage();
 
-			// TODO: scan storage for fragments to reassemble on startup
-
-			dtn::storage::BundleResultList list;
-
 			// create a task loop to reassemble fragments asynchronously
 			try {
 				while (_running)
 				{
 					dtn::data::MetaBundle meta = _incoming.poll();
 
+					// drop the reassembly of expired bundles
+					expire_reassembly();
+
 					// skip merge if complete bundle is already in the storage
 					dtn::data::BundleID origin(meta);
 					origin.setFragment(false);
-					if (storage.contains(origin)) continue;
+					if (storage.contains(origin))
+					{
+						_reassembly.erase(origin);
+						continue;
+					}
 
-					// search for matching bundles
-					list.clear();
-					search(meta, list);
+					// TODO: drop fragments if other fragments available containing the same payload or larger payload
 
-					IBRCOMMON_LOGGER_DEBUG_TAG(FragmentManager::TAG, 20) << "found " << list.size() << " fragments similar to bundle " << meta.toString() << IBRCOMMON_LOGGER_ENDL;
+					// add the payload of the fragment to the reassembly
+					Reassembly &r = merge(meta);
 
-					// TODO: drop fragments if other fragments available containing the same payload or larger payload
+					// wait for the next bundle if the fragment is not complete
+					if (!r.container.isComplete()) continue;
+
+					dtn::data::Bundle &merged = r.container.getBundle();
+
+					IBRCOMMON_LOGGER_TAG(FragmentManager::TAG, notice) << "Bundle " << merged.toString() << " merged" << IBRCOMMON_LOGGER_ENDL;
+
+					// pass merged bundle through the filter
+					FilterContext context;
+					context.setBundle(merged);
+					if (BundleCore::getInstance().filter(BundleFilter::INPUT, context, merged) == BundleFilter::ACCEPT)
+					{
+						// inject bundle into core
+						dtn::core::BundleCore::getInstance().inject(dtn::core::BundleCore::local, merged, false);
+					}
 
-					// check first if all fragment are available
-					std::set<BundleMerger::Chunk> chunks;
-					for (std::list<dtn::data::MetaBundle>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+					// delete all fragments of the merged bundle
+					if (merged.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON))
 					{
-						const dtn::data::MetaBundle &m = (*iter);
-						if (meta.getPayloadLength() > 0)
+						for (std::set<dtn::data::MetaBundle>::const_iterator iter = r.fragments.begin(); iter != r.fragments.end(); ++iter)
 						{
-							BundleMerger::Chunk chunk(m.fragmentoffset.get<dtn::data::Length>(), m.getPayloadLength());
-							chunks.insert(chunk);
+							dtn::core::BundlePurgeEvent::raise(*iter);
 						}
 					}
 
-					// wait for the next bundle if the fragment is not complete
-					if (!BundleMerger::Chunk::isComplete(meta.appdatalength.get<dtn::data::Length>(), chunks)) continue;
+					_reassembly.erase(origin);
+				}
+			} catch (const ibrcommon::QueueUnblockedException&) { }
 
-					// create a new bundle merger container
-					dtn::data::BundleMerger::Container c = dtn::data::BundleMerger::getContainer();
+			_reassembly.clear();
+		}
 
-					for (std::list<dtn::data::MetaBundle>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
-					{
-						const dtn::data::MetaBundle &meta = (*iter);
+		FragmentManager::Reassembly& FragmentManager::merge(const dtn::data::MetaBundle &meta)
+		{
+			dtn::storage::BundleStorage &storage = dtn::core::BundleCore::getInstance().getStorage();
 
-						if (meta.getPayloadLength() > 0)
-						{
-							IBRCOMMON_LOGGER_DEBUG_TAG(FragmentManager::TAG, 20) << "fragment: " << (*iter).toString() << IBRCOMMON_LOGGER_ENDL;
+			dtn::data::BundleID origin(meta);
+			origin.setFragment(false);
 
-							try {
-								// load bundle from storage
-								const dtn::data::Bundle bundle = dtn::core::BundleCore::getInstance().getStorage().get(*iter);
+			dtn::storage::BundleResultList list;
 
-								// merge the bundle
-								c << bundle;
-							} catch (const dtn::storage::NoBundleFoundException&) {
-								IBRCOMMON_LOGGER_TAG(FragmentManager::TAG, error) << "could not load fragment to merge bundle" << IBRCOMMON_LOGGER_ENDL;
-							};
-						}
-					}
+			reassembly_map::iterator it = _reassembly.find(origin);
+			if (it == _reassembly.end())
+			{
+				it = _reassembly.insert(std::make_pair(origin, Reassembly())).first;
 
-					if (c.isComplete())
-					{
-						dtn::data::Bundle &merged = c.getBundle();
+				// fragments may have been stored before the reassembly has been started, e.g. before a restart
+				search(meta, list);
 
-						IBRCOMMON_LOGGER_TAG(FragmentManager::TAG, notice) << "Bundle " << merged.toString() << " merged" << IBRCOMMON_LOGGER_ENDL;
+				IBRCOMMON_LOGGER_DEBUG_TAG(FragmentManager::TAG, 20) << "found " << list.size() << " fragments similar to bundle " << meta.toString() << IBRCOMMON_LOGGER_ENDL;
+			}
+			else
+			{
+				list.push_back(meta);
+			}
 
-						// pass merged bundle through the filter
-						FilterContext context;
-						context.setBundle(merged);
-						if (BundleCore::getInstance().filter(BundleFilter::INPUT, context, merged) == BundleFilter::ACCEPT)
-						{
-							// inject bundle into core
-							dtn::core::BundleCore::getInstance().inject(dtn::core::BundleCore::local, merged, false);
-						}
+			Reassembly &r = it->second;
 
-						// delete all fragments of the merged bundle
-						if (merged.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON))
-						{
-							for (std::list<dtn::data::MetaBundle>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
-							{
-								dtn::core::BundlePurgeEvent::raise(*iter);
-							}
-						}
-					}
+			for (std::list<dtn::data::MetaBundle>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+			{
+				const dtn::data::MetaBundle &m = (*iter);
+
+				if (m.getPayloadLength() == 0) continue;
+
+				// each fragment is merged only once
+				if (r.fragments.find(m) != r.fragments.end()) continue;
+
+				IBRCOMMON_LOGGER_DEBUG_TAG(FragmentManager::TAG, 20) << "fragment: " << m.toString() << IBRCOMMON_LOGGER_ENDL;
+
+				try {
+					// load bundle from storage
+					const dtn::data::Bundle bundle = storage.get(m);
+
+					// write the payload into the merged bundle
+					r.container << bundle;
+					r.fragments.insert(m);
+				} catch (const dtn::storage::NoBundleFoundException&) {
+					IBRCOMMON_LOGGER_TAG(FragmentManager::TAG, error) << "could not load fragment to merge bundle" << IBRCOMMON_LOGGER_ENDL;
+				} catch (const ibrcommon::Exception &ex) {
+					IBRCOMMON_LOGGER_TAG(FragmentManager::TAG, error) << "could not merge fragment: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 				}
-			} catch (const ibrcommon::QueueUnblockedException&) { }
+			}
+
+			return r;
+		}
+
+		void FragmentManager::expire_reassembly()
+		{
+			for (reassembly_map::iterator iter = _reassembly.begin(); iter != _reassembly.end();)
+			{
+				const Reassembly &r = iter->second;
+
+				if (r.fragments.empty() || dtn::utils::Clock::isExpired(*r.fragments.begin()))
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(FragmentManager::TAG, 20) << "drop reassembly of bundle " << iter->first.toString() << IBRCOMMON_LOGGER_ENDL;
+					_reassembly.erase(iter++);
+				}
+				else
+				{
+					++iter;
+				}
+			}
 		}
 
 		void FragmentManager::componentDown() throw ()
@@ -348,12 +387,11 @@ namespace dtn
 				fragment.appdatalength = payloadLength;
 
 				ibrcommon::BLOB::Reference ref = payloadBlock.getBLOB();
-				ibrcommon::BLOB::iostream stream = ref.iostream();
 
 				bool isFirstFragment = true;
 				dtn::data::Length offset = 0;
 
-				while (!(*stream).eof() && (payloadLength > offset))
+				while (payloadLength > offset)
 				{
 					// clear all the blocks
 					fragment.clear();
@@ -361,24 +399,13 @@ namespace dtn
 					// set fragment offset
 					fragment.fragmentoffset = offset;
 
-					// copy partial payload to the payload of the fragment
+					// the payload of the fragment is a view on the origin payload
 					try {
-						// create new blob for fragment payload
-						ibrcommon::BLOB::Reference fragment_ref = ibrcommon::BLOB::create();
-
-						// get the iostream object
-						ibrcommon::BLOB::iostream fragment_stream = fragment_ref.iostream();
-
-						if ((offset + maxPayloadLength) > payloadLength) {
-							// copy payload to the fragment
-							ibrcommon::BLOB::copy(*fragment_stream, *stream, payloadLength - offset, 65535);
-						} else {
-							// copy payload to the fragment
-							ibrcommon::BLOB::copy(*fragment_stream, *stream, maxPayloadLength, 65535);
-						}
+						const dtn::data::Length length = std::min(maxPayloadLength, payloadLength - offset);
+						ibrcommon::BLOB::Reference fragment_ref = ibrcommon::BLOB::range(ref, offset, length);
 
 						// set new offset position
-						offset += fragment_stream.size();
+						offset += length;
 
 						// create fragment payload block
 						dtn::data::PayloadBlock &fragment_payloadBlock = fragment.push_back(fragment_ref);
@@ -492,6 +519,15 @@ namespace dtn
 
 		}
 
+		FragmentManager::Reassembly::Reassembly()
+		 : container(dtn::data::BundleMerger::getContainer())
+		{
+		}
+
+		FragmentManager::Reassembly::~Reassembly()
+		{
+		}
+
 		FragmentManager::Transmission::Transmission()
 		 : offset(0), expires(0)
 		{
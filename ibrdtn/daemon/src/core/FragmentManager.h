@@ -27,10 +27,12 @@
 #include "storage/BundleResult.h"
 #include "routing/QueueBundleEvent.h"
 #include <ibrdtn/data/MetaBundle.h>
+#include <ibrdtn/data/BundleMerger.h>
 #include <ibrcommon/thread/Queue.h>
 #include <ibrcommon/thread/Mutex.h>
 #include <list>
 #include <set>
+#include <map>
 
 namespace dtn
 {
@@ -118,6 +120,35 @@ namespace dtn
 				dtn::data::Timestamp expires;
 			};
 
+			/**
+			 * The state of a bundle in reassembly. The payload of each fragment is
+			 * written into the merged bundle as it arrives.
+			 */
+			class Reassembly
+			{
+			public:
+				Reassembly();
+				virtual ~Reassembly();
+
+				dtn::data::BundleMerger::Container container;
+
+				// all fragments merged so far
+				std::set<dtn::data::MetaBundle> fragments;
+			};
+
+			typedef std::map<dtn::data::BundleID, Reassembly> reassembly_map;
+
+			/**
+			 * Add a fragment to the reassembly of its bundle
+			 * @return The reassembly of the bundle
+			 */
+			Reassembly& merge(const dtn::data::MetaBundle &meta);
+
+			/**
+			 * Drop the reassembly of expired bundles
+			 */
+			void expire_reassembly();
+
 			static void expire_offsets(const dtn::data::Timestamp &timestamp);
 			static dtn::data::Length get_payload_offset(const dtn::data::Bundle &bundle, const dtn::data::Length &abs_offset, const dtn::data::Length &frag_offset) throw ();
 
@@ -137,6 +168,9 @@ namespace dtn
 			ibrcommon::Queue<dtn::data::MetaBundle> _incoming;
 			bool _running;
 
+			// bundles in reassembly, only accessed by the thread of this component
+			reassembly_map _reassembly;
+
 			static ibrcommon::Mutex _offsets_mutex;
 			static std::set<Transmission> _offsets;
 		};
@@ -0,0 +1,614 @@
+/*
+ * Metrics.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "core/Metrics.h"
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
+#include <ibrcommon/MonotonicClock.h>
+#include <ibrcommon/Logger.h>
+#include <sstream>
+#include <cstring>
+
+namespace dtn
+{
+	namespace core
+	{
+		/**
+		 * Each slot is written by one thread only and read by the collecting
+		 * thread. If 64-bit atomics are not available, a collected value may
+		 * be torn while it is updated.
+		 */
+		static inline Metrics::value_type __load_value(const Metrics::value_type *v)
+		{
+#if defined(__ATOMIC_RELAXED) && defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+			return __atomic_load_n(v, __ATOMIC_RELAXED);
+#else
+			return *static_cast<const volatile Metrics::value_type*>(v);
+#endif
+		}
+
+		static inline void __store_value(Metrics::value_type *v, const Metrics::value_type &value)
+		{
+#if defined(__ATOMIC_RELAXED) && defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+			__atomic_store_n(v, value, __ATOMIC_RELAXED);
+#else
+			*static_cast<volatile Metrics::value_type*>(v) = value;
+#endif
+		}
+
+		template<class T> static inline T* __load_pointer(T* const *p)
+		{
+#if defined(__ATOMIC_ACQUIRE)
+			return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+			T *ret = *static_cast<T* const volatile*>(p);
+			__sync_synchronize();
+			return ret;
+#endif
+		}
+
+		template<class T> static inline void __store_pointer(T **p, T *value)
+		{
+#if defined(__ATOMIC_RELEASE)
+			__atomic_store_n(p, value, __ATOMIC_RELEASE);
+#else
+			__sync_synchronize();
+			*static_cast<T* volatile*>(p) = value;
+#endif
+		}
+
+		Metrics::Counter::Counter()
+		 : _slot(INVALID_SLOT)
+		{
+		}
+
+		Metrics::Counter::Counter(size_t slot)
+		 : _slot(slot)
+		{
+		}
+
+		void Metrics::Counter::add(const value_type &value) const throw ()
+		{
+			if (_slot == INVALID_SLOT) return;
+			Metrics::getInstance().__get_shard().add(_slot, value);
+		}
+
+		Metrics::Gauge::Gauge()
+		 : _slot(INVALID_SLOT)
+		{
+		}
+
+		Metrics::Gauge::Gauge(size_t slot)
+		 : _slot(slot)
+		{
+		}
+
+		void Metrics::Gauge::add(const int64_t &value) const throw ()
+		{
+			if (_slot == INVALID_SLOT) return;
+
+			// the per-thread values may be negative, but their sum is not
+			Metrics::getInstance().__get_shard().add(_slot, static_cast<value_type>(value));
+		}
+
+		Metrics::Histogram::Histogram()
+		 : _slot(INVALID_SLOT)
+		{
+		}
+
+		Metrics::Histogram::Histogram(size_t slot)
+		 : _slot(slot)
+		{
+		}
+
+		void Metrics::Histogram::record(const value_type &value) const throw ()
+		{
+			if (_slot == INVALID_SLOT) return;
+
+			Shard &shard = Metrics::getInstance().__get_shard();
+			shard.add(_slot + __get_bucket(value), 1);
+			shard.add(_slot + BUCKETS, value);
+		}
+
+		Metrics::Timer::Timer(const Histogram &h)
+		 : _histogram(h), _start(Metrics::now())
+		{
+		}
+
+		Metrics::Timer::~Timer()
+		{
+			_histogram.record(Metrics::now() - _start);
+		}
+
+		Metrics::Sample::Sample()
+		 : type(METRIC_COUNTER), value(0), sum(0)
+		{
+		}
+
+		Metrics::value_type Metrics::Sample::percentile(const double fraction) const
+		{
+			if (value == 0) return 0;
+
+			// the rank of the requested value, starting at one
+			value_type rank = static_cast<value_type>(fraction * static_cast<double>(value) + 0.5);
+			if (rank < 1) rank = 1;
+			if (rank > value) rank = value;
+
+			value_type count = 0;
+			for (size_t i = 0; i < buckets.size(); ++i)
+			{
+				count += buckets[i];
+				if (count >= rank) return __get_bucket_limit(i);
+			}
+
+			return __get_bucket_limit(buckets.size() - 1);
+		}
+
+		Metrics::Shard::Shard()
+		 : generation(0)
+		{
+			for (size_t i = 0; i < MAX_CHUNKS; ++i) _chunks[i] = NULL;
+		}
+
+		Metrics::Shard::~Shard()
+		{
+			for (size_t i = 0; i < MAX_CHUNKS; ++i) delete[] _chunks[i];
+		}
+
+		void Metrics::Shard::add(const size_t slot, const value_type &value) throw ()
+		{
+			value_type *chunk = _chunks[slot / CHUNK_SLOTS];
+
+			if (chunk == NULL)
+			{
+				chunk = new value_type[CHUNK_SLOTS];
+				::memset(chunk, 0, sizeof(value_type) * CHUNK_SLOTS);
+
+				// publish the initialized chunk to the collecting thread
+				__store_pointer(&_chunks[slot / CHUNK_SLOTS], chunk);
+			}
+
+			value_type *v = &chunk[slot % CHUNK_SLOTS];
+			__store_value(v, *v + value);
+		}
+
+		Metrics::value_type Metrics::Shard::get(const size_t slot) const throw ()
+		{
+			const value_type *chunk = __load_pointer(&_chunks[slot / CHUNK_SLOTS]);
+			if (chunk == NULL) return 0;
+			return __load_value(&chunk[slot % CHUNK_SLOTS]);
+		}
+
+		Metrics::Metrics()
+		 : _slots(0), _generation(0)
+		{
+			pthread_key_create(&_shard_key, &Metrics::__release_shard);
+		}
+
+		Metrics::~Metrics()
+		{
+			pthread_key_delete(_shard_key);
+
+			for (std::list<Shard*>::iterator iter = _shards.begin(); iter != _shards.end(); ++iter)
+			{
+				delete (*iter);
+			}
+		}
+
+		Metrics& Metrics::getInstance()
+		{
+			static Metrics instance;
+			return instance;
+		}
+
+		Metrics::value_type Metrics::now() throw ()
+		{
+			struct timespec ts;
+			ibrcommon::MonotonicClock::gettime(ts);
+			return static_cast<value_type>(ts.tv_sec) * 1000000 + static_cast<value_type>(ts.tv_nsec / 1000);
+		}
+
+		std::string Metrics::label(const std::string &key, const std::string &value)
+		{
+			std::string ret = key + "=\"";
+
+			for (std::string::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+			{
+				switch (*iter)
+				{
+				case '\\': ret += "\\\\"; break;
+				case '"': ret += "\\\""; break;
+				case '\n': ret += "\\n"; break;
+				default: ret += (*iter); break;
+				}
+			}
+
+			return ret + "\"";
+		}
+
+		Metrics::Counter Metrics::getCounter(const std::string &name, const std::string &labels, const std::string &help)
+		{
+			return Counter(__get_slot(name, labels, help, METRIC_COUNTER));
+		}
+
+		Metrics::Gauge Metrics::getGauge(const std::string &name, const std::string &labels, const std::string &help)
+		{
+			return Gauge(__get_slot(name, labels, help, METRIC_GAUGE));
+		}
+
+		Metrics::Histogram Metrics::getHistogram(const std::string &name, const std::string &labels, const std::string &help)
+		{
+			return Histogram(__get_slot(name, labels, help, METRIC_HISTOGRAM));
+		}
+
+		Metrics::Shard& Metrics::__get_shard()
+		{
+			Shard *shard = static_cast<Shard*>(pthread_getspecific(_shard_key));
+			if (shard != NULL) return *shard;
+
+			shard = new Shard();
+			pthread_setspecific(_shard_key, shard);
+
+			ibrcommon::MutexLock l(_lock);
+			_shards.push_back(shard);
+
+			return *shard;
+		}
+
+		void Metrics::__release_shard(void *data)
+		{
+			Shard *shard = static_cast<Shard*>(data);
+			Metrics &m = Metrics::getInstance();
+
+			ibrcommon::MutexLock l(m._lock);
+
+			// keep the values of the thread
+			for (size_t slot = 0; slot < m._slots; ++slot)
+			{
+				const value_type v = shard->get(slot);
+				if (v != 0) m._retired.add(slot, v);
+			}
+
+			m._shards.remove(shard);
+			delete shard;
+		}
+
+		size_t Metrics::__get_slot(const std::string &name, const std::string &labels, const std::string &help, const Type type)
+		{
+			const std::string key = name + "{" + labels + "}";
+
+			Shard &shard = __get_shard();
+
+			// drop the cached slots if metrics have been removed
+			const size_t generation = ibrcommon::atomic::load(_generation);
+			if (shard.generation != generation)
+			{
+				shard.cache.clear();
+				shard.generation = generation;
+			}
+
+			std::map<std::string, cache_entry>::const_iterator cached = shard.cache.find(key);
+
+			if (cached == shard.cache.end())
+			{
+				ibrcommon::MutexLock l(_lock);
+
+				std::map<std::string, Descriptor>::iterator iter = _metrics.find(key);
+
+				if (iter == _metrics.end())
+				{
+					const size_t length = __get_length(type);
+
+					bool reused = false;
+					const size_t slot = __allocate(length, reused);
+
+					if (slot == INVALID_SLOT)
+					{
+						IBRCOMMON_LOGGER_TAG("Metrics", warning) << "no free slot for metric " << key << IBRCOMMON_LOGGER_ENDL;
+						return INVALID_SLOT;
+					}
+
+					Descriptor &nd = _metrics[key];
+					nd.name = name;
+					nd.labels = labels;
+					nd.type = type;
+					nd.slot = slot;
+
+					// the values of other threads can not be reset, thus
+					// the new metric starts at the current values of the slots
+					if (reused)
+					{
+						nd.base.assign(length, 0);
+						__sum(slot, nd.base);
+					}
+
+					if ((help.length() > 0) && (_help.find(name) == _help.end())) _help[name] = help;
+
+					iter = _metrics.find(key);
+				}
+
+				cached = shard.cache.insert(std::make_pair(key, cache_entry(iter->second.type, iter->second.slot))).first;
+			}
+
+			if (cached->second.first != type)
+			{
+				IBRCOMMON_LOGGER_TAG("Metrics", warning) << "metric " << key << " is already registered with another type" << IBRCOMMON_LOGGER_ENDL;
+				return INVALID_SLOT;
+			}
+
+			return cached->second.second;
+		}
+
+		size_t Metrics::__allocate(const size_t length, bool &reused)
+		{
+			std::map<size_t, std::list<std::pair<size_t, value_type> > >::iterator f = _free.find(length);
+
+			// reuse slots which are released long enough, so that no pending
+			// value of the removed metric is added to the new one
+			if ((f != _free.end()) && (Metrics::now() - f->second.front().second >= RELEASE_DELAY))
+			{
+				const size_t slot = f->second.front().first;
+				f->second.pop_front();
+				if (f->second.empty()) _free.erase(f);
+
+				reused = true;
+				return slot;
+			}
+
+			// do not spread the slots of a metric across chunks
+			if ((_slots % CHUNK_SLOTS) + length > CHUNK_SLOTS)
+			{
+				_slots += CHUNK_SLOTS - (_slots % CHUNK_SLOTS);
+			}
+
+			if (_slots + length > CHUNK_SLOTS * MAX_CHUNKS)
+			{
+				return INVALID_SLOT;
+			}
+
+			const size_t slot = _slots;
+			_slots += length;
+
+			reused = false;
+			return slot;
+		}
+
+		void Metrics::remove(const std::string &name, const std::string &labels)
+		{
+			const std::string key = name + "{" + labels + "}";
+
+			ibrcommon::MutexLock l(_lock);
+
+			std::map<std::string, Descriptor>::iterator iter = _metrics.find(key);
+			if (iter == _metrics.end()) return;
+
+			const Descriptor &d = iter->second;
+			_free[__get_length(d.type)].push_back(std::make_pair(d.slot, Metrics::now()));
+			_metrics.erase(iter);
+
+			// invalidate the lookup caches of all threads
+			ibrcommon::atomic::add(_generation, 1);
+		}
+
+		void Metrics::__sum(const size_t slot, std::vector<value_type> &values) const
+		{
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				values[i] = _retired.get(slot + i);
+			}
+
+			for (std::list<Shard*>::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+			{
+				const Shard &shard = (**it);
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					values[i] += shard.get(slot + i);
+				}
+			}
+		}
+
+		size_t Metrics::__get_length(const Type type) throw ()
+		{
+			return (type == METRIC_HISTOGRAM) ? (BUCKETS + 1) : 1;
+		}
+
+		size_t Metrics::__get_bucket(const value_type &value) throw ()
+		{
+			// values below 16 have their own bucket
+			if (value < (2 << SUB_BITS)) return static_cast<size_t>(value);
+
+			// position of the most significant bit
+			size_t exp = 0;
+			for (value_type v = value >> 1; v > 0; v >>= 1) ++exp;
+
+			if (exp > MAX_EXPONENT) return BUCKETS - 1;
+
+			// the bits following the most significant bit select the sub-bucket
+			return ((exp - SUB_BITS) << SUB_BITS) + static_cast<size_t>(value >> (exp - SUB_BITS));
+		}
+
+		Metrics::value_type Metrics::__get_bucket_limit(const size_t bucket) throw ()
+		{
+			if (bucket < (2 << SUB_BITS)) return bucket;
+
+			const size_t exp = (bucket >> SUB_BITS) + SUB_BITS - 1;
+			const value_type sub = (bucket & ((1 << SUB_BITS) - 1)) + (1 << SUB_BITS);
+
+			// the largest value of the bucket
+			return ((sub + 1) << (exp - SUB_BITS)) - 1;
+		}
+
+		const char* Metrics::__get_type_name(const Type type)
+		{
+			switch (type)
+			{
+			case METRIC_COUNTER: return "counter";
+			case METRIC_GAUGE: return "gauge";
+			case METRIC_HISTOGRAM: return "histogram";
+			}
+			return "untyped";
+		}
+
+		void Metrics::collect(sample_list &samples)
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			for (std::map<std::string, Descriptor>::const_iterator iter = _metrics.begin(); iter != _metrics.end(); ++iter)
+			{
+				const Descriptor &d = iter->second;
+
+				samples.push_back(Sample());
+				Sample &s = samples.back();
+				s.name = d.name;
+				s.labels = d.labels;
+				s.type = d.type;
+
+				std::vector<value_type> values(__get_length(d.type), 0);
+				__sum(d.slot, values);
+
+				// hide the values of previous metrics using the same slots
+				for (size_t i = 0; i < d.base.size(); ++i)
+				{
+					values[i] -= d.base[i];
+				}
+
+				if (d.type == METRIC_HISTOGRAM)
+				{
+					s.buckets.assign(values.begin(), values.begin() + BUCKETS);
+					s.sum = values[BUCKETS];
+
+					// count the values of the buckets, thus the count matches the buckets
+					for (size_t i = 0; i < BUCKETS; ++i) s.value += s.buckets[i];
+				}
+				else
+				{
+					s.value = values[0];
+				}
+			}
+		}
+
+		void Metrics::write(std::ostream &stream)
+		{
+			sample_list samples;
+			collect(samples);
+
+			for (sample_list::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+			{
+				const Sample &s = (*iter);
+
+				stream << s.name;
+				if (s.labels.length() > 0) stream << "{" << s.labels << "}";
+				stream << ": ";
+
+				switch (s.type)
+				{
+				case METRIC_GAUGE:
+					stream << static_cast<int64_t>(s.value);
+					break;
+
+				case METRIC_HISTOGRAM:
+					stream << "count=" << s.value << " sum=" << s.sum
+							<< " p50=" << s.percentile(0.5)
+							<< " p90=" << s.percentile(0.9)
+							<< " p99=" << s.percentile(0.99)
+							<< " max=" << s.percentile(1.0);
+					break;
+
+				default:
+					stream << s.value;
+					break;
+				}
+
+				stream << std::endl;
+			}
+		}
+
+		void Metrics::writePrometheus(std::ostream &stream)
+		{
+			sample_list samples;
+			collect(samples);
+
+			std::map<std::string, std::string> help;
+			{
+				ibrcommon::MutexLock l(_lock);
+				help = _help;
+			}
+
+			std::string family;
+
+			for (sample_list::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+			{
+				const Sample &s = (*iter);
+
+				// samples of the same name are ordered next to each other
+				if (s.name != family)
+				{
+					family = s.name;
+
+					std::map<std::string, std::string>::const_iterator h = help.find(family);
+					if (h != help.end()) stream << "# HELP " << family << " " << h->second << "\n";
+					stream << "# TYPE " << family << " " << __get_type_name(s.type) << "\n";
+				}
+
+				const std::string labels = (s.labels.length() > 0) ? ("{" + s.labels + "}") : "";
+
+				switch (s.type)
+				{
+				case METRIC_GAUGE:
+					stream << s.name << labels << " " << static_cast<int64_t>(s.value) << "\n";
+					break;
+
+				case METRIC_HISTOGRAM:
+				{
+					const std::string prefix = (s.labels.length() > 0) ? (s.labels + ",") : "";
+
+					// export cumulative buckets at every second power of two
+					value_type count = 0;
+					size_t bucket = 0;
+
+					for (size_t exp = 2; exp <= MAX_EXPONENT + 1; exp += 2)
+					{
+						const value_type limit = (static_cast<value_type>(1) << exp) - 1;
+
+						for (; (bucket < BUCKETS - 1) && (__get_bucket_limit(bucket) <= limit); ++bucket)
+						{
+							count += s.buckets[bucket];
+						}
+
+						stream << s.name << "_bucket{" << prefix << "le=\"" << limit << "\"} " << count << "\n";
+					}
+
+					stream << s.name << "_bucket{" << prefix << "le=\"+Inf\"} " << s.value << "\n";
+					stream << s.name << "_sum" << labels << " " << s.sum << "\n";
+					stream << s.name << "_count" << labels << " " << s.value << "\n";
+					break;
+				}
+
+				default:
+					stream << s.name << labels << " " << s.value << "\n";
+					break;
+				}
+			}
+
+			stream << std::flush;
+		}
+	} /* namespace core */
+} /* namespace dtn */
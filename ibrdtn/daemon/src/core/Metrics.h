@@ -0,0 +1,310 @@
+/*
+ * Metrics.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <ibrcommon/thread/Mutex.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+namespace dtn
+{
+	namespace core
+	{
+		/**
+		 * Registry of counters, gauges and latency histograms. Every thread
+		 * updates its own copy of the values, thus recording a value
+		 * neither takes a lock nor shares a cache line with other threads.
+		 * The copies are summed up when the values are collected. Metrics
+		 * are identified by a name and an optional set of labels. Metrics
+		 * labelled with short-living entities, e.g. peers, have to be
+		 * removed once the entity is gone, so that their slots are reused.
+		 */
+		class Metrics
+		{
+		public:
+			typedef uint64_t value_type;
+
+			enum Type
+			{
+				METRIC_COUNTER = 0,
+				METRIC_GAUGE = 1,
+				METRIC_HISTOGRAM = 2
+			};
+
+			/**
+			 * Monotonic increasing counter
+			 */
+			class Counter
+			{
+			public:
+				Counter();
+				void add(const value_type &value = 1) const throw ();
+
+			private:
+				friend class Metrics;
+				Counter(size_t slot);
+				size_t _slot;
+			};
+
+			/**
+			 * Value which goes up and down, e.g. the length of a queue
+			 */
+			class Gauge
+			{
+			public:
+				Gauge();
+				void add(const int64_t &value) const throw ();
+
+			private:
+				friend class Metrics;
+				Gauge(size_t slot);
+				size_t _slot;
+			};
+
+			/**
+			 * Distribution of values, usually latencies in microseconds.
+			 * The buckets are exact up to 16 and have a relative width of
+			 * 12.5% above, values beyond 2^36 are put into the last bucket.
+			 */
+			class Histogram
+			{
+			public:
+				Histogram();
+				void record(const value_type &value) const throw ();
+
+			private:
+				friend class Metrics;
+				Histogram(size_t slot);
+				size_t _slot;
+			};
+
+			/**
+			 * Records the lifetime of the object in a histogram
+			 */
+			class Timer
+			{
+			public:
+				Timer(const Histogram &h);
+				~Timer();
+
+			private:
+				const Histogram _histogram;
+				const value_type _start;
+			};
+
+			/**
+			 * Collected values of one metric
+			 */
+			class Sample
+			{
+			public:
+				Sample();
+
+				std::string name;
+				std::string labels;
+				Type type;
+
+				// value of counters and gauges, number of values of histograms
+				value_type value;
+
+				// sum of all values and the buckets of histograms
+				value_type sum;
+				std::vector<value_type> buckets;
+
+				/**
+				 * Returns the value below which the given fraction of all
+				 * recorded values falls, e.g. 0.99 for the 99th percentile
+				 */
+				value_type percentile(const double fraction) const;
+			};
+
+			typedef std::list<Sample> sample_list;
+
+			static Metrics& getInstance();
+
+			/**
+			 * Returns a monotonic timestamp in microseconds
+			 */
+			static value_type now() throw ();
+
+			/**
+			 * Returns a label pair with an escaped value, e.g. peer="dtn://node"
+			 */
+			static std::string label(const std::string &key, const std::string &value);
+
+			/**
+			 * Get or create a metric. The lookup of known metrics does not
+			 * lock the registry, but it should be avoided on hot paths if
+			 * the labels are constant.
+			 * @param name The name of the metric
+			 * @param labels Comma separated label pairs created by label()
+			 * @param help A description of the metric used for the first creation
+			 */
+			Counter getCounter(const std::string &name, const std::string &labels = "", const std::string &help = "");
+			Gauge getGauge(const std::string &name, const std::string &labels = "", const std::string &help = "");
+			Histogram getHistogram(const std::string &name, const std::string &labels = "", const std::string &help = "");
+
+			/**
+			 * Remove a metric and release its slots for other metrics.
+			 * The slots are reused after a minute at the earliest, thus
+			 * handles of the removed metric must not be used longer,
+			 * otherwise their values are added to the metric which reuses
+			 * the slots.
+			 * @param name The name of the metric
+			 * @param labels Comma separated label pairs created by label()
+			 */
+			void remove(const std::string &name, const std::string &labels = "");
+
+			/**
+			 * Sum up the values of all threads
+			 */
+			void collect(sample_list &samples);
+
+			/**
+			 * Write all metrics in a human-readable form, one metric per line
+			 */
+			void write(std::ostream &stream);
+
+			/**
+			 * Write all metrics in the text exposition format of Prometheus
+			 */
+			void writePrometheus(std::ostream &stream);
+
+		private:
+			// histogram buckets, exact up to 16 and 8 buckets per power of two up to 2^36
+			static const size_t SUB_BITS = 3;
+			static const size_t MAX_EXPONENT = 35;
+			static const size_t BUCKETS = ((MAX_EXPONENT - SUB_BITS) << SUB_BITS) + (2 << SUB_BITS);
+
+			static const size_t CHUNK_SLOTS = 1024;
+			static const size_t MAX_CHUNKS = 1024;
+			static const size_t INVALID_SLOT = static_cast<size_t>(-1);
+
+			// microseconds until released slots are reused
+			static const value_type RELEASE_DELAY = 60000000;
+
+			class Descriptor
+			{
+			public:
+				std::string name;
+				std::string labels;
+				Type type;
+				size_t slot;
+
+				// values of reused slots at the creation of the metric
+				std::vector<value_type> base;
+			};
+
+			typedef std::pair<Type, size_t> cache_entry;
+
+			/**
+			 * Values written by one thread. The slots are allocated in chunks
+			 * on the first write, thus a thread only allocates memory for
+			 * metrics it actually uses.
+			 */
+			class Shard
+			{
+			public:
+				Shard();
+				~Shard();
+
+				void add(const size_t slot, const value_type &value) throw ();
+				value_type get(const size_t slot) const throw ();
+
+				// lookup cache of metrics used by the owning thread
+				std::map<std::string, cache_entry> cache;
+
+				// generation of the registry the cache is valid for
+				size_t generation;
+
+			private:
+				value_type *_chunks[MAX_CHUNKS];
+			};
+
+			Metrics();
+			virtual ~Metrics();
+
+			/**
+			 * Returns the shard of the calling thread
+			 */
+			Shard& __get_shard();
+
+			/**
+			 * Lookup a metric in the cache of the calling thread and register
+			 * it if necessary. Returns INVALID_SLOT if there are no free slots.
+			 */
+			size_t __get_slot(const std::string &name, const std::string &labels, const std::string &help, const Type type);
+
+			/**
+			 * Allocate consecutive slots, preferably slots released by
+			 * removed metrics. Returns INVALID_SLOT if there are no free slots.
+			 * @param reused Set to true if the slots were used before
+			 */
+			size_t __allocate(const size_t length, bool &reused);
+
+			/**
+			 * Sum up the values of consecutive slots of all threads
+			 */
+			void __sum(const size_t slot, std::vector<value_type> &values) const;
+
+			static size_t __get_length(const Type type) throw ();
+
+			static void __release_shard(void *data);
+
+			static size_t __get_bucket(const value_type &value) throw ();
+			static value_type __get_bucket_limit(const size_t bucket) throw ();
+
+			static const char* __get_type_name(const Type type);
+
+			ibrcommon::Mutex _lock;
+
+			// all metrics, ordered by name and labels
+			std::map<std::string, Descriptor> _metrics;
+
+			// descriptions of the metric names
+			std::map<std::string, std::string> _help;
+
+			// next free slot
+			size_t _slots;
+
+			// slots of removed metrics and the time of the removal,
+			// ordered by the number of slots
+			std::map<size_t, std::list<std::pair<size_t, value_type> > > _free;
+
+			// incremented on each removal to invalidate the lookup caches
+			volatile size_t _generation;
+
+			pthread_key_t _shard_key;
+			std::list<Shard*> _shards;
+
+			// values of shards released by terminated threads
+			Shard _retired;
+		};
+	} /* namespace core */
+} /* namespace dtn */
+#endif /* METRICS_H_ */
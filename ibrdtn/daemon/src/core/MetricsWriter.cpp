@@ -0,0 +1,97 @@
+/*
+ * MetricsWriter.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "core/MetricsWriter.h"
+#include "core/Metrics.h"
+#include "core/EventDispatcher.h"
+#include <ibrcommon/Logger.h>
+#include <fstream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+namespace dtn
+{
+	namespace core
+	{
+		const std::string MetricsWriter::TAG = "MetricsWriter";
+
+		MetricsWriter::MetricsWriter(const ibrcommon::File &file, const unsigned int interval)
+		 : _file(file), _interval(interval), _ticks(0)
+		{
+		}
+
+		MetricsWriter::~MetricsWriter()
+		{
+		}
+
+		void MetricsWriter::componentUp() throw ()
+		{
+			dtn::core::EventDispatcher<dtn::core::TimeEvent>::add(this);
+			IBRCOMMON_LOGGER_TAG(MetricsWriter::TAG, info) << "write metrics to " << _file.getPath() << " every " << _interval << " seconds" << IBRCOMMON_LOGGER_ENDL;
+		}
+
+		void MetricsWriter::componentDown() throw ()
+		{
+			dtn::core::EventDispatcher<dtn::core::TimeEvent>::remove(this);
+
+			// write the final values
+			__write();
+		}
+
+		void MetricsWriter::raiseEvent(const dtn::core::TimeEvent &evt) throw ()
+		{
+			if (evt.getAction() != dtn::core::TIME_SECOND_TICK) return;
+
+			if (++_ticks < _interval) return;
+			_ticks = 0;
+
+			__write();
+		}
+
+		void MetricsWriter::__write() throw ()
+		{
+			// write into a temporary file and replace the previous dump
+			const std::string tmp = _file.getPath() + ".tmp";
+
+			{
+				std::ofstream stream(tmp.c_str(), std::ios::out | std::ios::trunc);
+				Metrics::getInstance().writePrometheus(stream);
+
+				if (!stream.good())
+				{
+					IBRCOMMON_LOGGER_TAG(MetricsWriter::TAG, error) << "can not write metrics to " << tmp << IBRCOMMON_LOGGER_ENDL;
+					return;
+				}
+			}
+
+			if (::rename(tmp.c_str(), _file.getPath().c_str()) != 0)
+			{
+				IBRCOMMON_LOGGER_TAG(MetricsWriter::TAG, error) << "can not replace " << _file.getPath() << ": " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		const std::string MetricsWriter::getName() const
+		{
+			return MetricsWriter::TAG;
+		}
+	} /* namespace core */
+} /* namespace dtn */
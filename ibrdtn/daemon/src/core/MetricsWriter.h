@@ -0,0 +1,68 @@
+/*
+ * MetricsWriter.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef METRICSWRITER_H_
+#define METRICSWRITER_H_
+
+#include "Component.h"
+#include "core/EventReceiver.h"
+#include "core/TimeEvent.h"
+#include <ibrcommon/data/File.h>
+
+namespace dtn
+{
+	namespace core
+	{
+		/**
+		 * Periodically dumps all metrics into a file using the text format
+		 * of Prometheus. The file is replaced atomically, thus it can be
+		 * picked up by the textfile collector of the node exporter.
+		 */
+		class MetricsWriter : public dtn::daemon::IntegratedComponent, public dtn::core::EventReceiver<dtn::core::TimeEvent>
+		{
+			static const std::string TAG;
+
+		public:
+			/**
+			 * @param file The file to write
+			 * @param interval The number of seconds between two dumps
+			 */
+			MetricsWriter(const ibrcommon::File &file, const unsigned int interval);
+			virtual ~MetricsWriter();
+
+			void raiseEvent(const dtn::core::TimeEvent &evt) throw ();
+
+			const std::string getName() const;
+
+		protected:
+			void componentUp() throw ();
+			void componentDown() throw ();
+
+		private:
+			void __write() throw ();
+
+			const ibrcommon::File _file;
+			const unsigned int _interval;
+			unsigned int _ticks;
+		};
+	} /* namespace core */
+} /* namespace dtn */
+#endif /* METRICSWRITER_H_ */
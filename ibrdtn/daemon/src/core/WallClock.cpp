@@ -56,11 +56,7 @@ namespace dtn
 			}
 			else
 			{
-				try {
-					_timer.start();
-				} catch (const ibrcommon::ThreadException &ex) {
-					IBRCOMMON_LOGGER_TAG("WallClock", error) << ex.what() << IBRCOMMON_LOGGER_ENDL;
-				}
+				_timer.start();
 			}
 		}
 
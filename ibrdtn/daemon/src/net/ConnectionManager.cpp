@@ -45,8 +45,39 @@ namespace dtn
 			}
 		};
 
+		ConnectionManager::NeighborSnapshot::NeighborSnapshot(const dtn::data::Size version)
+		 : _version(version)
+		{
+		}
+
+		ConnectionManager::NeighborSnapshot::~NeighborSnapshot()
+		{
+		}
+
+		const std::set<dtn::core::Node>& ConnectionManager::NeighborSnapshot::getNeighbors() const throw ()
+		{
+			return _neighbors;
+		}
+
+		bool ConnectionManager::NeighborSnapshot::isNeighbor(const dtn::data::EID &eid) const throw ()
+		{
+			return (_protocols.find(eid) != _protocols.end());
+		}
+
+		const ConnectionManager::protocol_list& ConnectionManager::NeighborSnapshot::getSupportedProtocols(const dtn::data::EID &eid) const throw (NodeNotAvailableException)
+		{
+			protocol_map::const_iterator iter = _protocols.find(eid);
+			if (iter == _protocols.end()) throw NodeNotAvailableException("Node is not reachable or not available.");
+			return (*iter).second;
+		}
+
+		dtn::data::Size ConnectionManager::NeighborSnapshot::getVersion() const throw ()
+		{
+			return _version;
+		}
+
 		ConnectionManager::ConnectionManager()
-		 : _next_autoconnect(0)
+		 : _snapshot(new NeighborSnapshot(0)), _snapshot_outdated(false), _next_autoconnect(0)
 		{
 		}
 
@@ -83,6 +114,7 @@ namespace dtn
 				ibrcommon::MutexLock l(_node_lock);
 				// clear the node list
 				_nodes.clear();
+				invalidateSnapshot();
 			}
 
 			_next_autoconnect = 0;
@@ -155,8 +187,15 @@ namespace dtn
 				break;
 
 			case GlobalEvent::GLOBAL_INTERNET_UNAVAILABLE:
+			{
+				{
+					// the availability of global addresses has changed
+					ibrcommon::MutexLock l(_node_lock);
+					invalidateSnapshot();
+				}
 				check_unavailable();
 				break;
+			}
 
 			default:
 				break;
@@ -210,15 +249,20 @@ namespace dtn
 				db += n;
 
 				if (old != db.size()) {
+					invalidateSnapshot();
+
 					// announce the new node
 					dtn::core::NodeEvent::raise(db, dtn::core::NODE_DATA_ADDED);
 				}
 			} else {
+				invalidateSnapshot();
+
 				IBRCOMMON_LOGGER_DEBUG_TAG("ConnectionManager", 56) << "New node available: " << db << IBRCOMMON_LOGGER_ENDL;
 			}
 
 			if (db.isAvailable() && !db.isAnnounced() && isReachable(db)) {
 				db.setAnnounced(true);
+				invalidateSnapshot();
 
 				// announce the new node
 				dtn::core::NodeEvent::raise(db, dtn::core::NODE_AVAILABLE);
@@ -237,6 +281,8 @@ namespace dtn
 				db -= n;
 
 				if (old != db.size()) {
+					invalidateSnapshot();
+
 					// announce the new node
 					dtn::core::NodeEvent::raise(db, dtn::core::NODE_DATA_REMOVED);
 				}
@@ -247,23 +293,35 @@ namespace dtn
 
 		void ConnectionManager::add(ConvergenceLayer *cl)
 		{
-			ibrcommon::MutexLock l(_cl_lock);
-			_cl.insert( cl );
-			_cl_protocols.insert( cl->getDiscoveryProtocol() );
+			{
+				ibrcommon::MutexLock l(_cl_lock);
+				_cl.insert( cl );
+				_cl_protocols.insert( cl->getDiscoveryProtocol() );
+			}
+
+			// the reachability of nodes may have changed
+			ibrcommon::MutexLock l(_node_lock);
+			invalidateSnapshot();
 		}
 
 		void ConnectionManager::remove(ConvergenceLayer *cl)
 		{
-			ibrcommon::MutexLock l(_cl_lock);
-			_cl.erase( cl );
-
-			// update protocols
-			_cl_protocols.clear();
-			for (std::set<ConvergenceLayer*>::const_iterator iter = _cl.begin(); iter != _cl.end(); ++iter)
 			{
-				ConvergenceLayer &cl = (**iter);
-				_cl_protocols.insert( cl.getDiscoveryProtocol() );
+				ibrcommon::MutexLock l(_cl_lock);
+				_cl.erase( cl );
+
+				// update protocols
+				_cl_protocols.clear();
+				for (std::set<ConvergenceLayer*>::const_iterator iter = _cl.begin(); iter != _cl.end(); ++iter)
+				{
+					ConvergenceLayer &cl = (**iter);
+					_cl_protocols.insert( cl.getDiscoveryProtocol() );
+				}
 			}
+
+			// the reachability of nodes may have changed
+			ibrcommon::MutexLock l(_node_lock);
+			invalidateSnapshot();
 		}
 
 		void ConnectionManager::getStats(dtn::net::ConvergenceLayer::stats_data &data)
@@ -288,14 +346,26 @@ namespace dtn
 
 		void ConnectionManager::add(P2PDialupExtension *ext)
 		{
-			ibrcommon::MutexLock l(_dialup_lock);
-			_dialups.insert(ext);
+			{
+				ibrcommon::MutexLock l(_dialup_lock);
+				_dialups.insert(ext);
+			}
+
+			// the reachability of nodes may have changed
+			ibrcommon::MutexLock l(_node_lock);
+			invalidateSnapshot();
 		}
 
 		void ConnectionManager::remove(P2PDialupExtension *ext)
 		{
-			ibrcommon::MutexLock l(_dialup_lock);
-			_dialups.erase(ext);
+			{
+				ibrcommon::MutexLock l(_dialup_lock);
+				_dialups.erase(ext);
+			}
+
+			// the reachability of nodes may have changed
+			ibrcommon::MutexLock l(_node_lock);
+			invalidateSnapshot();
 		}
 
 		void ConnectionManager::discovered(const dtn::core::Node &node)
@@ -356,6 +426,9 @@ namespace dtn
 		{
 			ibrcommon::MutexLock l(_node_lock);
 
+			// the availability of global addresses may have changed
+			invalidateSnapshot();
+
 			// search for outdated nodes
 			for (nodemap::iterator iter = _nodes.begin(); iter != _nodes.end(); ++iter)
 			{
@@ -364,6 +437,7 @@ namespace dtn
 
 				if (n.isAvailable() && isReachable(n)) {
 					n.setAnnounced(true);
+					invalidateSnapshot();
 
 					// announce the unavailable event
 					dtn::core::NodeEvent::raise(n, dtn::core::NODE_AVAILABLE);
@@ -387,12 +461,19 @@ namespace dtn
 
 				if ( !n.isAvailable() ||  !isReachable(n) ) {
 					n.setAnnounced(false);
+					invalidateSnapshot();
 
 					// announce the unavailable event
 					dtn::core::NodeEvent::raise(n, dtn::core::NODE_UNAVAILABLE);
 				}
 
-				if ( n.expire() )
+				const dtn::data::Size old = n.size();
+				const bool expired = n.expire();
+
+				// the attributes of the node have changed
+				if (old != n.size()) invalidateSnapshot();
+
+				if ( expired )
 				{
 					if (n.isAnnounced()) {
 						// announce the unavailable event
@@ -401,6 +482,7 @@ namespace dtn
 
 					// remove the element
 					_nodes.erase( iter++ );
+					invalidateSnapshot();
 				}
 				else
 				{
@@ -566,39 +648,61 @@ namespace dtn
 
 		const ConnectionManager::protocol_list ConnectionManager::getSupportedProtocols(const dtn::data::EID &peer) throw (NodeNotAvailableException)
 		{
-			protocol_list ret;
-
-			const dtn::core::Node node = getNeighbor(peer);
-			const std::list<Node::URI> protocols = node.getAll();
-
-			// lock convergence layers while iterating over them
-			ibrcommon::MutexLock l(_cl_lock);
-
-			for (std::list<Node::URI>::const_iterator iter = protocols.begin(); iter != protocols.end(); ++iter)
-			{
-				const Node::URI &uri = (*iter);
-				if (uri.type == Node::NODE_P2P_DIALUP || _cl_protocols.find(uri.protocol) != _cl_protocols.end())
-				{
-					ret.push_back(uri.protocol);
-				}
-			}
-
-			return ret;
+			const neighbor_snapshot snapshot = getNeighborSnapshot();
+			return snapshot->getSupportedProtocols(peer);
 		}
 
 		const std::set<dtn::core::Node> ConnectionManager::getNeighbors()
+		{
+			const neighbor_snapshot snapshot = getNeighborSnapshot();
+			return snapshot->getNeighbors();
+		}
+
+		const ConnectionManager::neighbor_snapshot ConnectionManager::getNeighborSnapshot() throw ()
 		{
 			ibrcommon::MutexLock l(_node_lock);
 
-			std::set<dtn::core::Node> ret;
+			// return the current snapshot if nothing has changed
+			if (!_snapshot_outdated) return _snapshot;
+
+			// get the protocols of all convergence layers
+			const protocol_set cl_protocols = getSupportedProtocols();
+
+			NeighborSnapshot *snapshot = new NeighborSnapshot(_snapshot->getVersion() + 1);
 
 			for (nodemap::const_iterator iter = _nodes.begin(); iter != _nodes.end(); ++iter)
 			{
 				const Node &n = (*iter).second;
-				if (n.isAvailable() && isReachable(n)) ret.insert( n );
+				if (!n.isAvailable() || !isReachable(n)) continue;
+
+				snapshot->_neighbors.insert( n );
+
+				// collect the protocols supported by both, the local BPA and the peer
+				protocol_list &plist = snapshot->_protocols[n.getEID()];
+
+				const std::list<Node::URI> protocols = n.getAll();
+				for (std::list<Node::URI>::const_iterator it = protocols.begin(); it != protocols.end(); ++it)
+				{
+					const Node::URI &uri = (*it);
+					if (uri.type == Node::NODE_P2P_DIALUP || cl_protocols.find(uri.protocol) != cl_protocols.end())
+					{
+						plist.push_back(uri.protocol);
+					}
+				}
 			}
 
-			return ret;
+			// publish the new snapshot
+			_snapshot = neighbor_snapshot(snapshot);
+			_snapshot_outdated = false;
+
+			IBRCOMMON_LOGGER_DEBUG_TAG("ConnectionManager", 60) << "neighbor snapshot " << _snapshot->getVersion() << " published with " << _snapshot->getNeighbors().size() << " neighbors" << IBRCOMMON_LOGGER_ENDL;
+
+			return _snapshot;
+		}
+
+		void ConnectionManager::invalidateSnapshot() throw ()
+		{
+			_snapshot_outdated = true;
 		}
 
 		const dtn::core::Node ConnectionManager::getNeighbor(const dtn::data::EID &eid) throw (NodeNotAvailableException)
@@ -612,13 +716,8 @@ namespace dtn
 
 		bool ConnectionManager::isNeighbor(const dtn::core::Node &node) throw ()
 		{
-			try {
-				ibrcommon::MutexLock l(_node_lock);
-				const Node &n = getNode(node.getEID());
-				if (n.isAvailable() && isReachable(n)) return true;
-			} catch (const NodeNotAvailableException&) { }
-
-			return false;
+			const neighbor_snapshot snapshot = getNeighborSnapshot();
+			return snapshot->isNeighbor(node.getEID());
 		}
 
 		void ConnectionManager::updateNeighbor(const Node &n)
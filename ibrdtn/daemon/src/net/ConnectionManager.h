@@ -30,6 +30,7 @@
 #include <ibrdtn/data/EID.h>
 #include "core/Node.h"
 #include <ibrcommon/Exceptions.h>
+#include <ibrcommon/refcnt_ptr.h>
 
 #include "core/NodeEvent.h"
 #include "core/TimeEvent.h"
@@ -38,6 +39,7 @@
 
 #include <set>
 #include <list>
+#include <map>
 
 namespace dtn
 {
@@ -117,6 +119,49 @@ namespace dtn
 			typedef std::set<dtn::core::Node::Protocol> protocol_set;
 			typedef std::list<dtn::core::Node::Protocol> protocol_list;
 
+			/**
+			 * Immutable view of all neighbors and the protocols supported by
+			 * both, the local BPA and the neighbor. A published snapshot is
+			 * never modified and may be shared between threads.
+			 */
+			class NeighborSnapshot
+			{
+			public:
+				NeighborSnapshot(const dtn::data::Size version);
+				virtual ~NeighborSnapshot();
+
+				/**
+				 * @return The set of all neighbors
+				 */
+				const std::set<dtn::core::Node>& getNeighbors() const throw ();
+
+				/**
+				 * @return True, if the given EID is a neighbor
+				 */
+				bool isNeighbor(const dtn::data::EID &eid) const throw ();
+
+				/**
+				 * Returns a list of protocol supported by both, local BPA and the peer
+				 */
+				const protocol_list& getSupportedProtocols(const dtn::data::EID &eid) const throw (NodeNotAvailableException);
+
+				/**
+				 * @return The version of this snapshot, increased on each change of the neighbors
+				 */
+				dtn::data::Size getVersion() const throw ();
+
+			private:
+				friend class ConnectionManager;
+
+				typedef std::map<dtn::data::EID, protocol_list> protocol_map;
+
+				const dtn::data::Size _version;
+				std::set<dtn::core::Node> _neighbors;
+				protocol_map _protocols;
+			};
+
+			typedef refcnt_ptr<const NeighborSnapshot> neighbor_snapshot;
+
 			/**
 			 * Returns a list of all supported protocols
 			 */
@@ -133,6 +178,12 @@ namespace dtn
 			 */
 			const std::set<dtn::core::Node> getNeighbors();
 
+			/**
+			 * Get the current snapshot of all neighbors. The snapshot is shared
+			 * and a new one is published if the set of neighbors changes.
+			 */
+			const neighbor_snapshot getNeighborSnapshot() throw ();
+
 			/**
 			 * Checks if a node is already known as neighbor.
 			 * @param
@@ -201,6 +252,11 @@ namespace dtn
 			 */
 			dtn::core::Node& getNode(const dtn::data::EID &eid) throw (NodeNotAvailableException);
 
+			/**
+			 * mark the neighbor snapshot as outdated, requires the node lock
+			 */
+			void invalidateSnapshot() throw ();
+
 			// mutex for the list of convergence layers
 			ibrcommon::Mutex _cl_lock;
 
@@ -219,6 +275,10 @@ namespace dtn
 			typedef std::map<dtn::data::EID, dtn::core::Node> nodemap;
 			nodemap _nodes;
 
+			// shared snapshot of the neighbors, rebuilt on demand if marked as outdated
+			neighbor_snapshot _snapshot;
+			bool _snapshot_outdated;
+
 			// next timestamp for autoconnect check
 			dtn::data::Timestamp _next_autoconnect;
 		};
@@ -37,5 +37,17 @@ namespace dtn
 		void ConvergenceLayer::getStats(ConvergenceLayer::stats_data&) const
 		{
 		}
+
+		dtn::core::Metrics::Counter ConvergenceLayer::getTrafficCounter(const dtn::core::Node::Protocol proto, const std::string &direction)
+		{
+			const std::string labels = dtn::core::Metrics::label("protocol", dtn::core::Node::toString(proto)) + "," + dtn::core::Metrics::label("direction", direction);
+			return dtn::core::Metrics::getInstance().getCounter("dtnd_cl_traffic_bytes_total", labels, "Bytes transferred by the convergence layers");
+		}
+
+		dtn::core::Metrics::Histogram ConvergenceLayer::getSegmentLatency(const dtn::core::Node::Protocol proto)
+		{
+			const std::string labels = dtn::core::Metrics::label("protocol", dtn::core::Node::toString(proto));
+			return dtn::core::Metrics::getInstance().getHistogram("dtnd_cl_segment_latency_microseconds", labels, "Time until a sent segment is acknowledged");
+		}
 	}
 }
@@ -24,6 +24,7 @@
 
 #include "net/BundleTransfer.h"
 #include "core/Node.h"
+#include "core/Metrics.h"
 
 #include <ibrdtn/data/BundleID.h>
 #include <ibrcommon/Exceptions.h>
@@ -74,6 +75,19 @@ namespace dtn
 			virtual void resetStats();
 
 			virtual void getStats(ConvergenceLayer::stats_data &data) const;
+
+		protected:
+			/**
+			 * Returns the counter for the bytes transferred with a protocol
+			 * @param direction "in" or "out"
+			 */
+			static dtn::core::Metrics::Counter getTrafficCounter(const dtn::core::Node::Protocol proto, const std::string &direction);
+
+			/**
+			 * Returns the histogram for the time between sending a segment and
+			 * its acknowledgement
+			 */
+			static dtn::core::Metrics::Histogram getSegmentLatency(const dtn::core::Node::Protocol proto);
 		};
 	}
 }
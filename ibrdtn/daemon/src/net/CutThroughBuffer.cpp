@@ -0,0 +1,286 @@
+/*
+ * CutThroughBuffer.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "net/CutThroughBuffer.h"
+#include <ibrdtn/data/PayloadBlock.h>
+#include <ibrdtn/data/Serializer.h>
+#include <ibrdtn/data/Dictionary.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace dtn
+{
+	namespace net
+	{
+		/**
+		 * Placeholder for the payload block while the bundle header is encoded.
+		 * It writes the block header with the announced length, but no data.
+		 */
+		class CutThroughPayloadBlock : public dtn::data::Block
+		{
+		public:
+			CutThroughPayloadBlock(const dtn::data::Block &payload, const dtn::data::Length &length)
+			 : dtn::data::Block(dtn::data::PayloadBlock::BLOCK_TYPE), _length(length)
+			{
+				// copy the processing flags of the received payload block
+				dtn::data::Block::operator=(payload);
+				set(dtn::data::Block::LAST_BLOCK, payload.get(dtn::data::Block::LAST_BLOCK));
+			}
+
+			virtual ~CutThroughPayloadBlock() { }
+
+			virtual dtn::data::Length getLength() const
+			{
+				return _length;
+			}
+
+			virtual std::ostream &serialize(std::ostream &stream, dtn::data::Length&) const
+			{
+				return stream;
+			}
+
+			virtual std::istream &deserialize(std::istream &stream, const dtn::data::Length&)
+			{
+				return stream;
+			}
+
+		private:
+			const dtn::data::Length _length;
+		};
+
+		const size_t CutThroughBuffer::ATTACH_TIMEOUT = 2000;
+
+		CutThroughBuffer::CutThroughBuffer(const dtn::data::Bundle &bundle, const dtn::data::Block &payload, const dtn::data::Length &length, const dtn::data::Length capacity)
+		 : _length(length), _data(std::max<dtn::data::Length>(1, std::min(length, capacity))),
+		   _head(0), _fill(0), _written(0), _read(0), _state(STATE_RECEIVING), _attached(false), _detached(false)
+		{
+			// encode the bundle now, its blocks may be modified once the reception is complete
+			std::stringstream ss;
+			dtn::data::DefaultSerializer serializer(ss, dtn::data::Dictionary(bundle));
+
+			serializer << (const dtn::data::PrimaryBlock&)bundle;
+
+			for (dtn::data::Bundle::const_iterator iter = bundle.begin(); iter != bundle.end(); ++iter)
+			{
+				const dtn::data::Block &b = (**iter);
+
+				if (&b == &payload) {
+					serializer << CutThroughPayloadBlock(payload, length);
+				} else {
+					serializer << b;
+				}
+			}
+
+			_header = ss.str();
+		}
+
+		CutThroughBuffer::~CutThroughBuffer()
+		{
+		}
+
+		const std::string& CutThroughBuffer::getHeader() const throw ()
+		{
+			return _header;
+		}
+
+		const dtn::data::Length& CutThroughBuffer::getLength() const throw ()
+		{
+			return _length;
+		}
+
+		void CutThroughBuffer::write(const char *data, const dtn::data::Length &length) throw ()
+		{
+			ibrcommon::MutexLock l(_cond);
+
+			dtn::data::Length remain = length;
+
+			while (remain > 0)
+			{
+				// discard the data once the forwarding has been given up
+				if (_detached || (_state != STATE_RECEIVING)) break;
+
+				const dtn::data::Length capacity = _data.size();
+
+				if (_fill == capacity)
+				{
+					try {
+						if (_attached) {
+							_cond.wait();
+						} else {
+							// do not stall the reception if nobody picks up the bundle
+							_cond.wait(ATTACH_TIMEOUT);
+						}
+					} catch (const ibrcommon::Conditional::ConditionalAbortException &ex) {
+						if (!_attached) _detached = true;
+					}
+					continue;
+				}
+
+				// copy as much as possible into the free space behind the tail
+				const dtn::data::Length tail = (_head + _fill) % capacity;
+				const dtn::data::Length chunk = std::min(remain, std::min(capacity - _fill, capacity - tail));
+
+				::memcpy(&_data[tail], data, chunk);
+				data += chunk;
+				remain -= chunk;
+				_fill += chunk;
+
+				_cond.signal(true);
+			}
+
+			_written += length;
+		}
+
+		void CutThroughBuffer::commit() throw ()
+		{
+			ibrcommon::MutexLock l(_cond);
+			if (_state != STATE_RECEIVING) return;
+
+			// a partially received payload (fragment) must not be completed
+			_state = (_written == _length) ? STATE_COMMITTED : STATE_ABORTED;
+			_cond.signal(true);
+		}
+
+		void CutThroughBuffer::abort() throw ()
+		{
+			ibrcommon::MutexLock l(_cond);
+			_state = STATE_ABORTED;
+			_cond.signal(true);
+		}
+
+		bool CutThroughBuffer::attach() throw ()
+		{
+			ibrcommon::MutexLock l(_cond);
+			if (_detached || (_state == STATE_ABORTED)) return false;
+			_attached = true;
+			_cond.signal(true);
+			return true;
+		}
+
+		dtn::data::Length CutThroughBuffer::read(char *data, const dtn::data::Length &length) throw (AbortedException)
+		{
+			ibrcommon::MutexLock l(_cond);
+
+			while (true)
+			{
+				if (_detached || (_state == STATE_ABORTED)) throw AbortedException();
+
+				// all data has been read
+				if (_read == _length) return 0;
+
+				dtn::data::Length available = _fill;
+
+				// hold back the last byte until the bundle has been accepted
+				if ((_state != STATE_COMMITTED) && (_read + _fill == _length)) --available;
+
+				if (available > 0)
+				{
+					const dtn::data::Length capacity = _data.size();
+					const dtn::data::Length chunk = std::min(length, std::min(available, capacity - _head));
+
+					::memcpy(data, &_data[_head], chunk);
+					_head = (_head + chunk) % capacity;
+					_fill -= chunk;
+					_read += chunk;
+
+					_cond.signal(true);
+					return chunk;
+				}
+
+				_cond.wait();
+			}
+		}
+
+		void CutThroughBuffer::detach() throw ()
+		{
+			ibrcommon::MutexLock l(_cond);
+			_detached = true;
+			_cond.signal(true);
+		}
+
+		CutThroughStreamBuffer::CutThroughStreamBuffer(std::streambuf &source)
+		 : _source(source)
+		{
+		}
+
+		CutThroughStreamBuffer::~CutThroughStreamBuffer()
+		{
+			abort();
+		}
+
+		void CutThroughStreamBuffer::attach(const refcnt_ptr<CutThroughBuffer> &buffer)
+		{
+			abort();
+			_sink.push_back(buffer);
+		}
+
+		void CutThroughStreamBuffer::commit()
+		{
+			if (_sink.empty()) return;
+			_sink.front()->commit();
+			_sink.clear();
+		}
+
+		void CutThroughStreamBuffer::abort()
+		{
+			if (_sink.empty()) return;
+			_sink.front()->abort();
+			_sink.clear();
+		}
+
+		std::streamsize CutThroughStreamBuffer::showmanyc()
+		{
+			return _source.in_avail();
+		}
+
+		CutThroughStreamBuffer::int_type CutThroughStreamBuffer::underflow()
+		{
+			return _source.sgetc();
+		}
+
+		CutThroughStreamBuffer::int_type CutThroughStreamBuffer::uflow()
+		{
+			const int_type c = _source.sbumpc();
+
+			if (!_sink.empty() && !traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				const char data = traits_type::to_char_type(c);
+				_sink.front()->write(&data, 1);
+			}
+
+			return c;
+		}
+
+		std::streamsize CutThroughStreamBuffer::xsgetn(char *s, std::streamsize n)
+		{
+			const std::streamsize ret = _source.sgetn(s, n);
+
+			if (!_sink.empty() && (ret > 0))
+			{
+				_sink.front()->write(s, ret);
+			}
+
+			return ret;
+		}
+	} /* namespace net */
+} /* namespace dtn */
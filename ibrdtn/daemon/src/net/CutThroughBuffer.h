@@ -0,0 +1,184 @@
+/*
+ * CutThroughBuffer.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef CUTTHROUGHBUFFER_H_
+#define CUTTHROUGHBUFFER_H_
+
+#include <ibrdtn/data/Bundle.h>
+#include <ibrdtn/data/Number.h>
+#include <ibrcommon/thread/Conditional.h>
+#include <ibrcommon/refcnt_ptr.h>
+#include <ibrcommon/Exceptions.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <list>
+
+namespace dtn
+{
+	namespace net
+	{
+		/**
+		 * Passes the payload of a bundle from a receiving connection to a
+		 * forwarding connection while the bundle is still received (cut-through).
+		 * The receiver blocks if the buffer is full. The last byte of the payload
+		 * is held back until the receiver has accepted the whole bundle, thus the
+		 * forwarding connection never completes a bundle which has been rejected.
+		 */
+		class CutThroughBuffer
+		{
+		public:
+			class AbortedException : public ibrcommon::IOException
+			{
+			public:
+				AbortedException(std::string what = "Cut-through forwarding aborted.") throw() : ibrcommon::IOException(what)
+				{
+				};
+			};
+
+			/**
+			 * @param bundle The received bundle, its blocks are encoded immediately
+			 * @param payload The payload block of the bundle, has to be the last block
+			 * @param length The length of the payload
+			 * @param capacity The number of payload bytes buffered at most
+			 */
+			CutThroughBuffer(const dtn::data::Bundle &bundle, const dtn::data::Block &payload, const dtn::data::Length &length, const dtn::data::Length capacity = 1048576);
+			virtual ~CutThroughBuffer();
+
+			/**
+			 * @return The encoded bundle up to the data of the payload block
+			 */
+			const std::string& getHeader() const throw ();
+
+			/**
+			 * @return The length of the payload
+			 */
+			const dtn::data::Length& getLength() const throw ();
+
+			/**
+			 * Append received payload data. Blocks while the buffer is full. If the
+			 * forwarding connection does not pick up the bundle in time or has failed,
+			 * the data is discarded.
+			 */
+			void write(const char *data, const dtn::data::Length &length) throw ();
+
+			/**
+			 * Mark the bundle as completely received and accepted
+			 */
+			void commit() throw ();
+
+			/**
+			 * Mark the reception of the bundle as failed
+			 */
+			void abort() throw ();
+
+			/**
+			 * Start the forwarding of the bundle.
+			 * @return False, if the reception has been failed or the receiver has given up waiting.
+			 */
+			bool attach() throw ();
+
+			/**
+			 * Read payload data. Blocks until data is available.
+			 * @return The number of bytes read
+			 * @throw AbortedException if the reception of the bundle has failed
+			 */
+			dtn::data::Length read(char *data, const dtn::data::Length &length) throw (AbortedException);
+
+			/**
+			 * Stop the forwarding of the bundle, e.g. if the connection went down.
+			 */
+			void detach() throw ();
+
+		private:
+			enum State
+			{
+				STATE_RECEIVING = 0,
+				STATE_COMMITTED = 1,
+				STATE_ABORTED = 2
+			};
+
+			// time to wait for the forwarding connection if the buffer is full
+			static const size_t ATTACH_TIMEOUT;
+
+			// encoded blocks and payload block header
+			std::string _header;
+			const dtn::data::Length _length;
+
+			ibrcommon::Conditional _cond;
+			std::vector<char> _data;
+
+			// position of the first unread byte and the number of buffered bytes
+			dtn::data::Length _head;
+			dtn::data::Length _fill;
+
+			// number of bytes received
+			dtn::data::Length _written;
+
+			// number of bytes read by the forwarding connection
+			dtn::data::Length _read;
+
+			State _state;
+			bool _attached;
+			bool _detached;
+		};
+
+		/**
+		 * Stream buffer for the reception of bundles. All data is read from the
+		 * underlying stream buffer. While a CutThroughBuffer is attached, all consumed
+		 * data is copied into it.
+		 */
+		class CutThroughStreamBuffer : public std::streambuf
+		{
+		public:
+			CutThroughStreamBuffer(std::streambuf &source);
+			virtual ~CutThroughStreamBuffer();
+
+			/**
+			 * Copy all data consumed from now on into the given buffer
+			 */
+			void attach(const refcnt_ptr<CutThroughBuffer> &buffer);
+
+			/**
+			 * Commit the bundle to an attached buffer and release it
+			 */
+			void commit();
+
+			/**
+			 * Abort the bundle of an attached buffer and release it
+			 */
+			void abort();
+
+		protected:
+			virtual std::streamsize showmanyc();
+			virtual int_type underflow();
+			virtual int_type uflow();
+			virtual std::streamsize xsgetn(char *s, std::streamsize n);
+
+		private:
+			std::streambuf &_source;
+
+			// the buffer of the bundle forwarded in cut-through mode, if any
+			std::list<refcnt_ptr<CutThroughBuffer> > _sink;
+		};
+	} /* namespace net */
+} /* namespace dtn */
+#endif /* CUTTHROUGHBUFFER_H_ */
@@ -29,6 +29,7 @@
 #include <ibrcommon/Logger.h>
 #include <ibrcommon/thread/MutexLock.h>
 #include <ibrcommon/thread/RWLock.h>
+#include <ibrcommon/data/MemoryStream.h>
 
 #include <string.h>
 #include <vector>
@@ -41,7 +42,9 @@ namespace dtn
 
 		DatagramConvergenceLayer::DatagramConvergenceLayer(DatagramService *ds)
 		 : _service(ds), _receiver(*this), _running(false),
-		   _stats_in(0), _stats_out(0), _stats_rtt(0.0), _stats_retries(0), _stats_failure(0)
+		   _stats_in(0), _stats_out(0), _stats_rtt(0.0), _stats_retries(0), _stats_failure(0),
+		   _traffic_in(getTrafficCounter(ds->getProtocol(), "in")), _traffic_out(getTrafficCounter(ds->getProtocol(), "out")),
+		   _segment_latency(getSegmentLatency(ds->getProtocol()))
 		{
 		}
 
@@ -125,6 +128,7 @@ namespace dtn
 
 			// traffic monitoring
 			_stats_out += len;
+			_traffic_out.add(len);
 		}
 
 		void DatagramConvergenceLayer::callback_ack(DatagramConnection&, const unsigned int &seqno, const std::string &destination) throw (DatagramException)
@@ -202,6 +206,9 @@ namespace dtn
 		{
 			_stats_rtt = rtt;
 			_stats_retries += retries;
+
+			// the round-trip time is reported in milliseconds
+			_segment_latency.record(static_cast<dtn::core::Metrics::value_type>(rtt * 1000.0));
 		}
 
 		void DatagramConvergenceLayer::reportFailure()
@@ -256,18 +263,20 @@ namespace dtn
 			// only handler beacons for this interface
 			if (iface != _service->getInterface()) return;
 
-			// serialize announcement
-			std::stringstream ss;
-			ss << beacon;
+			// serialize announcement into a buffer of the max. message size
+			std::vector<char> data(_service->getParameter().max_msg_length);
+			ibrcommon::MemoryStream ms(&data[0], data.size());
+			ms << beacon;
 
-			std::streamsize len = ss.str().size();
+			// the beacon does not fit into a message
+			if (ms.bad()) return;
 
 			try {
 				// only on sender at once
 				ibrcommon::MutexLock l(_send_lock);
 
 				// forward the send request to DatagramService
-				_service->send(HEADER_BROADCAST, 0, 0, ss.str().c_str(), static_cast<dtn::data::Length>(len));
+				_service->send(HEADER_BROADCAST, 0, 0, &data[0], static_cast<dtn::data::Length>(ms.getWritten()));
 			} catch (const DatagramException&) {
 				// ignore any send failure
 			};
@@ -294,6 +303,7 @@ namespace dtn
 
 					// traffic monitoring
 					_stats_in += len;
+					_traffic_in.add(len);
 				} catch (const DatagramException &ex) {
 					if (_running) {
 						IBRCOMMON_LOGGER_TAG(DatagramConvergenceLayer::TAG, error) << "recvfrom() failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
@@ -312,9 +322,8 @@ namespace dtn
 
 						DiscoveryBeacon beacon = agent.obtainBeacon();
 
-						std::stringstream ss;
-						ss.write(&data[0], len);
-						ss >> beacon;
+						ibrcommon::MemoryStream ms(static_cast<const char*>(&data[0]), len);
+						ms >> beacon;
 
 						// ignore own beacons
 						if (beacon.getEID() == dtn::core::BundleCore::local) continue;
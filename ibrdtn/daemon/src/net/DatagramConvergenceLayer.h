@@ -253,6 +253,10 @@ namespace dtn
 			double _stats_rtt;
 			size_t _stats_retries;
 			size_t _stats_failure;
+
+			const dtn::core::Metrics::Counter _traffic_in;
+			const dtn::core::Metrics::Counter _traffic_out;
+			const dtn::core::Metrics::Histogram _segment_latency;
 		};
 	} /* namespace data */
 } /* namespace dtn */
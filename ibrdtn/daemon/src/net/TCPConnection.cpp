@@ -25,11 +25,15 @@
 #include "core/BundleEvent.h"
 #include "storage/BundleStorage.h"
 #include "core/FragmentManager.h"
+#include "routing/BaseRouter.h"
 
 #include "net/TCPConvergenceLayer.h"
 #include "net/ConnectionEvent.h"
 #include "net/TransferAbortedEvent.h"
 
+#include <ibrdtn/data/ScopeControlHopLimitBlock.h>
+#include <ibrdtn/data/TrackingBlock.h>
+
 #include <ibrcommon/net/socket.h>
 #include <ibrcommon/TimeMeasurement.h>
 #include <ibrcommon/net/vinterface.h>
@@ -59,16 +63,13 @@ namespace dtn
 		 */
 		TCPConnection::TCPConnection(TCPConvergenceLayer &tcpsrv, const dtn::core::Node &node, ibrcommon::clientsocket *sock, const size_t timeout)
 		 : _peer(), _node(node), _socket(sock), _socket_stream(NULL), _sec_stream(NULL), _protocol_stream(NULL), _sender(*this),
-		   _keepalive_sender(*this, _keepalive_timeout), _timeout(timeout), _lastack(0), _resume_offset(0), _keepalive_timeout(0),
+		   _timeout(timeout), _lastack(0), _resume_offset(0), _keepalive_timeout(0),
 		   _callback(tcpsrv), _flags(0), _aborted(false)
 		{
 		}
 
 		TCPConnection::~TCPConnection()
 		{
-			// join the keepalive sender thread
-			_keepalive_sender.join();
-
 			// wait until the sender thread is finished
 			_sender.join();
 
@@ -95,6 +96,16 @@ namespace dtn
 			_sender.push(job);
 		}
 
+		void TCPConnection::forward(const dtn::net::BundleTransfer &job, const refcnt_ptr<CutThroughBuffer> &buffer)
+		{
+			_sender.forward(job, buffer);
+		}
+
+		bool TCPConnection::isIdle() const
+		{
+			return (_sender.size() == 0) && (_sentqueue.size() == 0);
+		}
+
 		const dtn::streams::StreamContactHeader& TCPConnection::getHeader() const
 		{
 			return _peer;
@@ -252,9 +263,6 @@ namespace dtn
 			IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 40) << "eventConnectionDown()" << IBRCOMMON_LOGGER_ENDL;
 
 			try {
-				// shutdown the keepalive sender thread
-				_keepalive_sender.stop();
-
 				// stop the sender
 				_sender.stop();
 			} catch (const ibrcommon::ThreadException &ex) {
@@ -368,9 +376,6 @@ namespace dtn
 			IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 60) << "TCPConnection down" << IBRCOMMON_LOGGER_ENDL;
 
 			try {
-				// shutdown the keepalive sender thread
-				_keepalive_sender.stop();
-
 				// shutdown the sender thread
 				_sender.stop();
 			} catch (const std::exception&) { };
@@ -519,16 +524,23 @@ namespace dtn
 				// start the sender
 				_sender.start();
 
-				// start keepalive sender
-				_keepalive_sender.start();
-
 				// create a filter context
 				dtn::core::FilterContext context;
 				context.setPeer(_peer._localeid);
 				context.setProtocol(_callback.getDiscoveryProtocol());
 
+				// forward large bundles to other neighbors while they are received
+				const dtn::data::Length cut_through = dtn::daemon::Configuration::getInstance().getNetwork().getTCPCutThrough();
+
+				// read bundles through a stream which copies the payload into a cut-through buffer
+				CutThroughStreamBuffer cut_through_buf(*stream.rdbuf());
+				std::istream cut_through_stream(&cut_through_buf);
+				CutThroughValidator validator(*this, cut_through_buf, cut_through);
+
+				std::istream &input = (cut_through > 0) ? cut_through_stream : stream;
+
 				// create a deserializer for next bundle
-				dtn::data::DefaultDeserializer deserializer(stream, dtn::core::BundleCore::getInstance());
+				dtn::data::DefaultDeserializer deserializer(input, (cut_through > 0) ? (dtn::data::Validator&)validator : (dtn::data::Validator&)dtn::core::BundleCore::getInstance());
 
 				while (!(*sc).eof())
 				{
@@ -537,7 +549,7 @@ namespace dtn
 						dtn::data::Bundle bundle;
 
 						// check if the stream is still good
-						if (!stream.good()) throw ibrcommon::IOException("stream went bad");
+						if (!stream.good() || !input.good()) throw ibrcommon::IOException("stream went bad");
 
 						// enable/disable fragmentation support according to the contact header.
 						deserializer.setFragmentationSupport(_peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_FRAGMENTATION));
@@ -560,6 +572,9 @@ namespace dtn
 							case BundleFilter::ACCEPT:
 								// inject bundle into core
 								dtn::core::BundleCore::getInstance().inject(_peer._localeid, bundle, false);
+
+								// release the last byte of a bundle forwarded in cut-through mode
+								cut_through_buf.commit();
 								break;
 
 							case BundleFilter::REJECT:
@@ -567,11 +582,15 @@ namespace dtn
 								break;
 
 							case BundleFilter::DROP:
+								cut_through_buf.abort();
 								break;
 						}
 					}
 					catch (const dtn::data::Validator::RejectedException &ex)
 					{
+						// abort the forwarding of this bundle
+						cut_through_buf.abort();
+
 						// bundle rejected
 						rejectTransmission();
 
@@ -579,6 +598,9 @@ namespace dtn
 						IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 2) << "bundle has been rejected: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					}
 					catch (const dtn::InvalidDataException &ex) {
+						// abort the forwarding of this bundle
+						cut_through_buf.abort();
+
 						// bundle rejected
 						rejectTransmission();
 
@@ -606,45 +628,6 @@ namespace dtn
 			return safe_streamconnection(_protocol_stream, _protocol_stream_mutex);
 		}
 
-		TCPConnection::KeepaliveSender::KeepaliveSender(TCPConnection &connection, size_t &keepalive_timeout)
-		 : _connection(connection), _keepalive_timeout(keepalive_timeout)
-		{
-
-		}
-
-		TCPConnection::KeepaliveSender::~KeepaliveSender()
-		{
-		}
-
-		void TCPConnection::KeepaliveSender::run() throw ()
-		{
-			try {
-				ibrcommon::MutexLock l(_wait);
-				while (true)
-				{
-					try {
-						_wait.wait(_keepalive_timeout);
-					} catch (const ibrcommon::Conditional::ConditionalAbortException &ex) {
-						if (ex.reason == ibrcommon::Conditional::ConditionalAbortException::COND_TIMEOUT)
-						{
-							// send a keepalive
-							_connection.keepalive();
-						}
-						else
-						{
-							throw;
-						}
-					}
-				}
-			} catch (const std::exception&) { };
-		}
-
-		void TCPConnection::KeepaliveSender::__cancellation() throw ()
-		{
-			ibrcommon::MutexLock l(_wait);
-			_wait.abort();
-		}
-
 		TCPConnection::Sender::Sender(TCPConnection &connection)
 		 : _connection(connection)
 		{
@@ -676,13 +659,38 @@ namespace dtn
 				// create a serializer
 				dtn::data::DefaultSerializer serializer(stream);
 
+				// wake-up regularly to send keepalives and to check the idle timeout
+				size_t interval = _connection._keepalive_timeout;
+				if (interval == 0) interval = dtn::daemon::Configuration::getInstance().getNetwork().getTCPIdleTimeout() * 1000;
+
 				while (stream.good())
 				{
+					try {
+						ibrcommon::Queue<dtn::net::BundleTransfer>::wait(ibrcommon::Queue<dtn::net::BundleTransfer>::QUEUE_NOT_EMPTY, interval);
+					} catch (const ibrcommon::QueueUnblockedException &ex) {
+						if (ex.reason != ibrcommon::QueueUnblockedException::QUEUE_TIMEOUT) throw;
+
+						if ((*sc).isIdle())
+						{
+							// nothing has been sent or received for a while
+							(*sc).shutdown(dtn::streams::StreamConnection::CONNECTION_SHUTDOWN_IDLE);
+						}
+						else if (_connection._keepalive_timeout > 0)
+						{
+							// send a keepalive
+							(*sc).keepalive();
+						}
+						continue;
+					}
+
 					dtn::net::BundleTransfer transfer = ibrcommon::Queue<dtn::net::BundleTransfer>::poll();
 
 					// check if the transfer is directed to the connected neighbor
 					if (transfer.getNeighbor() != _connection.getNode().getEID()) continue;
 
+					// bundles forwarded in cut-through mode are not in the storage yet
+					if (transmit(transfer, stream)) continue;
+
 					try {
 						// read the bundle out of the storage
 						dtn::data::Bundle bundle = storage.get(transfer.getBundle());
@@ -803,6 +811,160 @@ namespace dtn
 
 		void TCPConnection::Sender::finally() throw ()
 		{
+			// release all receivers waiting for this sender
+			ibrcommon::MutexLock l(_cut_through_lock);
+			for (cut_through_map::iterator it = _cut_through.begin(); it != _cut_through.end(); ++it)
+			{
+				(*it).second->detach();
+			}
+			_cut_through.clear();
+		}
+
+		void TCPConnection::Sender::forward(const dtn::net::BundleTransfer &job, const refcnt_ptr<CutThroughBuffer> &buffer)
+		{
+			{
+				ibrcommon::MutexLock l(_cut_through_lock);
+				_cut_through.insert(std::make_pair(dtn::data::BundleID(job.getBundle()), buffer));
+			}
+
+			push(job);
+		}
+
+		bool TCPConnection::Sender::transmit(dtn::net::BundleTransfer &transfer, std::ostream &stream)
+		{
+			cut_through_map pending;
+
+			{
+				ibrcommon::MutexLock l(_cut_through_lock);
+				cut_through_map::iterator it = _cut_through.find(transfer.getBundle());
+				if (it == _cut_through.end()) return false;
+
+				pending.insert(*it);
+				_cut_through.erase(it);
+			}
+
+			CutThroughBuffer &buffer = *(*pending.begin()).second;
+
+			// the reception has been failed before the transmission started
+			if (!buffer.attach())
+			{
+				transfer.abort(dtn::net::TransferAbortedEvent::REASON_BUNDLE_DELETED);
+				return true;
+			}
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 4) << "Cut-through transfer of bundle " << transfer.getBundle().toString() << " to " << _connection.getNode().getEID().getString() << IBRCOMMON_LOGGER_ENDL;
+
+			// cut-through transfers always start at the beginning of the bundle
+			_connection._resume_offset = 0;
+
+			// put the bundle into the sentqueue
+			_connection._sentqueue.push(transfer);
+
+			try {
+				// activate exceptions for this method
+				if (!stream.good()) throw ibrcommon::IOException("stream went bad");
+
+				// transmit all blocks up to the payload data
+				const std::string &header = buffer.getHeader();
+				stream.write(header.c_str(), header.length());
+
+				// transmit the payload while it is received
+				char data[4096];
+				dtn::data::Length len = 0;
+
+				while ((len = buffer.read(data, sizeof(data))) > 0)
+				{
+					stream.write(data, len);
+					if (!stream.good()) throw ibrcommon::IOException("stream went bad");
+				}
+
+				// flush the stream
+				stream << std::flush;
+			} catch (const ibrcommon::Exception &ex) {
+				// release the receiver
+				buffer.detach();
+
+				// a partially transmitted bundle can only be aborted by closing the connection
+				IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 10) << "cut-through transfer failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+
+				// forward exception
+				throw;
+			}
+
+			return true;
+		}
+
+		TCPConnection::CutThroughValidator::CutThroughValidator(TCPConnection &connection, CutThroughStreamBuffer &buffer, const dtn::data::Length &threshold)
+		 : _connection(connection), _validator(dtn::core::BundleCore::getInstance()), _buffer(buffer), _threshold(threshold)
+		{
+		}
+
+		TCPConnection::CutThroughValidator::~CutThroughValidator()
+		{
+		}
+
+		void TCPConnection::CutThroughValidator::validate(const dtn::data::PrimaryBlock &p) const throw (RejectedException)
+		{
+			_validator.validate(p);
+		}
+
+		void TCPConnection::CutThroughValidator::validate(const dtn::data::Block &block, const dtn::data::Number &size) const throw (RejectedException)
+		{
+			_validator.validate(block, size);
+		}
+
+		void TCPConnection::CutThroughValidator::validate(const dtn::data::PrimaryBlock &p, const dtn::data::Block &block, const dtn::data::Number &size) const throw (RejectedException)
+		{
+			_validator.validate(p, block, size);
+
+			// only the payload of large bundles is forwarded while it is received
+			if (block.getType() != dtn::data::PayloadBlock::BLOCK_TYPE) return;
+			if (size.get<dtn::data::Length>() < _threshold) return;
+
+			// no data may follow the payload
+			if (!block.get(dtn::data::Block::LAST_BLOCK)) return;
+
+			const dtn::data::Bundle *bundle = dynamic_cast<const dtn::data::Bundle*>(&p);
+			if (bundle == NULL) return;
+
+			// only complete bundles for a single neighbor, other than the sender and this node
+			if (!bundle->get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)) return;
+			if (bundle->get(dtn::data::PrimaryBlock::FRAGMENT)) return;
+
+			const dtn::data::EID next = bundle->destination.getNode();
+			if (next.sameHost(dtn::core::BundleCore::local)) return;
+			if (next.sameHost(_connection._peer._localeid)) return;
+
+			// these blocks are modified on each hop
+			if (bundle->find(dtn::data::ScopeControlHopLimitBlock::BLOCK_TYPE) != bundle->end()) return;
+			if (bundle->find(dtn::data::TrackingBlock::BLOCK_TYPE) != bundle->end()) return;
+
+			// duplicates are dropped after the reception
+			if (dtn::core::BundleCore::getInstance().getRouter().isKnown(*bundle)) return;
+
+			// the output filter must accept the bundle without modifications
+			dtn::core::FilterContext context;
+			context.setPeer(next);
+			context.setProtocol(dtn::core::Node::CONN_TCPIP);
+			context.setPrimaryBlock(*bundle);
+			if (dtn::core::BundleCore::getInstance().evaluate(dtn::core::BundleFilter::OUTPUT, context) != BundleFilter::ACCEPT) return;
+
+			const dtn::data::MetaBundle meta = dtn::data::MetaBundle::create(*bundle);
+
+			const refcnt_ptr<CutThroughBuffer> buffer(new CutThroughBuffer(*bundle, block, size.get<dtn::data::Length>()));
+
+			if (_connection._callback.forward(next, meta, buffer))
+			{
+				// copy the payload into the buffer while it is received
+				_buffer.attach(buffer);
+
+				IBRCOMMON_LOGGER_DEBUG_TAG(TCPConnection::TAG, 15) << "forward bundle " << meta.toString() << " in cut-through mode to " << next.getString() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		void TCPConnection::CutThroughValidator::validate(const dtn::data::Bundle &b) const throw (RejectedException)
+		{
+			_validator.validate(b);
 		}
 
 		bool TCPConnection::match(const dtn::core::Node &n) const
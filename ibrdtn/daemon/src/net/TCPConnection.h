@@ -24,6 +24,7 @@
 
 #include "core/NodeEvent.h"
 #include "net/BundleTransfer.h"
+#include "net/CutThroughBuffer.h"
 
 #include <ibrdtn/data/Bundle.h>
 #include <ibrdtn/data/EID.h>
@@ -39,6 +40,7 @@
 #include <ibrcommon/thread/SharedReference.h>
 
 #include <memory>
+#include <map>
 
 namespace dtn
 {
@@ -112,6 +114,18 @@ namespace dtn
 			 */
 			void queue(const dtn::net::BundleTransfer &job);
 
+			/**
+			 * queue a bundle which is still received by another connection
+			 * @param job
+			 * @param buffer The buffer the payload is read from
+			 */
+			void forward(const dtn::net::BundleTransfer &job, const refcnt_ptr<CutThroughBuffer> &buffer);
+
+			/**
+			 * @return True, if no bundle is queued or in transit on this connection
+			 */
+			bool isIdle() const;
+
 			bool match(const dtn::core::Node &n) const;
 			bool match(const dtn::data::EID &destination) const;
 			bool match(const dtn::core::NodeEvent &evt) const;
@@ -140,41 +154,56 @@ namespace dtn
 			void initiateExtendedHandshake() throw (ibrcommon::Exception);
 
 		private:
-			class KeepaliveSender : public ibrcommon::JoinableThread
+			class Sender : public ibrcommon::JoinableThread, public ibrcommon::Queue<dtn::net::BundleTransfer>
 			{
 			public:
-				KeepaliveSender(TCPConnection &connection, size_t &keepalive_timeout);
-				~KeepaliveSender();
+				Sender(TCPConnection &connection);
+				virtual ~Sender();
 
 				/**
-				 * run method of the thread
+				 * queue a bundle and read its payload from the given buffer
 				 */
+				void forward(const dtn::net::BundleTransfer &job, const refcnt_ptr<CutThroughBuffer> &buffer);
+
+			protected:
 				void run() throw ();
+				void finally() throw ();
+				void __cancellation() throw ();
 
+			private:
 				/**
-				 * soft-cancellation function
+				 * Transmit a bundle forwarded in cut-through mode
+				 * @return False, if no cut-through buffer is registered for this transfer
 				 */
-				void __cancellation() throw ();
+				bool transmit(dtn::net::BundleTransfer &transfer, std::ostream &stream);
 
-			private:
-				ibrcommon::Conditional _wait;
 				TCPConnection &_connection;
-				size_t &_keepalive_timeout;
+
+				typedef std::map<dtn::data::BundleID, refcnt_ptr<CutThroughBuffer> > cut_through_map;
+				ibrcommon::Mutex _cut_through_lock;
+				cut_through_map _cut_through;
 			};
 
-			class Sender : public ibrcommon::JoinableThread, public ibrcommon::Queue<dtn::net::BundleTransfer>
+			/**
+			 * Validates received bundles and decides if the payload of
+			 * a bundle is forwarded while it is still received.
+			 */
+			class CutThroughValidator : public dtn::data::Validator
 			{
 			public:
-				Sender(TCPConnection &connection);
-				virtual ~Sender();
+				CutThroughValidator(TCPConnection &connection, CutThroughStreamBuffer &buffer, const dtn::data::Length &threshold);
+				virtual ~CutThroughValidator();
 
-			protected:
-				void run() throw ();
-				void finally() throw ();
-				void __cancellation() throw ();
+				virtual void validate(const dtn::data::PrimaryBlock&) const throw (RejectedException);
+				virtual void validate(const dtn::data::Block&, const dtn::data::Number&) const throw (RejectedException);
+				virtual void validate(const dtn::data::PrimaryBlock&, const dtn::data::Block&, const dtn::data::Number&) const throw (RejectedException);
+				virtual void validate(const dtn::data::Bundle&) const throw (RejectedException);
 
 			private:
 				TCPConnection &_connection;
+				dtn::data::Validator &_validator;
+				CutThroughStreamBuffer &_buffer;
+				const dtn::data::Length _threshold;
 			};
 
 			void __setup_socket(ibrcommon::clientsocket *sock, bool server);
@@ -208,9 +237,6 @@ namespace dtn
 			// and transmit them to the peer.
 			Sender _sender;
 
-			// Keepalive sender
-			KeepaliveSender _keepalive_sender;
-
 			// handshake variables
 			size_t _timeout;
 
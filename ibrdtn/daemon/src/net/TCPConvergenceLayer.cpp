@@ -26,9 +26,11 @@
 #include "net/DiscoveryAgent.h"
 #include "core/BundleCore.h"
 #include "core/EventDispatcher.h"
+#include "routing/BaseRouter.h"
 
 #include <ibrcommon/net/vinterface.h>
 #include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
 #include <ibrcommon/Logger.h>
 #include <ibrcommon/net/socket.h>
 #include <ibrcommon/Logger.h>
@@ -55,8 +57,26 @@ namespace dtn
 
 		TCPConvergenceLayer::TCPConvergenceLayer()
 		 : _vsocket_state(false), _any_port(0), _stats_in(0), _stats_out(0),
-		   _keepalive_timeout( dtn::daemon::Configuration::getInstance().getNetwork().getKeepaliveInterval() )
+		   _keepalive_timeout( dtn::daemon::Configuration::getInstance().getNetwork().getKeepaliveInterval() ),
+		   _eventloop(NULL)
 		{
+			const size_t io_threads = dtn::daemon::Configuration::getInstance().getNetwork().getTCPIOThreads();
+
+			if ((io_threads > 0) && TCPEventLoop::isSupported())
+			{
+				_eventloop = new TCPEventLoop(*this, io_threads, _keepalive_timeout);
+			}
+		}
+
+		TCPConvergenceLayer::TCPConvergenceLayer(const size_t io_threads)
+		 : _vsocket_state(false), _any_port(0), _stats_in(0), _stats_out(0),
+		   _keepalive_timeout( dtn::daemon::Configuration::getInstance().getNetwork().getKeepaliveInterval() ),
+		   _eventloop(NULL)
+		{
+			if ((io_threads > 0) && TCPEventLoop::isSupported())
+			{
+				_eventloop = new TCPEventLoop(*this, io_threads, _keepalive_timeout);
+			}
 		}
 
 		TCPConvergenceLayer::~TCPConvergenceLayer()
@@ -71,6 +91,8 @@ namespace dtn
 
 			// delete all sockets
 			_vsocket.destroy();
+
+			delete _eventloop;
 		}
 
 		void TCPConvergenceLayer::add(const ibrcommon::vinterface &net, int port) throw ()
@@ -384,6 +406,12 @@ namespace dtn
 
 		void TCPConvergenceLayer::open(const dtn::core::Node &n)
 		{
+			if (_eventloop != NULL)
+			{
+				_eventloop->open(n);
+				return;
+			}
+
 			// search for an existing connection
 			ibrcommon::MutexLock l(_connections_cond);
 
@@ -427,6 +455,12 @@ namespace dtn
 
 		void TCPConvergenceLayer::queue(const dtn::core::Node &n, const dtn::net::BundleTransfer &job)
 		{
+			if (_eventloop != NULL)
+			{
+				_eventloop->queue(n, job);
+				return;
+			}
+
 			// search for an existing connection
 			ibrcommon::MutexLock l(_connections_cond);
 
@@ -476,6 +510,47 @@ namespace dtn
 			}
 		}
 
+		bool TCPConvergenceLayer::forward(const dtn::data::EID &neighbor, const dtn::data::MetaBundle &meta, const refcnt_ptr<CutThroughBuffer> &buffer)
+		{
+			// cut-through forwarding is not supported by event-driven connections
+			if (_eventloop != NULL) return false;
+
+			dtn::routing::NeighborDatabase &db = dtn::core::BundleCore::getInstance().getRouter().getNeighborDB();
+
+			// acquire a transfer slot first, the neighbor database must not be locked
+			// while the list of connections is locked
+			{
+				ibrcommon::MutexLock l(db);
+				dtn::routing::NeighborDatabase::NeighborEntry *entry = db.find(neighbor, true);
+				if (entry == NULL) return false;
+				if (entry->tryAcquireTransfer(meta) != dtn::routing::NeighborDatabase::TRANSFER_ACQUIRED) return false;
+			}
+
+			{
+				ibrcommon::MutexLock l(_connections_cond);
+
+				for (std::list<TCPConnection*>::iterator iter = _connections.begin(); iter != _connections.end(); ++iter)
+				{
+					TCPConnection &conn = *(*iter);
+
+					// only idle connections, otherwise the bundle would wait behind others
+					if ((conn.getNode().getEID() != neighbor) || !conn.isIdle()) continue;
+
+					conn.forward(dtn::net::BundleTransfer(neighbor, meta, dtn::core::Node::CONN_TCPIP), buffer);
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPConvergenceLayer::TAG, 15) << "forward bundle in cut-through mode to an existing tcp connection (" << conn.getNode().toString() << ")" << IBRCOMMON_LOGGER_ENDL;
+
+					return true;
+				}
+			}
+
+			// no connection available, release the transfer slot silently
+			ibrcommon::MutexLock l(db);
+			dtn::routing::NeighborDatabase::NeighborEntry *entry = db.find(neighbor, false);
+			if (entry != NULL) entry->releaseTransfer(meta);
+
+			return false;
+		}
+
 		void TCPConvergenceLayer::connectionUp(TCPConnection *conn)
 		{
 			ibrcommon::MutexLock l(_connections_cond);
@@ -515,14 +590,18 @@ namespace dtn
 
 		void TCPConvergenceLayer::addTrafficIn(size_t amount) throw ()
 		{
-			ibrcommon::MutexLock l(_stats_lock);
-			_stats_in += amount;
+			static const dtn::core::Metrics::Counter traffic = getTrafficCounter(dtn::core::Node::CONN_TCPIP, "in");
+			traffic.add(amount);
+
+			ibrcommon::atomic::add(_stats_in, amount);
 		}
 
 		void TCPConvergenceLayer::addTrafficOut(size_t amount) throw ()
 		{
-			ibrcommon::MutexLock l(_stats_lock);
-			_stats_out += amount;
+			static const dtn::core::Metrics::Counter traffic = getTrafficCounter(dtn::core::Node::CONN_TCPIP, "out");
+			traffic.add(amount);
+
+			ibrcommon::atomic::add(_stats_out, amount);
 		}
 
 		void TCPConvergenceLayer::componentRun() throw ()
@@ -554,6 +633,13 @@ namespace dtn
 							const std::string uri = "ip=" + peeraddr.address() + ";port=" + peeraddr.service() + ";";
 							node.add( dtn::core::Node::URI(Node::NODE_CONNECTED, Node::CONN_TCPIP, uri, 0, 10) );
 
+							// hand the connection over to the event loop
+							if (_eventloop != NULL)
+							{
+								_eventloop->accept(client, node);
+								continue;
+							}
+
 							// create a new TCPConnection and return the pointer
 							TCPConnection *obj = new TCPConnection(*this, node, client, _keepalive_timeout);
 
@@ -591,6 +677,8 @@ namespace dtn
 
 		void TCPConvergenceLayer::closeAll()
 		{
+			if (_eventloop != NULL) _eventloop->closeAll();
+
 			// search for an existing connection
 			ibrcommon::MutexLock l(_connections_cond);
 			for (std::list<TCPConnection*>::iterator iter = _connections.begin(); iter != _connections.end(); ++iter)
@@ -607,6 +695,24 @@ namespace dtn
 			// listen on P2P dial-up events
 			dtn::core::EventDispatcher<dtn::net::P2PDialupEvent>::add(this);
 
+			if (_eventloop != NULL)
+			{
+#ifdef WITH_TLS
+				// the event-driven connections do not support TLS
+				if ( ibrcommon::TLSStream::isInitialized() )
+				{
+					IBRCOMMON_LOGGER_TAG(TCPConvergenceLayer::TAG, warning) << "TLS is enabled, falling back to one thread per connection" << IBRCOMMON_LOGGER_ENDL;
+					delete _eventloop;
+					_eventloop = NULL;
+				}
+				else
+#endif
+				{
+					IBRCOMMON_LOGGER_TAG(TCPConvergenceLayer::TAG, info) << "event-driven mode enabled" << IBRCOMMON_LOGGER_ENDL;
+					_eventloop->start();
+				}
+			}
+
 			// routine checked for throw() on 15.02.2013
 			try {
 				// listen on the socket
@@ -639,6 +745,9 @@ namespace dtn
 				ibrcommon::MutexLock l(_connections_cond);
 				while (_connections.size() > 0) _connections_cond.wait();
 			}
+
+			// wait until all sessions are down and stop the I/O threads
+			if (_eventloop != NULL) _eventloop->stop();
 		}
 	}
 
@@ -649,17 +758,17 @@ namespace dtn
 		static const std::string IN_TAG = dtn::core::Node::toString(getDiscoveryProtocol()) + "|in";
 		static const std::string OUT_TAG = dtn::core::Node::toString(getDiscoveryProtocol()) + "|out";
 
-		ss_format << _stats_in;
+		ss_format << ibrcommon::atomic::load(_stats_in);
 		data[IN_TAG] = ss_format.str();
 		ss_format.str("");
 
-		ss_format << _stats_out;
+		ss_format << ibrcommon::atomic::load(_stats_out);
 		data[OUT_TAG] = ss_format.str();
 	}
 
 	void TCPConvergenceLayer::resetStats()
 	{
-		_stats_in = 0;
-		_stats_out = 0;
+		ibrcommon::atomic::exchange(_stats_in, 0);
+		ibrcommon::atomic::exchange(_stats_out, 0);
 	}
 }
@@ -29,6 +29,7 @@
 #include "core/EventReceiver.h"
 #include "net/ConvergenceLayer.h"
 #include "net/TCPConnection.h"
+#include "net/TCPEventLoop.h"
 #include "net/DiscoveryBeaconHandler.h"
 #include "net/P2PDialupEvent.h"
 
@@ -52,6 +53,8 @@ namespace dtn
 		class TCPConvergenceLayer : public dtn::daemon::IndependentComponent, public dtn::core::EventReceiver<dtn::net::P2PDialupEvent>, public ConvergenceLayer, public DiscoveryBeaconHandler, public ibrcommon::LinkManager::EventCallback
 		{
 			friend class TCPConnection;
+			friend class TCPSession;
+			friend class TCPEventLoop;
 
 			const static std::string TAG;
 		public:
@@ -62,6 +65,13 @@ namespace dtn
 			 */
 			TCPConvergenceLayer();
 
+			/**
+			 * Constructor
+			 * @param[in] io_threads Number of I/O threads serving all connections.
+			 * If zero, each connection uses its own threads.
+			 */
+			TCPConvergenceLayer(const size_t io_threads);
+
 			/**
 			 * Destructor
 			 */
@@ -80,6 +90,16 @@ namespace dtn
 			 */
 			void queue(const dtn::core::Node &n, const dtn::net::BundleTransfer &job);
 
+			/**
+			 * Forward a bundle, which is still received, to an idle connection
+			 * of the given neighbor.
+			 * @param neighbor The EID of the neighbor
+			 * @param meta The bundle to forward
+			 * @param buffer The buffer containing the received payload
+			 * @return False, if no idle connection or no transfer slot is available
+			 */
+			bool forward(const dtn::data::EID &neighbor, const dtn::data::MetaBundle &meta, const refcnt_ptr<CutThroughBuffer> &buffer);
+
 			/**
 			 * Open a connection to the given node.
 			 * @param n
@@ -175,12 +195,14 @@ namespace dtn
 			std::map<ibrcommon::vinterface, unsigned int> _portmap;
 			unsigned int _any_port;
 
-			// stats variables
-			ibrcommon::Mutex _stats_lock;
-			size_t _stats_in;
-			size_t _stats_out;
+			// stats variables, updated by atomic operations
+			volatile size_t _stats_in;
+			volatile size_t _stats_out;
 
 			const size_t _keepalive_timeout;
+
+			// event loop for all connections, if the event-driven mode is enabled
+			TCPEventLoop *_eventloop;
 		};
 	}
 }
@@ -0,0 +1,599 @@
+/*
+ * TCPEventLoop.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "config.h"
+#include "net/TCPEventLoop.h"
+#include "net/TCPConvergenceLayer.h"
+#include "net/ConnectionEvent.h"
+
+#include <ibrdtn/utils/Clock.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/Logger.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+namespace dtn
+{
+	namespace net
+	{
+		const std::string TCPEventLoop::TAG = "TCPEventLoop";
+
+		bool TCPEventLoop::isSupported()
+		{
+#ifdef HAVE_SYS_EPOLL_H
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		TCPEventLoop::TCPEventLoop(TCPConvergenceLayer &cl, const size_t threads, const dtn::data::Timeout timeout)
+		 : _callback(cl), _timeout(timeout), _next_thread(0), _tasks_shutdown(false)
+		{
+			for (size_t i = 0; i < threads; ++i)
+			{
+				_threads.push_back(new IOThread(*this));
+				_workers.push_back(new Worker(*this));
+			}
+		}
+
+		TCPEventLoop::~TCPEventLoop()
+		{
+			stop();
+
+			for (std::vector<IOThread*>::iterator it = _threads.begin(); it != _threads.end(); ++it)
+			{
+				delete (*it);
+			}
+
+			for (std::vector<Worker*>::iterator it = _workers.begin(); it != _workers.end(); ++it)
+			{
+				delete (*it);
+			}
+		}
+
+		void TCPEventLoop::start()
+		{
+			{
+				ibrcommon::MutexLock l(_tasks_cond);
+				_tasks_shutdown = false;
+			}
+
+			for (std::vector<Worker*>::iterator it = _workers.begin(); it != _workers.end(); ++it)
+			{
+				try {
+					(*it)->start();
+				} catch (const ibrcommon::ThreadException &ex) {
+					IBRCOMMON_LOGGER_TAG(TCPEventLoop::TAG, error) << "failed to start worker thread: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+				}
+			}
+
+			for (std::vector<IOThread*>::iterator it = _threads.begin(); it != _threads.end(); ++it)
+			{
+				try {
+					(*it)->start();
+				} catch (const ibrcommon::ThreadException &ex) {
+					IBRCOMMON_LOGGER_TAG(TCPEventLoop::TAG, error) << "failed to start I/O thread: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+				}
+			}
+		}
+
+		void TCPEventLoop::stop()
+		{
+			// close all sessions and wait until they are gone
+			closeAll();
+			wait();
+
+			for (std::vector<IOThread*>::iterator it = _threads.begin(); it != _threads.end(); ++it)
+			{
+				(*it)->stop();
+				(*it)->join();
+			}
+
+			// the workers process all remaining tasks before they stop
+			for (std::vector<Worker*>::iterator it = _workers.begin(); it != _workers.end(); ++it)
+			{
+				(*it)->stop();
+				(*it)->join();
+			}
+		}
+
+		size_t TCPEventLoop::accept(ibrcommon::clientsocket *sock, const dtn::core::Node &node)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			TCPSession *session = new TCPSession(_callback, *this, node, sock, _timeout);
+			__assign(session);
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(TCPEventLoop::TAG, 15) << "tcp session added (" << node.toString() << ")" << IBRCOMMON_LOGGER_ENDL;
+
+			return session->getId();
+		}
+
+		void TCPEventLoop::open(const dtn::core::Node &n)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			for (session_map::iterator iter = _sessions.begin(); iter != _sessions.end(); ++iter)
+			{
+				if ((*iter).second.session->match(n)) return;
+			}
+
+			__create(n);
+		}
+
+		void TCPEventLoop::queue(const dtn::core::Node &n, const dtn::net::BundleTransfer &job)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			for (session_map::iterator iter = _sessions.begin(); iter != _sessions.end(); ++iter)
+			{
+				TCPSession &session = *(*iter).second.session;
+
+				if (session.match(n))
+				{
+					session.queue(job);
+					(*iter).second.thread->notify(&session);
+
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPEventLoop::TAG, 15) << "queued bundle to an existing tcp session (" << session.getNode().toString() << ")" << IBRCOMMON_LOGGER_ENDL;
+					return;
+				}
+			}
+
+			TCPSession *session = __create(n);
+			session->queue(job);
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(TCPEventLoop::TAG, 15) << "queued bundle to an new tcp session (" << n.toString() << ")" << IBRCOMMON_LOGGER_ENDL;
+		}
+
+		TCPSession* TCPEventLoop::__create(const dtn::core::Node &n)
+		{
+			TCPSession *session = new TCPSession(_callback, *this, n, NULL, _timeout);
+
+			// raise setup event
+			ConnectionEvent::raise(ConnectionEvent::CONNECTION_SETUP, n);
+
+			__assign(session);
+			return session;
+		}
+
+		void TCPEventLoop::__assign(TCPSession *session)
+		{
+			IOThread *t = _threads[_next_thread];
+			_next_thread = (_next_thread + 1) % _threads.size();
+
+			SessionEntry &e = _sessions[session->getId()];
+			e.session = session;
+			e.thread = t;
+			t->add(session);
+
+			// signal that there is a new session
+			_sessions_cond.signal(true);
+		}
+
+		void TCPEventLoop::__remove(TCPSession *session)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+			_sessions.erase(session->getId());
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(TCPEventLoop::TAG, 15) << "tcp session removed (" << session->getNode().toString() << ")" << IBRCOMMON_LOGGER_ENDL;
+
+			// signal that there is a session less
+			_sessions_cond.signal(true);
+		}
+
+		void TCPEventLoop::closeAll()
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			for (session_map::iterator iter = _sessions.begin(); iter != _sessions.end(); ++iter)
+			{
+				TCPSession &session = *(*iter).second.session;
+				session.shutdown();
+				(*iter).second.thread->notify(&session);
+			}
+		}
+
+		void TCPEventLoop::wait()
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+			while (!_sessions.empty()) _sessions_cond.wait();
+		}
+
+		size_t TCPEventLoop::size() const
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+			return _sessions.size();
+		}
+
+		void TCPEventLoop::submit(const TCPSession::task_ref &task)
+		{
+			ibrcommon::MutexLock l(_tasks_cond);
+			_tasks.push_back(task);
+			_tasks_cond.signal(false);
+		}
+
+		void TCPEventLoop::__complete(const TCPSession::task_ref &task)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			// drop the result if the session is gone
+			session_map::iterator iter = _sessions.find(task->session);
+			if (iter == _sessions.end()) return;
+
+			(*iter).second.thread->complete(task);
+		}
+
+		void TCPEventLoop::expire(const size_t session)
+		{
+			ibrcommon::MutexLock l(_sessions_cond);
+
+			session_map::iterator iter = _sessions.find(session);
+			if (iter == _sessions.end()) return;
+
+			(*iter).second.thread->expire(session);
+		}
+
+		TCPEventLoop::Worker::Worker(TCPEventLoop &loop)
+		 : _loop(loop)
+		{
+		}
+
+		TCPEventLoop::Worker::~Worker()
+		{
+			join();
+		}
+
+		void TCPEventLoop::Worker::__cancellation() throw ()
+		{
+			ibrcommon::MutexLock l(_loop._tasks_cond);
+			_loop._tasks_shutdown = true;
+			_loop._tasks_cond.signal(true);
+		}
+
+		void TCPEventLoop::Worker::run() throw ()
+		{
+			while (true)
+			{
+				std::list<TCPSession::task_ref> next;
+
+				{
+					ibrcommon::MutexLock l(_loop._tasks_cond);
+
+					while (_loop._tasks.empty())
+					{
+						if (_loop._tasks_shutdown) return;
+						_loop._tasks_cond.wait();
+					}
+
+					next.splice(next.end(), _loop._tasks, _loop._tasks.begin());
+				}
+
+				TCPSession::task_ref &task = next.front();
+				task->run();
+
+				_loop.__complete(task);
+			}
+		}
+
+		TCPEventLoop::IOThread::IOThread(TCPEventLoop &loop)
+		 : _loop(loop), _epoll_fd(-1), _running(true)
+		{
+			_wakeup[0] = -1;
+			_wakeup[1] = -1;
+
+#ifdef HAVE_SYS_EPOLL_H
+			_epoll_fd = ::epoll_create(64);
+
+			if (::pipe(_wakeup) == 0)
+			{
+				::fcntl(_wakeup[0], F_SETFL, O_NONBLOCK);
+				::fcntl(_wakeup[1], F_SETFL, O_NONBLOCK);
+
+				struct epoll_event ev;
+				ev.events = EPOLLIN;
+				// session ids start at one, zero denotes the wakeup pipe
+				ev.data.u64 = 0;
+				::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup[0], &ev);
+			}
+#endif
+		}
+
+		TCPEventLoop::IOThread::~IOThread()
+		{
+			join();
+
+			if (_wakeup[0] != -1) ::close(_wakeup[0]);
+			if (_wakeup[1] != -1) ::close(_wakeup[1]);
+			if (_epoll_fd != -1) ::close(_epoll_fd);
+		}
+
+		void TCPEventLoop::IOThread::add(TCPSession *session)
+		{
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+				_added.push_back(session);
+			}
+			__wakeup();
+		}
+
+		void TCPEventLoop::IOThread::notify(TCPSession *session)
+		{
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+				_notified.insert(session->getId());
+			}
+			__wakeup();
+		}
+
+		void TCPEventLoop::IOThread::complete(const TCPSession::task_ref &task)
+		{
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+				_completed.push_back(task);
+			}
+			__wakeup();
+		}
+
+		void TCPEventLoop::IOThread::expire(const size_t session)
+		{
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+				_expired.insert(session);
+			}
+			__wakeup();
+		}
+
+		void TCPEventLoop::IOThread::__wakeup()
+		{
+			char c = 0;
+			if (::write(_wakeup[1], &c, 1) < 0) {
+				// the pipe is full, the thread is going to wake up anyway
+			}
+		}
+
+		void TCPEventLoop::IOThread::__cancellation() throw ()
+		{
+			_running = false;
+			__wakeup();
+		}
+
+		void TCPEventLoop::IOThread::__register(TCPSession *session, const dtn::data::Timestamp &now)
+		{
+			_sessions[session->getId()] = session;
+
+			// start the session (connect or send the contact header)
+			session->setup(now);
+
+			__update(session);
+		}
+
+		void TCPEventLoop::IOThread::__update(TCPSession *session)
+		{
+			if (session->closed())
+			{
+				__remove(session);
+				return;
+			}
+
+#ifdef HAVE_SYS_EPOLL_H
+			const int fd = session->fd();
+			const bool want_write = session->wantWrite();
+
+			struct epoll_event ev;
+			ev.events = EPOLLIN;
+			if (want_write) ev.events |= EPOLLOUT;
+			ev.data.u64 = session->getId();
+
+			if (fd == -1)
+			{
+				// there is no descriptor while the addresses are resolved
+			}
+			else if (session->_registered_fd != fd)
+			{
+				// the descriptor is new or has been replaced by a new connection attempt
+				if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+				{
+					IBRCOMMON_LOGGER_TAG(TCPEventLoop::TAG, error) << "epoll_ctl() failed: " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					session->__close();
+					__remove(session);
+					return;
+				}
+
+				session->_registered_fd = fd;
+				session->_epoll_out = want_write;
+			}
+			else if (session->_epoll_out != want_write)
+			{
+				::epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+				session->_epoll_out = want_write;
+			}
+#endif
+
+			// re-arm the timer of the session
+			__schedule(session);
+		}
+
+		void TCPEventLoop::IOThread::__remove(TCPSession *session)
+		{
+			// the descriptor is removed from the epoll set by closing it,
+			// the timer is cancelled by the destructor of the session
+			_sessions.erase(session->getId());
+
+			// clean-up queues and raise events
+			session->finalize();
+
+			// remove the session from the global list, after that no other
+			// thread is able to reach this session
+			_loop.__remove(session);
+
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+				_notified.erase(session->getId());
+				_expired.erase(session->getId());
+
+				// drop the results of tasks of this session
+				for (std::list<TCPSession::task_ref>::iterator it = _completed.begin(); it != _completed.end();)
+				{
+					if ((*it)->session == session->getId()) _completed.erase(it++);
+					else ++it;
+				}
+			}
+
+			delete session;
+		}
+
+		void TCPEventLoop::IOThread::__schedule(TCPSession *session)
+		{
+			const dtn::data::Timestamp deadline = session->getDeadline();
+
+			// do not touch the timer wheel if the deadline is unchanged
+			if (deadline == session->_timer_deadline) return;
+			session->_timer_deadline = deadline;
+
+			if (deadline == 0)
+			{
+				ibrcommon::TimerWheel::getInstance().disarm(session->_timer);
+				return;
+			}
+
+			const dtn::data::Timestamp now = dtn::utils::Clock::getMonotonicTimestamp();
+			const size_t timeout = (deadline > now) ? (deadline - now).get<size_t>() * 1000 : 0;
+			ibrcommon::TimerWheel::getInstance().arm(session->_timer, timeout);
+		}
+
+		void TCPEventLoop::IOThread::run() throw ()
+		{
+#ifdef HAVE_SYS_EPOLL_H
+			const int max_events = 64;
+			struct epoll_event events[max_events];
+
+			while (_running || !_sessions.empty())
+			{
+				const int ret = ::epoll_wait(_epoll_fd, events, max_events, -1);
+
+				if ((ret < 0) && (errno != EINTR))
+				{
+					IBRCOMMON_LOGGER_TAG(TCPEventLoop::TAG, error) << "epoll_wait() failed: " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					break;
+				}
+
+				const dtn::data::Timestamp now = dtn::utils::Clock::getMonotonicTimestamp();
+
+				for (int i = 0; i < ret; ++i)
+				{
+					if (events[i].data.u64 == 0)
+					{
+						// drain the wakeup pipe
+						char buf[64];
+						while (::read(_wakeup[0], buf, sizeof(buf)) > 0) { };
+						continue;
+					}
+
+					// skip sessions removed while processing this batch
+					std::map<size_t, TCPSession*>::const_iterator si = _sessions.find(static_cast<size_t>(events[i].data.u64));
+					if (si == _sessions.end()) continue;
+
+					TCPSession *session = (*si).second;
+
+					if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+					{
+						session->onReadable(now);
+					}
+
+					if (!session->closed() && (events[i].events & EPOLLOUT))
+					{
+						session->onWritable(now);
+					}
+
+					__update(session);
+				}
+
+				// take over new sessions, pending notifications and results of tasks
+				std::list<TCPSession*> added;
+				std::set<size_t> notified;
+				std::list<TCPSession::task_ref> completed;
+				std::set<size_t> expired;
+
+				{
+					ibrcommon::MutexLock l(_pending_lock);
+					added.swap(_added);
+					notified.swap(_notified);
+					completed.swap(_completed);
+					expired.swap(_expired);
+				}
+
+				for (std::list<TCPSession*>::iterator it = added.begin(); it != added.end(); ++it)
+				{
+					__register(*it, now);
+				}
+
+				for (std::list<TCPSession::task_ref>::iterator it = completed.begin(); it != completed.end(); ++it)
+				{
+					std::map<size_t, TCPSession*>::const_iterator si = _sessions.find((*it)->session);
+					if (si == _sessions.end()) continue;
+
+					(*it)->complete(*(*si).second);
+
+					// send the responses and the prepared data
+					notified.insert((*it)->session);
+				}
+
+				for (std::set<size_t>::iterator it = notified.begin(); it != notified.end(); ++it)
+				{
+					std::map<size_t, TCPSession*>::const_iterator si = _sessions.find(*it);
+					if (si == _sessions.end()) continue;
+
+					TCPSession *session = (*si).second;
+
+					session->onNotify(now);
+					__update(session);
+				}
+
+				// process timeouts
+				for (std::set<size_t>::iterator it = expired.begin(); it != expired.end(); ++it)
+				{
+					std::map<size_t, TCPSession*>::const_iterator si = _sessions.find(*it);
+					if (si == _sessions.end()) continue;
+
+					TCPSession *session = (*si).second;
+					session->_timer_deadline = 0;
+
+					// the deadline may have been moved since the timer was armed
+					if (session->getDeadline() <= now)
+					{
+						session->onTimeout(now);
+					}
+
+					__update(session);
+				}
+			}
+#endif
+		}
+	}
+}
@@ -0,0 +1,235 @@
+/*
+ * TCPEventLoop.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef TCPEVENTLOOP_H_
+#define TCPEVENTLOOP_H_
+
+#include "config.h"
+#include "core/Node.h"
+#include "net/BundleTransfer.h"
+#include "net/TCPSession.h"
+
+#include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <ibrcommon/thread/Conditional.h>
+#include <ibrcommon/net/socket.h>
+
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+
+namespace dtn
+{
+	namespace net
+	{
+		class TCPConvergenceLayer;
+
+		/**
+		 * The TCPEventLoop drives all TCPSession objects of a TCPConvergenceLayer
+		 * with a small fixed number of I/O threads. Each I/O thread waits on its
+		 * own epoll descriptor. Keepalives and timeouts of the sessions are armed
+		 * on the shared ibrcommon::TimerWheel, which hands expired sessions back
+		 * to their I/O thread. The I/O threads only
+		 * move data, everything which may block is done by the same number of
+		 * worker threads.
+		 */
+		class TCPEventLoop
+		{
+			static const std::string TAG;
+		public:
+			/**
+			 * @return True, if the event-driven mode is supported on this system.
+			 */
+			static bool isSupported();
+
+			TCPEventLoop(TCPConvergenceLayer &cl, const size_t threads, const dtn::data::Timeout timeout);
+			virtual ~TCPEventLoop();
+
+			/**
+			 * Start / stop the I/O threads. stop() closes all sessions
+			 * and returns once all of them are gone.
+			 */
+			void start();
+			void stop();
+
+			/**
+			 * Add an accepted connection to the event loop
+			 * @return The id of the new session
+			 */
+			size_t accept(ibrcommon::clientsocket *sock, const dtn::core::Node &node);
+
+			/**
+			 * Open a connection to the given node, if there is none yet.
+			 */
+			void open(const dtn::core::Node &n);
+
+			/**
+			 * Queue a transfer for the given node. A new session is created
+			 * if there is no session to the node yet.
+			 */
+			void queue(const dtn::core::Node &n, const dtn::net::BundleTransfer &job);
+
+			/**
+			 * Request a shutdown of all sessions
+			 */
+			void closeAll();
+
+			/**
+			 * Wait until all sessions are gone
+			 */
+			void wait();
+
+			/**
+			 * @return The number of sessions
+			 */
+			size_t size() const;
+
+			/**
+			 * Hand a task of a session to the workers. The result is passed
+			 * to the session by its I/O thread.
+			 */
+			void submit(const TCPSession::task_ref &task);
+
+			/**
+			 * Called by the timer of a session once its deadline is reached.
+			 * The session is checked by its I/O thread.
+			 */
+			void expire(const size_t session);
+
+		private:
+			class IOThread : public ibrcommon::JoinableThread
+			{
+			public:
+				IOThread(TCPEventLoop &loop);
+				virtual ~IOThread();
+
+				/**
+				 * Hand a new session to this thread
+				 */
+				void add(TCPSession *session);
+
+				/**
+				 * Signal pending work (queued bundles, shutdown requests) of a session
+				 */
+				void notify(TCPSession *session);
+
+				/**
+				 * Hand the result of a task to a session of this thread
+				 */
+				void complete(const TCPSession::task_ref &task);
+
+				/**
+				 * Signal an expired timer of a session of this thread
+				 */
+				void expire(const size_t session);
+
+			protected:
+				void run() throw ();
+				void __cancellation() throw ();
+
+			private:
+				void __wakeup();
+				void __register(TCPSession *session, const dtn::data::Timestamp &now);
+				void __update(TCPSession *session);
+				void __remove(TCPSession *session);
+
+				void __schedule(TCPSession *session);
+
+				TCPEventLoop &_loop;
+				int _epoll_fd;
+				int _wakeup[2];
+				bool _running;
+
+				ibrcommon::Mutex _pending_lock;
+				std::list<TCPSession*> _added;
+				std::set<size_t> _notified;
+				std::list<TCPSession::task_ref> _completed;
+				std::set<size_t> _expired;
+
+				// sessions of this thread by their id
+				std::map<size_t, TCPSession*> _sessions;
+			};
+
+			class Worker : public ibrcommon::JoinableThread
+			{
+			public:
+				Worker(TCPEventLoop &loop);
+				virtual ~Worker();
+
+			protected:
+				void run() throw ();
+				void __cancellation() throw ();
+
+			private:
+				TCPEventLoop &_loop;
+			};
+
+			/**
+			 * Pass the result of a task to the I/O thread of its session,
+			 * if the session still exists
+			 */
+			void __complete(const TCPSession::task_ref &task);
+
+			/**
+			 * Create a session for an outgoing connection.
+			 * The lock of the session list has to be held.
+			 */
+			TCPSession* __create(const dtn::core::Node &n);
+
+			/**
+			 * Assign a session to one of the I/O threads.
+			 * The lock of the session list has to be held.
+			 */
+			void __assign(TCPSession *session);
+
+			/**
+			 * Called by the I/O threads before a session is destroyed
+			 */
+			void __remove(TCPSession *session);
+
+			TCPConvergenceLayer &_callback;
+			const dtn::data::Timeout _timeout;
+
+			std::vector<IOThread*> _threads;
+			size_t _next_thread;
+
+			// tasks waiting for a worker
+			std::vector<Worker*> _workers;
+			std::list<TCPSession::task_ref> _tasks;
+			ibrcommon::Conditional _tasks_cond;
+			bool _tasks_shutdown;
+
+			// maps the id of a session to the session and its I/O thread
+			struct SessionEntry
+			{
+				TCPSession *session;
+				IOThread *thread;
+			};
+
+			typedef std::map<size_t, SessionEntry> session_map;
+			session_map _sessions;
+			mutable ibrcommon::Conditional _sessions_cond;
+		};
+	}
+}
+
+#endif /* TCPEVENTLOOP_H_ */
@@ -0,0 +1,1503 @@
+/*
+ * TCPSession.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "config.h"
+#include "Configuration.h"
+#include "core/BundleCore.h"
+#include "core/FragmentManager.h"
+#include <ibrdtn/utils/Clock.h>
+#include "storage/BundleStorage.h"
+
+#include "net/TCPSession.h"
+#include "net/TCPEventLoop.h"
+#include "net/TCPConvergenceLayer.h"
+#include "net/ConnectionEvent.h"
+#include "net/TransferAbortedEvent.h"
+
+#include <ibrdtn/data/Serializer.h>
+#include <ibrdtn/data/Exceptions.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
+#include <ibrcommon/Logger.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+namespace dtn
+{
+	namespace net
+	{
+		const std::string TCPSession::TAG = "TCPSession";
+
+		// id zero is never assigned to a session
+		volatile size_t TCPSession::__next_id = 0;
+
+		TCPSession::TCPSession(TCPConvergenceLayer &cl, TCPEventLoop &loop, const dtn::core::Node &node, ibrcommon::clientsocket *sock, const dtn::data::Timeout timeout)
+		 : _id(ibrcommon::atomic::add(__next_id, 1)), _callback(cl), _loop(loop), _node(node), _peer(), _timeout(timeout), _fd(-1), _state(SESSION_CONNECTING), _flags(0),
+		   _ack_support(false), _nack_support(false), _started(0), _last_recv(0), _last_sent(0), _last_activity(0),
+		   _idle_timeout(dtn::daemon::Configuration::getInstance().getNetwork().getTCPIdleTimeout()), _inpos(0),
+		   _recv_blob(NULL), _recv_size(0), _recv_remain(0), _recv_flags(0), _responses_base(0), _outpos(0),
+		   _chunksize(dtn::daemon::Configuration::getInstance().getNetwork().getTCPChunkSize()),
+		   _send_part_offset(0), _send_offset(0), _send_length(0), _send_skip(false), _preparing(false),
+		   _file_fd(-1), _file_offset(0), _file_remain(0), _shutdown_requested(false),
+		   _refused_segments(0), _lastack(0), _resume_offset(0),
+		   _timer(*this), _timer_deadline(0), _registered_fd(-1), _epoll_out(false)
+		{
+			_flags |= dtn::streams::StreamContactHeader::REQUEST_ACKNOWLEDGMENTS;
+			_flags |= dtn::streams::StreamContactHeader::REQUEST_NEGATIVE_ACKNOWLEDGMENTS;
+
+			if (dtn::daemon::Configuration::getInstance().getNetwork().doFragmentation())
+			{
+				_flags |= dtn::streams::StreamContactHeader::REQUEST_FRAGMENTATION;
+			}
+
+			if (sock != NULL)
+			{
+				// take over the file descriptor of the accepted socket
+				try {
+					_fd = sock->release();
+				} catch (const ibrcommon::socket_exception&) { };
+				delete sock;
+			}
+		}
+
+		TCPSession::~TCPSession()
+		{
+			// wait for a running expiration of the timer
+			ibrcommon::TimerWheel::getInstance().cancel(_timer);
+
+			if (_fd != -1) ::close(_fd);
+			delete _recv_blob;
+			if (_file_fd != -1) ::close(_file_fd);
+		}
+
+		size_t TCPSession::getId() const
+		{
+			return _id;
+		}
+
+		const dtn::core::Node& TCPSession::getNode() const
+		{
+			return _node;
+		}
+
+		const dtn::streams::StreamContactHeader& TCPSession::getHeader() const
+		{
+			return _peer;
+		}
+
+		void TCPSession::queue(const dtn::net::BundleTransfer &job)
+		{
+			ibrcommon::MutexLock l(_queue_lock);
+			_jobs.push(job);
+		}
+
+		void TCPSession::shutdown()
+		{
+			ibrcommon::MutexLock l(_queue_lock);
+			_shutdown_requested = true;
+		}
+
+		bool TCPSession::match(const dtn::core::Node &n) const
+		{
+			return (_node == n);
+		}
+
+		bool TCPSession::match(const dtn::data::EID &destination) const
+		{
+			return _node.getEID().sameHost(destination);
+		}
+
+		int TCPSession::fd() const
+		{
+			return _fd;
+		}
+
+		bool TCPSession::closed() const
+		{
+			return (_state == SESSION_CLOSED);
+		}
+
+		bool TCPSession::wantWrite() const
+		{
+			if (_state == SESSION_CONNECTING) return true;
+			if ((_outpos < _outbuf.size()) || (_file_remain > 0)) return true;
+			return ((_state == SESSION_ESTABLISHED) && !_send_parts.empty());
+		}
+
+		dtn::data::Timestamp TCPSession::getDeadline() const
+		{
+			switch (_state)
+			{
+				case SESSION_RESOLVING:
+				case SESSION_CONNECTING:
+				case SESSION_HANDSHAKE:
+					return _started + _timeout;
+
+				case SESSION_ESTABLISHED:
+				{
+					dtn::data::Timestamp deadline = 0;
+
+					if (_peer._keepalive > 0)
+					{
+						// send keepalives and detect a dead peer
+						deadline = std::min(_last_sent + _peer._keepalive, _last_recv + (_peer._keepalive * 2));
+					}
+
+					if (_idle_timeout > 0)
+					{
+						const dtn::data::Timestamp idle = _last_activity + _idle_timeout;
+						if ((deadline == 0) || (idle < deadline)) deadline = idle;
+					}
+
+					return deadline;
+				}
+
+				default:
+					return 0;
+			}
+		}
+
+		bool TCPSession::setup(const dtn::data::Timestamp &now) throw ()
+		{
+			_started = now;
+			_last_recv = now;
+			_last_sent = now;
+			_last_activity = now;
+
+			if (_fd != -1)
+			{
+				// accepted connection: start with the handshake
+				__established(now);
+				return !closed();
+			}
+
+			// resolve the addresses of the node without blocking the I/O thread
+			_state = SESSION_RESOLVING;
+			_loop.submit(task_ref(new ResolveTask(*this)));
+			return true;
+		}
+
+		bool TCPSession::__connect() throw ()
+		{
+			while (!_addresses.empty())
+			{
+				const Address &a = _addresses.front();
+
+				int fd = ::socket(a.addr.ss_family, SOCK_STREAM, 0);
+
+				if (fd >= 0)
+				{
+					::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+					if ((::connect(fd, (struct sockaddr*)&a.addr, a.len) == 0) || (errno == EINPROGRESS))
+					{
+						IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 15) << "Initiate TCP connection to " << a.uri << IBRCOMMON_LOGGER_ENDL;
+
+						// wait until the socket gets writable
+						_fd = fd;
+						_state = SESSION_CONNECTING;
+						return true;
+					}
+
+					::close(fd);
+				}
+
+				_addresses.pop_front();
+			}
+
+			IBRCOMMON_LOGGER_TAG(TCPSession::TAG, warning) << "connection to " << _node.toString() << " failed" << IBRCOMMON_LOGGER_ENDL;
+			_state = SESSION_CLOSED;
+			return false;
+		}
+
+		bool TCPSession::__connected() throw ()
+		{
+			int err = 0;
+			socklen_t len = sizeof(err);
+
+			if ((::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) || (err != 0))
+			{
+				// this attempt failed, try the next address
+				::close(_fd);
+				_fd = -1;
+				_addresses.pop_front();
+				return __connect();
+			}
+
+			// add TCP connection descriptor to the node object
+			const std::string uri = _addresses.front().uri;
+			_addresses.clear();
+
+			_node.clear();
+			_node.add( dtn::core::Node::URI(dtn::core::Node::NODE_CONNECTED, dtn::core::Node::CONN_TCPIP, uri, 0, 10) );
+
+			__established(dtn::utils::Clock::getMonotonicTimestamp());
+			return !closed();
+		}
+
+		void TCPSession::__established(const dtn::data::Timestamp &now) throw ()
+		{
+			::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) | O_NONBLOCK);
+
+			if ( dtn::daemon::Configuration::getInstance().getNetwork().getTCPOptionNoDelay() )
+			{
+				int on = 1;
+				::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+			}
+
+			// send the contact header
+			dtn::streams::StreamContactHeader header(dtn::core::BundleCore::local);
+			header._keepalive = static_cast<uint16_t>(_timeout);
+			header._flags = _flags;
+
+			std::stringstream ss;
+			ss << header;
+			_outbuf.append(ss.str());
+
+			_state = SESSION_HANDSHAKE;
+			__flush(now);
+		}
+
+		void TCPSession::__close() throw ()
+		{
+			if (_fd != -1)
+			{
+				::close(_fd);
+				_fd = -1;
+			}
+
+			_state = SESSION_CLOSED;
+		}
+
+		void TCPSession::finalize() throw ()
+		{
+			__close();
+
+			// deliver a partially received bundle as fragment
+			if ((_recv_blob != NULL) && (_recv_size > 0) && _peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_FRAGMENTATION))
+			{
+				_loop.submit(task_ref(new DeliverTask(*this, *_recv_blob, true, 0)));
+			}
+
+			delete _recv_blob;
+			_recv_blob = NULL;
+
+			__clear_parts();
+
+			// drop the prepared bundles, this requeues them
+			_prepared.clear();
+
+			if (_peer._localeid != dtn::data::EID())
+			{
+				// event
+				ConnectionEvent::raise(ConnectionEvent::CONNECTION_DOWN, _node);
+			}
+
+			// requeue all bundles still in transit
+			__clear_queue();
+
+			// drop all queued transfers, this requeues the bundles
+			ibrcommon::MutexLock l(_queue_lock);
+			while (!_jobs.empty()) _jobs.pop();
+		}
+
+		void TCPSession::onNotify(const dtn::data::Timestamp &now) throw ()
+		{
+			{
+				ibrcommon::MutexLock l(_queue_lock);
+				if (_shutdown_requested)
+				{
+					_shutdown_requested = false;
+
+					// announce the shutdown to the peer
+					if (_state == SESSION_ESTABLISHED)
+					{
+						__send(dtn::streams::StreamDataSegment(dtn::streams::StreamDataSegment::MSG_SHUTDOWN_NONE));
+					}
+
+					__flush(now);
+					__close();
+					return;
+				}
+			}
+
+			if (_state == SESSION_ESTABLISHED)
+			{
+				onWritable(now);
+			}
+		}
+
+		void TCPSession::onTimeout(const dtn::data::Timestamp &now) throw ()
+		{
+			switch (_state)
+			{
+				case SESSION_RESOLVING:
+				case SESSION_CONNECTING:
+				case SESSION_HANDSHAKE:
+					if (now >= (_started + _timeout))
+					{
+						IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "handshake with " << _node.toString() << " timed out" << IBRCOMMON_LOGGER_ENDL;
+						__close();
+					}
+					return;
+
+				case SESSION_ESTABLISHED:
+					break;
+
+				default:
+					return;
+			}
+
+			if (_peer._keepalive > 0)
+			{
+				if (now >= (_last_recv + (_peer._keepalive * 2)))
+				{
+					// event
+					ConnectionEvent::raise(ConnectionEvent::CONNECTION_TIMEOUT, _node);
+
+					__close();
+					return;
+				}
+
+				if (now >= (_last_sent + _peer._keepalive))
+				{
+					__send(dtn::streams::StreamDataSegment());
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 15) << "KEEPALIVE sent" << IBRCOMMON_LOGGER_ENDL;
+					__flush(now);
+				}
+			}
+
+			if ((_idle_timeout > 0) && (now >= (_last_activity + _idle_timeout)))
+			{
+				__send(dtn::streams::StreamDataSegment(dtn::streams::StreamDataSegment::MSG_SHUTDOWN_IDLE_TIMEOUT));
+				__flush(now);
+
+				// event
+				ConnectionEvent::raise(ConnectionEvent::CONNECTION_TIMEOUT, _node);
+
+				__close();
+			}
+		}
+
+		void TCPSession::onReadable(const dtn::data::Timestamp &now) throw ()
+		{
+			if (_state == SESSION_CONNECTING)
+			{
+				onWritable(now);
+				return;
+			}
+
+			char buf[8192];
+
+			// read a limited amount of data to be fair to other sessions
+			for (int i = 0; (i < 16) && !closed(); ++i)
+			{
+				const ssize_t ret = ::recv(_fd, buf, sizeof(buf), 0);
+
+				if (ret == 0)
+				{
+					// connection closed by the peer
+					__close();
+					return;
+				}
+
+				if (ret < 0)
+				{
+					if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) break;
+
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "read error: " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					__close();
+					return;
+				}
+
+				_inbuf.append(buf, ret);
+				_last_recv = now;
+
+				try {
+					while (__parse(now)) { };
+				} catch (const ibrcommon::Exception &ex) {
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "protocol error: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+					__close();
+					return;
+				}
+
+				// remove consumed data from the input buffer
+				_inbuf.erase(0, _inpos);
+				_inpos = 0;
+
+				if (static_cast<size_t>(ret) < sizeof(buf)) break;
+			}
+
+			// send ACKs and pending data
+			if (!closed()) onWritable(now);
+		}
+
+		void TCPSession::onWritable(const dtn::data::Timestamp &now) throw ()
+		{
+			if (_state == SESSION_CONNECTING)
+			{
+				if (!__connected()) return;
+				if (_state == SESSION_CONNECTING) return;
+			}
+
+			// send a limited amount of chunks to be fair to other sessions
+			for (int i = 0; (i < 16) && !closed(); ++i)
+			{
+				__fill();
+				__flush(now);
+
+				// stop if the socket is congested
+				if ((_outpos < _outbuf.size()) || (_file_remain > 0)) break;
+
+				// stop if there is nothing more to send
+				if (_send_parts.empty()) break;
+			}
+		}
+
+		bool TCPSession::__parse(const dtn::data::Timestamp &now) throw (ibrcommon::Exception)
+		{
+			if (_state == SESSION_HANDSHAKE)
+			{
+				if (!__parse_header()) return false;
+
+				// enable/disable ACK/NACK support
+				_ack_support = _peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_ACKNOWLEDGMENTS);
+				_nack_support = _peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_NEGATIVE_ACKNOWLEDGMENTS);
+
+				// copy old attributes and urls to the new node object
+				dtn::core::Node n_old = _node;
+				_node = dtn::core::Node(_peer._localeid);
+				_node += n_old;
+
+				// check if the peer has the same EID
+				if (_node.getEID() == dtn::core::BundleCore::getInstance().local)
+				{
+					IBRCOMMON_LOGGER_TAG(TCPSession::TAG, warning) << "connection to local endpoint rejected" << IBRCOMMON_LOGGER_ENDL;
+
+					// do not raise a down event
+					_peer._localeid = dtn::data::EID();
+					__close();
+					return false;
+				}
+
+				_state = SESSION_ESTABLISHED;
+				_last_activity = now;
+
+				// raise up event
+				ConnectionEvent::raise(ConnectionEvent::CONNECTION_UP, _node);
+				return true;
+			}
+
+			if (_state != SESSION_ESTABLISHED) return false;
+
+			if (_recv_remain > 0)
+			{
+				const size_t avail = _inbuf.size() - _inpos;
+				if (avail == 0) return false;
+
+				const size_t len = std::min(avail, _recv_remain);
+				__receive_data(_inbuf.data() + _inpos, len);
+
+				_inpos += len;
+				_recv_remain -= len;
+				_last_activity = now;
+
+				if (_recv_remain == 0) __segment_complete();
+				return true;
+			}
+
+			return __parse_segment(now);
+		}
+
+		bool TCPSession::__parse_header() throw (ibrcommon::Exception)
+		{
+			const char *data = _inbuf.data() + _inpos;
+			const size_t avail = _inbuf.size() - _inpos;
+
+			// magic, version, flags and keepalive
+			const size_t fixed_length = 8;
+			if (avail < fixed_length) return false;
+
+			// length of the local EID
+			const size_t sdnv = __sdnv_length(data + fixed_length, avail - fixed_length);
+			if (sdnv == 0) return false;
+
+			dtn::data::Number eid_length;
+			{
+				std::istringstream ss(std::string(data + fixed_length, sdnv));
+				ss >> eid_length;
+			}
+
+			if (eid_length > 0xffff) throw dtn::InvalidProtocolException("EID in contact header is too long");
+
+			const size_t length = fixed_length + sdnv + eid_length.get<size_t>();
+			if (avail < length) return false;
+
+			std::istringstream ss(std::string(data, length));
+			ss >> _peer;
+
+			_inpos += length;
+			return true;
+		}
+
+		bool TCPSession::__parse_segment(const dtn::data::Timestamp &now) throw (ibrcommon::Exception)
+		{
+			const char *data = _inbuf.data() + _inpos;
+			const size_t avail = _inbuf.size() - _inpos;
+			if (avail == 0) return false;
+
+			const dtn::streams::StreamDataSegment::SegmentType type = dtn::streams::StreamDataSegment::SegmentType( (data[0] & 0xF0) >> 4 );
+			const uint8_t flags = (data[0] & 0x0F);
+
+			size_t length = 1;
+
+			switch (type)
+			{
+				case dtn::streams::StreamDataSegment::MSG_DATA_SEGMENT:
+				case dtn::streams::StreamDataSegment::MSG_ACK_SEGMENT:
+				{
+					const size_t sdnv = __sdnv_length(data + 1, avail - 1);
+					if (sdnv == 0) return false;
+					length += sdnv;
+					break;
+				}
+
+				case dtn::streams::StreamDataSegment::MSG_REFUSE_BUNDLE:
+				case dtn::streams::StreamDataSegment::MSG_KEEPALIVE:
+					break;
+
+				case dtn::streams::StreamDataSegment::MSG_SHUTDOWN:
+				{
+					// optional reason code
+					if (flags & 0x02) length += 1;
+
+					// optional reconnection delay
+					if (flags & 0x01)
+					{
+						if (avail < length) return false;
+						const size_t sdnv = __sdnv_length(data + length, avail - length);
+						if (sdnv == 0) return false;
+						length += sdnv;
+					}
+					break;
+				}
+
+				default:
+					throw dtn::InvalidProtocolException("unknown segment type");
+			}
+
+			if (avail < length) return false;
+
+			dtn::streams::StreamDataSegment seg;
+			{
+				std::istringstream ss(std::string(data, length));
+				if (type != dtn::streams::StreamDataSegment::MSG_SHUTDOWN) ss >> seg;
+				else seg._type = type;
+			}
+
+			_inpos += length;
+
+			if (seg._type != dtn::streams::StreamDataSegment::MSG_KEEPALIVE)
+			{
+				// reset idle timeout
+				_last_activity = now;
+			}
+
+			switch (seg._type)
+			{
+				case dtn::streams::StreamDataSegment::MSG_DATA_SEGMENT:
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 70) << "MSG_DATA_SEGMENT received, size: " << seg._value.toString() << IBRCOMMON_LOGGER_ENDL;
+
+					if (seg._flags & dtn::streams::StreamDataSegment::MSG_MARK_BEGINN)
+					{
+						_recv_size = seg._value;
+
+						// create a new container for the bundle data
+						delete _recv_blob;
+						_recv_blob = new ibrcommon::BLOB::Reference(ibrcommon::BLOB::create());
+					}
+					else
+					{
+						_recv_size += seg._value;
+					}
+
+					_recv_flags = seg._flags;
+					_recv_remain = seg._value.get<dtn::data::Length>();
+
+					if (_recv_remain == 0) __segment_complete();
+					break;
+				}
+
+				case dtn::streams::StreamDataSegment::MSG_ACK_SEGMENT:
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 70) << "MSG_ACK_SEGMENT received, size: " << seg._value.toString() << IBRCOMMON_LOGGER_ENDL;
+
+					if (_ack_support)
+					{
+						if (_unacked.empty())
+						{
+							IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "got an unexpected ACK with size of " << seg._value.toString() << IBRCOMMON_LOGGER_ENDL;
+						}
+						else
+						{
+							__ack(seg._value.get<dtn::data::Length>());
+
+							static const dtn::core::Metrics::Histogram latency = TCPConvergenceLayer::getSegmentLatency(dtn::core::Node::CONN_TCPIP);
+							latency.record(dtn::core::Metrics::now() - _unacked.front().second);
+
+							if (_unacked.front().first & dtn::streams::StreamDataSegment::MSG_MARK_END)
+							{
+								__forwarded();
+							}
+
+							_unacked.pop_front();
+						}
+					}
+					break;
+				}
+
+				case dtn::streams::StreamDataSegment::MSG_KEEPALIVE:
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 70) << "MSG_KEEPALIVE received" << IBRCOMMON_LOGGER_ENDL;
+					break;
+
+				case dtn::streams::StreamDataSegment::MSG_REFUSE_BUNDLE:
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 70) << "MSG_REFUSE_BUNDLE received, flags: " << (int)seg._flags << IBRCOMMON_LOGGER_ENDL;
+
+					if (_ack_support && _nack_support)
+					{
+						if (_refused_segments > 0)
+						{
+							// skip NACKs of further segments of an already refused bundle
+							--_refused_segments;
+						}
+						else if (_unacked.empty())
+						{
+							IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "got an unexpected NACK" << IBRCOMMON_LOGGER_ENDL;
+						}
+						else
+						{
+							_unacked.pop_front();
+
+							// get all segment ACKs in the queue for this transmission
+							while (!_unacked.empty() && !(_unacked.front().first & dtn::streams::StreamDataSegment::MSG_MARK_BEGINN))
+							{
+								_unacked.pop_front();
+								++_refused_segments;
+							}
+
+							__refused();
+
+							// the queue is empty, then skip the current transfer
+							if (_unacked.empty() && !_send_parts.empty())
+							{
+								_send_skip = true;
+							}
+						}
+					}
+					else
+					{
+						IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "got an unexpected NACK" << IBRCOMMON_LOGGER_ENDL;
+					}
+					break;
+				}
+
+				case dtn::streams::StreamDataSegment::MSG_SHUTDOWN:
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 70) << "MSG_SHUTDOWN received" << IBRCOMMON_LOGGER_ENDL;
+					__close();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void TCPSession::__receive_data(const char *data, size_t len) throw (ibrcommon::Exception)
+		{
+			// record statistics
+			_callback.addTrafficIn(len);
+
+			// discard data without a preceding start segment
+			if (_recv_blob == NULL) return;
+
+			ibrcommon::BLOB::iostream io = _recv_blob->iostream();
+			(*io).seekp(0, std::ios::end);
+			(*io).write(data, len);
+
+			if (!(*io).good()) throw ibrcommon::IOException("can not write received data");
+		}
+
+		void TCPSession::__segment_complete() throw ()
+		{
+			Response r;
+			r.size = _recv_size;
+			r.pending = false;
+			r.accepted = true;
+
+			if ((_recv_flags & dtn::streams::StreamDataSegment::MSG_MARK_END) && (_recv_blob != NULL))
+			{
+				// the bundle is processed by a worker, the response waits for the result
+				r.pending = true;
+				_loop.submit(task_ref(new DeliverTask(*this, *_recv_blob, false, _responses_base + _responses.size())));
+
+				delete _recv_blob;
+				_recv_blob = NULL;
+			}
+
+			_responses.push_back(r);
+			__respond();
+		}
+
+		void TCPSession::__delivered(const size_t response, bool accepted) throw ()
+		{
+			const size_t index = response - _responses_base;
+			if (index >= _responses.size()) return;
+
+			Response &r = _responses[index];
+			r.pending = false;
+			r.accepted = accepted;
+
+			__respond();
+		}
+
+		void TCPSession::__respond() throw ()
+		{
+			// responses are sent in the order of the received segments
+			while (!_responses.empty() && !_responses.front().pending)
+			{
+				const Response &r = _responses.front();
+
+				if (!r.accepted)
+				{
+					// send NACK on bundle reject
+					if (_nack_support) __send(dtn::streams::StreamDataSegment(dtn::streams::StreamDataSegment::MSG_REFUSE_BUNDLE));
+				}
+				else if (_ack_support)
+				{
+					// New data segment received. Send an ACK.
+					__send(dtn::streams::StreamDataSegment(dtn::streams::StreamDataSegment::MSG_ACK_SEGMENT, r.size));
+				}
+
+				_responses.pop_front();
+				++_responses_base;
+			}
+		}
+
+		void TCPSession::__fill() throw ()
+		{
+			if (_state != SESSION_ESTABLISHED) return;
+
+			// keep the output buffer small, data is only generated if the socket is able to take it
+			// a pending range of a file has to be sent before the next segment
+			while (((_outbuf.size() - _outpos) < _chunksize) && (_file_remain == 0))
+			{
+				// skip the rest of a refused transfer
+				if (_send_skip) __clear_parts();
+
+				// drop all parts already sent
+				while (!_send_parts.empty() && (_send_part_offset == _send_parts.front().length))
+				{
+					if (_file_fd != -1)
+					{
+						::close(_file_fd);
+						_file_fd = -1;
+					}
+
+					_send_parts.pop_front();
+					_send_part_offset = 0;
+				}
+
+				if (_send_parts.empty())
+				{
+					// release the payload of the last bundle
+					_send_blobs.clear();
+
+					if (!__next()) return;
+				}
+
+				const SendPart &part = _send_parts.front();
+
+				// segments do not span multiple parts
+				const dtn::data::Length length = std::min(_chunksize, part.length - _send_part_offset);
+
+				// wrap a segment around the data
+				dtn::streams::StreamDataSegment seg(dtn::streams::StreamDataSegment::MSG_DATA_SEGMENT, length);
+
+				// set the start flag
+				if (_send_offset == 0) seg._flags |= dtn::streams::StreamDataSegment::MSG_MARK_BEGINN;
+
+				// set the end flag
+				if ((_send_offset + length) == _send_length) seg._flags |= dtn::streams::StreamDataSegment::MSG_MARK_END;
+
+				if (part.path.empty())
+				{
+					__send(seg);
+					_outbuf.append(part.data, _send_part_offset, length);
+				}
+				else
+				{
+					if (_file_fd == -1)
+					{
+						_file_fd = ::open(part.path.c_str(), O_RDONLY);
+
+						if (_file_fd == -1)
+						{
+							IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "can not open payload file " << part.path << ": " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+							__close();
+							return;
+						}
+					}
+
+					// the data is sent directly from the file after the segment header
+					__send(seg);
+					_file_offset = part.offset + _send_part_offset;
+					_file_remain = length;
+				}
+
+				_send_part_offset += length;
+				_send_offset += length;
+
+				// record statistics
+				_callback.addTrafficOut(length);
+
+				if (_ack_support)
+				{
+					// put the segment into the queue
+					_unacked.push_back(std::make_pair(seg._flags, dtn::core::Metrics::now()));
+				}
+				else if (seg._flags & dtn::streams::StreamDataSegment::MSG_MARK_END)
+				{
+					// without ACK support we have to assume that a bundle is forwarded
+					// when the last segment is sent.
+					__forwarded();
+				}
+			}
+		}
+
+		void TCPSession::__clear_parts() throw ()
+		{
+			if (_file_fd != -1)
+			{
+				::close(_file_fd);
+				_file_fd = -1;
+			}
+
+			_send_parts.clear();
+			_send_blobs.clear();
+			_send_part_offset = 0;
+			_send_skip = false;
+			_file_remain = 0;
+
+			_outbuf.append(_trailer);
+			_trailer.clear();
+		}
+
+		bool TCPSession::__next() throw ()
+		{
+			if (_prepared.empty())
+			{
+				__request();
+				return false;
+			}
+
+			Prepared &p = _prepared.front();
+
+			_send_parts.splice(_send_parts.end(), p.parts);
+			_send_blobs.splice(_send_blobs.end(), p.blobs);
+			_send_length = p.length;
+			_resume_offset = p.resume_offset;
+			_send_part_offset = 0;
+			_send_offset = 0;
+
+			// put the bundle into the sentqueue
+			_sentqueue.push(p.transfer);
+			_prepared.pop_front();
+
+			// prepare the next bundle while this one is sent
+			__request();
+
+			return !_send_parts.empty();
+		}
+
+		void TCPSession::__request() throw ()
+		{
+			if (_preparing || !_prepared.empty()) return;
+
+			ibrcommon::MutexLock l(_queue_lock);
+
+			while (!_jobs.empty())
+			{
+				dtn::net::BundleTransfer transfer = _jobs.front();
+				_jobs.pop();
+
+				// check if the transfer is directed to the connected neighbor
+				if (transfer.getNeighbor() != _node.getEID()) continue;
+
+				_preparing = true;
+				_loop.submit(task_ref(new PrepareTask(*this, transfer)));
+				return;
+			}
+		}
+
+		void TCPSession::__prepared(Prepared &result, bool ready) throw ()
+		{
+			_preparing = false;
+
+			if (ready)
+			{
+				_prepared.push_back(Prepared(result.transfer));
+
+				Prepared &p = _prepared.back();
+				p.parts.splice(p.parts.end(), result.parts);
+				p.blobs.splice(p.blobs.end(), result.blobs);
+				p.length = result.length;
+				p.resume_offset = result.resume_offset;
+			}
+			else
+			{
+				// the bundle has been skipped, go on with the next one
+				__request();
+			}
+		}
+
+		void TCPSession::__flush(const dtn::data::Timestamp &now) throw ()
+		{
+			if (_fd == -1) return;
+
+			while (_outpos < _outbuf.size())
+			{
+				const ssize_t ret = ::send(_fd, _outbuf.data() + _outpos, _outbuf.size() - _outpos, MSG_NOSIGNAL);
+
+				if (ret < 0)
+				{
+					if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) break;
+
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "write error: " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					__close();
+					return;
+				}
+
+				_outpos += ret;
+				_last_sent = now;
+			}
+
+			if (_outpos == _outbuf.size())
+			{
+				_outbuf.clear();
+				_outpos = 0;
+
+				// send the pending range of the payload file
+				while (_file_remain > 0)
+				{
+#ifdef HAVE_SYS_SENDFILE_H
+					off_t offset = _file_offset;
+					const ssize_t ret = ::sendfile(_fd, _file_fd, &offset, _file_remain);
+
+					if (ret > 0)
+					{
+						_file_offset += ret;
+						_file_remain -= ret;
+						_last_sent = now;
+						continue;
+					}
+
+					if ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))) break;
+
+					// fall back to copy the data if sendfile() is not supported for this file
+					if ((ret < 0) && (errno != EINVAL) && (errno != ENOSYS))
+					{
+						IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "sendfile error: " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+						__close();
+						return;
+					}
+#endif
+					// read the pending range into the output buffer
+					std::vector<char> buf(_file_remain);
+					const ssize_t len = ::pread(_file_fd, &buf[0], buf.size(), _file_offset);
+
+					if (len != static_cast<ssize_t>(buf.size()))
+					{
+						IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "can not read payload file" << IBRCOMMON_LOGGER_ENDL;
+						__close();
+						return;
+					}
+
+					_outbuf.append(&buf[0], buf.size());
+					_file_remain = 0;
+
+					// append the segments queued while the range was pending
+					_outbuf.append(_trailer);
+					_trailer.clear();
+
+					__flush(now);
+					return;
+				}
+
+				if ((_file_remain == 0) && !_trailer.empty())
+				{
+					// send the segments queued while the range was pending
+					_outbuf.append(_trailer);
+					_trailer.clear();
+
+					__flush(now);
+				}
+			}
+			else if (_outpos > _chunksize)
+			{
+				_outbuf.erase(0, _outpos);
+				_outpos = 0;
+			}
+		}
+
+		void TCPSession::__send(const dtn::streams::StreamDataSegment &seg) throw ()
+		{
+			std::stringstream ss;
+			ss << seg;
+
+			// do not put a segment into a pending range of a file
+			if (_file_remain > 0) _trailer.append(ss.str());
+			else _outbuf.append(ss.str());
+		}
+
+		void TCPSession::__ack(const dtn::data::Length &ack) throw ()
+		{
+			_lastack = ack;
+		}
+
+		void TCPSession::__refused() throw ()
+		{
+			// stop here if the queue is already empty
+			if (_sentqueue.empty()) {
+				IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "transfer refused without a bundle in queue" << IBRCOMMON_LOGGER_ENDL;
+				return;
+			}
+
+			// abort the transmission
+			_sentqueue.front().abort(dtn::net::TransferAbortedEvent::REASON_REFUSED);
+
+			// set ACK to zero
+			_lastack = 0;
+
+			// release the job
+			_sentqueue.pop();
+		}
+
+		void TCPSession::__forwarded() throw ()
+		{
+			// stop here if the queue is already empty
+			if (_sentqueue.empty()) {
+				IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "transfer completed without a bundle in queue" << IBRCOMMON_LOGGER_ENDL;
+				return;
+			}
+
+			// mark job as complete
+			_sentqueue.front().complete();
+
+			// set ACK to zero
+			_lastack = 0;
+
+			// release the job
+			_sentqueue.pop();
+		}
+
+		void TCPSession::__clear_queue() throw ()
+		{
+			while (!_sentqueue.empty())
+			{
+				// get the job on top of the sent queue
+				const dtn::net::BundleTransfer &job = _sentqueue.front();
+
+				if ((_lastack > 0) && (_peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_FRAGMENTATION)))
+				{
+					// some data are already acknowledged
+					// store this information in the fragment manager
+					dtn::core::FragmentManager::setOffset(_peer.getEID(), job.getBundle(), _lastack, _resume_offset);
+				}
+
+				// set last ack to zero
+				_lastack = 0;
+
+				// release the job
+				_sentqueue.pop();
+			}
+		}
+
+		TCPSession::DeadlineTimer::DeadlineTimer(TCPSession &session)
+		 : _loop(session._loop), _session(session.getId())
+		{
+		}
+
+		TCPSession::DeadlineTimer::~DeadlineTimer()
+		{
+		}
+
+		void TCPSession::DeadlineTimer::expired() throw ()
+		{
+			// called by the thread of the timer wheel, the session is
+			// processed by its I/O thread
+			_loop.expire(_session);
+		}
+
+		TCPSession::Task::Task(TCPSession &s)
+		 : session(s.getId())
+		{
+		}
+
+		TCPSession::Task::Task(const size_t s)
+		 : session(s)
+		{
+		}
+
+		TCPSession::Task::~Task()
+		{
+		}
+
+		TCPSession::Prepared::Prepared(const dtn::net::BundleTransfer &t)
+		 : transfer(t), length(0), resume_offset(0)
+		{
+		}
+
+		TCPSession::ResolveTask::ResolveTask(TCPSession &s)
+		 : Task(s), _uris(s._node.get(dtn::core::Node::CONN_TCPIP))
+		{
+		}
+
+		TCPSession::ResolveTask::~ResolveTask()
+		{
+		}
+
+		void TCPSession::ResolveTask::run() throw ()
+		{
+			// collect all addresses of the node
+			for (std::list<dtn::core::Node::URI>::const_iterator iter = _uris.begin(); iter != _uris.end(); ++iter)
+			{
+				const dtn::core::Node::URI &uri = (*iter);
+
+				std::string address = "0.0.0.0";
+				unsigned int port = 0;
+				uri.decode(address, port);
+
+				std::stringstream ss; ss << port;
+
+				struct addrinfo hints;
+				::memset(&hints, 0, sizeof(struct addrinfo));
+				hints.ai_family = PF_UNSPEC;
+				hints.ai_socktype = SOCK_STREAM;
+
+				struct addrinfo *res = NULL;
+				if (::getaddrinfo(address.c_str(), ss.str().c_str(), &hints, &res) != 0) continue;
+
+				for (struct addrinfo *walk = res; walk != NULL; walk = walk->ai_next)
+				{
+					Address a;
+					::memcpy(&a.addr, walk->ai_addr, walk->ai_addrlen);
+					a.len = walk->ai_addrlen;
+					a.uri = uri.value;
+					_addresses.push_back(a);
+				}
+
+				::freeaddrinfo(res);
+			}
+		}
+
+		void TCPSession::ResolveTask::complete(TCPSession &s) throw ()
+		{
+			// the session may have been closed in the meantime
+			if (s._state != SESSION_RESOLVING) return;
+
+			s._addresses = _addresses;
+			s.__connect();
+		}
+
+		TCPSession::PrepareTask::PrepareTask(TCPSession &s, const dtn::net::BundleTransfer &transfer)
+		 : Task(s), _neighbor(s._node.getEID()), _peer(s._peer._localeid), _protocol(s._callback.getDiscoveryProtocol()),
+		   _result(transfer), _ready(false)
+		{
+		}
+
+		TCPSession::PrepareTask::~PrepareTask()
+		{
+		}
+
+		void TCPSession::PrepareTask::run() throw ()
+		{
+			dtn::storage::BundleStorage &storage = dtn::core::BundleCore::getInstance().getStorage();
+
+			try {
+				// read the bundle out of the storage
+				dtn::data::Bundle bundle = storage.get(_result.transfer.getBundle());
+
+				// create a filter context
+				dtn::core::FilterContext context;
+				context.setPeer(_peer);
+				context.setProtocol(_protocol);
+
+				// push bundle through the filter routines
+				context.setBundle(bundle);
+				dtn::core::BundleFilter::ACTION ret = dtn::core::BundleCore::getInstance().filter(dtn::core::BundleFilter::OUTPUT, context, bundle);
+
+				switch (ret) {
+					case dtn::core::BundleFilter::ACCEPT:
+					// only used within a filter table, a table does not return them
+					case dtn::core::BundleFilter::PASS:
+					case dtn::core::BundleFilter::SKIP:
+						break;
+					case dtn::core::BundleFilter::REJECT:
+					case dtn::core::BundleFilter::DROP:
+						_result.transfer.abort(dtn::net::TransferAbortedEvent::REASON_REFUSED_BY_FILTER);
+						return;
+				}
+
+				// get the offset, if this bundle has been reactively fragmented before
+				if (dtn::daemon::Configuration::getInstance().getNetwork().doFragmentation()
+						&& !bundle.get(dtn::data::PrimaryBlock::DONT_FRAGMENT))
+				{
+					_result.resume_offset = dtn::core::FragmentManager::getOffset(_neighbor, bundle);
+				}
+
+				// serialize the bundle into parts, the data is sent in chunks
+				// whenever the socket is writable
+				std::stringstream buffer;
+				PartSerializer serializer(buffer, _result.parts, _result.blobs);
+
+				if (_result.resume_offset > 0)
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 4) << "Resume transfer of bundle " << bundle.toString() << " to " << _neighbor.getString() << ", offset: " << _result.resume_offset << IBRCOMMON_LOGGER_ENDL;
+
+					// transmit the fragment
+					serializer << dtn::data::BundleFragment(bundle, _result.resume_offset, -1);
+				}
+				else
+				{
+					// transmit the bundle
+					serializer << bundle;
+				}
+
+				serializer.flush();
+
+				for (std::list<SendPart>::const_iterator it = _result.parts.begin(); it != _result.parts.end(); ++it)
+				{
+					_result.length += (*it).length;
+				}
+
+				_ready = true;
+			} catch (const dtn::storage::NoBundleFoundException&) {
+				// send transfer aborted event
+				_result.transfer.abort(dtn::net::TransferAbortedEvent::REASON_BUNDLE_DELETED);
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(TCPSession::TAG, error) << "can not serialize bundle: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		void TCPSession::PrepareTask::complete(TCPSession &s) throw ()
+		{
+			s.__prepared(_result, _ready);
+		}
+
+		TCPSession::DeliverTask::DeliverTask(TCPSession &s, const ibrcommon::BLOB::Reference &data, bool fragment, const size_t response)
+		 : Task(s), _data(data), _fragment(fragment), _peer(s._peer._localeid), _protocol(s._callback.getDiscoveryProtocol()),
+		   _response(response), _accepted(false)
+		{
+		}
+
+		TCPSession::DeliverTask::~DeliverTask()
+		{
+		}
+
+		void TCPSession::DeliverTask::run() throw ()
+		{
+			try {
+				dtn::data::Bundle bundle;
+
+				{
+					ibrcommon::BLOB::iostream io = _data.iostream();
+					(*io).seekg(0);
+
+					// create a deserializer for the received data
+					dtn::data::DefaultDeserializer deserializer(*io, dtn::core::BundleCore::getInstance());
+
+					// turn the data received so far into a fragment if the transmission broke up
+					deserializer.setFragmentationSupport(_fragment);
+
+					// read the bundle (or the fragment if fragmentation is enabled)
+					deserializer >> bundle;
+				}
+
+				// check the bundle
+				if ( ( bundle.destination == dtn::data::EID() ) || ( bundle.source == dtn::data::EID() ) )
+				{
+					// invalid bundle!
+					throw dtn::data::Validator::RejectedException("destination or source EID is null");
+				}
+
+				// create a filter context
+				dtn::core::FilterContext context;
+				context.setPeer(_peer);
+				context.setProtocol(_protocol);
+
+				// push bundle through the filter routines
+				context.setBundle(bundle);
+				dtn::core::BundleFilter::ACTION ret = dtn::core::BundleCore::getInstance().filter(dtn::core::BundleFilter::INPUT, context, bundle);
+
+				switch (ret) {
+					case dtn::core::BundleFilter::ACCEPT:
+					// only used within a filter table, a table does not return them
+					case dtn::core::BundleFilter::PASS:
+					case dtn::core::BundleFilter::SKIP:
+						// inject bundle into core
+						dtn::core::BundleCore::getInstance().inject(_peer, bundle, false);
+						break;
+
+					case dtn::core::BundleFilter::REJECT:
+						throw dtn::data::Validator::RejectedException("rejected by input filter");
+						break;
+
+					case dtn::core::BundleFilter::DROP:
+						break;
+				}
+
+				_accepted = true;
+			} catch (const dtn::data::Validator::RejectedException &ex) {
+				// display the rejection
+				IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 2) << "bundle has been rejected: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			} catch (const dtn::InvalidDataException &ex) {
+				// display the rejection
+				IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 2) << "invalid bundle-data received: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			} catch (const std::exception &ex) {
+				IBRCOMMON_LOGGER_DEBUG_TAG(TCPSession::TAG, 10) << "failed to read bundle: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		void TCPSession::DeliverTask::complete(TCPSession &s) throw ()
+		{
+			// fragments are delivered when the session is gone
+			if (_fragment) return;
+
+			s.__delivered(_response, _accepted);
+		}
+
+		TCPSession::PartSerializer::PartSerializer(std::stringstream &buffer, std::list<SendPart> &parts, std::list<ibrcommon::BLOB::Reference> &blobs)
+		 : dtn::data::DefaultSerializer(buffer), _buffer(buffer), _parts(parts), _blobs(blobs)
+		{
+		}
+
+		TCPSession::PartSerializer::~PartSerializer()
+		{
+		}
+
+		dtn::data::Serializer& TCPSession::PartSerializer::operator<<(const dtn::data::Block &obj)
+		{
+			try {
+				// test if this is the payload block
+				const dtn::data::PayloadBlock &payload = dynamic_cast<const dtn::data::PayloadBlock&>(obj);
+
+				return serialize(payload, 0, payload.getLength());
+			} catch (const std::bad_cast&) {
+				return dtn::data::DefaultSerializer::operator<<(obj);
+			}
+		}
+
+		dtn::data::Serializer& TCPSession::PartSerializer::serialize(const dtn::data::PayloadBlock& obj, const dtn::data::Length &clip_offset, const dtn::data::Length &clip_length)
+		{
+			ibrcommon::BLOB::Reference ref = obj.getBLOB();
+			std::string path;
+
+			try {
+				path = (*ref).getFile().getPath();
+			} catch (const ibrcommon::IOException&) {
+				// the payload is held in memory
+				return dtn::data::DefaultSerializer::serialize(obj, clip_offset, clip_length);
+			}
+
+			// get the remaining payload size
+			const dtn::data::Length payload_size = obj.getLength();
+
+			// check if the remaining data length is >= clip_length
+			dtn::data::Length frag_len = (clip_offset < payload_size) ? payload_size - clip_offset : 0;
+
+			// limit the fragment length to the clip length
+			if (frag_len > clip_length) frag_len = clip_length;
+
+			writeBlockHeader(obj, frag_len);
+			flush();
+
+			if (frag_len > 0)
+			{
+				// reference the range of the file instead of copying the data
+				SendPart part;
+				part.path = path;
+				part.offset = (*ref).getFileOffset() + clip_offset;
+				part.length = frag_len;
+				_parts.push_back(part);
+
+				// keep the BLOB until the transfer is done
+				_blobs.push_back(ref);
+			}
+
+			return (*this);
+		}
+
+		void TCPSession::PartSerializer::flush()
+		{
+			const std::string data = _buffer.str();
+			if (data.empty()) return;
+
+			SendPart part;
+			part.data = data;
+			part.offset = 0;
+			part.length = data.size();
+			_parts.push_back(part);
+
+			_buffer.str("");
+		}
+
+		size_t TCPSession::__sdnv_length(const char *data, size_t len) throw (ibrcommon::Exception)
+		{
+			for (size_t i = 0; i < len; ++i)
+			{
+				// the last byte of a SDNV has the highest bit unset
+				if ((data[i] & 0x80) == 0) return i + 1;
+
+				if (i >= 10) throw dtn::InvalidProtocolException("SDNV is too long");
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,445 @@
+/*
+ * TCPSession.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef TCPSESSION_H_
+#define TCPSESSION_H_
+
+#include "core/Node.h"
+#include "core/Metrics.h"
+#include "net/BundleTransfer.h"
+
+#include <ibrdtn/data/Number.h>
+#include <ibrdtn/data/Serializer.h>
+#include <ibrdtn/data/PayloadBlock.h>
+#include <ibrdtn/streams/StreamContactHeader.h>
+#include <ibrdtn/streams/StreamDataSegment.h>
+
+#include <ibrcommon/data/BLOB.h>
+#include <ibrcommon/net/socket.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <ibrcommon/thread/TimerWheel.h>
+#include <ibrcommon/refcnt_ptr.h>
+
+#include <sys/socket.h>
+#include <string>
+#include <sstream>
+#include <queue>
+#include <deque>
+#include <list>
+
+namespace dtn
+{
+	namespace net
+	{
+		class TCPConvergenceLayer;
+		class TCPEventLoop;
+
+		/**
+		 * A TCPSession is the event-driven counterpart of the TCPConnection. It speaks
+		 * the same TCP convergence layer protocol as the StreamConnection, but all
+		 * socket operations are non-blocking and driven by one of the I/O threads of
+		 * the TCPEventLoop. Work which may block (name resolution, loading and
+		 * serializing outgoing bundles, processing received bundles) is handed to
+		 * the workers of the TCPEventLoop as a Task.
+		 * Only queue() and shutdown() may be called from other threads.
+		 */
+		class TCPSession
+		{
+			friend class TCPEventLoop;
+
+			static const std::string TAG;
+		public:
+			/**
+			 * Create a new session. If the socket is NULL, the session
+			 * connects to the given node on setup().
+			 */
+			TCPSession(TCPConvergenceLayer &cl, TCPEventLoop &loop, const dtn::core::Node &node, ibrcommon::clientsocket *sock, const dtn::data::Timeout timeout);
+			virtual ~TCPSession();
+
+			/**
+			 * Returns the id of the session. Ids are unique during the lifetime
+			 * of the process, in contrast to the address of a session.
+			 */
+			size_t getId() const;
+
+			/**
+			 * Get the associated Node object
+			 */
+			const dtn::core::Node& getNode() const;
+
+			/**
+			 * Get the header of the peer
+			 */
+			const dtn::streams::StreamContactHeader& getHeader() const;
+
+			/**
+			 * queue a bundle for this session
+			 * This method is thread-safe.
+			 */
+			void queue(const dtn::net::BundleTransfer &job);
+
+			/**
+			 * Request a shutdown of this session.
+			 * This method is thread-safe.
+			 */
+			void shutdown();
+
+			bool match(const dtn::core::Node &n) const;
+			bool match(const dtn::data::EID &destination) const;
+
+			/**
+			 * Work done by a worker of the TCPEventLoop on behalf of a session.
+			 * The session may be gone once the work is done, then the result
+			 * is dropped.
+			 */
+			class Task
+			{
+			public:
+				Task(TCPSession &session);
+
+				/**
+				 * @param session The id of the session
+				 */
+				Task(const size_t session);
+				virtual ~Task();
+
+				/**
+				 * Do the work, called by a worker thread
+				 */
+				virtual void run() throw () = 0;
+
+				/**
+				 * Hand the result to the session, called by the I/O thread
+				 * of the session if the session still exists
+				 */
+				virtual void complete(TCPSession &session) throw () = 0;
+
+				// id of the session to find it again, a later session may
+				// be located at the address of a removed session
+				const size_t session;
+			};
+
+			typedef refcnt_ptr<Task> task_ref;
+
+		private:
+			enum State
+			{
+				SESSION_RESOLVING,
+				SESSION_CONNECTING,
+				SESSION_HANDSHAKE,
+				SESSION_ESTABLISHED,
+				SESSION_CLOSED
+			};
+
+			/**
+			 * Entry of the session on the shared timer wheel. On expiration
+			 * the I/O thread of the session is notified to check the deadline.
+			 */
+			class DeadlineTimer : public ibrcommon::TimerWheel::Entry
+			{
+			public:
+				DeadlineTimer(TCPSession &session);
+				virtual ~DeadlineTimer();
+
+				virtual void expired() throw ();
+
+			private:
+				TCPEventLoop &_loop;
+				const size_t _session;
+			};
+
+			/**
+			 * A part of a serialized bundle. The data is either held in memory
+			 * or is a range of a file holding the payload of the bundle.
+			 */
+			struct SendPart
+			{
+				std::string data;
+				std::string path;
+				dtn::data::Length offset;
+				dtn::data::Length length;
+			};
+
+			/**
+			 * This serializer splits a bundle into parts. Payload data stored in files
+			 * is not copied, instead the range of the file is referenced by a part to
+			 * send it later directly from the file to the socket.
+			 */
+			class PartSerializer : public dtn::data::DefaultSerializer
+			{
+			public:
+				PartSerializer(std::stringstream &buffer, std::list<SendPart> &parts, std::list<ibrcommon::BLOB::Reference> &blobs);
+				virtual ~PartSerializer();
+
+				using dtn::data::DefaultSerializer::operator<<;
+				virtual dtn::data::Serializer &operator<<(const dtn::data::Block &obj);
+
+				/**
+				 * Move the buffered data into a new part
+				 */
+				void flush();
+
+			protected:
+				virtual dtn::data::Serializer &serialize(const dtn::data::PayloadBlock& obj, const dtn::data::Length &clip_offset, const dtn::data::Length &clip_length);
+
+			private:
+				std::stringstream &_buffer;
+				std::list<SendPart> &_parts;
+				std::list<ibrcommon::BLOB::Reference> &_blobs;
+			};
+
+			// candidate addresses for outgoing connections
+			struct Address
+			{
+				struct sockaddr_storage addr;
+				socklen_t len;
+				std::string uri;
+			};
+
+			/**
+			 * A bundle serialized into parts, ready to be sent
+			 */
+			struct Prepared
+			{
+				Prepared(const dtn::net::BundleTransfer &t);
+
+				dtn::net::BundleTransfer transfer;
+				std::list<SendPart> parts;
+				std::list<ibrcommon::BLOB::Reference> blobs;
+				dtn::data::Length length;
+				dtn::data::Length resume_offset;
+			};
+
+			/**
+			 * Resolves the addresses of the node to connect to
+			 */
+			class ResolveTask : public Task
+			{
+			public:
+				ResolveTask(TCPSession &session);
+				virtual ~ResolveTask();
+				virtual void run() throw ();
+				virtual void complete(TCPSession &session) throw ();
+
+			private:
+				const std::list<dtn::core::Node::URI> _uris;
+				std::list<Address> _addresses;
+			};
+
+			/**
+			 * Loads a bundle out of the storage and serializes it into parts
+			 */
+			class PrepareTask : public Task
+			{
+			public:
+				PrepareTask(TCPSession &session, const dtn::net::BundleTransfer &transfer);
+				virtual ~PrepareTask();
+				virtual void run() throw ();
+				virtual void complete(TCPSession &session) throw ();
+
+			private:
+				const dtn::data::EID _neighbor;
+				const dtn::data::EID _peer;
+				const dtn::core::Node::Protocol _protocol;
+				Prepared _result;
+				bool _ready;
+			};
+
+			/**
+			 * Deserializes a received bundle and injects it into the core
+			 */
+			class DeliverTask : public Task
+			{
+			public:
+				DeliverTask(TCPSession &session, const ibrcommon::BLOB::Reference &data, bool fragment, const size_t response);
+				virtual ~DeliverTask();
+				virtual void run() throw ();
+				virtual void complete(TCPSession &session) throw ();
+
+			private:
+				ibrcommon::BLOB::Reference _data;
+				const bool _fragment;
+				const dtn::data::EID _peer;
+				const dtn::core::Node::Protocol _protocol;
+				const size_t _response;
+				bool _accepted;
+			};
+
+			/**
+			 * The response to a received segment. The response to the last segment
+			 * of a bundle is pending until the bundle has been processed.
+			 */
+			struct Response
+			{
+				dtn::data::Number size;
+				bool pending;
+				bool accepted;
+			};
+
+			/**
+			 * Methods called by the I/O thread owning this session
+			 */
+			bool setup(const dtn::data::Timestamp &now) throw ();
+			void onReadable(const dtn::data::Timestamp &now) throw ();
+			void onWritable(const dtn::data::Timestamp &now) throw ();
+			void onNotify(const dtn::data::Timestamp &now) throw ();
+			void onTimeout(const dtn::data::Timestamp &now) throw ();
+			void finalize() throw ();
+
+			int fd() const;
+			bool closed() const;
+			bool wantWrite() const;
+			dtn::data::Timestamp getDeadline() const;
+
+			/**
+			 * connection setup
+			 */
+			bool __connect() throw ();
+			bool __connected() throw ();
+			void __established(const dtn::data::Timestamp &now) throw ();
+			void __close() throw ();
+
+			/**
+			 * input processing
+			 */
+			bool __parse(const dtn::data::Timestamp &now) throw (ibrcommon::Exception);
+			bool __parse_header() throw (ibrcommon::Exception);
+			bool __parse_segment(const dtn::data::Timestamp &now) throw (ibrcommon::Exception);
+			void __receive_data(const char *data, size_t len) throw (ibrcommon::Exception);
+			void __segment_complete() throw ();
+			void __delivered(const size_t response, bool accepted) throw ();
+			void __respond() throw ();
+
+			/**
+			 * output processing
+			 */
+			void __fill() throw ();
+			bool __next() throw ();
+			void __request() throw ();
+			void __prepared(Prepared &result, bool ready) throw ();
+			void __flush(const dtn::data::Timestamp &now) throw ();
+			void __clear_parts() throw ();
+			void __send(const dtn::streams::StreamDataSegment &seg) throw ();
+
+			/**
+			 * transfer events
+			 */
+			void __ack(const dtn::data::Length &ack) throw ();
+			void __refused() throw ();
+			void __forwarded() throw ();
+			void __clear_queue() throw ();
+
+			/**
+			 * Returns the number of bytes of a complete SDNV at the beginning of
+			 * the given data or zero if the SDNV is not complete yet.
+			 */
+			static size_t __sdnv_length(const char *data, size_t len) throw (ibrcommon::Exception);
+
+			// the id of the next session
+			static volatile size_t __next_id;
+
+			const size_t _id;
+			TCPConvergenceLayer &_callback;
+			TCPEventLoop &_loop;
+			dtn::core::Node _node;
+			dtn::streams::StreamContactHeader _peer;
+			const dtn::data::Timeout _timeout;
+
+			int _fd;
+			State _state;
+
+			std::list<Address> _addresses;
+
+			/* flags to be used in this nodes StreamContactHeader */
+			dtn::data::Bitset<dtn::streams::StreamContactHeader::HEADER_BITS> _flags;
+
+			// peer capabilities
+			bool _ack_support;
+			bool _nack_support;
+
+			// timestamps for timeouts and keepalives
+			dtn::data::Timestamp _started;
+			dtn::data::Timestamp _last_recv;
+			dtn::data::Timestamp _last_sent;
+			dtn::data::Timestamp _last_activity;
+			dtn::data::Timeout _idle_timeout;
+
+			// input buffer
+			std::string _inbuf;
+			size_t _inpos;
+
+			// receive state
+			ibrcommon::BLOB::Reference *_recv_blob;
+			dtn::data::Number _recv_size;
+			dtn::data::Length _recv_remain;
+			uint8_t _recv_flags;
+
+			// responses to received segments in order of the segments
+			std::deque<Response> _responses;
+			size_t _responses_base;
+
+			// output buffer
+			std::string _outbuf;
+			size_t _outpos;
+
+			// segments queued while a range of a file is pending
+			std::string _trailer;
+			const dtn::data::Length _chunksize;
+
+			// send state
+			std::list<SendPart> _send_parts;
+			std::list<ibrcommon::BLOB::Reference> _send_blobs;
+			dtn::data::Length _send_part_offset;
+			dtn::data::Length _send_offset;
+			dtn::data::Length _send_length;
+			bool _send_skip;
+
+			// next bundle to send and whether a worker is preparing one
+			std::list<Prepared> _prepared;
+			bool _preparing;
+
+			// range of a file which has to be sent after the output buffer
+			int _file_fd;
+			dtn::data::Length _file_offset;
+			dtn::data::Length _file_remain;
+
+			// pending and sent transfers
+			ibrcommon::Mutex _queue_lock;
+			std::queue<dtn::net::BundleTransfer> _jobs;
+			bool _shutdown_requested;
+
+			std::queue<dtn::net::BundleTransfer> _sentqueue;
+			// flags and queuing time of segments waiting for an ACK
+			std::deque<std::pair<uint8_t, dtn::core::Metrics::value_type> > _unacked;
+			size_t _refused_segments;
+			dtn::data::Length _lastack;
+			dtn::data::Length _resume_offset;
+
+			// timer and epoll state (managed by the TCPEventLoop)
+			DeadlineTimer _timer;
+			dtn::data::Timestamp _timer_deadline;
+			int _registered_fd;
+			bool _epoll_out;
+		};
+	}
+}
+
+#endif /* TCPSESSION_H_ */
@@ -57,7 +57,8 @@ namespace dtn
 		const int UDPConvergenceLayer::DEFAULT_PORT = 4556;
 
 		UDPConvergenceLayer::UDPConvergenceLayer(ibrcommon::vinterface net, int port, dtn::data::Length mtu)
-		 : _net(net), _port(port), m_maxmsgsize(mtu), _running(false), _stats_in(0), _stats_out(0)
+		 : _net(net), _port(port), m_maxmsgsize(mtu), _running(false), _stats_in(0), _stats_out(0),
+		   _traffic_in(getTrafficCounter(dtn::core::Node::CONN_UDPIP, "in")), _traffic_out(getTrafficCounter(dtn::core::Node::CONN_UDPIP, "out"))
 		{
 		}
 
@@ -232,30 +233,30 @@ namespace dtn
 					IBRCOMMON_LOGGER_DEBUG_TAG("UDPConvergenceLayer", 30) << "MTU of " << m_maxmsgsize << " is too small to carry " << psize << " bytes of payload." << IBRCOMMON_LOGGER_ENDL;
 					IBRCOMMON_LOGGER_DEBUG_TAG("UDPConvergenceLayer", 30) << "create " << fragment_count << " fragments with " << fragment_size << " bytes each." << IBRCOMMON_LOGGER_ENDL;
 
+					// each fragment fits into one message
+					std::vector<char> data(m_maxmsgsize);
+
 					for (size_t i = 0; i < fragment_count; ++i)
 					{
 						dtn::data::BundleFragment fragment(bundle, i * fragment_size, fragment_size);
 
-						std::stringstream ss;
-						dtn::data::DefaultSerializer serializer(ss);
-
+						dtn::data::BufferSerializer serializer(&data[0], data.size());
 						serializer << fragment;
-						std::string data = ss.str();
 
 						// send out the bundle data
-						send(addr, data);
+						send(addr, &data[0], serializer.getWritten());
 					}
 				}
 				else
 				{
-					std::stringstream ss;
-					dtn::data::DefaultSerializer serializer(ss);
+					// serialize the bundle into a buffer of the exact size
+					std::vector<char> data(size);
 
+					dtn::data::BufferSerializer serializer(&data[0], data.size(), dict);
 					serializer << bundle;
-					std::string data = ss.str();
 
 					// send out the bundle data
-					send(addr, data);
+					send(addr, &data[0], serializer.getWritten());
 				}
 
 				// success - raise bundle event
@@ -265,6 +266,12 @@ namespace dtn
 				// send transfer aborted event
 				dtn::net::BundleTransfer local_job = job;
 				local_job.abort(dtn::net::TransferAbortedEvent::REASON_BUNDLE_DELETED);
+			} catch (const dtn::SerializationFailedException &ex) {
+				// the bundle does not fit into a message
+				IBRCOMMON_LOGGER_DEBUG_TAG("UDPConvergenceLayer", 10) << "serialization failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+
+				dtn::net::BundleTransfer local_job = job;
+				local_job.abort(dtn::net::TransferAbortedEvent::REASON_UNDEFINED);
 			} catch (const ibrcommon::socket_exception&) {
 				// CL is busy, requeue bundle
 			} catch (const NoAddressFoundException &ex) {
@@ -274,7 +281,7 @@ namespace dtn
 			}
 		}
 
-		void UDPConvergenceLayer::send(const ibrcommon::vaddress &addr, const std::string &data) throw (ibrcommon::socket_exception, NoAddressFoundException)
+		void UDPConvergenceLayer::send(const ibrcommon::vaddress &addr, const char *data, const size_t len) throw (ibrcommon::socket_exception, NoAddressFoundException)
 		{
 			// set write lock
 			ibrcommon::MutexLock l(m_writelock);
@@ -285,10 +292,11 @@ namespace dtn
 				ibrcommon::udpsocket &sock = dynamic_cast<ibrcommon::udpsocket&>(**iter);
 
 				// send converted line back to client.
-				sock.sendto(data.c_str(), data.length(), 0, addr);
+				sock.sendto(data, len, 0, addr);
 
 				// add statistic data
-				_stats_out += data.length();
+				_stats_out += len;
+				_traffic_out.add(len);
 
 				// success
 				return;
@@ -318,18 +326,15 @@ namespace dtn
 
 				// add statistic data
 				_stats_in += len;
+				_traffic_in.add(len);
 
 				std::stringstream ss; ss << "udp://" << fromaddr.toString();
 				sender = dtn::data::EID(ss.str());
 
 				if (len > 0)
 				{
-					// read all data into a stream
-					std::stringstream ss;
-					ss.write(&data[0], len);
-
 					// get the bundle
-					dtn::data::DefaultDeserializer(ss, dtn::core::BundleCore::getInstance()) >> bundle;
+					dtn::data::BufferDeserializer(&data[0], len, dtn::core::BundleCore::getInstance()) >> bundle;
 				}
 			}
 		}
@@ -86,7 +86,7 @@ namespace dtn
 
 		private:
 			void receive(dtn::data::Bundle&, dtn::data::EID &sender) throw (ibrcommon::socket_exception, dtn::InvalidDataException);
-			void send(const ibrcommon::vaddress &addr, const std::string &data) throw (ibrcommon::socket_exception, NoAddressFoundException);
+			void send(const ibrcommon::vaddress &addr, const char *data, const size_t len) throw (ibrcommon::socket_exception, NoAddressFoundException);
 
 			ibrcommon::vsocket _vsocket;
 			ibrcommon::vinterface _net;
@@ -104,6 +104,8 @@ namespace dtn
 			// stats variables
 			size_t _stats_in;
 			size_t _stats_out;
+			const dtn::core::Metrics::Counter _traffic_in;
+			const dtn::core::Metrics::Counter _traffic_out;
 		};
 	}
 }
@@ -119,7 +119,8 @@ namespace dtn
 			_extension_state = true;
 
 			// trigger all routing modules to react to initial topology
-			const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+			const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+			const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 			for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 			{
@@ -320,6 +321,9 @@ namespace dtn
 					_neighbor_database.create( event.getNode().getEID() );
 				}
 
+				// create the per-peer metrics before the first search
+				__eventNeighborChanged(event.getNode().getEID(), true);
+
 				// trigger all routing modules to search for bundles to forward
 				__eventDataChanged(event.getNode().getEID());
 			}
@@ -335,12 +339,16 @@ namespace dtn
 					_neighbor_database.get( event.getNode().getEID() ).reset();
 				} catch (const NeighborDatabase::EntryNotFoundException&) { };
 
+				// release the per-peer metrics
+				__eventNeighborChanged(event.getNode().getEID(), false);
+
 				// trigger transfer slot changed event to purge pending
 				// transfers from the extensions
 				__eventTransferSlotChanged(event.getNode().getEID());
 
 				// new bundles trigger a re-check for all neighbors
-				const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+				const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+				const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 				for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 				{
@@ -410,7 +418,8 @@ namespace dtn
 					ibrcommon::MutexLock l(_neighbor_database);
 
 					// get all active neighbors
-					const std::set<dtn::core::Node> neighbors = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+					const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+					const std::set<dtn::core::Node> &neighbors = snapshot->getNeighbors();
 
 					// touch all active neighbors
 					for (std::set<dtn::core::Node>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
@@ -455,6 +464,19 @@ namespace dtn
 			}
 		}
 
+		void BaseRouter::__eventNeighborChanged(const dtn::data::EID &peer, bool available) throw ()
+		{
+			// update the metrics even if the extensions are down, otherwise
+			// the metrics of a neighbor would never be removed
+			for (extension_list::const_iterator iter = _extensions.begin(); iter != _extensions.end(); ++iter)
+			{
+				if (available)
+					(*iter)->addNeighborMetrics(peer);
+				else
+					(*iter)->removeNeighborMetrics(peer);
+			}
+		}
+
 		void BaseRouter::__eventBundleQueued(const dtn::data::EID &peer, const dtn::data::MetaBundle &meta) throw ()
 		{
 			// do not forward the event if the extensions are down
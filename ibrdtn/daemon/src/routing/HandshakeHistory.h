@@ -0,0 +1,110 @@
+/*
+ * HandshakeHistory.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef HANDSHAKEHISTORY_H_
+#define HANDSHAKEHISTORY_H_
+
+#include <ibrdtn/data/Number.h>
+#include <ibrdtn/utils/Clock.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <sys/time.h>
+#include <list>
+
+namespace dtn
+{
+	namespace routing
+	{
+		/**
+		 * Keeps the last versions of a handshake item to answer
+		 * requests with the difference to a version known by the peer.
+		 */
+		template<class T>
+		class HandshakeHistory
+		{
+		public:
+			HandshakeHistory(const size_t max = 16)
+			 : _max(max), _version(0)
+			{
+				// start with a time based version to avoid mismatches
+				// with versions known by peers before a restart
+				struct timeval tv;
+				dtn::utils::Clock::gettimeofday(&tv);
+				_version = (dtn::data::Size(tv.tv_sec) * 1000) + (tv.tv_usec / 1000);
+			}
+
+			virtual ~HandshakeHistory()
+			{
+			}
+
+			/**
+			 * Put the current state into the history. A new version
+			 * is assigned if the state differs from the latest one.
+			 * @return The version of the state
+			 */
+			dtn::data::Number put(const T &state)
+			{
+				ibrcommon::MutexLock l(_lock);
+
+				if (!_history.empty() && (_history.back().second == state))
+					return _history.back().first;
+
+				_version += 1;
+				_history.push_back(std::make_pair(_version, state));
+
+				// limit the number of stored versions
+				if (_history.size() > _max) _history.pop_front();
+
+				return _version;
+			}
+
+			/**
+			 * Get the state of a specific version.
+			 * @return False, if the version is not available anymore
+			 */
+			bool get(const dtn::data::Number &version, T &state) const
+			{
+				ibrcommon::MutexLock l(_lock);
+
+				for (typename history_list::const_reverse_iterator it = _history.rbegin(); it != _history.rend(); ++it)
+				{
+					if ((*it).first == version)
+					{
+						state = (*it).second;
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+		private:
+			typedef std::list<std::pair<dtn::data::Number, T> > history_list;
+			history_list _history;
+
+			const size_t _max;
+			dtn::data::Number _version;
+
+			mutable ibrcommon::Mutex _lock;
+		};
+	} /* namespace routing */
+} /* namespace dtn */
+#endif /* HANDSHAKEHISTORY_H_ */
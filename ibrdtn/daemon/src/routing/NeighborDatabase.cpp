@@ -93,6 +93,11 @@ namespace dtn
 			return (_filter_state == FILTER_AVAILABLE);
 		}
 
+		const ibrcommon::BloomFilter& NeighborDatabase::NeighborEntry::getFilter() const
+		{
+			return _filter;
+		}
+
 		bool NeighborDatabase::NeighborEntry::isExpired(const dtn::data::Timestamp &timestamp) const
 		{
 			// expired after 15 minutes
@@ -147,16 +152,30 @@ namespace dtn
 
 		void NeighborDatabase::NeighborEntry::acquireTransfer(const dtn::data::BundleID &id) throw (NoMoreTransfersAvailable, AlreadyInTransitException)
 		{
-			// check if enough resources available to transfer the bundle
-			if (_transit_bundles.size() >= dtn::core::BundleCore::max_bundles_in_transit) throw NoMoreTransfersAvailable(eid);
+			switch (tryAcquireTransfer(id))
+			{
+			case TRANSFER_NO_SLOTS:
+				throw NoMoreTransfersAvailable(eid);
 
-			// check if the bundle is already in transit
-			if (_transit_bundles.find(id) != _transit_bundles.end()) throw AlreadyInTransitException();
+			case TRANSFER_IN_TRANSIT:
+				throw AlreadyInTransitException();
 
-			// insert the bundle into the transit list
-			_transit_bundles.insert(id);
+			default:
+				break;
+			}
+		}
+
+		NeighborDatabase::TransferResult NeighborDatabase::NeighborEntry::tryAcquireTransfer(const dtn::data::BundleID &id) throw ()
+		{
+			// check if enough resources available to transfer the bundle
+			if (_transit_bundles.size() >= dtn::core::BundleCore::max_bundles_in_transit) return TRANSFER_NO_SLOTS;
+
+			// insert the bundle into the transit list, fails if the bundle is already in transit
+			if (!_transit_bundles.insert(id).second) return TRANSFER_IN_TRANSIT;
 
 			IBRCOMMON_LOGGER_DEBUG_TAG("NeighborDatabase", 20) << "acquire transfer of " << id.toString() << " to " << eid.getString() << " (" << _transit_bundles.size() << " bundles in transit)" << IBRCOMMON_LOGGER_ENDL;
+
+			return TRANSFER_ACQUIRED;
 		}
 
 		dtn::data::Size NeighborDatabase::NeighborEntry::getFreeTransferSlots() const
@@ -221,20 +240,24 @@ namespace dtn
 		}
 
 		NeighborDatabase::NeighborEntry& NeighborDatabase::get(const dtn::data::EID &eid, bool noCached) throw (EntryNotFoundException)
+		{
+			NeighborDatabase::NeighborEntry *entry = find(eid, noCached);
+			if (entry == NULL) throw EntryNotFoundException();
+			return *entry;
+		}
+
+		NeighborDatabase::NeighborEntry* NeighborDatabase::find(const dtn::data::EID &eid, bool noCached) throw ()
 		{
 			if (noCached && !dtn::core::BundleCore::getInstance().getConnectionManager().isNeighbor(eid))
-				throw NeighborDatabase::EntryNotFoundException();
+				return NULL;
 
 			neighbor_map::iterator iter = _entries.find(eid);
-			if (iter == _entries.end())
-			{
-				throw EntryNotFoundException();
-			}
+			if (iter == _entries.end()) return NULL;
 
 			// set last update timestamp
 			(*(*iter).second).touch();
 
-			return *(*iter).second;
+			return (*iter).second;
 		}
 
 		void NeighborDatabase::remove(const dtn::data::EID &eid)
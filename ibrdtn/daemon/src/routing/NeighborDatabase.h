@@ -92,6 +92,17 @@ namespace dtn
 				virtual ~DatasetNotAvailableException() throw () { };
 			};
 
+			/**
+			 * Result of a transfer request
+			 */
+			enum TransferResult
+			{
+				TRANSFER_ACQUIRED = 0,
+				TRANSFER_NO_SLOTS = 1,
+				TRANSFER_IN_TRANSIT = 2,
+				TRANSFER_NO_ENTRY = 3
+			};
+
 			class NeighborEntry
 			{
 			public:
@@ -118,6 +129,12 @@ namespace dtn
 				 */
 				void acquireTransfer(const dtn::data::BundleID &id) throw (NoMoreTransfersAvailable, AlreadyInTransitException);
 
+				/**
+				 * Acquire transfer resources without throwing exceptions.
+				 * @return TRANSFER_ACQUIRED on success, TRANSFER_NO_SLOTS or TRANSFER_IN_TRANSIT otherwise
+				 */
+				TransferResult tryAcquireTransfer(const dtn::data::BundleID &id) throw ();
+
 				/**
 				 * @return the number of free transfer slots
 				 */
@@ -154,6 +171,12 @@ namespace dtn
 				 */
 				bool isFilterValid() const;
 
+				/**
+				 * Returns the bloomfilter of this entry. The filter
+				 * is only meaningful if isFilterValid() returns true.
+				 */
+				const ibrcommon::BloomFilter& getFilter() const;
+
 				/**
 				 * Returns the last update of this entry
 				 */
@@ -169,17 +192,25 @@ namespace dtn
 				 */
 				template <class T>
 				const T& getDataset() const throw (DatasetNotAvailableException)
+				{
+					const T *dset = findDataset<T>();
+					if (dset == NULL) throw DatasetNotAvailableException();
+					return *dset;
+				}
+
+				/**
+				 * Retrieve a specific data-set.
+				 * @return A pointer to the data-set or NULL if it is not available
+				 */
+				template <class T>
+				const T* findDataset() const throw ()
 				{
 					NeighborDataset item(T::identifier);
 					data_set::const_iterator iter = _datasets.find(item);
 
-					if (iter == _datasets.end()) throw DatasetNotAvailableException();
+					if (iter == _datasets.end()) return NULL;
 
-					try {
-						return dynamic_cast<const T&>(**iter);
-					} catch (const std::bad_cast&) {
-						throw DatasetNotAvailableException();
-					}
+					return dynamic_cast<const T*>(&(**iter));
 				}
 
 				/**
@@ -240,6 +271,15 @@ namespace dtn
 			 */
 			NeighborDatabase::NeighborEntry& get(const dtn::data::EID &eid, bool noCached = false) throw (EntryNotFoundException);
 
+			/**
+			 * Query a neighbor entry of the database like get(), but
+			 * returns NULL if the neighbor is not available.
+			 * @param eid The EID of the neighbor
+			 * @param noCached Only returns an entry if the neighbor is available
+			 * @return A pointer to the neighbor entry or NULL.
+			 */
+			NeighborDatabase::NeighborEntry* find(const dtn::data::EID &eid, bool noCached = false) throw ();
+
 			/**
 			 * Query a neighbor entry of the database. If the entry does not
 			 * exists, a new entry is created and returned.
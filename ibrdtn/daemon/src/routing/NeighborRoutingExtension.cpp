@@ -31,13 +31,10 @@
 #include "net/ConnectionManager.h"
 #include "ibrcommon/thread/MutexLock.h"
 #include "storage/BundleStorage.h"
+#include "storage/BundleConstraints.h"
 #include "core/BundleEvent.h"
 #include <ibrcommon/Logger.h>
 
-#ifdef HAVE_SQLITE
-#include "storage/SQLiteBundleStorage.h"
-#endif
-
 #include <functional>
 #include <list>
 #include <algorithm>
@@ -66,21 +63,22 @@ namespace dtn
 
 		void NeighborRoutingExtension::run() throw ()
 		{
-#ifdef HAVE_SQLITE
-			class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::SQLiteDatabase::SQLBundleQuery
-#else
-			class BundleFilter : public dtn::storage::BundleSelector
-#endif
+			class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::IndexedBundleQuery
 			{
 			public:
 				BundleFilter(NeighborRoutingExtension &e, const NeighborDatabase::NeighborEntry &entry, const dtn::net::ConnectionManager::protocol_list &plist)
 				 : _extension(e), _entry(entry), _plist(plist)
-				{};
+				{
+					// only bundles addressed to the neighbor are routed
+					_constraints.setDestinationNode(_entry.eid);
+				};
 
 				virtual ~BundleFilter() {};
 
 				virtual dtn::data::Size limit() const throw () { return _entry.getFreeTransferSlots(); };
 
+				virtual const dtn::storage::BundleConstraints& getConstraints() const throw () { return _constraints; };
+
 				virtual bool addIfSelected(dtn::storage::BundleResult &result, const dtn::data::MetaBundle &meta) const throw (dtn::storage::BundleSelectorException)
 				{
 					// check if the considered bundle should get routed
@@ -93,24 +91,11 @@ namespace dtn
 					return ret.first;
 				};
 
-#ifdef HAVE_SQLITE
-				const std::string getWhere() const throw ()
-				{
-					return "destination LIKE ?";
-				};
-
-				int bind(sqlite3_stmt *st, int offset) const throw ()
-				{
-					const std::string d = _entry.eid.getNode().getString() + "%";
-					sqlite3_bind_text(st, offset, d.c_str(), static_cast<int>(d.size()), SQLITE_TRANSIENT);
-					return offset + 1;
-				}
-#endif
-
 			private:
 				NeighborRoutingExtension &_extension;
 				const NeighborDatabase::NeighborEntry &_entry;
 				const dtn::net::ConnectionManager::protocol_list &_plist;
+				dtn::storage::BundleConstraints _constraints;
 			};
 
 			RoutingResult list;
@@ -132,6 +117,7 @@ namespace dtn
 					 */
 					try {
 						SearchNextBundleTask &task = dynamic_cast<SearchNextBundleTask&>(*t);
+						dtn::core::Metrics::Timer timer(getSearchLatency(task.eid));
 
 						// clear the result list
 						list.clear();
@@ -304,7 +290,8 @@ namespace dtn
 		void NeighborRoutingExtension::eventBundleQueued(const dtn::data::EID &peer, const dtn::data::MetaBundle &meta) throw ()
 		{
 			// try to deliver new bundles to all neighbors
-			const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+			const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+			const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 			for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 			{
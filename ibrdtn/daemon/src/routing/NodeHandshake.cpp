@@ -20,6 +20,8 @@
  */
 
 #include "routing/NodeHandshake.h"
+#include <ibrdtn/data/Exceptions.h>
+#include <algorithm>
 
 namespace dtn
 {
@@ -66,6 +68,21 @@ namespace dtn
 			return _requests;
 		}
 
+		void NodeHandshake::addRequest(const dtn::data::Number &identifier, const dtn::data::Number &version)
+		{
+			_requests.insert(identifier);
+			_versions[identifier] = version;
+		}
+
+		const dtn::data::Number& NodeHandshake::getRequestVersion(const dtn::data::Number &identifier) const
+		{
+			static const dtn::data::Number none(0);
+
+			version_map::const_iterator it = _versions.find(identifier);
+			if (it == _versions.end()) return none;
+			return (*it).second;
+		}
+
 		const NodeHandshake::item_set& NodeHandshake::getItems() const
 		{
 			return _items;
@@ -142,6 +159,9 @@ namespace dtn
 				{
 					const dtn::data::Number &item = (*iter);
 					ss << " " << item.toString();
+
+					const dtn::data::Number &version = getRequestVersion(item);
+					if (version > 0) ss << "@" << version.toString();
 				}
 			}
 			else if (getType() == NodeHandshake::HANDSHAKE_RESPONSE)
@@ -176,6 +196,18 @@ namespace dtn
 					dtn::data::Number req(*iter);
 					stream << req;
 				}
+
+				// append the known versions of requested items, peers
+				// without support for versions stop reading before
+				if ((hs.getType() == NodeHandshake::HANDSHAKE_REQUEST) && !hs._versions.empty())
+				{
+					stream << dtn::data::Number(hs._versions.size());
+
+					for (NodeHandshake::version_map::const_iterator iter = hs._versions.begin(); iter != hs._versions.end(); ++iter)
+					{
+						stream << (*iter).first << (*iter).second;
+					}
+				}
 			}
 			else if (hs.getType() == NodeHandshake::HANDSHAKE_RESPONSE)
 			{
@@ -225,6 +257,20 @@ namespace dtn
 					stream >> req;
 					hs._requests.insert(req);
 				}
+
+				// read the versions of requested items if available
+				if ((hs.getType() == NodeHandshake::HANDSHAKE_REQUEST) && (stream.peek() != std::char_traits<char>::eof()))
+				{
+					dtn::data::Number number_of_versions;
+					stream >> number_of_versions;
+
+					for (size_t i = 0; number_of_versions > i; ++i)
+					{
+						dtn::data::Number id, version;
+						stream >> id >> version;
+						hs._versions[id] = version;
+					}
+				}
 			}
 			else if (hs.getType() == NodeHandshake::HANDSHAKE_RESPONSE)
 			{
@@ -390,6 +436,206 @@ namespace dtn
 
 		const dtn::data::Number BloomFilterPurgeVector::identifier = NodeHandshakeItem::BLOOM_FILTER_PURGE_VECTOR;
 
+		BloomFilterSummaryDelta::BloomFilterSummaryDelta()
+		 : NeighborDataSetImpl(BloomFilterSummaryDelta::identifier), _version(0), _base(0), _checksum(0)
+		{
+		}
+
+		BloomFilterSummaryDelta::BloomFilterSummaryDelta(const dtn::data::Number &version, const std::vector<unsigned char> &table)
+		 : NeighborDataSetImpl(BloomFilterSummaryDelta::identifier), _version(version), _base(0), _checksum(checksum(table)), _table(table)
+		{
+		}
+
+		BloomFilterSummaryDelta::BloomFilterSummaryDelta(const dtn::data::Number &version, const std::vector<unsigned char> &table,
+				const dtn::data::Number &base, const std::vector<unsigned char> &base_table)
+		 : NeighborDataSetImpl(BloomFilterSummaryDelta::identifier), _version(version), _base(base), _checksum(checksum(table)), _table(table)
+		{
+			// send the complete vector if the size has been changed
+			if (base_table.size() != table.size())
+			{
+				_base = 0;
+				return;
+			}
+
+			// a range header costs at least two bytes, thus
+			// unchanged gaps shorter than that are included
+			const size_t max_gap = 2;
+
+			size_t i = 0;
+			while (i < table.size())
+			{
+				// skip unchanged bytes
+				if (table[i] == base_table[i]) { ++i; continue; }
+
+				const size_t offset = i;
+				size_t end = i + 1;
+
+				// extend the range until the gap is too large
+				for (size_t j = end; (j < table.size()) && ((j - end) <= max_gap); ++j)
+				{
+					if (table[j] != base_table[j]) end = j + 1;
+				}
+
+				_ranges.push_back(std::make_pair(offset, end - offset));
+				i = end;
+			}
+		}
+
+		BloomFilterSummaryDelta::~BloomFilterSummaryDelta()
+		{
+		}
+
+		uint32_t BloomFilterSummaryDelta::checksum(const std::vector<unsigned char> &table)
+		{
+			// FNV-1a hash over the table
+			uint32_t hash = 2166136261U;
+			for (std::vector<unsigned char>::const_iterator it = table.begin(); it != table.end(); ++it)
+			{
+				hash ^= (*it);
+				hash *= 16777619U;
+			}
+			return hash;
+		}
+
+		const dtn::data::Number& BloomFilterSummaryDelta::getIdentifier() const
+		{
+			return identifier;
+		}
+
+		const dtn::data::Number& BloomFilterSummaryDelta::getVersion() const
+		{
+			return _version;
+		}
+
+		const dtn::data::Number& BloomFilterSummaryDelta::getBase() const
+		{
+			return _base;
+		}
+
+		const std::vector<unsigned char>& BloomFilterSummaryDelta::getTable() const
+		{
+			return _table;
+		}
+
+		const ibrcommon::BloomFilter BloomFilterSummaryDelta::getFilter() const
+		{
+			ibrcommon::BloomFilter filter;
+			if (!_table.empty()) filter.load(&_table[0], _table.size());
+			return filter;
+		}
+
+		bool BloomFilterSummaryDelta::apply(const BloomFilterSummaryDelta &previous)
+		{
+			// nothing to do for complete vectors
+			if (_base == 0) return true;
+
+			// the previous vector has to match the base of this difference
+			if (previous._version != _base) return false;
+			if (previous._table.size() != _table.size()) return false;
+
+			std::vector<unsigned char> table = previous._table;
+
+			for (range_list::const_iterator it = _ranges.begin(); it != _ranges.end(); ++it)
+			{
+				std::copy(_table.begin() + (*it).first, _table.begin() + (*it).first + (*it).second, table.begin() + (*it).first);
+			}
+
+			if (checksum(table) != _checksum) return false;
+
+			_table.swap(table);
+			_ranges.clear();
+			_base = 0;
+
+			return true;
+		}
+
+		dtn::data::Length BloomFilterSummaryDelta::getLength() const
+		{
+			dtn::data::Length len = _version.getLength() + _base.getLength()
+					+ dtn::data::Number(_checksum).getLength() + dtn::data::Number(_table.size()).getLength();
+
+			if (_base == 0) return len + _table.size();
+
+			len += dtn::data::Number(_ranges.size()).getLength();
+
+			size_t last = 0;
+			for (range_list::const_iterator it = _ranges.begin(); it != _ranges.end(); ++it)
+			{
+				len += dtn::data::Number((*it).first - last).getLength() + dtn::data::Number((*it).second).getLength() + (*it).second;
+				last = (*it).first + (*it).second;
+			}
+
+			return len;
+		}
+
+		std::ostream& BloomFilterSummaryDelta::serialize(std::ostream &stream) const
+		{
+			stream << _version << _base << dtn::data::Number(_checksum) << dtn::data::Number(_table.size());
+
+			if (_base == 0)
+			{
+				if (!_table.empty()) stream.write((const char*)&_table[0], _table.size());
+				return stream;
+			}
+
+			stream << dtn::data::Number(_ranges.size());
+
+			// each range is encoded with the gap to the previous range
+			size_t last = 0;
+			for (range_list::const_iterator it = _ranges.begin(); it != _ranges.end(); ++it)
+			{
+				stream << dtn::data::Number((*it).first - last) << dtn::data::Number((*it).second);
+				stream.write((const char*)&_table[(*it).first], (*it).second);
+				last = (*it).first + (*it).second;
+			}
+
+			return stream;
+		}
+
+		std::istream& BloomFilterSummaryDelta::deserialize(std::istream &stream)
+		{
+			dtn::data::Number checksum, length;
+			stream >> _version >> _base >> checksum >> length;
+
+			_checksum = checksum.get<uint32_t>();
+			_ranges.clear();
+			_table.clear();
+			_table.resize(length.get<size_t>());
+
+			if (_base == 0)
+			{
+				if (!_table.empty()) stream.read((char*)&_table[0], _table.size());
+
+				if (BloomFilterSummaryDelta::checksum(_table) != _checksum)
+					throw dtn::InvalidDataException("summary vector checksum mismatch");
+
+				return stream;
+			}
+
+			dtn::data::Number ranges;
+			stream >> ranges;
+
+			size_t last = 0;
+			for (size_t i = 0; ranges > i; ++i)
+			{
+				dtn::data::Number gap, len;
+				stream >> gap >> len;
+
+				const size_t offset = last + gap.get<size_t>();
+				if ((offset + len.get<size_t>()) > _table.size())
+					throw dtn::InvalidDataException("summary vector range out of bounds");
+
+				if (len > 0) stream.read((char*)&_table[offset], len.get<size_t>());
+
+				_ranges.push_back(std::make_pair(offset, len.get<size_t>()));
+				last = offset + len.get<size_t>();
+			}
+
+			return stream;
+		}
+
+		const dtn::data::Number BloomFilterSummaryDelta::identifier = NodeHandshakeItem::BLOOM_FILTER_SUMMARY_DELTA;
+
 		RoutingLimitations::RoutingLimitations()
 		 : NeighborDataSetImpl(RoutingLimitations::identifier)
 		{
@@ -25,8 +25,11 @@
 #include "routing/NeighborDataset.h"
 #include <ibrdtn/data/BundleSet.h>
 #include <ibrdtn/data/SDNV.h>
+#include <ibrcommon/data/BloomFilter.h>
+#include <stdint.h>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <list>
 #include <set>
 #include <map>
@@ -45,7 +48,9 @@ namespace dtn
 				BLOOM_FILTER_PURGE_VECTOR = 2,
 				DELIVERY_PREDICTABILITY_MAP = 3,
 				PROPHET_ACKNOWLEDGEMENT_SET = 4,
-				ROUTING_LIMITATIONS = 5
+				ROUTING_LIMITATIONS = 5,
+				BLOOM_FILTER_SUMMARY_DELTA = 6,
+				DELIVERY_PREDICTABILITY_DELTA = 7
 			};
 
 			virtual ~NodeHandshakeItem() { };
@@ -91,6 +96,82 @@ namespace dtn
 			dtn::data::BundleSet _vector;
 		};
 
+		/**
+		 * Summary vector encoded as difference to a previous version of the vector.
+		 * If the peer does not know the requested base version, the complete vector
+		 * is sent instead (base version zero).
+		 */
+		class BloomFilterSummaryDelta : public NeighborDataSetImpl, public NodeHandshakeItem
+		{
+		public:
+			BloomFilterSummaryDelta();
+
+			/**
+			 * Create a complete summary vector
+			 * @param version The version of the vector
+			 * @param table The bloom-filter table of the vector
+			 */
+			BloomFilterSummaryDelta(const dtn::data::Number &version, const std::vector<unsigned char> &table);
+
+			/**
+			 * Create a summary vector encoded as difference to a previous version
+			 * @param version The version of the vector
+			 * @param table The bloom-filter table of the vector
+			 * @param base The version of the previous vector
+			 * @param base_table The bloom-filter table of the previous vector
+			 */
+			BloomFilterSummaryDelta(const dtn::data::Number &version, const std::vector<unsigned char> &table,
+					const dtn::data::Number &base, const std::vector<unsigned char> &base_table);
+
+			virtual ~BloomFilterSummaryDelta();
+			const dtn::data::Number& getIdentifier() const;
+			dtn::data::Length getLength() const;
+			std::ostream& serialize(std::ostream&) const;
+			std::istream& deserialize(std::istream&);
+			static const dtn::data::Number identifier;
+
+			/**
+			 * Returns the version of this vector
+			 */
+			const dtn::data::Number& getVersion() const;
+
+			/**
+			 * Returns the version this difference is based on or
+			 * zero if this is a complete vector
+			 */
+			const dtn::data::Number& getBase() const;
+
+			/**
+			 * Apply a received difference to the previous version of the vector
+			 * @return False, if the previous vector does not match
+			 */
+			bool apply(const BloomFilterSummaryDelta &previous);
+
+			/**
+			 * Returns the bloom-filter of this vector. Differences have to
+			 * be applied to the previous version first.
+			 */
+			const ibrcommon::BloomFilter getFilter() const;
+
+			/**
+			 * Returns the bloom-filter table of this vector
+			 */
+			const std::vector<unsigned char>& getTable() const;
+
+		private:
+			static uint32_t checksum(const std::vector<unsigned char> &table);
+
+			dtn::data::Number _version;
+			dtn::data::Number _base;
+			uint32_t _checksum;
+
+			std::vector<unsigned char> _table;
+
+			// changed ranges of the table (offset, length)
+			typedef std::list<std::pair<size_t, size_t> > range_list;
+			range_list _ranges;
+		};
+
 		class RoutingLimitations : public NeighborDataSetImpl, public NodeHandshakeItem
 		{
 		public:
@@ -128,6 +209,7 @@ namespace dtn
 			};
 
 			typedef std::set<dtn::data::Number> request_set;
+			typedef std::map<dtn::data::Number, dtn::data::Number> version_map;
 			typedef std::list<NodeHandshakeItem*> item_set;
 
 			NodeHandshake();
@@ -139,6 +221,19 @@ namespace dtn
 			bool hasRequest(const dtn::data::Number &identifier) const;
 			const request_set& getRequests() const;
 
+			/**
+			 * Request an item as difference to a previous version
+			 * known by the requester. The version is appended to the
+			 * request and ignored by peers without support for it.
+			 */
+			void addRequest(const dtn::data::Number &identifier, const dtn::data::Number &version);
+
+			/**
+			 * Returns the version of an item known by the requester or
+			 * zero, if no previous version is known.
+			 */
+			const dtn::data::Number& getRequestVersion(const dtn::data::Number &identifier) const;
+
 			void addItem(NodeHandshakeItem *item);
 			bool hasItem(const dtn::data::Number &identifier) const;
 			const item_set& getItems() const;
@@ -177,6 +272,7 @@ namespace dtn
 			dtn::data::Number _lifetime;
 
 			request_set _requests;
+			version_map _versions;
 			item_set _items;
 
 			StreamMap _raw_items;
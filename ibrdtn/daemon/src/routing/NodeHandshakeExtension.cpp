@@ -59,7 +59,30 @@ namespace dtn
 
 		void NodeHandshakeExtension::responseHandshake(const dtn::data::EID&, const NodeHandshake &request, NodeHandshake &answer)
 		{
-			if (request.hasRequest(BloomFilterSummaryVector::identifier))
+			if (request.hasRequest(BloomFilterSummaryDelta::identifier))
+			{
+				// get own summary vector
+				const dtn::data::BundleSet vec = (**this).getKnownBundles();
+				const ibrcommon::BloomFilter &filter = vec.getBloomFilter();
+				const std::vector<unsigned char> table(filter.table(), filter.table() + filter.size());
+
+				// assign a version to the current vector
+				const dtn::data::Number version = _summary_history.put(table);
+
+				// encode the vector as difference if the version known by the peer is still available
+				const dtn::data::Number &base = request.getRequestVersion(BloomFilterSummaryDelta::identifier);
+				std::vector<unsigned char> base_table;
+
+				if ((base > 0) && _summary_history.get(base, base_table))
+				{
+					answer.addItem(new BloomFilterSummaryDelta(version, table, base, base_table));
+				}
+				else
+				{
+					answer.addItem(new BloomFilterSummaryDelta(version, table));
+				}
+			}
+			else if (request.hasRequest(BloomFilterSummaryVector::identifier))
 			{
 				// add own summary vector to the message
 				const dtn::data::BundleSet vec = (**this).getKnownBundles();
@@ -119,6 +142,47 @@ namespace dtn
 				db.get(source.getNode()).update(filter, answer.getLifetime());
 			} catch (std::exception&) { };
 
+			try {
+				BloomFilterSummaryDelta &delta = answer.get<BloomFilterSummaryDelta>();
+
+				IBRCOMMON_LOGGER_DEBUG_TAG(NodeHandshakeExtension::TAG, 10) << "summary vector version " << delta.getVersion().toString() << " (base " << delta.getBase().toString() << ") received from " << source.getString() << IBRCOMMON_LOGGER_ENDL;
+
+				NeighborDatabase &db = (**this).getNeighborDB();
+				ibrcommon::MutexLock l(db);
+				NeighborDatabase::NeighborEntry &entry = db.get(source.getNode());
+
+				bool valid = (delta.getBase() == 0);
+
+				if (!valid)
+				{
+					try {
+						// apply the difference to the previous version
+						valid = delta.apply(entry.getDataset<BloomFilterSummaryDelta>());
+					} catch (const NeighborDatabase::DatasetNotAvailableException&) { }
+				}
+
+				if (valid)
+				{
+					// store the vector as base for the next difference
+					NeighborDataset ds(new BloomFilterSummaryDelta(delta));
+					entry.putDataset(ds);
+
+					// update the neighbor database with the received filter
+					entry.update(delta.getFilter(), answer.getLifetime());
+				}
+				else
+				{
+					IBRCOMMON_LOGGER_DEBUG_TAG(NodeHandshakeExtension::TAG, 10) << "summary vector version mismatch, request complete vector of " << source.getString() << IBRCOMMON_LOGGER_ENDL;
+
+					// drop the previous version to get the complete vector with the next handshake
+					entry.removeDataset<BloomFilterSummaryDelta>();
+
+					// expire the filter to trigger a new handshake
+					entry.reset();
+					_endpoint.removeFromBlacklist(source.getNode());
+				}
+			} catch (std::exception&) { };
+
 			try {
 				const BloomFilterPurgeVector bfpv = answer.get<BloomFilterPurgeVector>();
 
@@ -207,6 +271,17 @@ namespace dtn
 			} catch (std::exception&) { };
 		}
 
+		const dtn::data::Number NodeHandshakeExtension::getSummaryVersion(const dtn::data::EID &peer)
+		{
+			try {
+				NeighborDatabase &db = (**this).getNeighborDB();
+				ibrcommon::MutexLock l(db);
+				return db.get(peer.getNode()).getDataset<BloomFilterSummaryDelta>().getVersion();
+			} catch (const std::exception&) {
+				return 0;
+			}
+		}
+
 		void NodeHandshakeExtension::doHandshake(const dtn::data::EID &eid)
 		{
 			_endpoint.query(eid);
@@ -332,6 +407,12 @@ namespace dtn
 			// walk through all extensions to generate a request
 			(*_callback).requestHandshake(origin, request);
 
+			// request the summary vector as difference to the last received version
+			if (request.hasRequest(BloomFilterSummaryVector::identifier))
+			{
+				request.addRequest(BloomFilterSummaryDelta::identifier, _callback.getSummaryVersion(origin));
+			}
+
 			IBRCOMMON_LOGGER_DEBUG_TAG(NodeHandshakeExtension::TAG, 15) << "handshake query for " << origin.getString() << ": " << request.toString() << IBRCOMMON_LOGGER_ENDL;
 
 			// create a new bundle with a zero timestamp (+age block)
@@ -23,12 +23,14 @@
 #define NODEHANDSHAKEEXTENSION_H_
 
 #include "routing/RoutingExtension.h"
+#include "routing/HandshakeHistory.h"
 #include "core/AbstractWorker.h"
 #include "core/EventReceiver.h"
 #include "core/NodeEvent.h"
 
 #include <ibrcommon/thread/Mutex.h>
 #include <ibrcommon/thread/Queue.h>
+#include <vector>
 #include <map>
 
 namespace dtn
@@ -69,6 +71,12 @@ namespace dtn
 		protected:
 			void processHandshake(const dtn::data::Bundle &bundle);
 
+			/**
+			 * Returns the version of the last summary vector received
+			 * from the given peer or zero if there is none.
+			 */
+			const dtn::data::Number getSummaryVersion(const dtn::data::EID &peer);
+
 		private:
 			class HandshakeEndpoint : public dtn::core::AbstractWorker
 			{
@@ -95,6 +103,11 @@ namespace dtn
 			 */
 			HandshakeEndpoint _endpoint;
 
+			/**
+			 * recent versions of the own summary vector
+			 */
+			HandshakeHistory<std::vector<unsigned char> > _summary_history;
+
 			static const dtn::data::EID BROADCAST_ENDPOINT;
 		};
 	} /* namespace routing */
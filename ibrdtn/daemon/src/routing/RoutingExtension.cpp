@@ -22,6 +22,7 @@
 #include "routing/RoutingExtension.h"
 #include "routing/BaseRouter.h"
 #include "core/BundleCore.h"
+#include <ibrcommon/thread/MutexLock.h>
 #include <ibrcommon/Logger.h>
 
 namespace dtn
@@ -69,16 +70,36 @@ namespace dtn
 		 */
 		void RoutingExtension::transferTo(const dtn::data::EID &destination, const dtn::data::MetaBundle &meta, const dtn::core::Node::Protocol p)
 		{
-			// acquire the transfer of this bundle, could throw already in transit or no resource left exception
+			switch (tryTransferTo(destination, meta, p))
+			{
+			case NeighborDatabase::TRANSFER_NO_SLOTS:
+				throw NeighborDatabase::NoMoreTransfersAvailable(destination);
+
+			case NeighborDatabase::TRANSFER_IN_TRANSIT:
+				throw NeighborDatabase::AlreadyInTransitException();
+
+			case NeighborDatabase::TRANSFER_NO_ENTRY:
+				throw NeighborDatabase::EntryNotFoundException();
+
+			default:
+				break;
+			}
+		}
+
+		NeighborDatabase::TransferResult RoutingExtension::tryTransferTo(const dtn::data::EID &destination, const dtn::data::MetaBundle &meta, const dtn::core::Node::Protocol p) throw ()
+		{
+			// acquire the transfer of this bundle
 			{
 				// lock the list of neighbors
 				ibrcommon::MutexLock l((**this).getNeighborDB());
 
 				// get the neighbor entry for the next hop
-				NeighborDatabase::NeighborEntry &entry = (**this).getNeighborDB().get(destination, true);
+				NeighborDatabase::NeighborEntry *entry = (**this).getNeighborDB().find(destination, true);
+				if (entry == NULL) return NeighborDatabase::TRANSFER_NO_ENTRY;
 
-				// acquire the transfer, could throw already in transit or no resource left exception
-				entry.acquireTransfer(meta);
+				// acquire the transfer, could fail if the bundle is in transit or no resource is left
+				const NeighborDatabase::TransferResult ret = entry->tryAcquireTransfer(meta);
+				if (ret != NeighborDatabase::TRANSFER_ACQUIRED) return ret;
 			}
 			try{
 				//create the transfer object
@@ -90,10 +111,33 @@ namespace dtn
 				IBRCOMMON_LOGGER_DEBUG_TAG(RoutingExtension::TAG, 20) << "bundle " << meta.toString() << " queued by " << getTag() << " for " << destination.getString() << " via protocol " << dtn::core::Node::toString(p) << IBRCOMMON_LOGGER_ENDL;
 			} catch (const dtn::core::P2PDialupException&) {
 				// the bundle transfer queues the bundle for retransmission, thus abort the query here
-				throw NeighborDatabase::EntryNotFoundException();
+				return NeighborDatabase::TRANSFER_NO_ENTRY;
 			} catch (const ibrcommon::Exception &e) {
 				// ignore any other error
 			}
+
+			return NeighborDatabase::TRANSFER_ACQUIRED;
+		}
+
+		RoutingExtension::SearchResult RoutingExtension::transferTo(const dtn::data::EID &destination, const RoutingResult &list) throw ()
+		{
+			// send the bundles as long as we have resources
+			for (RoutingResult::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+			{
+				switch (tryTransferTo(destination, (*iter).first, (*iter).second))
+				{
+				case NeighborDatabase::TRANSFER_NO_SLOTS:
+					return SEARCH_NO_SLOTS;
+
+				case NeighborDatabase::TRANSFER_NO_ENTRY:
+					return SEARCH_NO_NEIGHBOR;
+
+				default:
+					break;
+				}
+			}
+
+			return SEARCH_COMPLETED;
 		}
 
 		void RoutingExtension::eventTransferSlotChanged(const dtn::data::EID &peer) throw ()
@@ -103,5 +147,39 @@ namespace dtn
 			eventDataChanged(peer);
 		}
 
+		std::string RoutingExtension::getSearchLatencyLabels(const dtn::data::EID &peer) const
+		{
+			return dtn::core::Metrics::label("routing", getTag()) + "," + dtn::core::Metrics::label("peer", peer.getString());
+		}
+
+		void RoutingExtension::addNeighborMetrics(const dtn::data::EID &peer)
+		{
+			ibrcommon::MutexLock l(_search_latency_lock);
+			if (_search_latency.find(peer) != _search_latency.end()) return;
+
+			_search_latency[peer] = dtn::core::Metrics::getInstance().getHistogram("dtnd_routing_search_microseconds", getSearchLatencyLabels(peer), "Time to search bundles for a peer");
+		}
+
+		void RoutingExtension::removeNeighborMetrics(const dtn::data::EID &peer)
+		{
+			ibrcommon::MutexLock l(_search_latency_lock);
+
+			std::map<dtn::data::EID, dtn::core::Metrics::Histogram>::iterator iter = _search_latency.find(peer);
+			if (iter == _search_latency.end()) return;
+
+			_search_latency.erase(iter);
+			dtn::core::Metrics::getInstance().remove("dtnd_routing_search_microseconds", getSearchLatencyLabels(peer));
+		}
+
+		dtn::core::Metrics::Histogram RoutingExtension::getSearchLatency(const dtn::data::EID &peer) const
+		{
+			ibrcommon::MutexLock l(_search_latency_lock);
+
+			std::map<dtn::data::EID, dtn::core::Metrics::Histogram>::const_iterator iter = _search_latency.find(peer);
+			if (iter == _search_latency.end()) return dtn::core::Metrics::Histogram();
+
+			return iter->second;
+		}
+
 	} /* namespace routing */
 } /* namespace dtn */
@@ -27,8 +27,11 @@
 #include "routing/NodeHandshake.h"
 #include "core/Event.h"
 #include "core/Node.h"
+#include "core/Metrics.h"
 #include <ibrdtn/data/BundleID.h>
 #include <ibrdtn/data/EID.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <map>
 
 namespace dtn
 {
@@ -109,6 +112,16 @@ namespace dtn
 			 */
 			virtual void processHandshake(const dtn::data::EID&, NodeHandshake&) { };
 
+			/**
+			 * Create the per-peer metrics of a new neighbor
+			 */
+			void addNeighborMetrics(const dtn::data::EID &peer);
+
+			/**
+			 * Remove the per-peer metrics of a neighbor which went away
+			 */
+			void removeNeighborMetrics(const dtn::data::EID &peer);
+
 		protected:
 			/**
 			 * Transfer one bundle to another node.
@@ -118,7 +131,51 @@ namespace dtn
 			 */
 			void transferTo(const dtn::data::EID &destination, const dtn::data::MetaBundle &meta, const dtn::core::Node::Protocol);
 
+			/**
+			 * Transfer one bundle to another node like transferTo(), but
+			 * report the outcome as return value instead of throwing exceptions.
+			 * @param destination The EID of the other node.
+			 * @param id The ID of the bundle to transfer. This bundle must be stored in the storage.
+			 * @return TRANSFER_ACQUIRED if the bundle has been queued for transmission
+			 */
+			NeighborDatabase::TransferResult tryTransferTo(const dtn::data::EID &destination, const dtn::data::MetaBundle &meta, const dtn::core::Node::Protocol) throw ();
+
+			/**
+			 * Outcome of a search for bundles to forward to a neighbor
+			 */
+			enum SearchResult
+			{
+				SEARCH_COMPLETED = 0,
+				SEARCH_NO_SLOTS = 1,
+				SEARCH_NO_NEIGHBOR = 2,
+				SEARCH_NO_BUNDLES = 3,
+				SEARCH_NEED_HANDSHAKE = 4
+			};
+
+			/**
+			 * Transfer all bundles of a routing result to another node. Bundles
+			 * already in transit are skipped.
+			 * @param destination The EID of the other node.
+			 * @param list The bundles to transfer.
+			 * @return SEARCH_NO_SLOTS or SEARCH_NO_NEIGHBOR if the transfers were aborted,
+			 * SEARCH_COMPLETED otherwise
+			 */
+			SearchResult transferTo(const dtn::data::EID &destination, const RoutingResult &list) throw ();
+
+			/**
+			 * Returns the histogram for the time to search bundles for a peer.
+			 * Searches for nodes which are not a neighbor are not recorded.
+			 */
+			dtn::core::Metrics::Histogram getSearchLatency(const dtn::data::EID &peer) const;
+
 			BaseRouter& operator*();
+
+		private:
+			std::string getSearchLatencyLabels(const dtn::data::EID &peer) const;
+
+			// search latency histograms of the current neighbors
+			mutable ibrcommon::Mutex _search_latency_lock;
+			std::map<dtn::data::EID, dtn::core::Metrics::Histogram> _search_latency;
 		};
 	} /* namespace routing */
 } /* namespace dtn */
@@ -0,0 +1,122 @@
+/*
+ * RoutingTaskQueue.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "routing/RoutingTaskQueue.h"
+#include <ibrcommon/thread/MutexLock.h>
+
+namespace dtn
+{
+	namespace routing
+	{
+		RoutingTask::RoutingTask(const int t, const dtn::data::EID &p, const bool c)
+		 : type(t), peer(p), coalesce(c)
+		{
+		}
+
+		RoutingTask::~RoutingTask()
+		{
+		}
+
+		RoutingTaskQueue::RoutingTaskQueue()
+		 : _size(0), _coalesced(0), _processed(0)
+		{
+		}
+
+		RoutingTaskQueue::~RoutingTaskQueue()
+		{
+			_queue.abort();
+
+			// delete all remaining tasks
+			try {
+				while (true)
+				{
+					delete _queue.take();
+				}
+			} catch (const ibrcommon::QueueUnblockedException&) { }
+		}
+
+		bool RoutingTaskQueue::push(RoutingTask *task) throw ()
+		{
+			{
+				ibrcommon::MutexLock l(_pending_lock);
+
+				if (task->coalesce)
+				{
+					// drop the task if an equal task is waiting for processing
+					if (!_pending.insert(task_key(task->type, task->peer)).second)
+					{
+						++_coalesced;
+						delete task;
+						return false;
+					}
+				}
+
+				++_size;
+			}
+
+			_queue.push(task);
+			return true;
+		}
+
+		RoutingTask* RoutingTaskQueue::poll() throw (ibrcommon::QueueUnblockedException)
+		{
+			RoutingTask *task = _queue.poll();
+
+			ibrcommon::MutexLock l(_pending_lock);
+
+			// accept equal tasks again as soon as the processing starts
+			if (task->coalesce) _pending.erase(task_key(task->type, task->peer));
+
+			--_size;
+			++_processed;
+
+			return task;
+		}
+
+		void RoutingTaskQueue::abort() throw ()
+		{
+			_queue.abort();
+		}
+
+		void RoutingTaskQueue::reset() throw ()
+		{
+			_queue.reset();
+		}
+
+		size_t RoutingTaskQueue::size() const throw ()
+		{
+			ibrcommon::MutexLock l(_pending_lock);
+			return _size;
+		}
+
+		size_t RoutingTaskQueue::getCoalesced() const throw ()
+		{
+			ibrcommon::MutexLock l(_pending_lock);
+			return _coalesced;
+		}
+
+		size_t RoutingTaskQueue::getProcessed() const throw ()
+		{
+			ibrcommon::MutexLock l(_pending_lock);
+			return _processed;
+		}
+	} /* namespace routing */
+} /* namespace dtn */
@@ -0,0 +1,119 @@
+/*
+ * RoutingTaskQueue.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ROUTINGTASKQUEUE_H_
+#define ROUTINGTASKQUEUE_H_
+
+#include <ibrdtn/data/EID.h>
+#include <ibrcommon/thread/Queue.h>
+#include <ibrcommon/thread/Mutex.h>
+#include <set>
+#include <string>
+
+namespace dtn
+{
+	namespace routing
+	{
+		/**
+		 * A task of a routing extension. The type is defined by the
+		 * extension and allows to dispatch tasks without RTTI.
+		 */
+		class RoutingTask
+		{
+		public:
+			RoutingTask(const int type, const dtn::data::EID &peer = dtn::data::EID(), const bool coalesce = false);
+			virtual ~RoutingTask();
+
+			virtual std::string toString() const = 0;
+
+			// type of the task as defined by the routing extension
+			const int type;
+
+			// peer this task belongs to
+			const dtn::data::EID peer;
+
+			// if true, the task is dropped if an equal task is still queued
+			const bool coalesce;
+		};
+
+		/**
+		 * Queue for routing tasks. Tasks marked as coalescing are dropped
+		 * if a task with the same type and peer is queued and not yet processed.
+		 */
+		class RoutingTaskQueue
+		{
+		public:
+			RoutingTaskQueue();
+			virtual ~RoutingTaskQueue();
+
+			/**
+			 * Put a task into the queue. The queue takes the ownership
+			 * of the task.
+			 * @return False, if the task has been coalesced with a queued task.
+			 */
+			bool push(RoutingTask *task) throw ();
+
+			/**
+			 * Retrieve the next task of the queue. The caller takes the
+			 * ownership of the task.
+			 */
+			RoutingTask* poll() throw (ibrcommon::QueueUnblockedException);
+
+			/**
+			 * Unblock the queue and any waiting thread
+			 */
+			void abort() throw ();
+
+			/**
+			 * Reset the queue after an abort
+			 */
+			void reset() throw ();
+
+			/**
+			 * @return The number of queued tasks
+			 */
+			size_t size() const throw ();
+
+			/**
+			 * @return The number of tasks dropped due to coalescing
+			 */
+			size_t getCoalesced() const throw ();
+
+			/**
+			 * @return The number of tasks retrieved for processing
+			 */
+			size_t getProcessed() const throw ();
+
+		private:
+			typedef std::pair<int, dtn::data::EID> task_key;
+
+			ibrcommon::Queue<RoutingTask*> _queue;
+
+			mutable ibrcommon::Mutex _pending_lock;
+			std::set<task_key> _pending;
+
+			size_t _size;
+			size_t _coalesced;
+			size_t _processed;
+		};
+	} /* namespace routing */
+} /* namespace dtn */
+#endif /* ROUTINGTASKQUEUE_H_ */
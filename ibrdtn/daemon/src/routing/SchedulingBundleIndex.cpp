@@ -22,37 +22,32 @@ namespace dtn
 		void SchedulingBundleIndex::add(const dtn::data::MetaBundle &b)
 		{
 			ibrcommon::MutexLock l(_index_mutex);
-			_priority_index.insert(b);
+			std::pair<priority_index::iterator, bool> ret = _priority_index.insert(b);
+
+			if (ret.second)
+			{
+				_ids[b] = ret.first;
+				_secondary_index.add(*ret.first);
+			}
 		}
 
 		void SchedulingBundleIndex::remove(const dtn::data::BundleID &id)
 		{
 			ibrcommon::MutexLock l(_index_mutex);
-			for (priority_index::const_iterator iter = _priority_index.begin(); iter != _priority_index.end(); ++iter)
-			{
-				const dtn::data::MetaBundle &b = (*iter);
-				if (id == (const dtn::data::BundleID&)b) {
-					_priority_index.erase(iter);
-					return;
-				}
-			}
+			id_map::iterator it = _ids.find(id);
+			if (it == _ids.end()) return;
+
+			_secondary_index.remove(*(*it).second);
+			_priority_index.erase((*it).second);
+			_ids.erase(it);
 		}
 
 		void SchedulingBundleIndex::get(const dtn::storage::BundleSelector &cb, dtn::storage::BundleResult &result) throw (dtn::storage::NoBundleFoundException, dtn::storage::BundleSelectorException)
 		{
-			bool unlimited = (cb.limit() <= 0);
-			size_t added = 0;
-
 			ibrcommon::MutexLock l(_index_mutex);
-			for (priority_index::const_iterator iter = _priority_index.begin(); iter != _priority_index.end(); ++iter)
-			{
-				const dtn::data::MetaBundle &b = (*iter);
-				if (cb.addIfSelected(result, b)) {
-					added++;
-				}
 
-				if (!unlimited && (added >= cb.limit())) break;
-			}
+			// select bundles using the priority index or one of the secondary indexes
+			const dtn::data::Size added = _secondary_index.select(_priority_index, cb, result, dtn::storage::SecondaryBundleIndex<CMP_BUNDLE_PRIORITY>::SkipNone());
 
 			if (added == 0)
 				throw dtn::storage::NoBundleFoundException();
@@ -9,8 +9,10 @@
 #define SCHEDULINGBUNDLEINDEX_H_
 
 #include "storage/BundleIndex.h"
+#include "storage/SecondaryBundleIndex.h"
 #include <ibrdtn/data/Number.h>
 #include <ibrcommon/thread/Mutex.h>
+#include <map>
 
 namespace dtn
 {
@@ -86,6 +88,14 @@ namespace dtn
 
 			typedef std::set<dtn::data::MetaBundle, CMP_BUNDLE_PRIORITY> priority_index;
 			priority_index _priority_index;
+
+			// map of bundle IDs to elements of the priority index
+			typedef std::map<dtn::data::BundleID, priority_index::iterator> id_map;
+			id_map _ids;
+
+			// secondary indexes for constrained queries
+			dtn::storage::SecondaryBundleIndex<CMP_BUNDLE_PRIORITY> _secondary_index;
+
 			ibrcommon::Mutex _index_mutex;
 		};
 	} /* namespace routing */
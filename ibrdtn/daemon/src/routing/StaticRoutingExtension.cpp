@@ -30,6 +30,7 @@
 #include "core/EventDispatcher.h"
 #include "core/NodeEvent.h"
 #include "storage/SimpleBundleStorage.h"
+#include "storage/BundleConstraints.h"
 
 #ifdef HAVE_REGEX_H
 #include <routing/StaticRegexRoute.h>
@@ -74,25 +75,24 @@ namespace dtn
 
 		void StaticRoutingExtension::run() throw ()
 		{
-			class BundleFilter : public dtn::storage::BundleSelector
+			class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::IndexedBundleQuery
 			{
 			public:
 				BundleFilter(const NeighborDatabase::NeighborEntry &entry, const std::list<const StaticRoute*> &routes, const dtn::core::FilterContext &context, const dtn::net::ConnectionManager::protocol_list &plist)
 				 : _entry(entry), _routes(routes), _plist(plist), _context(context)
-				{};
+				{
+					// check Scope Control Block - do not forward bundles without remaining hops
+					_constraints.setForwardable();
+				};
 
 				virtual ~BundleFilter() {};
 
 				virtual dtn::data::Size limit() const throw () { return _entry.getFreeTransferSlots(); };
 
+				virtual const dtn::storage::BundleConstraints& getConstraints() const throw () { return _constraints; };
+
 				virtual bool addIfSelected(dtn::storage::BundleResult &result, const dtn::data::MetaBundle &meta) const throw (dtn::storage::BundleSelectorException)
 				{
-					// check Scope Control Block - do not forward bundles with hop limit == 0
-					if (meta.hopcount == 0)
-					{
-						return false;
-					}
-
 					// do not forward local bundles
 					if ((meta.destination.getNode() == dtn::core::BundleCore::local)
 							&& meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)
@@ -101,12 +101,6 @@ namespace dtn
 						return false;
 					}
 
-					// check Scope Control Block - do not forward non-group bundles with hop limit <= 1
-					if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)))
-					{
-						return false;
-					}
-
 					// request limits from neighbor database
 					try {
 						const RoutingLimitations &limits = _entry.getDataset<RoutingLimitations>();
@@ -173,6 +167,7 @@ namespace dtn
 				const std::list<const StaticRoute*> &_routes;
 				const dtn::net::ConnectionManager::protocol_list &_plist;
 				const dtn::core::FilterContext &_context;
+				dtn::storage::BundleConstraints _constraints;
 			};
 
 			// announce static routes here
@@ -199,6 +194,7 @@ namespace dtn
 
 					try {
 						SearchNextBundleTask &task = dynamic_cast<SearchNextBundleTask&>(*t);
+						dtn::core::Metrics::Timer timer(getSearchLatency(task.eid));
 
 						// remove all routes of the previous round
 						routes.clear();
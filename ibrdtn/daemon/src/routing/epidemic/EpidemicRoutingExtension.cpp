@@ -30,6 +30,7 @@
 #include "net/ConnectionManager.h"
 #include "Configuration.h"
 #include "core/BundleCore.h"
+#include "storage/BundleConstraints.h"
 #include "core/EventDispatcher.h"
 #include "core/BundleEvent.h"
 
@@ -93,7 +94,8 @@ namespace dtn
 			if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON))) return;
 
 			// new bundles trigger a recheck for all neighbors
-			const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+			const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+			const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 			for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 			{
@@ -157,25 +159,31 @@ namespace dtn
 
 		void EpidemicRoutingExtension::run() throw ()
 		{
-			class BundleFilter : public dtn::storage::BundleSelector
+			class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::IndexedBundleQuery
 			{
 			public:
 				BundleFilter(const NeighborDatabase::NeighborEntry &entry, const std::set<dtn::core::Node> &neighbors, const dtn::core::FilterContext &context, const dtn::net::ConnectionManager::protocol_list &plist)
 				 : _entry(entry), _neighbors(neighbors), _plist(plist), _context(context)
-				{};
+				{
+					// check Scope Control Block - do not forward bundles without remaining hops
+					_constraints.setForwardable();
+
+					// do not forward bundles addressed to this neighbor,
+					// because this is handled by neighbor routing extension
+					_constraints.setExcludeDestinationNode(_entry.eid);
+
+					// skip bundles already known by the neighbor
+					if (_entry.isFilterValid()) _constraints.setExcludeFilter(_entry.getFilter());
+				};
 
 				virtual ~BundleFilter() {};
 
 				virtual dtn::data::Size limit() const throw () { return _entry.getFreeTransferSlots(); };
 
+				virtual const dtn::storage::BundleConstraints& getConstraints() const throw () { return _constraints; };
+
 				virtual bool addIfSelected(dtn::storage::BundleResult &result, const dtn::data::MetaBundle &meta) const throw (dtn::storage::BundleSelectorException)
 				{
-					// check Scope Control Block - do not forward bundles with hop limit == 0
-					if (meta.hopcount == 0)
-					{
-						return false;
-					}
-
 					// do not forward local bundles
 					if ((meta.destination.getNode() == dtn::core::BundleCore::local)
 							&& meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)
@@ -184,19 +192,6 @@ namespace dtn
 						return false;
 					}
 
-					// check Scope Control Block - do not forward non-group bundles with hop limit <= 1
-					if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)))
-					{
-						return false;
-					}
-
-					// do not forward bundles addressed to this neighbor,
-					// because this is handled by neighbor routing extension
-					if (_entry.eid == meta.destination.getNode())
-					{
-						return false;
-					}
-
 					// request limits from neighbor database
 					try {
 						const RoutingLimitations &limits = _entry.getDataset<RoutingLimitations>();
@@ -271,95 +266,127 @@ namespace dtn
 				const std::set<dtn::core::Node> &_neighbors;
 				const dtn::net::ConnectionManager::protocol_list &_plist;
 				const dtn::core::FilterContext &_context;
+				dtn::storage::BundleConstraints _constraints;
 			};
 
 			// list for bundles
 			RoutingResult list;
 
-			// set of known neighbors
-			std::set<dtn::core::Node> neighbors;
+			// empty set of neighbors, used if the "prefer direct" option is disabled
+			const std::set<dtn::core::Node> no_neighbors;
 
 			while (true)
 			{
 				try {
-					Task *t = _taskqueue.poll();
-					std::auto_ptr<Task> killer(t);
+					RoutingTask *t = _taskqueue.poll();
+					std::auto_ptr<RoutingTask> killer(t);
 
-					IBRCOMMON_LOGGER_DEBUG_TAG(EpidemicRoutingExtension::TAG, 50) << "processing task " << t->toString() << IBRCOMMON_LOGGER_ENDL;
+					IBRCOMMON_LOGGER_DEBUG_TAG(EpidemicRoutingExtension::TAG, 50) << "processing task " << t->toString() << " (" << _taskqueue.size() << " queued, " << _taskqueue.getCoalesced() << " coalesced)" << IBRCOMMON_LOGGER_ENDL;
 
 					try {
+						switch (t->type)
+						{
 						/**
 						 * SearchNextBundleTask triggers a search for a bundle to transfer
 						 * to another host. This Task is generated by TransferCompleted, TransferAborted
 						 * and node events.
 						 */
-						try {
-							SearchNextBundleTask &task = dynamic_cast<SearchNextBundleTask&>(*t);
+						case TASK_SEARCH_NEXT_BUNDLE:
+						{
+							dtn::core::Metrics::Timer timer(getSearchLatency(t->peer));
+							SearchResult ret = SEARCH_COMPLETED;
 
 							// clear the result list
 							list.clear();
 
 							// lock the neighbor database while searching for bundles
-							try {
+							{
 								NeighborDatabase &db = (**this).getNeighborDB();
+
 								ibrcommon::MutexLock l(db);
-								NeighborDatabase::NeighborEntry &entry = db.get(task.eid, true);
+								NeighborDatabase::NeighborEntry *entry = db.find(t->peer, true);
 
+								if (entry == NULL)
+								{
+									ret = SEARCH_NO_NEIGHBOR;
+								}
 								// check if enough transfer slots available (threshold reached)
-								if (!entry.isTransferThresholdReached())
-									throw NeighborDatabase::NoMoreTransfersAvailable(task.eid);
-
-								if (dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect()) {
-									// get current neighbor list
-									neighbors = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
-								} else {
-									// "prefer direct" option disabled - clear the list of neighbors
-									neighbors.clear();
+								else if (!entry->isTransferThresholdReached())
+								{
+									ret = SEARCH_NO_SLOTS;
 								}
+								else
+								{
+									// get the current snapshot of all neighbors
+									const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+
+									// consider the neighbors only if the "prefer direct" option is enabled
+									const std::set<dtn::core::Node> &neighbors = dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect() ? snapshot->getNeighbors() : no_neighbors;
+
+									// get a list of protocols supported by both, the local BPA and the remote peer
+									const dtn::net::ConnectionManager::protocol_list &plist = snapshot->getSupportedProtocols(entry->eid);
+
+									// create a filter context
+									dtn::core::FilterContext context;
+									context.setPeer(entry->eid);
+									context.setRouting(*this);
+
+									// get the bundle filter of the neighbor
+									const BundleFilter filter(*entry, neighbors, context, plist);
+
+									// some debug output
+									IBRCOMMON_LOGGER_DEBUG_TAG(EpidemicRoutingExtension::TAG, 40) << "search some bundles not known by " << t->peer.getString() << IBRCOMMON_LOGGER_ENDL;
+
+									// query some unknown bundle from the storage
+									try {
+										(**this).getSeeker().get(filter, list);
+									} catch (const dtn::storage::BundleSelectorException&) {
+										// query a new summary vector from this neighbor
+										ret = SEARCH_NEED_HANDSHAKE;
+									} catch (const dtn::storage::NoBundleFoundException&) {
+										ret = SEARCH_NO_BUNDLES;
+									}
+								}
+							}
 
-								// get a list of protocols supported by both, the local BPA and the remote peer
-								const dtn::net::ConnectionManager::protocol_list plist =
-										dtn::core::BundleCore::getInstance().getConnectionManager().getSupportedProtocols(entry.eid);
-
-								// create a filter context
-								dtn::core::FilterContext context;
-								context.setPeer(entry.eid);
-								context.setRouting(*this);
+							// send the bundles as long as we have resources
+							if (ret == SEARCH_COMPLETED) ret = transferTo(t->peer, list);
 
-								// get the bundle filter of the neighbor
-								const BundleFilter filter(entry, neighbors, context, plist);
+							switch (ret)
+							{
+							case SEARCH_NEED_HANDSHAKE:
+								(**this).doHandshake(t->peer);
+								break;
 
-								// some debug output
-								IBRCOMMON_LOGGER_DEBUG_TAG(EpidemicRoutingExtension::TAG, 40) << "search some bundles not known by " << task.eid.getString() << IBRCOMMON_LOGGER_ENDL;
+							case SEARCH_NO_SLOTS:
+							{
+								// remember that this peer has pending transfers
+								ibrcommon::MutexLock pending_lock(_pending_mutex);
+								_pending_peers.insert(t->peer);
 
-								// query some unknown bundle from the storage
-								(**this).getSeeker().get(filter, list);
-							} catch (const dtn::storage::BundleSelectorException&) {
-								// query a new summary vector from this neighbor
-								(**this).doHandshake(task.eid);
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no more transfers allowed" << IBRCOMMON_LOGGER_ENDL;
+								break;
 							}
 
-							// send the bundles as long as we have resources
-							for (RoutingResult::const_iterator iter = list.begin(); iter != list.end(); ++iter)
-							{
-								try {
-									// transfer the bundle to the neighbor
-									transferTo(task.eid, (*iter).first, (*iter).second);
-								} catch (const NeighborDatabase::AlreadyInTransitException&) { };
+							case SEARCH_NO_NEIGHBOR:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: neighbor not available" << IBRCOMMON_LOGGER_ENDL;
+								break;
+
+							case SEARCH_NO_BUNDLES:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no bundles found" << IBRCOMMON_LOGGER_ENDL;
+								break;
+
+							default:
+								break;
 							}
-						} catch (const NeighborDatabase::NoMoreTransfersAvailable &ex) {
-							// remember that this peer has pending transfers
-							ibrcommon::MutexLock pending_lock(_pending_mutex);
-							_pending_peers.insert(ex.peer);
-
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NeighborDatabase::EntryNotFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NodeNotAvailableException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const dtn::storage::NoBundleFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const std::bad_cast&) { };
+							break;
+						}
+
+						default:
+							break;
+						}
+					} catch (const NodeNotAvailableException &ex) {
+						IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					} catch (const ibrcommon::Exception &ex) {
 						IBRCOMMON_LOGGER_DEBUG_TAG(EpidemicRoutingExtension::TAG, 20) << "task failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					}
@@ -375,15 +402,15 @@ namespace dtn
 		/****************************************/
 
 		EpidemicRoutingExtension::SearchNextBundleTask::SearchNextBundleTask(const dtn::data::EID &e)
-		 : eid(e)
+		 : RoutingTask(TASK_SEARCH_NEXT_BUNDLE, e, true)
 		{ }
 
 		EpidemicRoutingExtension::SearchNextBundleTask::~SearchNextBundleTask()
 		{ }
 
-		std::string EpidemicRoutingExtension::SearchNextBundleTask::toString()
+		std::string EpidemicRoutingExtension::SearchNextBundleTask::toString() const
 		{
-			return "SearchNextBundleTask: " + eid.getString();
+			return "SearchNextBundleTask: " + peer.getString();
 		}
 	}
 }
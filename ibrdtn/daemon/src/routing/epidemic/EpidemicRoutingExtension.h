@@ -29,13 +29,13 @@
 #include "routing/NodeHandshakeEvent.h"
 #include "routing/RoutingExtension.h"
 #include "routing/NeighborDatabase.h"
+#include "routing/RoutingTaskQueue.h"
 
 #include <ibrdtn/data/Block.h>
 #include <ibrdtn/data/SDNV.h>
 #include <ibrdtn/data/BundleString.h>
 #include <ibrdtn/data/ExtensionBlock.h>
 
-#include <ibrcommon/thread/Queue.h>
 #include <ibrcommon/thread/Thread.h>
 
 #include <list>
@@ -75,28 +75,24 @@ namespace dtn
 			void __cancellation() throw ();
 
 		private:
-			class Task
+			enum TaskType
 			{
-			public:
-				virtual ~Task() {};
-				virtual std::string toString() = 0;
+				TASK_SEARCH_NEXT_BUNDLE = 0
 			};
 
-			class SearchNextBundleTask : public Task
+			class SearchNextBundleTask : public RoutingTask
 			{
 			public:
 				SearchNextBundleTask(const dtn::data::EID &eid);
 				virtual ~SearchNextBundleTask();
 
-				virtual std::string toString();
-
-				const dtn::data::EID eid;
+				virtual std::string toString() const;
 			};
 
 			/**
 			 * hold queued tasks for later processing
 			 */
-			ibrcommon::Queue<EpidemicRoutingExtension::Task* > _taskqueue;
+			RoutingTaskQueue _taskqueue;
 
 			// set for pending transfers
 			ibrcommon::Mutex _pending_mutex;
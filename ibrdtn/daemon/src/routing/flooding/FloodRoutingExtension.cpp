@@ -74,7 +74,8 @@ namespace dtn
 			if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON))) return;
 
 			// new bundles trigger a recheck for all neighbors
-			const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+			const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+			const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 			for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 			{
@@ -239,20 +240,29 @@ namespace dtn
 			// list for bundles
 			RoutingResult list;
 
-			// set of known neighbors
-			std::set<dtn::core::Node> neighbors;
+			// empty set of neighbors, used if the "prefer direct" option is disabled
+			const std::set<dtn::core::Node> no_neighbors;
 
 			while (true)
 			{
 				try {
-					Task *t = _taskqueue.poll();
-					std::auto_ptr<Task> killer(t);
+					RoutingTask *t = _taskqueue.poll();
+					std::auto_ptr<RoutingTask> killer(t);
 
-					IBRCOMMON_LOGGER_DEBUG_TAG(FloodRoutingExtension::TAG, 50) << "processing task " << t->toString() << IBRCOMMON_LOGGER_ENDL;
+					IBRCOMMON_LOGGER_DEBUG_TAG(FloodRoutingExtension::TAG, 50) << "processing task " << t->toString() << " (" << _taskqueue.size() << " queued, " << _taskqueue.getCoalesced() << " coalesced)" << IBRCOMMON_LOGGER_ENDL;
 
 					try {
-						try {
-							SearchNextBundleTask &task = dynamic_cast<SearchNextBundleTask&>(*t);
+						switch (t->type)
+						{
+						/**
+						 * SearchNextBundleTask triggers a search for a bundle to transfer
+						 * to another host. This Task is generated by TransferCompleted, TransferAborted
+						 * and node events.
+						 */
+						case TASK_SEARCH_NEXT_BUNDLE:
+						{
+							dtn::core::Metrics::Timer timer(getSearchLatency(t->peer));
+							SearchResult ret = SEARCH_COMPLETED;
 
 							// clear the result list
 							list.clear();
@@ -262,56 +272,78 @@ namespace dtn
 								NeighborDatabase &db = (**this).getNeighborDB();
 
 								ibrcommon::MutexLock l(db);
-								NeighborDatabase::NeighborEntry &entry = db.get(task.eid, true);
+								NeighborDatabase::NeighborEntry *entry = db.find(t->peer, true);
 
+								if (entry == NULL)
+								{
+									ret = SEARCH_NO_NEIGHBOR;
+								}
 								// check if enough transfer slots available (threshold reached)
-								if (!entry.isTransferThresholdReached())
-									throw NeighborDatabase::NoMoreTransfersAvailable(task.eid);
-
-								if (dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect()) {
-									// get current neighbor list
-									neighbors = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
-								} else {
-									// "prefer direct" option disabled - clear the list of neighbors
-									neighbors.clear();
+								else if (!entry->isTransferThresholdReached())
+								{
+									ret = SEARCH_NO_SLOTS;
+								}
+								else
+								{
+									// get the current snapshot of all neighbors
+									const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+
+									// consider the neighbors only if the "prefer direct" option is enabled
+									const std::set<dtn::core::Node> &neighbors = dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect() ? snapshot->getNeighbors() : no_neighbors;
+
+									// get a list of protocols supported by both, the local BPA and the remote peer
+									const dtn::net::ConnectionManager::protocol_list &plist = snapshot->getSupportedProtocols(entry->eid);
+
+									// create a filter context
+									dtn::core::FilterContext context;
+									context.setPeer(entry->eid);
+									context.setRouting(*this);
+
+									// get the bundle filter of the neighbor
+									BundleFilter filter(*entry, neighbors, context, plist);
+
+									// some debug output
+									IBRCOMMON_LOGGER_DEBUG_TAG(FloodRoutingExtension::TAG, 40) << "search some bundles not known by " << t->peer.getString() << IBRCOMMON_LOGGER_ENDL;
+
+									// query all bundles from the storage
+									try {
+										(**this).getSeeker().get(filter, list);
+									} catch (const dtn::storage::NoBundleFoundException&) {
+										ret = SEARCH_NO_BUNDLES;
+									}
 								}
+							}
 
-								// get a list of protocols supported by both, the local BPA and the remote peer
-								const dtn::net::ConnectionManager::protocol_list plist =
-										dtn::core::BundleCore::getInstance().getConnectionManager().getSupportedProtocols(entry.eid);
+							// send the bundles as long as we have resources
+							if (ret == SEARCH_COMPLETED) ret = transferTo(t->peer, list);
 
-								// create a filter context
-								dtn::core::FilterContext context;
-								context.setPeer(entry.eid);
-								context.setRouting(*this);
+							switch (ret)
+							{
+							case SEARCH_NO_SLOTS:
+							{
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no more transfers allowed" << IBRCOMMON_LOGGER_ENDL;
+								break;
+							}
 
-								// get the bundle filter of the neighbor
-								BundleFilter filter(entry, neighbors, context, plist);
+							case SEARCH_NO_NEIGHBOR:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: neighbor not available" << IBRCOMMON_LOGGER_ENDL;
+								break;
 
-								// some debug
-								IBRCOMMON_LOGGER_DEBUG_TAG(FloodRoutingExtension::TAG, 40) << "search some bundles not known by " << task.eid.getString() << IBRCOMMON_LOGGER_ENDL;
+							case SEARCH_NO_BUNDLES:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no bundles found" << IBRCOMMON_LOGGER_ENDL;
+								break;
 
-								// query all bundles from the storage
-								(**this).getSeeker().get(filter, list);
+							default:
+								break;
 							}
+							break;
+						}
 
-							// send the bundles as long as we have resources
-							for (RoutingResult::const_iterator iter = list.begin(); iter != list.end(); ++iter)
-							{
-								try {
-									// transfer the bundle to the neighbor
-									transferTo(task.eid, (*iter).first, (*iter).second);
-								} catch (const NeighborDatabase::AlreadyInTransitException&) { };
-							}
-						} catch (const NeighborDatabase::NoMoreTransfersAvailable &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NeighborDatabase::EntryNotFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NodeNotAvailableException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const dtn::storage::NoBundleFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const std::bad_cast&) { };
+						default:
+							break;
+						}
+					} catch (const NodeNotAvailableException &ex) {
+						IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					} catch (const ibrcommon::Exception &ex) {
 						IBRCOMMON_LOGGER_DEBUG_TAG(FloodRoutingExtension::TAG, 20) << "task failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					}
@@ -327,15 +359,15 @@ namespace dtn
 		/****************************************/
 
 		FloodRoutingExtension::SearchNextBundleTask::SearchNextBundleTask(const dtn::data::EID &e)
-		 : eid(e)
+		 : RoutingTask(TASK_SEARCH_NEXT_BUNDLE, e, true)
 		{ }
 
 		FloodRoutingExtension::SearchNextBundleTask::~SearchNextBundleTask()
 		{ }
 
-		std::string FloodRoutingExtension::SearchNextBundleTask::toString()
+		std::string FloodRoutingExtension::SearchNextBundleTask::toString() const
 		{
-			return "SearchNextBundleTask: " + eid.getString();
+			return "SearchNextBundleTask: " + peer.getString();
 		}
 	}
 }
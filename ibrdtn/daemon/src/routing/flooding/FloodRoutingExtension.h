@@ -26,12 +26,12 @@
 
 #include "routing/RoutingExtension.h"
 #include "routing/NeighborDatabase.h"
+#include "routing/RoutingTaskQueue.h"
 
 #include <ibrdtn/data/Block.h>
 #include <ibrdtn/data/SDNV.h>
 #include <ibrdtn/data/BundleString.h>
 
-#include <ibrcommon/thread/Queue.h>
 
 #include <list>
 #include <queue>
@@ -62,28 +62,24 @@ namespace dtn
 			void __cancellation() throw ();
 
 		private:
-			class Task
+			enum TaskType
 			{
-			public:
-				virtual ~Task() {};
-				virtual std::string toString() = 0;
+				TASK_SEARCH_NEXT_BUNDLE = 0
 			};
 
-			class SearchNextBundleTask : public Task
+			class SearchNextBundleTask : public RoutingTask
 			{
 			public:
 				SearchNextBundleTask(const dtn::data::EID &eid);
 				virtual ~SearchNextBundleTask();
 
-				virtual std::string toString();
-
-				const dtn::data::EID eid;
+				virtual std::string toString() const;
 			};
 
 			/**
 			 * hold queued tasks for later processing
 			 */
-			ibrcommon::Queue<FloodRoutingExtension::Task* > _taskqueue;
+			RoutingTaskQueue _taskqueue;
 		};
 	}
 }
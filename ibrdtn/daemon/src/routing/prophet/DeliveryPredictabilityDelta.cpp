@@ -0,0 +1,236 @@
+/*
+ * DeliveryPredictabilityDelta.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "routing/prophet/DeliveryPredictabilityDelta.h"
+#include <ibrdtn/data/Exceptions.h>
+#include <sstream>
+#include <vector>
+
+namespace dtn
+{
+	namespace routing
+	{
+		const dtn::data::Number DeliveryPredictabilityDelta::identifier = NodeHandshakeItem::DELIVERY_PREDICTABILITY_DELTA;
+
+		DeliveryPredictabilityDelta::DeliveryPredictabilityDelta()
+		 : NeighborDataSetImpl(DeliveryPredictabilityDelta::identifier), _version(0), _base(0)
+		{
+		}
+
+		DeliveryPredictabilityDelta::DeliveryPredictabilityDelta(const dtn::data::Number &version, const predictmap &map)
+		 : NeighborDataSetImpl(DeliveryPredictabilityDelta::identifier), _version(version), _base(0), _map(map)
+		{
+		}
+
+		DeliveryPredictabilityDelta::DeliveryPredictabilityDelta(const dtn::data::Number &version, const predictmap &map,
+				const dtn::data::Number &base, const predictmap &base_map)
+		 : NeighborDataSetImpl(DeliveryPredictabilityDelta::identifier), _version(version), _base(base)
+		{
+			// add all new and changed entries
+			for (predictmap::const_iterator it = map.begin(); it != map.end(); ++it)
+			{
+				predictmap::const_iterator base_it = base_map.find((*it).first);
+
+				// compare the values as transferred
+				if ((base_it == base_map.end()) || (toString((*base_it).second) != toString((*it).second)))
+				{
+					_map.insert(*it);
+				}
+			}
+
+			// add all removed entries
+			for (predictmap::const_iterator it = base_map.begin(); it != base_map.end(); ++it)
+			{
+				if (map.find((*it).first) == map.end()) _removed.insert((*it).first);
+			}
+		}
+
+		DeliveryPredictabilityDelta::~DeliveryPredictabilityDelta()
+		{
+		}
+
+		const dtn::data::Number& DeliveryPredictabilityDelta::getIdentifier() const
+		{
+			return identifier;
+		}
+
+		const dtn::data::Number& DeliveryPredictabilityDelta::getVersion() const
+		{
+			return _version;
+		}
+
+		const dtn::data::Number& DeliveryPredictabilityDelta::getBase() const
+		{
+			return _base;
+		}
+
+		const DeliveryPredictabilityDelta::predictmap& DeliveryPredictabilityDelta::getMap() const
+		{
+			return _map;
+		}
+
+		void DeliveryPredictabilityDelta::copy(const DeliveryPredictabilityMap &dpm, predictmap &map)
+		{
+			map.clear();
+			for (DeliveryPredictabilityMap::const_iterator it = dpm.begin(); it != dpm.end(); ++it)
+			{
+				map[*it] = dpm.get(*it);
+			}
+		}
+
+		bool DeliveryPredictabilityDelta::apply(const DeliveryPredictabilityDelta &previous)
+		{
+			// nothing to do for complete maps
+			if (_base == 0) return true;
+
+			// the previous map has to match the base of this difference
+			if (previous._version != _base) return false;
+
+			predictmap map = previous._map;
+
+			for (std::set<dtn::data::EID>::const_iterator it = _removed.begin(); it != _removed.end(); ++it)
+			{
+				map.erase(*it);
+			}
+
+			for (predictmap::const_iterator it = _map.begin(); it != _map.end(); ++it)
+			{
+				map[(*it).first] = (*it).second;
+			}
+
+			_map.swap(map);
+			_removed.clear();
+			_base = 0;
+
+			return true;
+		}
+
+		const std::string DeliveryPredictabilityDelta::toString(const float &f)
+		{
+			std::stringstream ss;
+			ss << f << std::flush;
+			return ss.str();
+		}
+
+		dtn::data::Length DeliveryPredictabilityDelta::getLength() const
+		{
+			dtn::data::Length len = _version.getLength() + _base.getLength();
+
+			len += dtn::data::Number(_map.size()).getLength();
+			for (predictmap::const_iterator it = _map.begin(); it != _map.end(); ++it)
+			{
+				const std::string &eid = (*it).first.getString();
+				const std::string f = toString((*it).second);
+				len += dtn::data::Number(eid.length()).getLength() + eid.length();
+				len += dtn::data::Number(f.length()).getLength() + f.length();
+			}
+
+			len += dtn::data::Number(_removed.size()).getLength();
+			for (std::set<dtn::data::EID>::const_iterator it = _removed.begin(); it != _removed.end(); ++it)
+			{
+				const std::string &eid = (*it).getString();
+				len += dtn::data::Number(eid.length()).getLength() + eid.length();
+			}
+
+			return len;
+		}
+
+		std::ostream& DeliveryPredictabilityDelta::serialize(std::ostream& stream) const
+		{
+			stream << _version << _base;
+
+			stream << dtn::data::Number(_map.size());
+			for (predictmap::const_iterator it = _map.begin(); it != _map.end(); ++it)
+			{
+				const std::string &eid = (*it).first.getString();
+				const std::string f = toString((*it).second);
+				stream << dtn::data::Number(eid.length()) << eid;
+				stream << dtn::data::Number(f.length()) << f;
+			}
+
+			stream << dtn::data::Number(_removed.size());
+			for (std::set<dtn::data::EID>::const_iterator it = _removed.begin(); it != _removed.end(); ++it)
+			{
+				const std::string &eid = (*it).getString();
+				stream << dtn::data::Number(eid.length()) << eid;
+			}
+
+			return stream;
+		}
+
+		std::istream& DeliveryPredictabilityDelta::deserialize(std::istream& stream)
+		{
+			_map.clear();
+			_removed.clear();
+
+			stream >> _version >> _base;
+
+			dtn::data::Number entries;
+			stream >> entries;
+
+			for (size_t i = 0; entries > i; ++i)
+			{
+				dtn::data::Number eid_len;
+				stream >> eid_len;
+
+				std::vector<char> eid_data(eid_len.get<size_t>());
+				if (!eid_data.empty()) stream.read(&eid_data[0], eid_data.size());
+
+				const dtn::data::EID eid(std::string(eid_data.begin(), eid_data.end()));
+				if (eid == dtn::data::EID())
+					throw dtn::InvalidDataException("EID could not be casted, while parsing a dp_map delta.");
+
+				dtn::data::Number f_len;
+				stream >> f_len;
+
+				std::vector<char> f_data(f_len.get<size_t>());
+				if (!f_data.empty()) stream.read(&f_data[0], f_data.size());
+
+				std::stringstream ss(std::string(f_data.begin(), f_data.end()));
+				float f;
+				ss >> f;
+
+				if (ss.fail())
+					throw dtn::InvalidDataException("Float could not be casted, while parsing a dp_map delta.");
+
+				// skip values out of range
+				if (f < 0 || f > 1) continue;
+
+				_map[eid] = f;
+			}
+
+			stream >> entries;
+
+			for (size_t i = 0; entries > i; ++i)
+			{
+				dtn::data::Number eid_len;
+				stream >> eid_len;
+
+				std::vector<char> eid_data(eid_len.get<size_t>());
+				if (!eid_data.empty()) stream.read(&eid_data[0], eid_data.size());
+
+				_removed.insert(dtn::data::EID(std::string(eid_data.begin(), eid_data.end())));
+			}
+
+			return stream;
+		}
+	} /* namespace routing */
+} /* namespace dtn */
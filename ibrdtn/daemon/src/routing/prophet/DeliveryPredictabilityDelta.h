@@ -0,0 +1,112 @@
+/*
+ * DeliveryPredictabilityDelta.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef DELIVERYPREDICTABILITYDELTA_H_
+#define DELIVERYPREDICTABILITYDELTA_H_
+
+#include "routing/NeighborDataset.h"
+#include "routing/NodeHandshake.h"
+#include "routing/prophet/DeliveryPredictabilityMap.h"
+#include <ibrdtn/data/EID.h>
+#include <map>
+#include <set>
+
+namespace dtn
+{
+	namespace routing
+	{
+		/*!
+		 * \brief Delivery predictability map encoded as difference to a previous version.
+		 *
+		 * Only entries changed since the base version are transferred together with
+		 * the removed entries. If the peer does not know the requested base version,
+		 * the complete map is sent instead (base version zero).
+		 */
+		class DeliveryPredictabilityDelta : public NeighborDataSetImpl, public NodeHandshakeItem
+		{
+		public:
+			static const dtn::data::Number identifier;
+
+			typedef DeliveryPredictabilityMap::predictmap predictmap;
+
+			DeliveryPredictabilityDelta();
+
+			/**
+			 * Create a complete map
+			 */
+			DeliveryPredictabilityDelta(const dtn::data::Number &version, const predictmap &map);
+
+			/**
+			 * Create a map encoded as difference to the map of a previous version
+			 */
+			DeliveryPredictabilityDelta(const dtn::data::Number &version, const predictmap &map,
+					const dtn::data::Number &base, const predictmap &base_map);
+
+			virtual ~DeliveryPredictabilityDelta();
+
+			virtual const dtn::data::Number& getIdentifier() const; ///< \see NodeHandshakeItem::getIdentifier
+			virtual dtn::data::Length getLength() const; ///< \see NodeHandshakeItem::getLength
+			virtual std::ostream& serialize(std::ostream& stream) const; ///< \see NodeHandshakeItem::serialize
+			virtual std::istream& deserialize(std::istream& stream); ///< \see NodeHandshakeItem::deserialize
+
+			/**
+			 * Returns the version of this map
+			 */
+			const dtn::data::Number& getVersion() const;
+
+			/**
+			 * Returns the version this difference is based on or
+			 * zero if this is a complete map
+			 */
+			const dtn::data::Number& getBase() const;
+
+			/**
+			 * Apply a received difference to the previous version of the map
+			 * @return False, if the previous map does not match
+			 */
+			bool apply(const DeliveryPredictabilityDelta &previous);
+
+			/**
+			 * Returns the entries of the map. Differences have to
+			 * be applied to the previous version first.
+			 */
+			const predictmap& getMap() const;
+
+			/**
+			 * Copy the entries of a delivery predictability map
+			 */
+			static void copy(const DeliveryPredictabilityMap &dpm, predictmap &map);
+
+		private:
+			static const std::string toString(const float &f);
+
+			dtn::data::Number _version;
+			dtn::data::Number _base;
+
+			// all entries or the changed entries of a difference
+			predictmap _map;
+
+			// entries removed since the base version
+			std::set<dtn::data::EID> _removed;
+		};
+	} /* namespace routing */
+} /* namespace dtn */
+#endif /* DELIVERYPREDICTABILITYDELTA_H_ */
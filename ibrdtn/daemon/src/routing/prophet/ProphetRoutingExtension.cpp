@@ -23,6 +23,7 @@
 #include "routing/prophet/DeliveryPredictabilityMap.h"
 
 #include "core/BundleCore.h"
+#include "storage/BundleConstraints.h"
 #include "core/EventDispatcher.h"
 
 #include <algorithm>
@@ -86,9 +87,19 @@ namespace dtn
 			delete _forwardingStrategy;
 		}
 
-		void ProphetRoutingExtension::requestHandshake(const dtn::data::EID&, NodeHandshake& handshake) const
+		void ProphetRoutingExtension::requestHandshake(const dtn::data::EID &neighbor, NodeHandshake& handshake) const
 		{
 			handshake.addRequest(DeliveryPredictabilityMap::identifier);
+
+			// request the map as difference to the last received version
+			dtn::data::Number version = 0;
+			try {
+				NeighborDatabase &db = dtn::core::BundleCore::getInstance().getRouter().getNeighborDB();
+				ibrcommon::MutexLock l(db);
+				version = db.get(neighbor.getNode()).getDataset<DeliveryPredictabilityDelta>().getVersion();
+			} catch (const std::exception&) { }
+
+			handshake.addRequest(DeliveryPredictabilityDelta::identifier, version);
 			handshake.addRequest(AcknowledgementSet::identifier);
 
 			// request summary vector to exclude bundles known by the peer
@@ -97,7 +108,32 @@ namespace dtn
 
 		void ProphetRoutingExtension::responseHandshake(const dtn::data::EID& neighbor, const NodeHandshake& request, NodeHandshake& response)
 		{
-			if (request.hasRequest(DeliveryPredictabilityMap::identifier))
+			if (request.hasRequest(DeliveryPredictabilityDelta::identifier))
+			{
+				DeliveryPredictabilityDelta::predictmap map;
+				{
+					ibrcommon::MutexLock l(_deliveryPredictabilityMap);
+					age();
+					DeliveryPredictabilityDelta::copy(_deliveryPredictabilityMap, map);
+				}
+
+				// assign a version to the current map
+				const dtn::data::Number version = _deliveryPredictabilityHistory.put(map);
+
+				// encode the map as difference if the version known by the peer is still available
+				const dtn::data::Number &base = request.getRequestVersion(DeliveryPredictabilityDelta::identifier);
+				DeliveryPredictabilityDelta::predictmap base_map;
+
+				if ((base > 0) && _deliveryPredictabilityHistory.get(base, base_map))
+				{
+					response.addItem(new DeliveryPredictabilityDelta(version, map, base, base_map));
+				}
+				else
+				{
+					response.addItem(new DeliveryPredictabilityDelta(version, map));
+				}
+			}
+			else if (request.hasRequest(DeliveryPredictabilityMap::identifier))
 			{
 				ibrcommon::MutexLock l(_deliveryPredictabilityMap);
 				age();
@@ -115,6 +151,60 @@ namespace dtn
 			/* ignore neighbors, that have our EID */
 			if (neighbor.sameHost(dtn::core::BundleCore::local)) return;
 
+			// peers with support for differences answer with a delta instead of the complete map
+			try {
+				DeliveryPredictabilityDelta &delta = response.get<DeliveryPredictabilityDelta>();
+
+				// strip possible application part off the neighbor EID
+				const dtn::data::EID neighbor_node = neighbor.getNode();
+
+				IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 10) << "delivery predictability map version " << delta.getVersion().toString() << " (base " << delta.getBase().toString() << ") received from " << neighbor_node.getString() << IBRCOMMON_LOGGER_ENDL;
+
+				DeliveryPredictabilityMap neighbor_dp_map;
+				bool valid = (delta.getBase() == 0);
+
+				{
+					NeighborDatabase &db = (**this).getNeighborDB();
+					ibrcommon::MutexLock l(db);
+					NeighborDatabase::NeighborEntry &entry = db.get(neighbor_node);
+
+					if (!valid)
+					{
+						try {
+							// apply the difference to the previous version
+							valid = delta.apply(entry.getDataset<DeliveryPredictabilityDelta>());
+						} catch (const NeighborDatabase::DatasetNotAvailableException&) { }
+					}
+
+					if (valid)
+					{
+						// store the map as base for the next difference
+						NeighborDataset delta_ds(new DeliveryPredictabilityDelta(delta));
+						entry.putDataset(delta_ds);
+
+						const DeliveryPredictabilityDelta::predictmap &map = delta.getMap();
+						for (DeliveryPredictabilityDelta::predictmap::const_iterator it = map.begin(); it != map.end(); ++it)
+						{
+							neighbor_dp_map.set((*it).first, (*it).second);
+						}
+
+						// store a copy of the map in the neighbor database
+						NeighborDataset ds(new DeliveryPredictabilityMap(neighbor_dp_map));
+						entry.putDataset(ds);
+					}
+					else
+					{
+						IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 10) << "delivery predictability map version mismatch for " << neighbor_node.getString() << IBRCOMMON_LOGGER_ENDL;
+
+						// drop the previous version to get the complete map with the next exchange
+						entry.removeDataset<DeliveryPredictabilityDelta>();
+					}
+				}
+
+				/* update predictability for this neighbor */
+				if (valid) updateNeighbor(neighbor_node, neighbor_dp_map);
+			} catch (std::exception&) { }
+
 			try {
 				const DeliveryPredictabilityMap& neighbor_dp_map = response.get<DeliveryPredictabilityMap>();
 
@@ -236,7 +326,8 @@ namespace dtn
 			if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON))) return;
 
 			// new bundles trigger a recheck for all neighbors
-			const std::set<dtn::core::Node> nl = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+			const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+			const std::set<dtn::core::Node> &nl = snapshot->getNeighbors();
 
 			for (std::set<dtn::core::Node>::const_iterator iter = nl.begin(); iter != nl.end(); ++iter)
 			{
@@ -360,25 +451,31 @@ namespace dtn
 
 		void ProphetRoutingExtension::ProphetRoutingExtension::run() throw ()
 		{
-			class BundleFilter : public dtn::storage::BundleSelector
+			class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::IndexedBundleQuery
 			{
 			public:
 				BundleFilter(const NeighborDatabase::NeighborEntry &entry, ForwardingStrategy &strategy, const DeliveryPredictabilityMap &dpm, const std::set<dtn::core::Node> &neighbors, const dtn::core::FilterContext &context, const dtn::net::ConnectionManager::protocol_list &plist)
 				 : _entry(entry), _strategy(strategy), _dpm(dpm), _neighbors(neighbors), _plist(plist), _context(context)
-				{ };
+				{
+					// check Scope Control Block - do not forward bundles without remaining hops
+					_constraints.setForwardable();
+
+					// do not forward bundles addressed to this neighbor,
+					// because this is handled by neighbor routing extension
+					_constraints.setExcludeDestinationNode(_entry.eid);
+
+					// skip bundles already known by the neighbor
+					if (_entry.isFilterValid()) _constraints.setExcludeFilter(_entry.getFilter());
+				};
 
 				virtual ~BundleFilter() {};
 
 				virtual dtn::data::Size limit() const throw () { return _entry.getFreeTransferSlots(); };
 
+				virtual const dtn::storage::BundleConstraints& getConstraints() const throw () { return _constraints; };
+
 				virtual bool addIfSelected(dtn::storage::BundleResult &result, const dtn::data::MetaBundle &meta) const throw (dtn::storage::BundleSelectorException)
 				{
-					// check Scope Control Block - do not forward bundles with hop limit == 0
-					if (meta.hopcount == 0)
-					{
-						return false;
-					}
-
 					// do not forward local bundles
 					if ((meta.destination.getNode() == dtn::core::BundleCore::local)
 							&& meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)
@@ -387,19 +484,6 @@ namespace dtn
 						return false;
 					}
 
-					// check Scope Control Block - do not forward non-group bundles with hop limit <= 1
-					if ((meta.hopcount <= 1) && (meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)))
-					{
-						return false;
-					}
-
-					// do not forward bundles addressed to this neighbor,
-					// because this is handled by neighbor routing extension
-					if (_entry.eid == meta.destination.getNode())
-					{
-						return false;
-					}
-
 					// request limits from neighbor database
 					try {
 						const RoutingLimitations &limits = _entry.getDataset<RoutingLimitations>();
@@ -485,111 +569,139 @@ namespace dtn
 				const std::set<dtn::core::Node> &_neighbors;
 				const dtn::net::ConnectionManager::protocol_list &_plist;
 				const dtn::core::FilterContext &_context;
+				dtn::storage::BundleConstraints _constraints;
 			};
 
 			// list for bundles
 			RoutingResult list;
 
-			// set of known neighbors
-			std::set<dtn::core::Node> neighbors;
+			// empty set of neighbors, used if the "prefer direct" option is disabled
+			const std::set<dtn::core::Node> no_neighbors;
 
 			while (true)
 			{
 				try {
-					Task *t = _taskqueue.poll();
-					std::auto_ptr<Task> killer(t);
+					RoutingTask *t = _taskqueue.poll();
+					std::auto_ptr<RoutingTask> killer(t);
 
-					IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 50) << "processing task " << t->toString() << IBRCOMMON_LOGGER_ENDL;
+					IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 50) << "processing task " << t->toString() << " (" << _taskqueue.size() << " queued, " << _taskqueue.getCoalesced() << " coalesced)" << IBRCOMMON_LOGGER_ENDL;
 
 					try {
+						switch (t->type)
+						{
 						/**
 						 * SearchNextBundleTask triggers a search for a bundle to transfer
 						 * to another host. This Task is generated by TransferCompleted, TransferAborted
 						 * and node events.
 						 */
-						try {
-							SearchNextBundleTask &task = dynamic_cast<SearchNextBundleTask&>(*t);
+						case TASK_SEARCH_NEXT_BUNDLE:
+						{
+							dtn::core::Metrics::Timer timer(getSearchLatency(t->peer));
+							SearchResult ret = SEARCH_COMPLETED;
 
 							// clear the result list
 							list.clear();
 
 							// lock the neighbor database while searching for bundles
-							try {
+							{
 								NeighborDatabase &db = (**this).getNeighborDB();
 
 								ibrcommon::MutexLock l(db);
-								NeighborDatabase::NeighborEntry &entry = db.get(task.eid, true);
-
-								// check if enough transfer slots available (threshold reached)
-								if (!entry.isTransferThresholdReached())
-									throw NeighborDatabase::NoMoreTransfersAvailable(task.eid);
+								NeighborDatabase::NeighborEntry *entry = db.find(t->peer, true);
 
 								// get the DeliveryPredictabilityMap of the potentially next hop
-								const DeliveryPredictabilityMap &dpm = entry.getDataset<DeliveryPredictabilityMap>();
-
-								if (dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect()) {
-									// get current neighbor list
-									neighbors = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
-								} else {
-									// "prefer direct" option disabled - clear the list of neighbors
-									neighbors.clear();
-								}
+								const DeliveryPredictabilityMap *dpm = (entry == NULL) ? NULL : entry->findDataset<DeliveryPredictabilityMap>();
 
-								// get a list of protocols supported by both, the local BPA and the remote peer
-								const dtn::net::ConnectionManager::protocol_list plist =
-										dtn::core::BundleCore::getInstance().getConnectionManager().getSupportedProtocols(entry.eid);
-
-								// create a filter context
-								dtn::core::FilterContext context;
-								context.setPeer(entry.eid);
-								context.setRouting(*this);
-
-								// get the bundle filter of the neighbor
-								const BundleFilter filter(entry, *_forwardingStrategy, dpm, neighbors, context, plist);
-
-								// some debug output
-								IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 40) << "search some bundles not known by " << task.eid.getString() << IBRCOMMON_LOGGER_ENDL;
-
-								// query some unknown bundle from the storage, the list contains max. 10 items.
-								(**this).getSeeker().get(filter, list);
-							} catch (const NeighborDatabase::DatasetNotAvailableException&) {
+								if (entry == NULL)
+								{
+									ret = SEARCH_NO_NEIGHBOR;
+								}
+								// check if enough transfer slots available (threshold reached)
+								else if (!entry->isTransferThresholdReached())
+								{
+									ret = SEARCH_NO_SLOTS;
+								}
 								// if there is no DeliveryPredictabilityMap for the next hop
 								// perform a routing handshake with the peer
-								(**this).doHandshake(task.eid);
-							} catch (const dtn::storage::BundleSelectorException&) {
-								// query a new summary vector from this neighbor
-								(**this).doHandshake(task.eid);
+								else if (dpm == NULL)
+								{
+									ret = SEARCH_NEED_HANDSHAKE;
+								}
+								else
+								{
+									// get the current snapshot of all neighbors
+									const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+
+									// consider the neighbors only if the "prefer direct" option is enabled
+									const std::set<dtn::core::Node> &neighbors = dtn::daemon::Configuration::getInstance().getNetwork().doPreferDirect() ? snapshot->getNeighbors() : no_neighbors;
+
+									// get a list of protocols supported by both, the local BPA and the remote peer
+									const dtn::net::ConnectionManager::protocol_list &plist = snapshot->getSupportedProtocols(entry->eid);
+
+									// create a filter context
+									dtn::core::FilterContext context;
+									context.setPeer(entry->eid);
+									context.setRouting(*this);
+
+									// get the bundle filter of the neighbor
+									const BundleFilter filter(*entry, *_forwardingStrategy, *dpm, neighbors, context, plist);
+
+									// some debug output
+									IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 40) << "search some bundles not known by " << t->peer.getString() << IBRCOMMON_LOGGER_ENDL;
+
+									// query some unknown bundle from the storage, the list contains max. 10 items.
+									try {
+										(**this).getSeeker().get(filter, list);
+									} catch (const dtn::storage::BundleSelectorException&) {
+										// query a new summary vector from this neighbor
+										ret = SEARCH_NEED_HANDSHAKE;
+									} catch (const dtn::storage::NoBundleFoundException&) {
+										ret = SEARCH_NO_BUNDLES;
+									}
+								}
 							}
 
 							// send the bundles as long as we have resources
-							for (RoutingResult::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+							if (ret == SEARCH_COMPLETED) ret = transferTo(t->peer, list);
+
+							switch (ret)
+							{
+							case SEARCH_NEED_HANDSHAKE:
+								(**this).doHandshake(t->peer);
+								break;
+
+							case SEARCH_NO_SLOTS:
 							{
-								try {
-									transferTo(task.eid, (*iter).first, (*iter).second);
-								} catch (const NeighborDatabase::AlreadyInTransitException&) { };
+								// remember that this peer has pending transfers
+								ibrcommon::MutexLock pending_lock(_pending_mutex);
+								_pending_peers.insert(t->peer);
+
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no more transfers allowed" << IBRCOMMON_LOGGER_ENDL;
+								break;
+							}
+
+							case SEARCH_NO_NEIGHBOR:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: neighbor not available" << IBRCOMMON_LOGGER_ENDL;
+								break;
+
+							case SEARCH_NO_BUNDLES:
+								IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: no bundles found" << IBRCOMMON_LOGGER_ENDL;
+								break;
+
+							default:
+								break;
 							}
-						} catch (const NeighborDatabase::NoMoreTransfersAvailable &ex) {
-							// remember that this peer has pending transfers
-							ibrcommon::MutexLock pending_lock(_pending_mutex);
-							_pending_peers.insert(ex.peer);
-
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NeighborDatabase::EntryNotFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const NodeNotAvailableException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const dtn::storage::NoBundleFoundException &ex) {
-							IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
-						} catch (const std::bad_cast&) { }
+							break;
+						}
 
 						/**
 						 * NextExchangeTask is a timer based event, that triggers
 						 * a new dp_map exchange for every connected node
 						 */
-						try {
-							dynamic_cast<NextExchangeTask&>(*t);
-
-							std::set<dtn::core::Node> neighbors = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
+						case TASK_NEXT_EXCHANGE:
+						{
+							const dtn::net::ConnectionManager::neighbor_snapshot snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+							const std::set<dtn::core::Node> &neighbors = snapshot->getNeighbors();
 							std::set<dtn::core::Node>::const_iterator it;
 							for(it = neighbors.begin(); it != neighbors.end(); ++it)
 							{
@@ -597,8 +709,14 @@ namespace dtn
 									(**this).doHandshake(it->getEID());
 								} catch (const ibrcommon::Exception &ex) { }
 							}
-						} catch (const std::bad_cast&) { }
+							break;
+						}
 
+						default:
+							break;
+						}
+					} catch (const NodeNotAvailableException &ex) {
+						IBRCOMMON_LOGGER_DEBUG_TAG(TAG, 10) << "task " << t->toString() << " aborted: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					} catch (const ibrcommon::Exception &ex) {
 						IBRCOMMON_LOGGER_DEBUG_TAG(ProphetRoutingExtension::TAG, 20) << "task failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
 					}
@@ -820,7 +938,7 @@ namespace dtn
 		}
 
 		ProphetRoutingExtension::SearchNextBundleTask::SearchNextBundleTask(const dtn::data::EID &eid)
-			: eid(eid)
+			: RoutingTask(TASK_SEARCH_NEXT_BUNDLE, eid, true)
 		{
 		}
 
@@ -830,10 +948,11 @@ namespace dtn
 
 		std::string ProphetRoutingExtension::SearchNextBundleTask::toString() const
 		{
-			return "SearchNextBundleTask: " + eid.getString();
+			return "SearchNextBundleTask: " + peer.getString();
 		}
 
 		ProphetRoutingExtension::NextExchangeTask::NextExchangeTask()
+			: RoutingTask(TASK_NEXT_EXCHANGE, dtn::data::EID(), true)
 		{
 		}
 
@@ -23,17 +23,19 @@
 #define PROPHETROUTINGEXTENSION_H_
 
 #include "routing/prophet/DeliveryPredictabilityMap.h"
+#include "routing/prophet/DeliveryPredictabilityDelta.h"
 #include "routing/prophet/ForwardingStrategy.h"
 #include "routing/prophet/AcknowledgementSet.h"
 
 #include "routing/RoutingExtension.h"
+#include "routing/HandshakeHistory.h"
+#include "routing/RoutingTaskQueue.h"
 #include "core/EventReceiver.h"
 #include "routing/NodeHandshakeEvent.h"
 #include "core/TimeEvent.h"
 #include "core/BundlePurgeEvent.h"
 
 #include <ibrcommon/thread/Mutex.h>
-#include <ibrcommon/thread/Queue.h>
 #include <ibrcommon/thread/ThreadsafeReference.h>
 
 #include <map>
@@ -134,6 +136,7 @@ namespace dtn
 			void restore(const ibrcommon::File &source);
 
 			DeliveryPredictabilityMap _deliveryPredictabilityMap;
+			HandshakeHistory<DeliveryPredictabilityDelta::predictmap> _deliveryPredictabilityHistory;
 			ForwardingStrategy *_forwardingStrategy;
 			AcknowledgementSet _acknowledgementSet;
 
@@ -158,25 +161,22 @@ namespace dtn
 
 			ibrcommon::File _persistent_file; ///< This file is used to store persistent routing data
 
-			class Task
+			enum TaskType
 			{
-			public:
-				virtual ~Task() {};
-				virtual std::string toString() const = 0;
+				TASK_SEARCH_NEXT_BUNDLE = 0,
+				TASK_NEXT_EXCHANGE = 1
 			};
 
-			class SearchNextBundleTask : public Task
+			class SearchNextBundleTask : public RoutingTask
 			{
 			public:
 				SearchNextBundleTask(const dtn::data::EID &eid);
 				virtual ~SearchNextBundleTask();
 
 				virtual std::string toString() const;
-
-				const dtn::data::EID eid;
 			};
 
-			class NextExchangeTask : public Task
+			class NextExchangeTask : public RoutingTask
 			{
 			public:
 				NextExchangeTask();
@@ -188,7 +188,7 @@ namespace dtn
 			/**
 			 * hold queued tasks for later processing
 			 */
-			ibrcommon::Queue<Task* > _taskqueue;
+			RoutingTaskQueue _taskqueue;
 
 			// set for pending transfers
 			ibrcommon::Mutex _pending_mutex;
@@ -0,0 +1,133 @@
+/*
+ * BundleConstraints.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "storage/BundleConstraints.h"
+
+namespace dtn
+{
+	namespace storage
+	{
+		BundleConstraints::BundleConstraints()
+		 : _constraints(CONSTRAINT_NONE), _min_priority(0), _exclude_filter(NULL)
+		{
+		}
+
+		BundleConstraints::~BundleConstraints()
+		{
+		}
+
+		void BundleConstraints::setDestination(const dtn::data::EID &destination)
+		{
+			_destination = destination;
+			_constraints |= CONSTRAINT_DESTINATION;
+		}
+
+		void BundleConstraints::setDestinationNode(const dtn::data::EID &node)
+		{
+			_destination_node = node.getNode();
+			_constraints |= CONSTRAINT_DESTINATION_NODE;
+		}
+
+		void BundleConstraints::setMinimumPriority(int priority)
+		{
+			_min_priority = priority;
+			_constraints |= CONSTRAINT_MIN_PRIORITY;
+		}
+
+		void BundleConstraints::setExcludeFilter(const ibrcommon::BloomFilter &filter)
+		{
+			_exclude_filter = &filter;
+			_constraints |= CONSTRAINT_NOT_IN_FILTER;
+		}
+
+		void BundleConstraints::setExcludeDestinationNode(const dtn::data::EID &node)
+		{
+			_excluded_node = node.getNode();
+			_constraints |= CONSTRAINT_NOT_DESTINATION_NODE;
+		}
+
+		void BundleConstraints::setForwardable()
+		{
+			_constraints |= CONSTRAINT_FORWARDABLE;
+		}
+
+		bool BundleConstraints::has(CONSTRAINT c) const
+		{
+			return (_constraints & c) == c;
+		}
+
+		const dtn::data::EID& BundleConstraints::getDestination() const
+		{
+			return _destination;
+		}
+
+		const dtn::data::EID& BundleConstraints::getDestinationNode() const
+		{
+			return _destination_node;
+		}
+
+		const dtn::data::EID& BundleConstraints::getExcludedDestinationNode() const
+		{
+			return _excluded_node;
+		}
+
+		int BundleConstraints::getMinimumPriority() const
+		{
+			return _min_priority;
+		}
+
+		const ibrcommon::BloomFilter& BundleConstraints::getExcludeFilter() const
+		{
+			// an empty filter does not exclude any bundle
+			static const ibrcommon::BloomFilter empty;
+
+			if (_exclude_filter == NULL) return empty;
+			return *_exclude_filter;
+		}
+
+		bool BundleConstraints::match(const dtn::data::MetaBundle &meta) const
+		{
+			if (_constraints == CONSTRAINT_NONE) return true;
+
+			if (has(CONSTRAINT_MIN_PRIORITY) && (meta.getPriority() < _min_priority)) return false;
+
+			if (has(CONSTRAINT_DESTINATION) && (meta.destination != _destination)) return false;
+
+			if (has(CONSTRAINT_DESTINATION_NODE) && !meta.destination.sameHost(_destination_node)) return false;
+
+			if (has(CONSTRAINT_NOT_DESTINATION_NODE) && meta.destination.sameHost(_excluded_node)) return false;
+
+			if (has(CONSTRAINT_FORWARDABLE))
+			{
+				if (meta.hopcount == 0) return false;
+				if ((meta.hopcount <= 1) && meta.get(dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON)) return false;
+			}
+
+			if (has(CONSTRAINT_NOT_IN_FILTER) && meta.isIn(*_exclude_filter)) return false;
+
+			return true;
+		}
+
+		IndexedBundleQuery::~IndexedBundleQuery()
+		{
+		}
+	} /* namespace storage */
+} /* namespace dtn */
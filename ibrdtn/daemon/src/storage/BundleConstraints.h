@@ -0,0 +1,135 @@
+/*
+ * BundleConstraints.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BUNDLECONSTRAINTS_H_
+#define BUNDLECONSTRAINTS_H_
+
+#include <ibrdtn/data/MetaBundle.h>
+#include <ibrdtn/data/EID.h>
+#include <ibrcommon/data/BloomFilter.h>
+
+namespace dtn
+{
+	namespace storage
+	{
+		/**
+		 * A set of constraints a bundle has to fulfill to get selected.
+		 * Storages use these constraints to answer queries using secondary
+		 * indexes instead of asking the selector for each stored bundle.
+		 */
+		class BundleConstraints
+		{
+		public:
+			enum CONSTRAINT
+			{
+				CONSTRAINT_NONE = 0,
+				CONSTRAINT_DESTINATION = 1,
+				CONSTRAINT_DESTINATION_NODE = 2,
+				CONSTRAINT_MIN_PRIORITY = 4,
+				CONSTRAINT_NOT_IN_FILTER = 8,
+				CONSTRAINT_NOT_DESTINATION_NODE = 16,
+				CONSTRAINT_FORWARDABLE = 32
+			};
+
+			BundleConstraints();
+			virtual ~BundleConstraints();
+
+			/**
+			 * Select only bundles addressed to this endpoint
+			 */
+			void setDestination(const dtn::data::EID &destination);
+
+			/**
+			 * Select only bundles addressed to an endpoint of this node
+			 */
+			void setDestinationNode(const dtn::data::EID &node);
+
+			/**
+			 * Select only bundles with a priority equal or greater than the given priority
+			 * (as returned by MetaBundle::getPriority(), -1 = low, 0 = medium, 1 = high)
+			 */
+			void setMinimumPriority(int priority);
+
+			/**
+			 * Skip all bundles which are contained in the bloom filter.
+			 * The filter has to be valid as long as these constraints are in use.
+			 */
+			void setExcludeFilter(const ibrcommon::BloomFilter &filter);
+
+			/**
+			 * Skip all bundles addressed to an endpoint of this node
+			 */
+			void setExcludeDestinationNode(const dtn::data::EID &node);
+
+			/**
+			 * Select only bundles which may be forwarded to another node according
+			 * to their hop limit (hop limit > 0 and hop limit > 1 for singleton bundles)
+			 */
+			void setForwardable();
+
+			/**
+			 * Returns true, if the given constraint is set
+			 */
+			bool has(CONSTRAINT c) const;
+
+			const dtn::data::EID& getDestination() const;
+			const dtn::data::EID& getDestinationNode() const;
+			const dtn::data::EID& getExcludedDestinationNode() const;
+			int getMinimumPriority() const;
+
+			/**
+			 * Returns the exclude filter or an empty filter if none has been set
+			 */
+			const ibrcommon::BloomFilter& getExcludeFilter() const;
+
+			/**
+			 * Returns true, if the bundle fulfills all constraints
+			 */
+			bool match(const dtn::data::MetaBundle &meta) const;
+
+		private:
+			unsigned int _constraints;
+			dtn::data::EID _destination;
+			dtn::data::EID _destination_node;
+			dtn::data::EID _excluded_node;
+			int _min_priority;
+			const ibrcommon::BloomFilter *_exclude_filter;
+		};
+
+		/**
+		 * A bundle selector may implement this interface in addition to
+		 * BundleSelector to declare constraints for the selected bundles.
+		 * All bundles passed to the selector will fulfill these constraints,
+		 * but the selector still decides on its own about the selection.
+		 */
+		class IndexedBundleQuery
+		{
+		public:
+			virtual ~IndexedBundleQuery() = 0;
+
+			/**
+			 * Returns the constraints of this query
+			 */
+			virtual const BundleConstraints& getConstraints() const throw () = 0;
+		};
+	} /* namespace storage */
+} /* namespace dtn */
+#endif /* BUNDLECONSTRAINTS_H_ */
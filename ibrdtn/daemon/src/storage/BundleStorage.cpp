@@ -187,6 +187,12 @@ namespace dtn
 			}
 		}
 
+		dtn::core::Metrics::Histogram BundleStorage::getLatency(const std::string &storage, const std::string &operation)
+		{
+			const std::string labels = dtn::core::Metrics::label("storage", storage) + "," + dtn::core::Metrics::label("operation", operation);
+			return dtn::core::Metrics::getInstance().getHistogram("dtnd_storage_latency_microseconds", labels, "Latency of storage operations");
+		}
+
 		void BundleStorage::attach(dtn::storage::BundleIndex *index)
 		{
 			ibrcommon::MutexLock l(_index_lock);
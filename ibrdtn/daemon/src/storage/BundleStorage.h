@@ -25,6 +25,7 @@
 #include <storage/BundleSeeker.h>
 #include <storage/BundleResult.h>
 #include <storage/BundleIndex.h>
+#include "core/Metrics.h"
 #include <ibrdtn/data/Bundle.h>
 #include <ibrdtn/data/BundleSet.h>
 #include <ibrdtn/data/BundleID.h>
@@ -193,6 +194,13 @@ namespace dtn
 			void eventBundleAdded(const dtn::data::MetaBundle &b) throw ();
 			void eventBundleRemoved(const dtn::data::BundleID &id) throw ();
 
+			/**
+			 * Returns the histogram for the latency of an operation
+			 * @param storage The name of the storage implementation
+			 * @param operation The name of the operation, e.g. store
+			 */
+			static dtn::core::Metrics::Histogram getLatency(const std::string &storage, const std::string &operation);
+
 			bool _faulty;
 
 		private:
@@ -0,0 +1,887 @@
+/*
+ * LogBundleStorage.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "storage/LogBundleStorage.h"
+#include "core/EventDispatcher.h"
+#include "core/BundleExpiredEvent.h"
+#include "core/BundleEvent.h"
+
+#include <ibrdtn/data/AgeBlock.h>
+#include <ibrdtn/data/BundleString.h>
+#include <ibrdtn/data/Serializer.h>
+#include <ibrcommon/thread/RWLock.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/Logger.h>
+
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <time.h>
+
+namespace dtn
+{
+	namespace storage
+	{
+		const std::string LogBundleStorage::TAG = "LogBundleStorage";
+
+		LogBundleStorage::Location::Location()
+		 : segment(0), offset(0), header(0), length(0)
+		{
+		}
+
+		LogBundleStorage::Location::Location(const dtn::data::Size &s, const dtn::data::Length &o, const dtn::data::Length &h, const dtn::data::Length &l)
+		 : segment(s), offset(o), header(h), length(l)
+		{
+		}
+
+		LogBundleStorage::Segment::Segment()
+		 : size(0), live(0)
+		{
+		}
+
+		LogBundleStorage::Segment::Segment(const ibrcommon::File &f)
+		 : file(f), size(0), live(0)
+		{
+		}
+
+		LogBundleStorage::LogBundleStorage(const ibrcommon::File &workdir, const dtn::data::Length maxsize, const dtn::data::Length segment_size)
+		 : BundleStorage(maxsize), _workdir(workdir), _segment_size((segment_size > 0) ? segment_size : 16000000), _metastore(this), _active(0), _next_segment(0)
+		{
+		}
+
+		LogBundleStorage::~LogBundleStorage()
+		{
+		}
+
+		void LogBundleStorage::componentUp() throw ()
+		{
+			// routine checked for throw() on 15.02.2013
+
+			_compactions.reset();
+
+			{
+				ibrcommon::RWLock l(_lock);
+
+				// restore all bundles of the segments
+				__load();
+
+				IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, info) << _metastore.size() << " Bundles restored from " << _segments.size() << " segments." << IBRCOMMON_LOGGER_ENDL;
+			}
+
+			dtn::core::EventDispatcher<dtn::core::TimeEvent>::add(this);
+		}
+
+		void LogBundleStorage::componentRun() throw ()
+		{
+			try {
+				while (true)
+				{
+					const dtn::data::Size segment = _compactions.poll();
+
+					__compact(segment);
+
+					ibrcommon::MutexLock l(_compactions_cond);
+					_compactions_pending.erase(segment);
+					_compactions_cond.signal(true);
+				}
+			} catch (const ibrcommon::QueueUnblockedException&) {
+				// we are aborted
+			}
+		}
+
+		void LogBundleStorage::componentDown() throw ()
+		{
+			// routine checked for throw() on 15.02.2013
+
+			dtn::core::EventDispatcher<dtn::core::TimeEvent>::remove(this);
+
+			stop();
+			join();
+
+			{
+				ibrcommon::MutexLock l(_compactions_cond);
+				_compactions_pending.clear();
+				_compactions_cond.signal(true);
+			}
+
+			// clear all data structures
+			ibrcommon::RWLock l(_lock);
+			_writer.close();
+			_metastore.clear();
+			_locations.clear();
+			_segments.clear();
+			clearSpace();
+		}
+
+		void LogBundleStorage::__cancellation() throw ()
+		{
+			_compactions.abort();
+		}
+
+		const std::string LogBundleStorage::getName() const
+		{
+			return "LogBundleStorage";
+		}
+
+		ibrcommon::File LogBundleStorage::__segment_file(const dtn::data::Size &segment) const
+		{
+			std::stringstream ss;
+			ss << "segment-" << std::setw(8) << std::setfill('0') << segment << ".log";
+			return _workdir.get(ss.str());
+		}
+
+		void LogBundleStorage::__load()
+		{
+			_metastore.clear();
+			_locations.clear();
+			_segments.clear();
+			_next_segment = 0;
+
+			// collect all segment files ordered by their number
+			std::map<dtn::data::Size, ibrcommon::File> files;
+			{
+				std::list<ibrcommon::File> list;
+				_workdir.getFiles(list);
+
+				for (std::list<ibrcommon::File>::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+				{
+					const ibrcommon::File &f = (*iter);
+					if (f.isSystem() || f.isDirectory()) continue;
+
+					const std::string name = f.getBasename();
+					if ((name.length() != 20) || (name.substr(0, 8) != "segment-") || (name.substr(16) != ".log")) continue;
+
+					std::stringstream ss(name.substr(8, 8));
+					dtn::data::Size segment = 0;
+					if (!(ss >> segment)) continue;
+
+					files[segment] = f;
+				}
+			}
+
+			// the meta data of all restored bundles
+			std::map<dtn::data::BundleID, dtn::data::MetaBundle> restored;
+
+			// find bundle records by their position
+			std::map<tombstone, dtn::data::BundleID> positions;
+
+			for (std::map<dtn::data::Size, ibrcommon::File>::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+			{
+				const dtn::data::Size &segment = (*iter).first;
+				Segment &seg = _segments[segment];
+				seg = Segment((*iter).second);
+
+				_next_segment = segment + 1;
+
+				std::ifstream is(seg.file.getPath().c_str(), std::ios::in | std::ios::binary);
+				const dtn::data::Length filesize = seg.file.size();
+				dtn::data::Length offset = 0;
+
+				while (offset < filesize)
+				{
+					RECORD_TYPE type;
+					std::string meta;
+					Location loc(segment, offset, 0, 0);
+
+					is.seekg(offset);
+					if (!__read_header(is, filesize, type, meta, loc))
+					{
+						IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, warning) << "incomplete record at offset " << offset << " in " << seg.file.getPath() << IBRCOMMON_LOGGER_ENDL;
+						break;
+					}
+
+					if (type == RECORD_BUNDLE)
+					{
+						try {
+							dtn::data::MetaBundle m;
+							dtn::data::Timestamp stored;
+							__decode(meta, m, stored);
+
+							// a newer copy of the record supersedes the previous one
+							location_map::iterator it = _locations.find(m);
+							if (it != _locations.end())
+							{
+								const Location &old = (*it).second;
+								_segments[old.segment].live -= (old.header + old.length);
+								positions.erase(tombstone(old.segment, old.offset));
+							}
+
+							_locations[m] = loc;
+							restored[m] = m;
+							positions[tombstone(segment, offset)] = m;
+							seg.live += (loc.header + loc.length);
+						} catch (const ibrcommon::Exception &ex) {
+							IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, warning) << "unable to read record at offset " << offset << " in " << seg.file.getPath() << ": " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+						}
+					}
+					else if (type == RECORD_TOMBSTONE)
+					{
+						std::stringstream ss(meta);
+						dtn::data::Number target_segment, target_offset;
+						ss >> target_segment >> target_offset;
+
+						const tombstone t(target_segment.get<dtn::data::Size>(), target_offset.get<dtn::data::Length>());
+
+						std::map<tombstone, dtn::data::BundleID>::iterator pos = positions.find(t);
+						if (pos != positions.end())
+						{
+							location_map::iterator it = _locations.find((*pos).second);
+							const Location &old = (*it).second;
+							_segments[old.segment].live -= (old.header + old.length);
+
+							restored.erase((*pos).second);
+							_locations.erase(it);
+							positions.erase(pos);
+						}
+
+						// keep the tombstone as long as the segment of the record exists
+						if (_segments.find(t.first) != _segments.end())
+						{
+							seg.tombstones.push_back(t);
+						}
+					}
+
+					offset += (loc.header + loc.length);
+				}
+
+				is.close();
+
+				// cut-off incomplete records at the end of the segment
+				if (offset < filesize)
+				{
+					if (::truncate(seg.file.getPath().c_str(), offset) != 0)
+					{
+						IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "unable to truncate " << seg.file.getPath() << ": " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					}
+				}
+
+				seg.size = offset;
+			}
+
+			// continue with the last segment
+			__open_writer(_segments.empty());
+
+			std::list<dtn::data::MetaBundle> dropped;
+
+			for (std::map<dtn::data::BundleID, dtn::data::MetaBundle>::const_iterator iter = restored.begin(); iter != restored.end(); ++iter)
+			{
+				const dtn::data::MetaBundle &meta = (*iter).second;
+				const Location &loc = _locations[meta];
+
+				try {
+					// allocate space for the bundle
+					allocSpace(loc.length);
+				} catch (const StorageSizeExeededException&) {
+					IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, warning) << "storage limit exceeded, drop bundle " << meta.toString() << IBRCOMMON_LOGGER_ENDL;
+					dropped.push_back(meta);
+					continue;
+				}
+
+				// add the bundle to the stored bundles
+				_metastore.store(meta, loc.length);
+
+				// raise bundle added event
+				eventBundleAdded(meta);
+			}
+
+			// write a tombstone for each dropped bundle
+			for (std::list<dtn::data::MetaBundle>::const_iterator iter = dropped.begin(); iter != dropped.end(); ++iter)
+			{
+				__remove(*iter);
+			}
+
+			// compact segments with mostly dead records
+			for (segment_map::const_iterator iter = _segments.begin(); iter != _segments.end(); ++iter)
+			{
+				__check_compaction((*iter).first);
+			}
+		}
+
+		void LogBundleStorage::__open_writer(bool rollover)
+		{
+			_writer.close();
+			_writer.clear();
+
+			if (rollover || _segments.empty())
+			{
+				_active = _next_segment++;
+				_segments[_active] = Segment(__segment_file(_active));
+
+				IBRCOMMON_LOGGER_DEBUG_TAG(LogBundleStorage::TAG, 20) << "start new segment " << _segments[_active].file.getPath() << IBRCOMMON_LOGGER_ENDL;
+			}
+			else
+			{
+				_active = (*_segments.rbegin()).first;
+			}
+
+			_writer.open(_segments[_active].file.getPath().c_str(), std::ios::out | std::ios::binary | std::ios::app);
+
+			if (!_writer.good())
+			{
+				IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "unable to open segment " << _segments[_active].file.getPath() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		LogBundleStorage::Location LogBundleStorage::__append(RECORD_TYPE type, const std::string &meta, const dtn::data::Bundle *bundle, const dtn::data::Length &length) throw (ibrcommon::IOException)
+		{
+			// start a new segment if the active one is full
+			if (_segments[_active].size >= _segment_size) __open_writer(true);
+
+			Segment &seg = _segments[_active];
+
+			const dtn::data::Number meta_length(meta.length());
+			const dtn::data::Number data_length(length);
+
+			Location loc(_active, seg.size, 1 + meta_length.getLength() + data_length.getLength() + meta.length(), length);
+
+			_writer.put(static_cast<char>(type));
+			_writer << meta_length << data_length;
+			_writer.write(meta.c_str(), meta.length());
+
+			if (bundle != NULL)
+			{
+				dtn::data::DefaultSerializer(_writer) << (*bundle);
+			}
+
+			_writer.flush();
+
+			if (!_writer.good())
+			{
+				// remove the incomplete record
+				if (::truncate(seg.file.getPath().c_str(), seg.size) != 0)
+				{
+					IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "unable to truncate " << seg.file.getPath() << ": " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+				}
+
+				__open_writer(false);
+
+				throw ibrcommon::IOException("unable to write to segment " + seg.file.getPath());
+			}
+
+			seg.size += (loc.header + loc.length);
+
+			return loc;
+		}
+
+		std::string LogBundleStorage::__encode(const dtn::data::MetaBundle &meta, const dtn::data::Timestamp &stored)
+		{
+			std::stringstream ss;
+
+			ss << (const dtn::data::BundleID&)meta;
+			ss << meta.lifetime;
+			ss << dtn::data::BundleString(meta.destination.getString());
+			ss << dtn::data::BundleString(meta.reportto.getString());
+			ss << dtn::data::BundleString(meta.custodian.getString());
+			ss << meta.appdatalength;
+			ss << meta.procflags;
+			ss << meta.expiretime;
+			ss << meta.hopcount;
+
+			// the priority may be negative
+			const int priority = meta.net_priority.get<int>();
+			ss.put((priority < 0) ? 1 : 0);
+			ss << dtn::data::Number((priority < 0) ? -priority : priority);
+
+			ss << stored;
+
+			return ss.str();
+		}
+
+		void LogBundleStorage::__decode(const std::string &data, dtn::data::MetaBundle &meta, dtn::data::Timestamp &stored)
+		{
+			std::stringstream ss(data);
+			dtn::data::BundleString destination, reportto, custodian;
+			dtn::data::Number priority;
+			char negative = 0;
+
+			ss >> (dtn::data::BundleID&)meta;
+			ss >> meta.lifetime;
+			ss >> destination >> reportto >> custodian;
+			ss >> meta.appdatalength;
+			ss >> meta.procflags;
+			ss >> meta.expiretime;
+			ss >> meta.hopcount;
+			ss.get(negative);
+			ss >> priority;
+			ss >> stored;
+
+			if (ss.fail()) throw ibrcommon::Exception("record header is incomplete");
+
+			meta.destination = dtn::data::EID(destination);
+			meta.reportto = dtn::data::EID(reportto);
+			meta.custodian = dtn::data::EID(custodian);
+			meta.net_priority = negative ? -priority.get<int>() : priority.get<int>();
+		}
+
+		bool LogBundleStorage::__read_header(std::istream &stream, const dtn::data::Length &size, RECORD_TYPE &type, std::string &meta, Location &location)
+		{
+			char t = 0;
+			dtn::data::Number meta_length, data_length;
+
+			stream.get(t);
+			stream >> meta_length >> data_length;
+			if (stream.fail()) return false;
+
+			type = static_cast<RECORD_TYPE>(t);
+			if ((type != RECORD_BUNDLE) && (type != RECORD_TOMBSTONE)) return false;
+
+			const dtn::data::Length mlen = meta_length.get<dtn::data::Length>();
+			if (mlen > size) return false;
+
+			std::vector<char> buf(mlen);
+			if (mlen > 0) stream.read(&buf[0], mlen);
+			if (stream.fail()) return false;
+			meta.assign(buf.begin(), buf.end());
+
+			location.header = 1 + meta_length.getLength() + data_length.getLength() + mlen;
+			location.length = data_length.get<dtn::data::Length>();
+
+			// the data of the record has to be complete
+			return (location.offset + location.header + location.length <= size);
+		}
+
+		void LogBundleStorage::raiseEvent(const dtn::core::TimeEvent &time) throw ()
+		{
+			if (time.getAction() == dtn::core::TIME_SECOND_TICK)
+			{
+				ibrcommon::RWLock l(_lock);
+				_metastore.expire(time.getTimestamp());
+
+				// remove all expired bundles
+				for (std::list<dtn::data::MetaBundle>::const_iterator iter = _expired.begin(); iter != _expired.end(); ++iter)
+				{
+					const dtn::data::MetaBundle &b = (*iter);
+
+					__remove(b);
+
+					// raise bundle event
+					dtn::core::BundleEvent::raise( b, dtn::core::BUNDLE_DELETED, dtn::data::StatusReportBlock::LIFETIME_EXPIRED);
+
+					// raise an event
+					dtn::core::BundleExpiredEvent::raise( b );
+
+					// raise bundle removed event
+					eventBundleRemoved(b);
+				}
+
+				_expired.clear();
+			}
+		}
+
+		void LogBundleStorage::eventBundleExpired(const dtn::data::MetaBundle &b) throw ()
+		{
+			// the bundle list is iterated right now, defer the removal
+			_expired.push_back(b);
+		}
+
+		bool LogBundleStorage::empty()
+		{
+			ibrcommon::MutexLock l(_lock);
+			return _metastore.empty();
+		}
+
+		dtn::data::Size LogBundleStorage::count()
+		{
+			ibrcommon::MutexLock l(_lock);
+			return _metastore.size();
+		}
+
+		dtn::data::Size LogBundleStorage::getSegmentCount()
+		{
+			ibrcommon::MutexLock l(_lock);
+			return _segments.size();
+		}
+
+		void LogBundleStorage::releaseCustody(const dtn::data::EID&, const dtn::data::BundleID&)
+		{
+			// custody is successful transferred to another node.
+			// it is safe to delete this bundle now. (depending on the routing algorithm.)
+		}
+
+		void LogBundleStorage::wait()
+		{
+			ibrcommon::MutexLock l(_compactions_cond);
+			while (!_compactions_pending.empty()) _compactions_cond.wait();
+		}
+
+		void LogBundleStorage::setFaulty(bool mode)
+		{
+			_faulty = mode;
+		}
+
+		void LogBundleStorage::get(const BundleSelector &cb, BundleResult &result) throw (NoBundleFoundException, BundleSelectorException)
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			// select bundles using the meta storage indexes
+			if (_metastore.select(cb, result) == 0) throw NoBundleFoundException();
+		}
+
+		dtn::data::Bundle LogBundleStorage::get(const dtn::data::BundleID &id)
+		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("log", "get");
+			dtn::core::Metrics::Timer timer(latency);
+
+			try {
+				ibrcommon::MutexLock l(_lock);
+
+				// faulty mechanism for unit-testing
+				if (_faulty) {
+					throw dtn::SerializationFailedException("bundle get failed due to faulty setting");
+				}
+
+				location_map::const_iterator it = _locations.find(id);
+				if (it == _locations.end()) throw NoBundleFoundException();
+
+				const Location &loc = (*it).second;
+				const Segment &seg = (*_segments.find(loc.segment)).second;
+
+				std::ifstream is(seg.file.getPath().c_str(), std::ios::in | std::ios::binary);
+
+				// read the record header
+				RECORD_TYPE type;
+				std::string meta;
+				Location header(loc.segment, loc.offset, 0, 0);
+
+				is.seekg(loc.offset);
+				if (!__read_header(is, seg.size, type, meta, header) || (type != RECORD_BUNDLE))
+				{
+					throw dtn::SerializationFailedException("invalid record in " + seg.file.getPath());
+				}
+
+				dtn::data::MetaBundle m;
+				dtn::data::Timestamp stored;
+				__decode(meta, m, stored);
+
+				// load the bundle from the segment
+				dtn::data::Bundle bundle;
+
+				try {
+					dtn::data::DefaultDeserializer(is) >> bundle;
+				} catch (const std::exception &ex) {
+					throw dtn::SerializationFailedException(ex.what());
+				}
+
+				try {
+					dtn::data::AgeBlock &agebl = bundle.find<dtn::data::AgeBlock>();
+
+					// modify the AgeBlock with the time spent in the storage
+					const dtn::data::Timestamp now = ::time(NULL);
+					if (now > stored) agebl.addSeconds(now - stored);
+				} catch (const dtn::data::Bundle::NoSuchBlockFoundException&) { };
+
+				return bundle;
+			} catch (const dtn::SerializationFailedException &ex) {
+				// bundle loading failed
+				IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "failed to load bundle: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+
+				// the bundle is broken, delete it
+				remove(id);
+
+				throw BundleStorage::BundleLoadException(ex.what());
+			}
+		}
+
+		const LogBundleStorage::eid_set LogBundleStorage::getDistinctDestinations()
+		{
+			ibrcommon::MutexLock l(_lock);
+			return _metastore.getDistinctDestinations();
+		}
+
+		void LogBundleStorage::store(const dtn::data::Bundle &bundle)
+		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("log", "store");
+			dtn::core::Metrics::Timer timer(latency);
+
+			// get the bundle size
+			dtn::data::DefaultSerializer s(std::cout);
+			const dtn::data::Length bundle_size = s.getLength(bundle);
+
+			// allocate space for the bundle
+			allocSpace(bundle_size);
+
+			// container for the bundle to store
+			dtn::data::Bundle b = bundle;
+
+			// accept custody if requested
+			try {
+				// set the new custodian
+				b.custodian = BundleStorage::acceptCustody(dtn::data::MetaBundle::create(bundle));
+			} catch (const ibrcommon::Exception&) {
+				// no custody has been requested - go on with standard store procedure
+			}
+
+			// create meta bundle object
+			const dtn::data::MetaBundle meta = dtn::data::MetaBundle::create(b);
+
+			ibrcommon::RWLock l(_lock);
+
+			// faulty mechanism for unit-testing
+			if (_faulty || (_locations.find(meta) != _locations.end()))
+			{
+				IBRCOMMON_LOGGER_DEBUG_TAG(LogBundleStorage::TAG, 10) << "bundle " << meta.toString() << " not stored" << IBRCOMMON_LOGGER_ENDL;
+				freeSpace(bundle_size);
+				return;
+			}
+
+			try {
+				// append the bundle to the active segment
+				const Location loc = __append(RECORD_BUNDLE, __encode(meta, ::time(NULL)), &b, bundle_size);
+
+				_locations[meta] = loc;
+				_segments[loc.segment].live += (loc.header + loc.length);
+
+				// add the new bundles to the meta storage
+				_metastore.store(meta, bundle_size);
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "failed to store bundle " << meta.toString() << ": " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+				freeSpace(bundle_size);
+				return;
+			}
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(LogBundleStorage::TAG, 10) << "bundle " << meta.toString() << " stored" << IBRCOMMON_LOGGER_ENDL;
+
+			// raise bundle added event
+			eventBundleAdded(meta);
+		}
+
+		bool LogBundleStorage::contains(const dtn::data::BundleID &id)
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			// search for the bundle in the meta storage
+			return _metastore.contains(id);
+		}
+
+		dtn::data::MetaBundle LogBundleStorage::info(const dtn::data::BundleID &id)
+		{
+			ibrcommon::MutexLock l(_lock);
+
+			// search for the bundle in the meta storage
+			return _metastore.find(dtn::data::MetaBundle::create(id));
+		}
+
+		void LogBundleStorage::remove(const dtn::data::BundleID &id)
+		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("log", "remove");
+			dtn::core::Metrics::Timer timer(latency);
+
+			ibrcommon::RWLock l(_lock);
+
+			if (!_metastore.contains(id)) return;
+
+			// copy the meta data, the entry in the meta storage will be removed
+			const dtn::data::MetaBundle meta = _metastore.find(dtn::data::MetaBundle::create(id));
+
+			__remove(meta);
+
+			// raise bundle removed event
+			eventBundleRemoved(meta);
+		}
+
+		void LogBundleStorage::__remove(const dtn::data::MetaBundle &meta)
+		{
+			// remove bundle and decrement the storage size
+			freeSpace( _metastore.remove(meta) );
+
+			location_map::iterator it = _locations.find(meta);
+			if (it == _locations.end()) return;
+
+			const Location loc = (*it).second;
+			_locations.erase(it);
+
+			_segments[loc.segment].live -= (loc.header + loc.length);
+
+			// mark the record as removed
+			try {
+				std::stringstream ss;
+				ss << dtn::data::Number(loc.segment) << dtn::data::Number(loc.offset);
+
+				const Location t = __append(RECORD_TOMBSTONE, ss.str(), NULL, 0);
+				_segments[t.segment].tombstones.push_back( tombstone(loc.segment, loc.offset) );
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "failed to remove bundle " << meta.toString() << ": " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			}
+
+			__check_compaction(loc.segment);
+		}
+
+		void LogBundleStorage::clear()
+		{
+			ibrcommon::RWLock l(_lock);
+
+			for (location_map::const_iterator iter = _locations.begin(); iter != _locations.end(); ++iter)
+			{
+				// raise bundle removed event
+				eventBundleRemoved((*iter).first);
+			}
+
+			// delete all segments
+			_writer.close();
+			for (segment_map::iterator iter = _segments.begin(); iter != _segments.end(); ++iter)
+			{
+				(*iter).second.file.remove();
+			}
+
+			_segments.clear();
+			_locations.clear();
+			_metastore.clear();
+
+			// start with an empty segment
+			__open_writer(true);
+
+			// set the storage size to zero
+			clearSpace();
+		}
+
+		void LogBundleStorage::__check_compaction(const dtn::data::Size &segment)
+		{
+			// never compact the active segment
+			if (segment == _active) return;
+
+			segment_map::const_iterator it = _segments.find(segment);
+			if (it == _segments.end()) return;
+
+			// compact segments with less than 25% of live data
+			const Segment &seg = (*it).second;
+			if (seg.live * 4 >= seg.size) return;
+
+			ibrcommon::MutexLock l(_compactions_cond);
+			if (_compactions_pending.insert(segment).second)
+			{
+				_compactions.push(segment);
+			}
+		}
+
+		void LogBundleStorage::__compact(const dtn::data::Size &segment)
+		{
+			std::list<dtn::data::BundleID> records;
+			ibrcommon::File file;
+
+			{
+				ibrcommon::MutexLock l(_lock);
+
+				segment_map::const_iterator it = _segments.find(segment);
+				if (it == _segments.end()) return;
+				file = (*it).second.file;
+
+				// collect all live records of this segment
+				for (location_map::const_iterator iter = _locations.begin(); iter != _locations.end(); ++iter)
+				{
+					if ((*iter).second.segment == segment) records.push_back((*iter).first);
+				}
+			}
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(LogBundleStorage::TAG, 20) << "compact segment " << file.getPath() << " with " << records.size() << " live records" << IBRCOMMON_LOGGER_ENDL;
+
+			std::ifstream is(file.getPath().c_str(), std::ios::in | std::ios::binary);
+			std::vector<char> buf(4096);
+
+			// move each record to the active segment, release the lock in between
+			for (std::list<dtn::data::BundleID>::const_iterator iter = records.begin(); iter != records.end(); ++iter)
+			{
+				ibrcommon::RWLock l(_lock);
+
+				// the segment has been deleted in the meantime
+				if (_segments.find(segment) == _segments.end()) return;
+
+				location_map::iterator it = _locations.find(*iter);
+				if ((it == _locations.end()) || ((*it).second.segment != segment)) continue;
+
+				Location &loc = (*it).second;
+
+				// start a new segment if the active one is full
+				if (_segments[_active].size >= _segment_size) __open_writer(true);
+
+				Segment &target = _segments[_active];
+
+				// copy the raw record
+				is.seekg(loc.offset);
+				dtn::data::Length remain = loc.header + loc.length;
+				while (remain > 0 && is.good())
+				{
+					const std::streamsize chunk = static_cast<std::streamsize>((remain < buf.size()) ? remain : buf.size());
+					is.read(&buf[0], chunk);
+					_writer.write(&buf[0], is.gcount());
+					remain -= is.gcount();
+				}
+				_writer.flush();
+
+				if ((remain > 0) || !_writer.good())
+				{
+					IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "compaction of segment " << file.getPath() << " failed" << IBRCOMMON_LOGGER_ENDL;
+
+					// remove the incomplete record
+					if (::truncate(target.file.getPath().c_str(), target.size) != 0)
+					{
+						IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "unable to truncate " << target.file.getPath() << ": " << ::strerror(errno) << IBRCOMMON_LOGGER_ENDL;
+					}
+
+					__open_writer(false);
+					return;
+				}
+
+				// update the location of the record
+				_segments[segment].live -= (loc.header + loc.length);
+				loc.segment = _active;
+				loc.offset = target.size;
+				target.size += (loc.header + loc.length);
+				target.live += (loc.header + loc.length);
+			}
+
+			is.close();
+
+			ibrcommon::RWLock l(_lock);
+
+			segment_map::iterator it = _segments.find(segment);
+			if (it == _segments.end()) return;
+
+			// keep the tombstones of records in other segments
+			const std::list<tombstone> tombstones = (*it).second.tombstones;
+			for (std::list<tombstone>::const_iterator iter = tombstones.begin(); iter != tombstones.end(); ++iter)
+			{
+				const tombstone &t = (*iter);
+				if ((t.first == segment) || (_segments.find(t.first) == _segments.end())) continue;
+
+				try {
+					std::stringstream ss;
+					ss << dtn::data::Number(t.first) << dtn::data::Number(t.second);
+
+					const Location loc = __append(RECORD_TOMBSTONE, ss.str(), NULL, 0);
+					_segments[loc.segment].tombstones.push_back(t);
+				} catch (const ibrcommon::Exception &ex) {
+					// keep the segment, otherwise removed bundles would be restored
+					IBRCOMMON_LOGGER_TAG(LogBundleStorage::TAG, error) << "compaction of segment " << file.getPath() << " failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+					return;
+				}
+			}
+
+			// delete the segment
+			(*it).second.file.remove();
+			_segments.erase(it);
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(LogBundleStorage::TAG, 20) << "segment " << file.getPath() << " compacted" << IBRCOMMON_LOGGER_ENDL;
+		}
+	}
+}
@@ -0,0 +1,308 @@
+/*
+ * LogBundleStorage.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LOGBUNDLESTORAGE_H_
+#define LOGBUNDLESTORAGE_H_
+
+#include "Component.h"
+#include "storage/BundleStorage.h"
+#include "storage/MetaStorage.h"
+#include "core/EventReceiver.h"
+#include "core/TimeEvent.h"
+
+#include <ibrdtn/data/Bundle.h>
+#include <ibrdtn/data/BundleList.h>
+#include <ibrcommon/data/File.h>
+#include <ibrcommon/thread/RWMutex.h>
+#include <ibrcommon/thread/Queue.h>
+#include <ibrcommon/thread/Conditional.h>
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <set>
+
+namespace dtn
+{
+	namespace storage
+	{
+		/**
+		 * This storage appends serialized bundles to large segment files. The location
+		 * of each bundle is kept in memory and rebuilt on startup using the record headers
+		 * of the segments only. Removed bundles are marked with a tombstone record and
+		 * segments with mostly dead records are compacted in the background.
+		 */
+		class LogBundleStorage : public BundleStorage, public dtn::core::EventReceiver<dtn::core::TimeEvent>, public dtn::daemon::IndependentComponent, public dtn::data::BundleList::Listener
+		{
+			static const std::string TAG;
+
+		public:
+			/**
+			 * Constructor
+			 * @param workdir Directory for the segment files
+			 * @param maxsize Max. number of bytes to store
+			 * @param segment_size A new segment is started if the active segment exceeds this size
+			 */
+			LogBundleStorage(const ibrcommon::File &workdir, const dtn::data::Length maxsize = 0, const dtn::data::Length segment_size = 0);
+
+			/**
+			 * Destructor
+			 */
+			virtual ~LogBundleStorage();
+
+			/**
+			 * Stores a bundle in the storage.
+			 * @param bundle The bundle to store.
+			 */
+			virtual void store(const dtn::data::Bundle &bundle);
+
+			/**
+			 * This method returns true if the requested bundle is
+			 * stored in the storage.
+			 */
+			virtual bool contains(const dtn::data::BundleID &id);
+
+			/**
+			 * Get meta data about a specific bundle ID
+			 */
+			virtual dtn::data::MetaBundle info(const dtn::data::BundleID &id);
+
+			/**
+			 * This method returns a specific bundle which is identified by
+			 * its id.
+			 * @param id The ID of the bundle to return.
+			 * @return A bundle object of the
+			 */
+			virtual dtn::data::Bundle get(const dtn::data::BundleID &id);
+
+			/**
+			 * @see BundleSeeker::get(BundleSelector &cb, BundleResult &result)
+			 */
+			virtual void get(const BundleSelector &cb, BundleResult &result) throw (NoBundleFoundException, BundleSelectorException);
+
+			/**
+			 * @see BundleSeeker::getDistinctDestinations()
+			 */
+			virtual const eid_set getDistinctDestinations();
+
+			/**
+			 * This method deletes a specific bundle in the storage.
+			 * No reports will be generated here.
+			 * @param id The ID of the bundle to remove.
+			 */
+			void remove(const dtn::data::BundleID &id);
+
+			/**
+			 * @sa BundleStorage::clear()
+			 */
+			void clear();
+
+			/**
+			 * @sa BundleStorage::empty()
+			 */
+			bool empty();
+
+			/**
+			 * @sa BundleStorage::count()
+			 */
+			dtn::data::Size count();
+
+			/**
+			 * @sa BundleStorage::releaseCustody();
+			 */
+			void releaseCustody(const dtn::data::EID &custodian, const dtn::data::BundleID &id);
+
+			/**
+			 * This method is used to receive events.
+			 * @param evt
+			 */
+			void raiseEvent(const dtn::core::TimeEvent &evt) throw ();
+
+			/**
+			 * @see Component::getName()
+			 */
+			virtual const std::string getName() const;
+
+			/**
+			 * Returns the number of segment files
+			 */
+			dtn::data::Size getSegmentCount();
+
+			/*** BEGIN: methods for unit-testing ***/
+
+			/**
+			 * Wait until all pending compactions are done
+			 */
+			virtual void wait();
+
+			/**
+			 * Set the storage to faulty. If set to true, each try to store
+			 * or retrieve a bundle will fail.
+			 */
+			virtual void setFaulty(bool mode);
+
+			/*** END: methods for unit-testing ***/
+
+		protected:
+			virtual void componentUp() throw ();
+			virtual void componentRun() throw ();
+			virtual void componentDown() throw ();
+			void __cancellation() throw ();
+
+			virtual void eventBundleExpired(const dtn::data::MetaBundle &b) throw ();
+
+		private:
+			enum RECORD_TYPE
+			{
+				RECORD_BUNDLE = 1,
+				RECORD_TOMBSTONE = 2
+			};
+
+			/**
+			 * Location of a bundle record within the segments
+			 */
+			class Location
+			{
+			public:
+				Location();
+				Location(const dtn::data::Size &segment, const dtn::data::Length &offset, const dtn::data::Length &header, const dtn::data::Length &length);
+
+				// number of the segment
+				dtn::data::Size segment;
+
+				// offset of the record within the segment
+				dtn::data::Length offset;
+
+				// length of the record header
+				dtn::data::Length header;
+
+				// length of the serialized bundle following the header
+				dtn::data::Length length;
+			};
+
+			/**
+			 * A tombstone marks a bundle record as removed
+			 */
+			typedef std::pair<dtn::data::Size, dtn::data::Length> tombstone;
+
+			class Segment
+			{
+			public:
+				Segment();
+				Segment(const ibrcommon::File &file);
+
+				ibrcommon::File file;
+
+				// number of bytes in the segment
+				dtn::data::Length size;
+
+				// number of bytes of records belonging to stored bundles
+				dtn::data::Length live;
+
+				// tombstones stored in this segment
+				std::list<tombstone> tombstones;
+			};
+
+			typedef std::map<dtn::data::Size, Segment> segment_map;
+			typedef std::map<dtn::data::BundleID, Location> location_map;
+
+			/**
+			 * Returns the file of the segment with the given number
+			 */
+			ibrcommon::File __segment_file(const dtn::data::Size &segment) const;
+
+			/**
+			 * Scan all segments and restore the locations of all bundles
+			 */
+			void __load();
+
+			/**
+			 * Open the active segment for writing. Starts a new segment if
+			 * the active segment is larger than the segment size.
+			 */
+			void __open_writer(bool rollover);
+
+			/**
+			 * Append a record to the active segment
+			 * @return The location of the new record
+			 */
+			Location __append(RECORD_TYPE type, const std::string &meta, const dtn::data::Bundle *bundle, const dtn::data::Length &length) throw (ibrcommon::IOException);
+
+			/**
+			 * Remove the bundle with the given meta data. Has to be called with the lock.
+			 */
+			void __remove(const dtn::data::MetaBundle &meta);
+
+			/**
+			 * Queue the segment for compaction if it is mostly dead
+			 */
+			void __check_compaction(const dtn::data::Size &segment);
+
+			/**
+			 * Move all live records of the segment to the active segment and delete it
+			 */
+			void __compact(const dtn::data::Size &segment);
+
+			/**
+			 * Serialize the meta data of a bundle to be stored in a record header
+			 */
+			static std::string __encode(const dtn::data::MetaBundle &meta, const dtn::data::Timestamp &stored);
+
+			/**
+			 * Restore the meta data of a bundle from a record header
+			 */
+			static void __decode(const std::string &data, dtn::data::MetaBundle &meta, dtn::data::Timestamp &stored);
+
+			/**
+			 * Read the record header at the current position of the stream
+			 * @return False, if the record is not complete
+			 */
+			static bool __read_header(std::istream &stream, const dtn::data::Length &size, RECORD_TYPE &type, std::string &meta, Location &location);
+
+			const ibrcommon::File _workdir;
+			const dtn::data::Length _segment_size;
+
+			ibrcommon::RWMutex _lock;
+
+			// stores all the meta data in memory
+			MetaStorage _metastore;
+
+			// locations of all bundles
+			location_map _locations;
+
+			// all segments and the one to append new records
+			segment_map _segments;
+			dtn::data::Size _active;
+			dtn::data::Size _next_segment;
+			std::ofstream _writer;
+
+			// bundles expired during the last expiration run
+			std::list<dtn::data::MetaBundle> _expired;
+
+			// segments waiting for compaction
+			ibrcommon::Queue<dtn::data::Size> _compactions;
+			ibrcommon::Conditional _compactions_cond;
+			std::set<dtn::data::Size> _compactions_pending;
+		};
+	}
+}
+
+#endif /* LOGBUNDLESTORAGE_H_ */
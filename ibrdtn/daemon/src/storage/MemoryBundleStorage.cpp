@@ -91,48 +91,31 @@ namespace dtn
 
 		void MemoryBundleStorage::get(const BundleSelector &cb, BundleResult &result) throw (NoBundleFoundException, BundleSelectorException)
 		{
-			size_t items_added = 0;
-
-			// we have to iterate through all bundles
 			ibrcommon::MutexLock l(_bundleslock);
 
-			for (prio_bundle_set::const_iterator iter = _priority_index.begin(); (iter != _priority_index.end()) && ((cb.limit() == 0) || (items_added < cb.limit())); ++iter)
-			{
-				const dtn::data::MetaBundle &bundle = (*iter);
-
-				// skip expired bundles
-				if ( dtn::utils::Clock::isExpired( bundle ) ) continue;
-
-				if ( cb.addIfSelected(result, bundle) ) items_added++;
-			}
+			// select bundles using the priority index or one of the secondary indexes
+			const dtn::data::Size items_added = _secondary_index.select(_priority_index, cb, result, SecondaryBundleIndex<CMP_BUNDLE_PRIORITY>::SkipExpired());
 
 			if (items_added == 0) throw NoBundleFoundException();
 		}
 
 		dtn::data::Bundle MemoryBundleStorage::get(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("memory", "get");
+			dtn::core::Metrics::Timer timer(latency);
+
 			try {
 				ibrcommon::MutexLock l(_bundleslock);
 
-				for (bundle_list::const_iterator iter = _bundles.begin(); iter != _bundles.end(); ++iter)
-				{
-					const dtn::data::Bundle &bundle = (*iter);
-
-					// the bundles are sorted, therefore it is possible to optimize
-					// the search for the bundle by skipping all "lower" bundles
-					if (id > bundle) continue;
-
-					if (id == bundle)
-					{
-						if (_faulty) {
-							throw dtn::SerializationFailedException("bundle get failed due to faulty setting");
-						}
+				const bundle_map::const_iterator iter = _bundles.find(id);
 
-						return bundle;
+				if (iter != _bundles.end())
+				{
+					if (_faulty) {
+						throw dtn::SerializationFailedException("bundle get failed due to faulty setting");
 					}
 
-					// stop here, following bundles are "greater"
-					break;
+					return (*iter).second;
 				}
 			} catch (const dtn::SerializationFailedException &ex) {
 				// bundle loading failed
@@ -153,9 +136,9 @@ namespace dtn
 
 			ibrcommon::MutexLock l(_bundleslock);
 
-			for (bundle_list::const_iterator iter = _bundles.begin(); iter != _bundles.end(); ++iter)
+			for (bundle_map::const_iterator iter = _bundles.begin(); iter != _bundles.end(); ++iter)
 			{
-				const dtn::data::Bundle &bundle = (*iter);
+				const dtn::data::Bundle &bundle = (*iter).second;
 				ret.insert(bundle.destination);
 			}
 
@@ -164,6 +147,9 @@ namespace dtn
 
 		void MemoryBundleStorage::store(const dtn::data::Bundle &bundle)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("memory", "store");
+			dtn::core::Metrics::Timer timer(latency);
+
 			ibrcommon::MutexLock l(_bundleslock);
 
 			if (_faulty) return;
@@ -175,14 +161,17 @@ namespace dtn
 			// increment the storage size
 			allocSpace(size);
 
+			const dtn::data::MetaBundle m = dtn::data::MetaBundle::create(bundle);
+
 			// insert Container
-			std::pair<std::set<dtn::data::Bundle>::iterator,bool> ret = _bundles.insert( bundle );
+			std::pair<bundle_map::iterator,bool> ret = _bundles.insert( std::make_pair(m, bundle) );
 
 			if (ret.second)
 			{
-				const dtn::data::MetaBundle m = dtn::data::MetaBundle::create(bundle);
 				_list.add(m);
-				_priority_index.insert(m);
+
+				std::pair<prio_bundle_set::iterator, bool> pret = _priority_index.insert(m);
+				if (pret.second) _secondary_index.add(*pret.first);
 
 				_bundle_lengths[m] = size;
 
@@ -208,30 +197,28 @@ namespace dtn
 		{
 			ibrcommon::MutexLock l(_bundleslock);
 
-			for (dtn::data::BundleList::const_iterator iter = _list.begin(); iter != _list.end(); ++iter)
-			{
-				const dtn::data::MetaBundle &meta = (*iter);
-				if (id == meta)
-				{
-					return meta;
-				}
-			}
+			const dtn::data::BundleList::const_iterator iter = _list.find(dtn::data::MetaBundle::create(id));
 
-			throw NoBundleFoundException();
+			if (iter == _list.end()) throw NoBundleFoundException();
+
+			return (*iter);
 		}
 
 		void MemoryBundleStorage::remove(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("memory", "remove");
+			dtn::core::Metrics::Timer timer(latency);
+
 			ibrcommon::MutexLock l(_bundleslock);
 
-			// search for the bundle in the bundle list
-			const bundle_list::const_iterator iter = find(_bundles.begin(), _bundles.end(), id);
+			// search for the bundle in the bundle index
+			const bundle_map::iterator iter = _bundles.find(id);
 
 			// if no bundle was found throw an exception
 			if (iter == _bundles.end()) throw NoBundleFoundException();
 
 			// remove item in the bundlelist
-			const dtn::data::MetaBundle m = dtn::data::MetaBundle::create(*iter);
+			const dtn::data::MetaBundle m = dtn::data::MetaBundle::create((*iter).second);
 			_list.remove(m);
 
 			// raise bundle removed event
@@ -245,15 +232,16 @@ namespace dtn
 		{
 			ibrcommon::MutexLock l(_bundleslock);
 
-			for (bundle_list::const_iterator iter = _bundles.begin(); iter != _bundles.end(); ++iter)
+			for (bundle_map::const_iterator iter = _bundles.begin(); iter != _bundles.end(); ++iter)
 			{
-				const dtn::data::Bundle &bundle = (*iter);
+				const dtn::data::Bundle &bundle = (*iter).second;
 
 				// raise bundle removed event
 				eventBundleRemoved(bundle);
 			}
 
 			_bundles.clear();
+			_secondary_index.clear();
 			_priority_index.clear();
 			_list.clear();
 			_bundle_lengths.clear();
@@ -264,8 +252,8 @@ namespace dtn
 
 		void MemoryBundleStorage::eventBundleExpired(const dtn::data::MetaBundle &b) throw ()
 		{
-			// search for the bundle in the bundle list
-			const bundle_list::iterator iter = find(_bundles.begin(), _bundles.end(), b);
+			// search for the bundle in the bundle index
+			const bundle_map::iterator iter = _bundles.find(b);
 
 			// if the bundle was found ...
 			if (iter != _bundles.end())
@@ -284,9 +272,12 @@ namespace dtn
 			}
 		}
 
-		void MemoryBundleStorage::__erase(const bundle_list::iterator &iter)
+		void MemoryBundleStorage::__erase(const bundle_map::iterator &iter)
 		{
-			const dtn::data::MetaBundle m = dtn::data::MetaBundle::create(*iter);
+			const dtn::data::MetaBundle m = dtn::data::MetaBundle::create((*iter).second);
+
+			// erase the bundle out of the secondary indexes
+			_secondary_index.remove(m);
 
 			// erase the bundle out of the priority index
 			_priority_index.erase(m);
@@ -298,7 +289,7 @@ namespace dtn
 			// decrement the storage size
 			freeSpace(len);
 
-			// remove bundle from bundle list
+			// remove bundle from bundle index
 			_bundles.erase(iter);
 		}
 	}
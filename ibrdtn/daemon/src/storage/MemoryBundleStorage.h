@@ -26,6 +26,7 @@
 #include "core/BundleCore.h"
 #include "core/TimeEvent.h"
 #include "storage/BundleStorage.h"
+#include "storage/SecondaryBundleIndex.h"
 #include "core/Node.h"
 #include "core/EventReceiver.h"
 
@@ -126,11 +127,12 @@ namespace dtn
 		private:
 			ibrcommon::Mutex _bundleslock;
 
-			typedef std::set<dtn::data::Bundle> bundle_list;
-			bundle_list _bundles;
+			// bundles are indexed by their ID to allow lookups in O(log n)
+			typedef std::map<dtn::data::BundleID, dtn::data::Bundle> bundle_map;
+			bundle_map _bundles;
 			dtn::data::BundleList _list;
 
-			void __erase(const bundle_list::iterator &iter);
+			void __erase(const bundle_map::iterator &iter);
 
 			struct CMP_BUNDLE_PRIORITY
 			{
@@ -149,6 +151,9 @@ namespace dtn
 			typedef std::set<dtn::data::MetaBundle, CMP_BUNDLE_PRIORITY> prio_bundle_set;
 			prio_bundle_set _priority_index;
 
+			// secondary indexes for constrained queries
+			SecondaryBundleIndex<CMP_BUNDLE_PRIORITY> _secondary_index;
+
 			typedef std::map<dtn::data::BundleID, dtn::data::Length> size_map;
 			size_map _bundle_lengths;
 		};
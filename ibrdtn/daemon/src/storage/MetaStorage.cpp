@@ -79,6 +79,11 @@ namespace dtn
 			return ret;
 		}
 
+		dtn::data::Size MetaStorage::select(const BundleSelector &cb, BundleResult &result) const throw (BundleSelectorException)
+		{
+			return _secondary_index.select(_priority_index, cb, result, SecondaryBundleIndex<CMP_BUNDLE_PRIORITY>::SkipExpired());
+		}
+
 		void MetaStorage::store(const dtn::data::MetaBundle &meta, const dtn::data::Length &space) throw ()
 		{
 			// increment the storage size
@@ -88,7 +93,10 @@ namespace dtn
 			_list.add(meta);
 
 			// add bundle to priority list
-			_priority_index.insert(meta);
+			std::pair<priority_set::iterator, bool> ret = _priority_index.insert(meta);
+
+			// add bundle to the secondary indexes
+			if (ret.second) _secondary_index.add(*ret.first);
 		}
 
 		dtn::data::Length MetaStorage::remove(const dtn::data::MetaBundle &meta) throw ()
@@ -111,6 +119,9 @@ namespace dtn
 			// remove the bundle from BundleList
 			_list.remove(meta);
 
+			// remove bundle from the secondary indexes
+			_secondary_index.remove(meta);
+
 			// remove bundle from priority index
 			_priority_index.erase(meta);
 
@@ -147,6 +158,7 @@ namespace dtn
 
 		void MetaStorage::clear() throw ()
 		{
+			_secondary_index.clear();
 			_priority_index.clear();
 			_list.clear();
 			_bundle_lengths.clear();
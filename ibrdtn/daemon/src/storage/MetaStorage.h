@@ -23,6 +23,7 @@
 #define METASTORAGE_H_
 
 #include <storage/BundleSelector.h>
+#include <storage/SecondaryBundleIndex.h>
 #include <ibrdtn/data/Bundle.h>
 #include <ibrdtn/data/BundleList.h>
 #include <ibrcommon/data/BloomFilter.h>
@@ -54,6 +55,9 @@ namespace dtn
 		private:
 			priority_set _priority_index;
 
+			// secondary indexes for constrained queries
+			SecondaryBundleIndex<CMP_BUNDLE_PRIORITY> _secondary_index;
+
 			// bundle list
 			dtn::data::BundleList _list;
 
@@ -96,6 +100,13 @@ namespace dtn
 
 			std::set<dtn::data::EID> getDistinctDestinations() const throw ();
 
+			/**
+			 * Select non-expired bundles using the given BundleSelector. If the selector
+			 * declares constraints, the query is answered using the secondary indexes.
+			 * @return The number of selected bundles
+			 */
+			dtn::data::Size select(const BundleSelector &cb, BundleResult &result) const throw (BundleSelectorException);
+
 			void store(const dtn::data::MetaBundle &meta, const dtn::data::Length &space) throw ();
 
 			/**
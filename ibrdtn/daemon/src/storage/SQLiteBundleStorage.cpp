@@ -108,13 +108,18 @@ namespace dtn
 			return _file.size();
 		}
 
+		const ibrcommon::File& SQLiteBundleStorage::SQLiteBLOB::getFile() const throw (ibrcommon::IOException)
+		{
+			return _file;
+		}
+
 		ibrcommon::BLOB::Reference SQLiteBundleStorage::create()
 		{
 			return ibrcommon::BLOB::Reference(new SQLiteBLOB(_blobPath));
 		}
 
 		SQLiteBundleStorage::SQLiteBundleStorage(const ibrcommon::File &path, const dtn::data::Length &maxsize, bool usePersistentBundleSets)
-		 : BundleStorage(maxsize), _database(path.get("sqlite.db"), *this)
+		 : BundleStorage(maxsize), _database(path.get("sqlite.db"), *this), _group_window(0), _group_limit(0), _group_open(false), _group_size(0)
 		{
 			//let the factory create SQLiteBundleSets
 			if (usePersistentBundleSets)
@@ -154,6 +159,9 @@ namespace dtn
 			try {
 				ibrcommon::RWLock l(_global_lock);
 
+				// commit all pending operations
+				__group_commit();
+
 				// close the database
 				_database.close();
 			} catch (const ibrcommon::Exception &ex) {
@@ -167,7 +175,18 @@ namespace dtn
 			try {
 				while (true)
 				{
-					Task *t = _tasks.poll();
+					// commit the running group if the window has been expired
+					__group_check();
+
+					Task *t = NULL;
+
+					try {
+						// wait for the next task, but not longer than the running group is open
+						t = _tasks.poll(__group_timeout());
+					} catch (const ibrcommon::QueueUnblockedException &ex) {
+						if (ex.reason != ibrcommon::QueueUnblockedException::QUEUE_TIMEOUT) throw;
+						continue;
+					}
 
 					try {
 						BlockingTask &btask = dynamic_cast<BlockingTask&>(*t);
@@ -217,6 +236,10 @@ namespace dtn
 
 			stop();
 			join();
+
+			// commit all pending operations
+			ibrcommon::RWLock l(_global_lock);
+			__group_commit();
 		}
 
 		void SQLiteBundleStorage::__cancellation() throw ()
@@ -243,6 +266,9 @@ namespace dtn
 
 		dtn::data::Bundle SQLiteBundleStorage::get(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("sqlite", "get");
+			dtn::core::Metrics::Timer timer(latency);
+
 			SQLiteDatabase::blocklist blocks;
 			dtn::data::Bundle bundle;
 
@@ -342,6 +368,9 @@ namespace dtn
 
 		void SQLiteBundleStorage::store(const dtn::data::Bundle &bundle)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("sqlite", "store");
+			dtn::core::Metrics::Timer timer(latency);
+
 			IBRCOMMON_LOGGER_DEBUG_TAG(SQLiteBundleStorage::TAG, 25) << "store bundle " << bundle.toString() << IBRCOMMON_LOGGER_ENDL;
 
 			ibrcommon::RWLock l(_global_lock);
@@ -353,8 +382,28 @@ namespace dtn
 			// increment the storage size
 			allocSpace(size);
 
-			// start transaction to store the bundle
-			_database.transaction();
+			try {
+				// start transaction to store the bundle
+				if (_group_window > 0)
+				{
+					// wake-up the task thread to commit the new group in time
+					if (__group_begin()) _tasks.push(new TaskGroupCommit());
+					_database.savepoint("store");
+				}
+				else
+				{
+					_database.transaction();
+				}
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, critical) << ex.what() << IBRCOMMON_LOGGER_ENDL;
+
+				// free the previously allocated space
+				freeSpace(size);
+				return;
+			}
+
+			// block files written for this bundle
+			std::list<ibrcommon::File> files;
 
 			try {
 				// store the bundle data in the database
@@ -418,6 +467,7 @@ namespace dtn
 						storedBytes += tmpfile.size();
 
 						// store the block into the database
+						files.push_back(tmpfile);
 						_database.store(id, index, block, tmpfile);
 					}
 					else
@@ -433,6 +483,7 @@ namespace dtn
 						storedBytes += tmpfile.size();
 
 						// store the block into the database
+						files.push_back(tmpfile);
 						_database.store(id, index, block, tmpfile);
 					}
 
@@ -440,31 +491,64 @@ namespace dtn
 					index++;
 				}
 
-				_database.commit();
+				if (_group_window > 0)
+				{
+					_database.release("store");
 
-				try {
-					// the bundle is stored sucessfully, we could accept custody if it is requested
-					const dtn::data::EID custodian = acceptCustody(meta);
+					// delete the block files if the group is rolled back
+					_group_files.splice(_group_files.end(), files);
 
-					// update the custody address of this bundle
-					_database.update(SQLiteDatabase::UPDATE_CUSTODIAN, bundle, custodian);
-				} catch (const ibrcommon::Exception&) {
-					// this bundle has no request for custody transfers
+					// delay the acknowledgement until the group is committed
+					_group_stored.push_back( std::make_pair(meta, size) );
+					__group_add();
+				}
+				else
+				{
+					_database.commit();
+					__stored(meta);
 				}
-
-				IBRCOMMON_LOGGER_DEBUG_TAG(SQLiteBundleStorage::TAG, 10) << "bundle " << bundle.toString() << " stored" << IBRCOMMON_LOGGER_ENDL;
-
-				// raise bundle added event
-				eventBundleAdded(meta);
 			} catch (const ibrcommon::Exception &ex) {
 				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, critical) << ex.what() << IBRCOMMON_LOGGER_ENDL;
-				_database.rollback();
+
+				if (_group_window > 0)
+				{
+					// undo this bundle only, other operations of the group remain
+					_database.rollback("store");
+
+					// delete the block files of this bundle
+					for (std::list<ibrcommon::File>::iterator it = files.begin(); it != files.end(); ++it)
+					{
+						(*it).remove();
+					}
+				}
+				else
+				{
+					_database.rollback();
+				}
 
 				// free the previously allocated space
 				freeSpace(size);
 			}
 		}
 
+		void SQLiteBundleStorage::__stored(const dtn::data::MetaBundle &meta) throw ()
+		{
+			try {
+				// the bundle is stored sucessfully, we could accept custody if it is requested
+				const dtn::data::EID custodian = acceptCustody(meta);
+
+				// update the custody address of this bundle
+				_database.update(SQLiteDatabase::UPDATE_CUSTODIAN, meta, custodian);
+			} catch (const ibrcommon::Exception&) {
+				// this bundle has no request for custody transfers
+			}
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(SQLiteBundleStorage::TAG, 10) << "bundle " << meta.toString() << " stored" << IBRCOMMON_LOGGER_ENDL;
+
+			// raise bundle added event
+			eventBundleAdded(meta);
+		}
+
 		bool SQLiteBundleStorage::contains(const dtn::data::BundleID &id)
 		{
 			try {
@@ -489,13 +573,53 @@ namespace dtn
 
 		void SQLiteBundleStorage::remove(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("sqlite", "remove");
+			dtn::core::Metrics::Timer timer(latency);
+
 			// remove the bundle in locked state
 			try {
 				ibrcommon::RWLock l(_global_lock);
-				freeSpace( _database.remove(id) );
 
-				// raise bundle removed event
-				eventBundleRemoved(id);
+				if (_group_window > 0)
+				{
+					// wake-up the task thread to commit the new group in time
+					if (__group_begin()) _tasks.push(new TaskGroupCommit());
+
+					// delete the block files after the group is committed
+					const dtn::data::Length size = _database.remove(id, _group_garbage);
+
+					// a bundle not acknowledged yet, is never announced
+					bool pending = false;
+					for (std::list<std::pair<dtn::data::MetaBundle, dtn::data::Length> >::iterator it = _group_stored.begin(); it != _group_stored.end(); ++it)
+					{
+						if (id == (*it).first)
+						{
+							_group_stored.erase(it);
+							pending = true;
+							break;
+						}
+					}
+
+					if (pending)
+					{
+						// the bundle is gone whether the group commits or not
+						freeSpace(size);
+					}
+					else
+					{
+						// raise the event and release the space after the commit
+						_group_removed.push_back( std::make_pair(id, size) );
+					}
+
+					__group_add();
+				}
+				else
+				{
+					freeSpace( _database.remove(id) );
+
+					// raise bundle removed event
+					eventBundleRemoved(id);
+				}
 			} catch (const ibrcommon::Exception &ex) {
 				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, critical) << ex.what() << IBRCOMMON_LOGGER_ENDL;
 			}
@@ -505,6 +629,9 @@ namespace dtn
 		{
 			ibrcommon::RWLock l(_global_lock);
 
+			// commit all pending operations
+			__group_commit();
+
 			try {
 				_database.clear();
 			} catch (const ibrcommon::Exception &ex) {
@@ -594,6 +721,10 @@ namespace dtn
 				 */
 				try {
 					ibrcommon::RWLock l(storage._global_lock);
+
+					// vacuum is not possible within a transaction
+					storage.__group_commit();
+
 					storage._database.vacuum();
 				} catch (const ibrcommon::Exception &ex) {
 					IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, critical) << ex.what() << IBRCOMMON_LOGGER_ENDL;
@@ -647,6 +778,189 @@ namespace dtn
 		void SQLiteBundleStorage::wait()
 		{
 			_tasks.wait(ibrcommon::Queue<Task*>::QUEUE_EMPTY);
+
+			// commit all pending operations
+			ibrcommon::RWLock l(_global_lock);
+			__group_commit();
+		}
+
+		void SQLiteBundleStorage::TaskGroupCommit::run(SQLiteBundleStorage &storage)
+		{
+			storage.__group_check();
+		}
+
+		SQLiteBundleStorage::GroupCommitStats::GroupCommitStats()
+		 : commits(0), operations(0), last_size(0), max_size(0), last_latency(0.0), total_latency(0.0), last_commit_time(0.0), total_commit_time(0.0)
+		{
+		}
+
+		void SQLiteBundleStorage::setGroupCommit(const dtn::data::Timeout &window, const dtn::data::Size &limit)
+		{
+			ibrcommon::RWLock l(_global_lock);
+
+			// commit the running group before the mode changes
+			__group_commit();
+
+			_group_window = window;
+			_group_limit = limit;
+		}
+
+		void SQLiteBundleStorage::setJournalMode(const std::string &mode)
+		{
+			try {
+				ibrcommon::RWLock l(_global_lock);
+				__group_commit();
+				_database.setJournalMode(mode);
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, error) << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		void SQLiteBundleStorage::setSynchronous(const std::string &mode)
+		{
+			try {
+				ibrcommon::RWLock l(_global_lock);
+				__group_commit();
+				_database.setSynchronous(mode);
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, error) << ex.what() << IBRCOMMON_LOGGER_ENDL;
+			}
+		}
+
+		SQLiteBundleStorage::GroupCommitStats SQLiteBundleStorage::getGroupCommitStats()
+		{
+			ibrcommon::MutexLock l(_global_lock);
+			return _group_stats;
+		}
+
+		bool SQLiteBundleStorage::__group_begin() throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			if (_group_open) return false;
+
+			_database.transaction();
+
+			_group_open = true;
+			_group_size = 0;
+			_group_age.start();
+
+			return true;
+		}
+
+		void SQLiteBundleStorage::__group_add() throw ()
+		{
+			_group_size++;
+
+			// commit the group early if the limit is reached
+			if ((_group_limit > 0) && (_group_size >= _group_limit))
+			{
+				__group_commit();
+			}
+		}
+
+		void SQLiteBundleStorage::__group_commit() throw ()
+		{
+			if (!_group_open) return;
+			_group_open = false;
+
+			ibrcommon::TimeMeasurement tm;
+			tm.start();
+
+			try {
+				_database.commit();
+			} catch (const ibrcommon::Exception &ex) {
+				IBRCOMMON_LOGGER_TAG(SQLiteBundleStorage::TAG, critical) << "group commit failed: " << ex.what() << IBRCOMMON_LOGGER_ENDL;
+
+				try {
+					_database.rollback();
+				} catch (const ibrcommon::Exception&) { };
+
+				// the stored bundles of this group are lost
+				for (std::list<std::pair<dtn::data::MetaBundle, dtn::data::Length> >::const_iterator it = _group_stored.begin(); it != _group_stored.end(); ++it)
+				{
+					freeSpace((*it).second);
+				}
+
+				// delete the block files written by this group
+				for (std::list<ibrcommon::File>::iterator it = _group_files.begin(); it != _group_files.end(); ++it)
+				{
+					(*it).remove();
+				}
+
+				// removed bundles are restored, keep their block files
+				_group_stored.clear();
+				_group_removed.clear();
+				_group_garbage.clear();
+				_group_files.clear();
+				_group_size = 0;
+				return;
+			}
+
+			tm.stop();
+			_group_age.stop();
+
+			// update statistics
+			_group_stats.commits++;
+			_group_stats.operations += _group_size;
+			_group_stats.last_size = _group_size;
+			if (_group_size > _group_stats.max_size) _group_stats.max_size = _group_size;
+			_group_stats.last_latency = _group_age.getMilliseconds();
+			_group_stats.total_latency += _group_stats.last_latency;
+			_group_stats.last_commit_time = tm.getMilliseconds();
+			_group_stats.total_commit_time += _group_stats.last_commit_time;
+
+			IBRCOMMON_LOGGER_DEBUG_TAG(SQLiteBundleStorage::TAG, 25) << "group of " << _group_size << " operations committed in " << tm << IBRCOMMON_LOGGER_ENDL;
+
+			// delete block files of removed bundles
+			for (std::list<ibrcommon::File>::iterator it = _group_garbage.begin(); it != _group_garbage.end(); ++it)
+			{
+				(*it).remove();
+			}
+			_group_garbage.clear();
+			_group_files.clear();
+
+			// announce all removed bundles of the group
+			for (std::list<std::pair<dtn::data::BundleID, dtn::data::Length> >::const_iterator it = _group_removed.begin(); it != _group_removed.end(); ++it)
+			{
+				// raise bundle removed event
+				eventBundleRemoved((*it).first);
+
+				// release consumed space of this bundle
+				freeSpace((*it).second);
+			}
+			_group_removed.clear();
+
+			// acknowledge all stored bundles of the group
+			for (std::list<std::pair<dtn::data::MetaBundle, dtn::data::Length> >::const_iterator it = _group_stored.begin(); it != _group_stored.end(); ++it)
+			{
+				__stored((*it).first);
+			}
+			_group_stored.clear();
+			_group_size = 0;
+		}
+
+		void SQLiteBundleStorage::__group_check() throw ()
+		{
+			ibrcommon::RWLock l(_global_lock);
+			if (!_group_open) return;
+
+			_group_age.stop();
+			if (_group_age.getMilliseconds() >= static_cast<double>(_group_window))
+			{
+				__group_commit();
+			}
+		}
+
+		size_t SQLiteBundleStorage::__group_timeout() throw ()
+		{
+			ibrcommon::RWLock l(_global_lock);
+			if (!_group_open) return 0;
+
+			_group_age.stop();
+			const double elapsed = _group_age.getMilliseconds();
+
+			// poll() needs at least one millisecond, zero would block forever
+			if (elapsed + 1.0 >= static_cast<double>(_group_window)) return 1;
+			return static_cast<size_t>(static_cast<double>(_group_window) - elapsed);
 		}
 
 		void SQLiteBundleStorage::setFaulty(bool mode)
@@ -39,6 +39,7 @@
 #include <ibrcommon/thread/Conditional.h>
 #include <ibrcommon/data/File.h>
 #include <ibrcommon/thread/Queue.h>
+#include <ibrcommon/TimeMeasurement.h>
 
 #include <string>
 #include <list>
@@ -73,6 +74,57 @@ namespace dtn
 			 */
 			virtual ~SQLiteBundleStorage();
 
+			/**
+			 * Statistics about the committed groups of store and remove operations
+			 */
+			class GroupCommitStats
+			{
+			public:
+				GroupCommitStats();
+
+				// number of committed groups
+				dtn::data::Size commits;
+
+				// number of operations in all committed groups
+				dtn::data::Size operations;
+
+				// number of operations in the last / largest group
+				dtn::data::Size last_size;
+				dtn::data::Size max_size;
+
+				// time in milliseconds between the first operation of a group and its commit
+				double last_latency;
+				double total_latency;
+
+				// time in milliseconds spent to commit a group
+				double last_commit_time;
+				double total_commit_time;
+			};
+
+			/**
+			 * Enable the group commit mode. Stores and removes arriving within the
+			 * window (in milliseconds) are committed in one transaction. A group is
+			 * committed early if it contains limit operations. The acceptance of custody
+			 * is delayed until the group is committed. A window of zero disables
+			 * the group commit.
+			 */
+			void setGroupCommit(const dtn::data::Timeout &window, const dtn::data::Size &limit);
+
+			/**
+			 * Set the journal mode of the database (e.g. "wal")
+			 */
+			void setJournalMode(const std::string &mode);
+
+			/**
+			 * Set the synchronous mode of the database (e.g. "off", "normal" or "full")
+			 */
+			void setSynchronous(const std::string &mode);
+
+			/**
+			 * Returns statistics about the group commits
+			 */
+			GroupCommitStats getGroupCommitStats();
+
 			/**
 			 * Stores a bundle in the storage.
 			 * @param bundle The bundle to store.
@@ -236,6 +288,15 @@ namespace dtn
 				static bool _idle;
 			};
 
+			class TaskGroupCommit : public Task
+			{
+			public:
+				TaskGroupCommit() { };
+
+				virtual ~TaskGroupCommit() {};
+				virtual void run(SQLiteBundleStorage &storage);
+			};
+
 			class TaskExpire : public Task
 			{
 			public:
@@ -264,6 +325,8 @@ namespace dtn
 				virtual void open();
 				virtual void close();
 
+				virtual const ibrcommon::File& getFile() const throw (ibrcommon::IOException);
+
 			protected:
 				std::iostream &__get_stream()
 				{
@@ -293,6 +356,39 @@ namespace dtn
 			 */
 			virtual const std::string getName() const;
 
+			/**
+			 * Make sure a group transaction is running. Has to be called with the global lock.
+			 * @return True, if a new group has been started.
+			 */
+			bool __group_begin() throw (SQLiteDatabase::SQLiteQueryException);
+
+			/**
+			 * Count an operation of the running group and commit the group if the limit
+			 * is reached. Has to be called with the global lock.
+			 */
+			void __group_add() throw ();
+
+			/**
+			 * Commit the running group if any. Has to be called with the global lock.
+			 */
+			void __group_commit() throw ();
+
+			/**
+			 * Commit the running group if the window has been expired.
+			 */
+			void __group_check() throw ();
+
+			/**
+			 * Returns the remaining time of the running group in milliseconds or zero
+			 * if there is no running group.
+			 */
+			size_t __group_timeout() throw ();
+
+			/**
+			 * Acknowledge a stored bundle. Accept custody and add the bundle to the indexes.
+			 */
+			void __stored(const dtn::data::MetaBundle &meta) throw ();
+
 			SQLiteDatabase _database;
 
 			ibrcommon::File _blobPath;
@@ -302,6 +398,29 @@ namespace dtn
 			ibrcommon::Queue<Task*> _tasks;
 
 			ibrcommon::RWMutex _global_lock;
+
+			// group commit configuration
+			dtn::data::Timeout _group_window;
+			dtn::data::Size _group_limit;
+
+			// state of the running group
+			bool _group_open;
+			dtn::data::Size _group_size;
+			ibrcommon::TimeMeasurement _group_age;
+
+			// stored bundles and their size waiting for the commit of the group
+			std::list<std::pair<dtn::data::MetaBundle, dtn::data::Length> > _group_stored;
+
+			// removed bundles and their size to announce after the commit of the group
+			std::list<std::pair<dtn::data::BundleID, dtn::data::Length> > _group_removed;
+
+			// block files of removed bundles to delete after the commit of the group
+			std::list<ibrcommon::File> _group_garbage;
+
+			// block files written by the group, to delete if the group is rolled back
+			std::list<ibrcommon::File> _group_files;
+
+			GroupCommitStats _group_stats;
 		};
 	}
 }
@@ -21,11 +21,14 @@
 
 #include "storage/SQLiteDatabase.h"
 #include "storage/SQLiteConfigure.h"
+#include "storage/BundleConstraints.h"
 #include <ibrdtn/data/ScopeControlHopLimitBlock.h>
 #include <ibrdtn/data/SchedulingBlock.h>
 #include <ibrdtn/utils/Clock.h>
 #include <ibrcommon/Logger.h>
 #include <stdint.h>
+#include <typeinfo>
+#include <limits>
 
 namespace dtn
 {
@@ -41,12 +44,14 @@ namespace dtn
 		const std::string SQLiteDatabase::_select_names[] = {
 				"source, destination, reportto, custodian, procflags, timestamp, sequencenumber, lifetime, expiretime, fragmentoffset, appdatalength, hopcount, netpriority, payloadlength, bytes",
 				"source, timestamp, sequencenumber, fragmentoffset, payloadlength, bytes",
-				"`source`, `timestamp`, `sequencenumber`, `fragmentoffset`, `fragmentlength`, `expiretime`"
+				"`source`, `timestamp`, `sequencenumber`, `fragmentoffset`, `fragmentlength`, `expiretime`",
+				"source, destination, reportto, custodian, procflags, timestamp, sequencenumber, lifetime, expiretime, fragmentoffset, appdatalength, hopcount, netpriority, payloadlength, bytes, fragmentlength, key"
 		};
 
 		const std::string SQLiteDatabase::_where_filter[] = {
 				"source = ? AND timestamp = ? AND sequencenumber = ? AND fragmentoffset = ? AND fragmentlength = ?",
-				"a.source = b.source AND a.timestamp = b.timestamp AND a.sequencenumber = b.sequencenumber AND a.fragmentoffset = b.fragmentoffset AND a.fragmentlength = b.fragmentlength"
+				"a.source = b.source AND a.timestamp = b.timestamp AND a.sequencenumber = b.sequencenumber AND a.fragmentoffset = b.fragmentoffset AND a.fragmentlength = b.fragmentlength",
+				"priority = ? AND timestamp >= ? AND (timestamp > ? OR sequencenumber > ? OR (sequencenumber = ? AND (fragmentoffset > ? OR (fragmentoffset = ? AND (fragmentlength > ? OR (fragmentlength = ? AND key > ?))))))"
 		};
 
 		const std::string SQLiteDatabase::_tables[] =
@@ -55,7 +60,7 @@ namespace dtn
 		// this is the version of a fresh created db scheme
 		const int SQLiteDatabase::DBSCHEMA_FRESH_VERSION = 8;
 
-		const int SQLiteDatabase::DBSCHEMA_VERSION = 8;
+		const int SQLiteDatabase::DBSCHEMA_VERSION = 9;
 
 		const std::string SQLiteDatabase::QUERY_SCHEMAVERSION = "SELECT `value` FROM " + SQLiteDatabase::_tables[SQLiteDatabase::SQL_TABLE_PROPERTIES] + " WHERE `key` = 'version' LIMIT 0,1;";
 		const std::string SQLiteDatabase::SET_SCHEMAVERSION = "INSERT INTO " + SQLiteDatabase::_tables[SQLiteDatabase::SQL_TABLE_PROPERTIES] + " (`key`, `value`) VALUES ('version', ?);";
@@ -63,7 +68,6 @@ namespace dtn
 		const std::string SQLiteDatabase::_sql_queries[SQL_QUERIES_END] =
 		{
 			"SELECT " + _select_names[0] + " FROM " + _tables[SQL_TABLE_BUNDLE],
-			"SELECT " + _select_names[0] + " FROM " + _tables[SQL_TABLE_BUNDLE] + " ORDER BY priority DESC, timestamp, sequencenumber, fragmentoffset, fragmentlength LIMIT ?,?;",
 			"SELECT " + _select_names[0] + " FROM "+ _tables[SQL_TABLE_BUNDLE] +" WHERE " + _where_filter[0] + " LIMIT 1;",
 			"SELECT bytes FROM "+ _tables[SQL_TABLE_BUNDLE] +" WHERE " + _where_filter[0] + " LIMIT 1;",
 			"SELECT DISTINCT destination FROM " + _tables[SQL_TABLE_BUNDLE],
@@ -120,12 +124,13 @@ namespace dtn
 			"CREATE INDEX IF NOT EXISTS blocks_bid ON " + _tables[SQL_TABLE_BLOCK] + " (source, timestamp, sequencenumber, fragmentoffset, fragmentlength);",
 			"CREATE INDEX IF NOT EXISTS bundles_destination ON " + _tables[SQL_TABLE_BUNDLE] + " (destination);",
 			"CREATE INDEX IF NOT EXISTS bundles_destination_priority ON " + _tables[SQL_TABLE_BUNDLE] + " (destination, priority);",
-			"CREATE UNIQUE INDEX IF NOT EXISTS bundles_id ON " + _tables[SQL_TABLE_BUNDLE] + " (source, timestamp, sequencenumber, fragmentoffset, fragmentlength);"
+			"CREATE UNIQUE INDEX IF NOT EXISTS bundles_id ON " + _tables[SQL_TABLE_BUNDLE] + " (source, timestamp, sequencenumber, fragmentoffset, fragmentlength);",
 			"CREATE INDEX IF NOT EXISTS bundles_expire ON " + _tables[SQL_TABLE_BUNDLE] + " (source, timestamp, sequencenumber, fragmentoffset, fragmentlength, expiretime);",
 			"CREATE TABLE IF NOT EXISTS '" + _tables[SQL_TABLE_PROPERTIES] + "' ( `key` TEXT PRIMARY KEY ASC ON CONFLICT REPLACE, `value` TEXT NOT NULL);",
 			"CREATE TABLE IF NOT EXISTS " + _tables[SQL_TABLE_BUNDLE_SET] + " (`source` TEXT NOT NULL, `timestamp` INTEGER NOT NULL, `sequencenumber` INTEGER NOT NULL, `fragmentoffset` INTEGER NOT NULL, `fragmentlength` INTEGER NOT NULL, `expiretime` INTEGER, `set_id` INTEGER, PRIMARY KEY(`set_id`, `source`, `timestamp`, `sequencenumber`, `fragmentoffset`, `fragmentlength`));",
 			"CREATE TABLE IF NOT EXISTS " + _tables[SQL_TABLE_BUNDLE_SET_NAME] + " (`id` INTEGER PRIMARY KEY, `name` TEXT NOT NULL, `persistent` INTEGER NOT NULL);",
-			"CREATE UNIQUE INDEX IF NOT EXISTS bundle_set_names_index ON " + _tables[SQL_TABLE_BUNDLE_SET_NAME] + " (`name`, `persistent`);"
+			"CREATE UNIQUE INDEX IF NOT EXISTS bundle_set_names_index ON " + _tables[SQL_TABLE_BUNDLE_SET_NAME] + " (`name`, `persistent`);",
+			"CREATE INDEX IF NOT EXISTS bundles_order ON " + _tables[SQL_TABLE_BUNDLE] + " (priority, timestamp, sequencenumber, fragmentoffset, fragmentlength);"
 		};
 
 		SQLiteDatabase::SQLBundleQuery::SQLBundleQuery()
@@ -279,7 +284,7 @@ namespace dtn
 					}
 
 					// create all tables
-					for (size_t i = 0; i < (DB_STRUCTURE_END - 1); ++i)
+					for (size_t i = 0; i < DB_STRUCTURE_END; ++i)
 					{
 						Statement st(_database, _db_structure[i]);
 						int err = st.step();
@@ -291,8 +296,23 @@ namespace dtn
 
 					// set new database version
 					setVersion(DBSCHEMA_FRESH_VERSION);
-					j = DBSCHEMA_FRESH_VERSION;
+
+					// continue with the upgrades following the fresh version
+					j = DBSCHEMA_FRESH_VERSION - 1;
+					break;
+
+				// add the index to page through the bundles
+				case 8:
+				{
+					Statement st(_database, _db_structure[DB_STRUCTURE_END - 1]);
+					if (st.step() != SQLITE_DONE)
+					{
+						IBRCOMMON_LOGGER_TAG(SQLiteDatabase::TAG, error) << "failed to create index bundles_order" << IBRCOMMON_LOGGER_ENDL;
+					}
+
+					setVersion(9);
 					break;
+				}
 
 				default:
 					// NO UPGRADE PATH HERE
@@ -475,76 +495,87 @@ namespace dtn
 		void SQLiteDatabase::get(const BundleSelector &cb, BundleResult &ret) throw (NoBundleFoundException, BundleSelectorException)
 		{
 			size_t items_added = 0;
-
-			const std::string base_query =
-					"SELECT " + _select_names[0] + " FROM " + _tables[SQL_TABLE_BUNDLE];
-
-			size_t offset = 0;
 			const bool unlimited = (cb.limit() <= 0);
-			const size_t query_limit = 50;
 
+			// get constraints declared by the selector
+			const BundleConstraints *constraints = NULL;
 			try {
-				try {
-					const SQLBundleQuery &query = dynamic_cast<const SQLBundleQuery&>(cb);
+				constraints = &dynamic_cast<const IndexedBundleQuery&>(cb).getConstraints();
+			} catch (const std::bad_cast&) { };
 
-					// custom query string
-					const std::string query_string = base_query + " WHERE " + query.getWhere() + " ORDER BY priority DESC, timestamp, sequencenumber, fragmentoffset, fragmentlength LIMIT ?,?;";
+			// get the custom query of the selector
+			const SQLBundleQuery *query = NULL;
+			try {
+				query = &dynamic_cast<const SQLBundleQuery&>(cb);
+			} catch (const std::bad_cast&) { };
 
-					// create statement for custom query
-					Statement st(_database, query_string);
+			try {
+				// let the database evaluate the custom query and the constraints
+				std::string filter;
+				if (query != NULL) filter += "(" + query->getWhere() + ") AND ";
+				if (constraints != NULL) filter += __where(*constraints);
 
-					while (unlimited || (items_added < query_limit))
-					{
-						// bind the statement parameter
-						int bind_offset = query.bind(*st, 1);
+				const std::string query_string = "SELECT " + _select_names[3] + " FROM " + _tables[SQL_TABLE_BUNDLE] + " WHERE " + filter + _where_filter[2] + " ORDER BY timestamp, sequencenumber, fragmentoffset, fragmentlength, key LIMIT ?;";
 
-						// query the database
-						__get(cb, st, ret, items_added, bind_offset, offset, query_limit);
+				// create statement for the query
+				Statement st(_database, query_string);
 
-						// increment the offset, because we might not have enough
-						offset += query_limit;
-					}
-				} catch (const std::bad_cast&) {
-					Statement st(_database, _sql_queries[BUNDLE_GET_FILTER]);
+				// walk through the priorities from high to low
+				for (int priority = dtn::data::PrimaryBlock::PRIO_HIGH; priority >= dtn::data::PrimaryBlock::PRIO_LOW; --priority)
+				{
+					// stop at the minimum priority of the query (the priorities of MetaBundle are shifted by one)
+					if ((constraints != NULL) && constraints->has(BundleConstraints::CONSTRAINT_MIN_PRIORITY)
+							&& ((priority - 1) < constraints->getMinimumPriority())) break;
+
+					// start at the first bundle of this priority
+					KeysetCursor cursor(priority);
 
-					while (unlimited || (items_added < query_limit))
+					while (unlimited || (items_added < cb.limit()))
 					{
-						// query the database
-						__get(cb, st, ret, items_added, 1, offset, query_limit);
+						// bind the statement parameter
+						int bind_offset = 1;
+						if (query != NULL) bind_offset = query->bind(*st, bind_offset);
+						if (constraints != NULL) bind_offset = __bind(*st, bind_offset, *constraints);
 
-						// increment the offset, because we might not have enough
-						offset += query_limit;
+						// query the next page, stop if there are no more bundles
+						if (!__get(cb, constraints, st, ret, items_added, bind_offset, cursor)) break;
 					}
 				}
 			} catch (const SQLiteDatabase::SQLiteQueryException &ex) {
 				IBRCOMMON_LOGGER_TAG(SQLiteDatabase::TAG, critical) << ex.what() << IBRCOMMON_LOGGER_ENDL;
-			} catch (const dtn::storage::NoBundleFoundException&) { }
+			}
 
 			if (items_added == 0) throw dtn::storage::NoBundleFoundException();
 		}
 
-		void SQLiteDatabase::__get(const BundleSelector &cb, Statement &st, BundleResult &ret, size_t &items_added, const int bind_offset, const size_t offset, const size_t query_limit) const throw (SQLiteDatabase::SQLiteQueryException, NoBundleFoundException, BundleSelectorException)
+		bool SQLiteDatabase::__get(const BundleSelector &cb, const BundleConstraints *constraints, Statement &st, BundleResult &ret, size_t &items_added, const int bind_offset, KeysetCursor &cursor) const throw (SQLiteDatabase::SQLiteQueryException, BundleSelectorException)
 		{
 			const bool unlimited = (cb.limit() <= 0);
 
-			// limit result according to callback result
-			sqlite3_bind_int64(*st, bind_offset, offset);
-			sqlite3_bind_int64(*st, bind_offset + 1, query_limit);
+			// number of bundles per page
+			const size_t query_limit = 50;
+
+			// continue after the last bundle of the previous page
+			const int limit_offset = cursor.bind(*st, bind_offset);
+			sqlite3_bind_int64(*st, limit_offset, query_limit);
 
-			// returned no result
-			if ((st.step() == SQLITE_DONE) || _faulty)
-				throw dtn::storage::NoBundleFoundException();
+			size_t rows = 0;
 
 			// abort if enough bundles are found
-			while (unlimited || (items_added < query_limit))
+			while ((unlimited || (items_added < cb.limit())) && !_faulty && (st.step() == SQLITE_ROW))
 			{
+				rows++;
+
+				// remember the position of this bundle
+				cursor.set(*st);
+
 				dtn::data::MetaBundle m;
 
 				// extract the primary values and set them in the bundle object
 				get(st, m, 0);
 
-				// check if the bundle is already expired
-				if ( !dtn::utils::Clock::isExpired( m ) )
+				// check if the bundle is already expired and fulfills the constraints
+				if ( !dtn::utils::Clock::isExpired( m ) && ((constraints == NULL) || constraints->match(m)) )
 				{
 					// ask the filter if this bundle should be added to the return list
 					if (cb.addIfSelected(ret, m))
@@ -555,11 +586,103 @@ namespace dtn
 						items_added++;
 					}
 				}
-
-				if (st.step() != SQLITE_ROW) break;
 			}
 
 			st.reset();
+
+			return (rows == query_limit);
+		}
+
+		const std::string SQLiteDatabase::__where(const BundleConstraints &constraints) throw ()
+		{
+			std::string ret;
+
+			if (constraints.has(BundleConstraints::CONSTRAINT_DESTINATION))
+				ret += "destination = ? AND ";
+
+			// the endpoints of a node are selected as a range to use the destination index
+			if (constraints.has(BundleConstraints::CONSTRAINT_DESTINATION_NODE))
+				ret += "(destination = ? OR (destination >= ? AND destination < ?)) AND ";
+
+			if (constraints.has(BundleConstraints::CONSTRAINT_NOT_DESTINATION_NODE))
+				ret += "NOT (destination = ? OR (destination >= ? AND destination < ?)) AND ";
+
+			if (constraints.has(BundleConstraints::CONSTRAINT_FORWARDABLE))
+				ret += "(hopcount IS NULL OR hopcount > 1 OR (hopcount = 1 AND (procflags & ?) = 0)) AND ";
+
+			return ret;
+		}
+
+		int SQLiteDatabase::__bind(sqlite3_stmt *st, int offset, const BundleConstraints &constraints) throw ()
+		{
+			if (constraints.has(BundleConstraints::CONSTRAINT_DESTINATION))
+			{
+				const std::string d = constraints.getDestination().getString();
+				sqlite3_bind_text(st, offset++, d.c_str(), static_cast<int>(d.size()), SQLITE_TRANSIENT);
+			}
+
+			const BundleConstraints::CONSTRAINT node_constraints[2] = {
+					BundleConstraints::CONSTRAINT_DESTINATION_NODE,
+					BundleConstraints::CONSTRAINT_NOT_DESTINATION_NODE
+			};
+
+			for (int i = 0; i < 2; ++i)
+			{
+				if (!constraints.has(node_constraints[i])) continue;
+
+				const dtn::data::EID &node = (i == 0) ? constraints.getDestinationNode() : constraints.getExcludedDestinationNode();
+
+				// all endpoints of the node start with this prefix (e.g. dtn://node/ or ipn:1.)
+				const std::string n = node.getString();
+				const std::string lower = node.getScheme() + ":" + node.getHost() + node.getDelimiter();
+				std::string upper = lower;
+				upper[upper.size() - 1]++;
+
+				sqlite3_bind_text(st, offset++, n.c_str(), static_cast<int>(n.size()), SQLITE_TRANSIENT);
+				sqlite3_bind_text(st, offset++, lower.c_str(), static_cast<int>(lower.size()), SQLITE_TRANSIENT);
+				sqlite3_bind_text(st, offset++, upper.c_str(), static_cast<int>(upper.size()), SQLITE_TRANSIENT);
+			}
+
+			if (constraints.has(BundleConstraints::CONSTRAINT_FORWARDABLE))
+			{
+				sqlite3_bind_int(st, offset++, dtn::data::PrimaryBlock::DESTINATION_IS_SINGLETON);
+			}
+
+			return offset;
+		}
+
+		SQLiteDatabase::KeysetCursor::KeysetCursor(int priority)
+		 : _priority(priority), _timestamp(std::numeric_limits<sqlite3_int64>::min()), _sequencenumber(std::numeric_limits<sqlite3_int64>::min()), _fragmentoffset(std::numeric_limits<sqlite3_int64>::min()), _fragmentlength(std::numeric_limits<sqlite3_int64>::min()), _key(std::numeric_limits<sqlite3_int64>::min())
+		{
+		}
+
+		SQLiteDatabase::KeysetCursor::~KeysetCursor()
+		{
+		}
+
+		int SQLiteDatabase::KeysetCursor::bind(sqlite3_stmt *st, int offset) const throw ()
+		{
+			sqlite3_bind_int(st, offset++, _priority);
+			sqlite3_bind_int64(st, offset++, _timestamp);
+			sqlite3_bind_int64(st, offset++, _timestamp);
+			sqlite3_bind_int64(st, offset++, _sequencenumber);
+			sqlite3_bind_int64(st, offset++, _sequencenumber);
+			sqlite3_bind_int64(st, offset++, _fragmentoffset);
+			sqlite3_bind_int64(st, offset++, _fragmentoffset);
+			sqlite3_bind_int64(st, offset++, _fragmentlength);
+			sqlite3_bind_int64(st, offset++, _fragmentlength);
+			sqlite3_bind_int64(st, offset++, _key);
+			return offset;
+		}
+
+		void SQLiteDatabase::KeysetCursor::set(sqlite3_stmt *st) throw ()
+		{
+			// column numbers according to _select_names[3]
+			_timestamp = sqlite3_column_int64(st, 5);
+			_sequencenumber = sqlite3_column_int64(st, 6);
+			_fragmentoffset = sqlite3_column_int64(st, 9);
+			_fragmentlength = sqlite3_column_int64(st, 15);
+			_key = sqlite3_column_int64(st, 16);
 		}
 
 		void SQLiteDatabase::get(const dtn::data::BundleID &id, dtn::data::Bundle &bundle, blocklist &blocks) const throw (SQLiteDatabase::SQLiteQueryException, NoBundleFoundException)
@@ -765,7 +888,83 @@ namespace dtn
 			}
 		}
 
+		void SQLiteDatabase::savepoint(const std::string &name) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			execute("SAVEPOINT " + name + ";");
+		}
+
+		void SQLiteDatabase::release(const std::string &name) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			execute("RELEASE SAVEPOINT " + name + ";");
+		}
+
+		void SQLiteDatabase::rollback(const std::string &name) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			// undo all changes since the savepoint and remove it
+			execute("ROLLBACK TRANSACTION TO SAVEPOINT " + name + ";");
+			execute("RELEASE SAVEPOINT " + name + ";");
+		}
+
+		std::string SQLiteDatabase::setJournalMode(const std::string &mode) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			Statement st(_database, "PRAGMA journal_mode = " + mode + ";");
+
+			if (st.step() != SQLITE_ROW)
+			{
+				throw SQLiteQueryException("unable to set journal mode");
+			}
+
+			// sqlite returns the journal mode in use after the change
+			const std::string ret = (const char*)sqlite3_column_text(*st, 0);
+
+			if (ret != mode)
+			{
+				IBRCOMMON_LOGGER_TAG(SQLiteDatabase::TAG, warning) << "journal mode " << mode << " not supported, using " << ret << IBRCOMMON_LOGGER_ENDL;
+			}
+
+			return ret;
+		}
+
+		void SQLiteDatabase::setSynchronous(const std::string &mode) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			execute("PRAGMA synchronous = " + mode + ";");
+		}
+
+		void SQLiteDatabase::execute(const std::string &query) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			char *zErrMsg = 0;
+
+			int ret = sqlite3_exec(_database, query.c_str(), NULL, NULL, &zErrMsg);
+
+			// check if the return value signals an error
+			if ( ret != SQLITE_OK )
+			{
+				const std::string msg = (zErrMsg == NULL) ? query : zErrMsg;
+				sqlite3_free( zErrMsg );
+				throw SQLiteQueryException( msg );
+			}
+		}
+
 		dtn::data::Length SQLiteDatabase::remove(const dtn::data::BundleID &id) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			std::list<ibrcommon::File> files;
+			const dtn::data::Length ret = __remove(id, files);
+
+			// delete each referenced block file
+			for (std::list<ibrcommon::File>::iterator it = files.begin(); it != files.end(); ++it)
+			{
+				(*it).remove();
+			}
+
+			return ret;
+		}
+
+		dtn::data::Length SQLiteDatabase::remove(const dtn::data::BundleID &id, std::list<ibrcommon::File> &files) throw (SQLiteDatabase::SQLiteQueryException)
+		{
+			return __remove(id, files);
+		}
+
+		dtn::data::Length SQLiteDatabase::__remove(const dtn::data::BundleID &id, std::list<ibrcommon::File> &files) throw (SQLiteDatabase::SQLiteQueryException)
 		{
 			// return value (size of the bundle in bytes)
 			dtn::data::Length ret = 0;
@@ -799,9 +998,8 @@ namespace dtn
 				// step through all blocks
 				while (st.step() == SQLITE_ROW)
 				{
-					// delete each referenced block file
-					ibrcommon::File blockfile( (const char*)sqlite3_column_text(*st, 0) );
-					blockfile.remove();
+					// collect each referenced block file
+					files.push_back( ibrcommon::File( (const char*)sqlite3_column_text(*st, 0) ) );
 				}
 			}
 
@@ -25,6 +25,7 @@
 #include "core/BundleExpiredEvent.h"
 #include "storage/BundleSeeker.h"
 #include "storage/BundleSelector.h"
+#include "storage/BundleConstraints.h"
 #include <ibrdtn/data/EID.h>
 #include <ibrdtn/data/MetaBundle.h>
 #include <ibrcommon/data/File.h>
@@ -58,7 +59,6 @@ namespace dtn
 			enum STORAGE_STMT
 			{
 				BUNDLE_GET_ITERATOR,
-				BUNDLE_GET_FILTER,
 				BUNDLE_GET_ID,
 				BUNDLE_GET_LENGTH_ID,
 				GET_DISTINCT_DESTINATIONS,
@@ -106,9 +106,9 @@ namespace dtn
 			static const std::string QUERY_SCHEMAVERSION;
 			static const std::string SET_SCHEMAVERSION;
 
-			static const std::string _select_names[3];
+			static const std::string _select_names[4];
 
-			static const std::string _where_filter[2];
+			static const std::string _where_filter[3];
 
 			static const std::string _tables[SQL_TABLE_END];
 
@@ -116,7 +116,7 @@ namespace dtn
 			static const std::string _sql_queries[SQL_QUERIES_END];
 
 			// array of the db structure as sql
-			static const int DB_STRUCTURE_END = 15;
+			static const int DB_STRUCTURE_END = 16;
 			static const std::string _db_structure[DB_STRUCTURE_END];
 
 			static const std::string TAG;
@@ -226,6 +226,16 @@ namespace dtn
 			 */
 			dtn::data::Length remove(const dtn::data::BundleID &id) throw (SQLiteQueryException);
 
+			/**
+			 * Delete an entry in the database, but do not delete the block files.
+			 * Instead the files are appended to the given list and the caller has
+			 * to delete them as soon as the transaction is committed.
+			 * @param id
+			 * @param files List to put the obsolete block files into
+			 * @return The number of released bytes
+			 */
+			dtn::data::Length remove(const dtn::data::BundleID &id, std::list<ibrcommon::File> &files) throw (SQLiteQueryException);
+
 			/**
 			 * @see BundleSeeker::get(BundleSelector &cb, BundleResult &result)
 			 */
@@ -255,6 +265,25 @@ namespace dtn
 			void rollback() throw (SQLiteQueryException);
 			void commit() throw (SQLiteQueryException);
 
+			/**
+			 * Nested transactions within a running transaction
+			 * @param name The name of the savepoint
+			 */
+			void savepoint(const std::string &name) throw (SQLiteQueryException);
+			void release(const std::string &name) throw (SQLiteQueryException);
+			void rollback(const std::string &name) throw (SQLiteQueryException);
+
+			/**
+			 * Set the journal mode of the database (e.g. "wal" or "delete").
+			 * @return The journal mode in use after the change
+			 */
+			std::string setJournalMode(const std::string &mode) throw (SQLiteQueryException);
+
+			/**
+			 * Set the synchronous mode of the database (e.g. "off", "normal" or "full").
+			 */
+			void setSynchronous(const std::string &mode) throw (SQLiteQueryException);
+
 			bool empty() const throw (SQLiteQueryException);
 
 			dtn::data::Size count() const throw (SQLiteQueryException);
@@ -304,13 +333,56 @@ namespace dtn
 			void get(Statement &st, dtn::data::Bundle &bundle, const int offset = 0) const throw (SQLiteQueryException);
 
 			/**
-			 *
+			 * Position of the last bundle returned by a paged query. The next page
+			 * continues right after this position instead of skipping an offset.
+			 */
+			class KeysetCursor
+			{
+			public:
+				KeysetCursor(int priority);
+				~KeysetCursor();
+
+				/**
+				 * bind the position to the keyset filter of the statement
+				 * @return the next free bind offset
+				 */
+				int bind(sqlite3_stmt *st, int offset) const throw ();
+
+				/**
+				 * move the position to the current row of the statement
+				 */
+				void set(sqlite3_stmt *st) throw ();
+
+			private:
+				int _priority;
+				sqlite3_int64 _timestamp;
+				sqlite3_int64 _sequencenumber;
+				sqlite3_int64 _fragmentoffset;
+				sqlite3_int64 _fragmentlength;
+				sqlite3_int64 _key;
+			};
+
+			/**
+			 * Query one page of bundles following the cursor position
 			 * @param st
 			 * @param ret
 			 * @param bind_offset
-			 * @param limit
+			 * @param cursor
+			 * @return true, if the page was full and more bundles may follow
+			 */
+			bool __get(const BundleSelector &cb, const BundleConstraints *constraints, Statement &st, BundleResult &ret, size_t &items_added, const int bind_offset, KeysetCursor &cursor) const throw (SQLiteQueryException, BundleSelectorException);
+
+			/**
+			 * Translate the constraints of a query into a sql filter. The
+			 * returned string is empty or ends with an AND operator.
 			 */
-			void __get(const BundleSelector &cb, Statement &st, BundleResult &ret, size_t &items_added, const int bind_offset, const size_t offset, const size_t query_limit) const throw (SQLiteQueryException, NoBundleFoundException, BundleSelectorException);
+			static const std::string __where(const BundleConstraints &constraints) throw ();
+
+			/**
+			 * bind all values of the constraints to the statement
+			 * @return the next free bind offset
+			 */
+			static int __bind(sqlite3_stmt *st, int offset, const BundleConstraints &constraints) throw ();
 
 			/**
 			 * updates the nextExpiredTime. The calling function has to have the databaselock.
@@ -345,6 +417,16 @@ namespace dtn
 			 */
 			void doUpgrade(int oldVersion, int newVersion) throw (ibrcommon::Exception);
 
+			/**
+			 * execute a single sql statement without results
+			 */
+			void execute(const std::string &query) throw (SQLiteQueryException);
+
+			/**
+			 * delete the bundle entry and put all referenced block files into the list
+			 */
+			dtn::data::Length __remove(const dtn::data::BundleID &id, std::list<ibrcommon::File> &files) throw (SQLiteQueryException);
+
 			ibrcommon::File _file;
 
 			// holds the database handle
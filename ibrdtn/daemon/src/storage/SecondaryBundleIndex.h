@@ -0,0 +1,205 @@
+/*
+ * SecondaryBundleIndex.h
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SECONDARYBUNDLEINDEX_H_
+#define SECONDARYBUNDLEINDEX_H_
+
+#include "storage/BundleSelector.h"
+#include "storage/BundleConstraints.h"
+#include "storage/BundleResult.h"
+#include <ibrdtn/data/MetaBundle.h>
+#include <ibrdtn/data/EID.h>
+#include <ibrdtn/utils/Clock.h>
+#include <typeinfo>
+#include <set>
+#include <map>
+
+namespace dtn
+{
+	namespace storage
+	{
+		/**
+		 * Secondary indexes over a set of MetaBundles ordered by Compare. The index
+		 * holds references to the elements of the primary set, thus every element
+		 * has to be removed here before it gets erased in the primary set.
+		 */
+		template<class Compare>
+		class SecondaryBundleIndex
+		{
+		public:
+			typedef std::set<dtn::data::MetaBundle, Compare> primary_index;
+
+			/**
+			 * Predicate to skip expired bundles during a selection
+			 */
+			struct SkipExpired
+			{
+				bool operator()(const dtn::data::MetaBundle &meta) const
+				{
+					return dtn::utils::Clock::isExpired(meta);
+				}
+			};
+
+			/**
+			 * Predicate to consider all bundles during a selection
+			 */
+			struct SkipNone
+			{
+				bool operator()(const dtn::data::MetaBundle&) const
+				{
+					return false;
+				}
+			};
+
+			SecondaryBundleIndex() { };
+			virtual ~SecondaryBundleIndex() { };
+
+			/**
+			 * Add a bundle to the index. The MetaBundle has to be
+			 * an element of the primary index.
+			 */
+			void add(const dtn::data::MetaBundle &meta)
+			{
+				_destinations[meta.destination].insert(&meta);
+				_nodes[meta.destination.getNode()].insert(&meta);
+			}
+
+			/**
+			 * Remove a bundle from the index. The MetaBundle has to be
+			 * an element of the primary index.
+			 */
+			void remove(const dtn::data::MetaBundle &meta)
+			{
+				__remove(_destinations, meta.destination, meta);
+				__remove(_nodes, meta.destination.getNode(), meta);
+			}
+
+			/**
+			 * Remove all bundles from the index
+			 */
+			void clear()
+			{
+				_destinations.clear();
+				_nodes.clear();
+			}
+
+			/**
+			 * Select bundles of the primary index using the BundleSelector. If the
+			 * selector declares constraints, the candidates are taken from the
+			 * matching secondary index. Otherwise all bundles of the primary
+			 * index are passed to the selector.
+			 * @return The number of selected bundles
+			 */
+			template<class SkipPredicate>
+			dtn::data::Size select(const primary_index &primary, const BundleSelector &cb, BundleResult &result, const SkipPredicate &skip) const throw (BundleSelectorException)
+			{
+				const BundleConstraints *constraints = NULL;
+
+				try {
+					const IndexedBundleQuery &query = dynamic_cast<const IndexedBundleQuery&>(cb);
+					constraints = &query.getConstraints();
+				} catch (const std::bad_cast&) { };
+
+				dtn::data::Size items_added = 0;
+
+				// fallback: ask the selector for each bundle
+				if (constraints == NULL)
+				{
+					for (typename primary_index::const_iterator iter = primary.begin(); (iter != primary.end()) && ((cb.limit() == 0) || (items_added < cb.limit())); ++iter)
+					{
+						const dtn::data::MetaBundle &meta = (*iter);
+						if ( skip(meta) ) continue;
+						if ( cb.addIfSelected(result, meta) ) items_added++;
+					}
+
+					return items_added;
+				}
+
+				const meta_ptr_set *candidates = NULL;
+
+				if (constraints->has(BundleConstraints::CONSTRAINT_DESTINATION))
+				{
+					typename eid_index::const_iterator it = _destinations.find(constraints->getDestination());
+					if (it == _destinations.end()) return 0;
+					candidates = &(*it).second;
+				}
+				else if (constraints->has(BundleConstraints::CONSTRAINT_DESTINATION_NODE))
+				{
+					typename eid_index::const_iterator it = _nodes.find(constraints->getDestinationNode());
+					if (it == _nodes.end()) return 0;
+					candidates = &(*it).second;
+				}
+
+				if (candidates == NULL)
+				{
+					for (typename primary_index::const_iterator iter = primary.begin(); (iter != primary.end()) && ((cb.limit() == 0) || (items_added < cb.limit())); ++iter)
+					{
+						const dtn::data::MetaBundle &meta = (*iter);
+						if ( skip(meta) ) continue;
+						if ( !constraints->match(meta) ) continue;
+						if ( cb.addIfSelected(result, meta) ) items_added++;
+					}
+				}
+				else
+				{
+					for (typename meta_ptr_set::const_iterator iter = candidates->begin(); (iter != candidates->end()) && ((cb.limit() == 0) || (items_added < cb.limit())); ++iter)
+					{
+						const dtn::data::MetaBundle &meta = (**iter);
+						if ( skip(meta) ) continue;
+						if ( !constraints->match(meta) ) continue;
+						if ( cb.addIfSelected(result, meta) ) items_added++;
+					}
+				}
+
+				return items_added;
+			}
+
+		private:
+			struct CMP_META_POINTER
+			{
+				bool operator() (const dtn::data::MetaBundle *lhs, const dtn::data::MetaBundle *rhs) const
+				{
+					return Compare()(*lhs, *rhs);
+				}
+			};
+
+			// the sets are ordered in the same way as the primary index
+			typedef std::set<const dtn::data::MetaBundle*, CMP_META_POINTER> meta_ptr_set;
+			typedef std::map<dtn::data::EID, meta_ptr_set> eid_index;
+
+			static void __remove(eid_index &index, const dtn::data::EID &key, const dtn::data::MetaBundle &meta)
+			{
+				typename eid_index::iterator it = index.find(key);
+				if (it == index.end()) return;
+
+				(*it).second.erase(&meta);
+				if ((*it).second.empty()) index.erase(it);
+			}
+
+			// index of bundles by destination
+			eid_index _destinations;
+
+			// index of bundles by destination node
+			eid_index _nodes;
+		};
+	} /* namespace storage */
+} /* namespace dtn */
+#endif /* SECONDARYBUNDLEINDEX_H_ */
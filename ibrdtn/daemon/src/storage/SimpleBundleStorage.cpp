@@ -255,26 +255,17 @@ namespace dtn
 
 		void SimpleBundleStorage::get(const BundleSelector &cb, BundleResult &result) throw (NoBundleFoundException, BundleSelectorException)
 		{
-			size_t items_added = 0;
-
-			// we have to iterate through all bundles
 			ibrcommon::MutexLock l(_meta_lock);
 
-			for (MetaStorage::const_iterator iter = _metastore.begin(); (iter != _metastore.end()) && ((cb.limit() == 0) || (items_added < cb.limit())); ++iter)
-			{
-				const dtn::data::MetaBundle &meta = (*iter);
-
-				// skip expired bundles
-				if ( dtn::utils::Clock::isExpired( meta ) ) continue;
-
-				if ( cb.addIfSelected(result, meta) ) items_added++;
-			}
-
-			if (items_added == 0) throw NoBundleFoundException();
+			// select bundles using the meta storage indexes
+			if (_metastore.select(cb, result) == 0) throw NoBundleFoundException();
 		}
 
 		dtn::data::Bundle SimpleBundleStorage::get(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("simple", "get");
+			dtn::core::Metrics::Timer timer(latency);
+
 			try {
 				ibrcommon::MutexLock l(_meta_lock);
 
@@ -348,6 +339,9 @@ namespace dtn
 
 		void SimpleBundleStorage::store(const dtn::data::Bundle &bundle)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("simple", "store");
+			dtn::core::Metrics::Timer timer(latency);
+
 			// get the bundle size
 			dtn::data::DefaultSerializer s(std::cout);
 			const dtn::data::Length bundle_size = s.getLength(bundle);
@@ -395,6 +389,9 @@ namespace dtn
 
 		void SimpleBundleStorage::remove(const dtn::data::BundleID &id)
 		{
+			static const dtn::core::Metrics::Histogram latency = getLatency("simple", "remove");
+			dtn::core::Metrics::Timer timer(latency);
+
 			ibrcommon::MutexLock l(_meta_lock);
 			const dtn::data::MetaBundle &meta = _metastore.find(dtn::data::MetaBundle::create(id));
 
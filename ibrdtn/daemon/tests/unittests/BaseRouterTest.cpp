@@ -33,6 +33,7 @@
 #include "BaseRouterTest.hh"
 #include "routing/RoutingExtension.h"
 #include "routing/BaseRouter.h"
+#include "routing/RoutingTaskQueue.h"
 #include "storage/BundleStorage.h"
 #include "core/Node.h"
 #include "../tools/EventSwitchLoop.h"
@@ -251,6 +252,54 @@ void BaseRouterTest::testGetSummaryVector()
 
 /*=== END   tests for class 'BaseRouter' ===*/
 
+void BaseRouterTest::testTaskQueueCoalescing()
+{
+	class TestTask : public dtn::routing::RoutingTask
+	{
+	public:
+		TestTask(const int type, const dtn::data::EID &peer, const bool coalesce)
+		 : dtn::routing::RoutingTask(type, peer, coalesce) {};
+		~TestTask() {};
+
+		std::string toString() const { return "TestTask"; };
+	};
+
+	const dtn::data::EID peer_a("dtn://node-a");
+	const dtn::data::EID peer_b("dtn://node-b");
+
+	dtn::routing::RoutingTaskQueue queue;
+
+	// equal searches are coalesced while queued
+	CPPUNIT_ASSERT(queue.push(new TestTask(0, peer_a, true)));
+	CPPUNIT_ASSERT(!queue.push(new TestTask(0, peer_a, true)));
+	CPPUNIT_ASSERT(queue.push(new TestTask(0, peer_b, true)));
+	CPPUNIT_ASSERT(queue.push(new TestTask(1, peer_a, true)));
+
+	// tasks without coalescing are always queued
+	CPPUNIT_ASSERT(queue.push(new TestTask(2, peer_a, false)));
+	CPPUNIT_ASSERT(queue.push(new TestTask(2, peer_a, false)));
+
+	CPPUNIT_ASSERT_EQUAL((size_t)5, queue.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, queue.getCoalesced());
+
+	// once the processing has started, the same task is accepted again
+	std::auto_ptr<dtn::routing::RoutingTask> t(queue.poll());
+	CPPUNIT_ASSERT_EQUAL(0, t->type);
+	CPPUNIT_ASSERT(peer_a == t->peer);
+	CPPUNIT_ASSERT(queue.push(new TestTask(0, peer_a, true)));
+
+	CPPUNIT_ASSERT_EQUAL((size_t)5, queue.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, queue.getProcessed());
+
+	// the queue keeps the order of the tasks
+	t.reset(queue.poll());
+	CPPUNIT_ASSERT(peer_b == t->peer);
+	t.reset(queue.poll());
+	CPPUNIT_ASSERT_EQUAL(1, t->type);
+
+	// remaining tasks are deleted by the queue
+}
+
 void BaseRouterTest::setUp()
 {
 	_storage.clear();
@@ -37,6 +37,8 @@ class BaseRouterTest : public CppUnit::TestFixture {
 		void testGetSummaryVector();
 		/*=== END   tests for class 'BaseRouter' ===*/
 
+		void testTaskQueueCoalescing();
+
 		void setUp();
 		void tearDown();
 
@@ -50,6 +52,7 @@ class BaseRouterTest : public CppUnit::TestFixture {
 			CPPUNIT_TEST(testIsKnown);
 			CPPUNIT_TEST(testSetKnown);
 			CPPUNIT_TEST(testGetSummaryVector);
+			CPPUNIT_TEST(testTaskQueueCoalescing);
 		CPPUNIT_TEST_SUITE_END();
 };
 #endif /* BASEROUTERTEST_HH */
@@ -44,18 +44,24 @@
 #include <ibrcommon/data/File.h>
 #include <ibrcommon/data/BLOB.h>
 #include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/TimeMeasurement.h>
 #include <ibrdtn/data/PayloadBlock.h>
 #include <ibrdtn/data/AgeBlock.h>
+#include <ibrdtn/data/ScopeControlHopLimitBlock.h>
 #include "Component.h"
 
 #include "storage/SimpleBundleStorage.h"
+#include "storage/LogBundleStorage.h"
 #include "storage/MemoryBundleStorage.h"
+#include "storage/BundleConstraints.h"
 
 #ifdef HAVE_SQLITE
 #include "storage/SQLiteBundleStorage.h"
 #endif
 
 #include <unistd.h>
+#include <stdlib.h>
+#include <set>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BundleStorageTest);
 
@@ -102,8 +108,20 @@ void BundleStorageTest::setUp()
 			break;
 		}
 
-#ifdef HAVE_SQLITE
 	case 2:
+		{
+			// prepare path for the log-structured storage
+			ibrcommon::File path("/tmp/bundle-log-test");
+			if (path.exists()) path.remove(true);
+			ibrcommon::File::createDirectory(path);
+
+			// use small segments to test the rollover and compaction
+			_storage = new dtn::storage::LogBundleStorage(path, 0, 65536);
+			break;
+		}
+
+#ifdef HAVE_SQLITE
+	case 3:
 		{
 			// prepare path for the sqlite based storage
 			ibrcommon::File path("/tmp/bundle-sqlite-test");
@@ -114,6 +132,22 @@ void BundleStorageTest::setUp()
 			_storage = new dtn::storage::SQLiteBundleStorage(path, 0);
 			break;
 		}
+
+	case 4:
+		{
+			// prepare path for the sqlite based storage
+			ibrcommon::File path("/tmp/bundle-sqlite-test");
+			if (path.exists()) path.remove(true);
+			ibrcommon::File::createDirectory(path);
+
+			// prepare a sqlite database with write-ahead log and group commit
+			dtn::storage::SQLiteBundleStorage *sqlite = new dtn::storage::SQLiteBundleStorage(path, 0);
+			sqlite->setJournalMode("wal");
+			sqlite->setSynchronous("normal");
+			sqlite->setGroupCommit(50, 64);
+			_storage = sqlite;
+			break;
+		}
 #endif
 	}
 
@@ -981,6 +1015,397 @@ void BundleStorageTest::testInfo(dtn::storage::BundleStorage &storage)
 	CPPUNIT_ASSERT_EQUAL((dtn::data::BundleID&)b, (dtn::data::BundleID&)meta);
 }
 
+void BundleStorageTest::testManyBundles()
+{
+	STORAGE_TEST(testManyBundles);
+}
+
+void BundleStorageTest::testManyBundles(dtn::storage::BundleStorage &storage)
+{
+	// number of lookups per round
+	const size_t lookups = 200;
+
+	for (size_t num = 250; num <= 4000; num *= 4)
+	{
+		std::vector<dtn::data::BundleID> ids;
+
+		for (size_t i = 0; i < num; ++i)
+		{
+			dtn::data::Bundle b;
+			b.source = dtn::data::EID("dtn://node-one/test");
+			b.destination = dtn::data::EID("dtn://node-two/test");
+			b.lifetime = 3600;
+			b.sequencenumber = i;
+
+			// add some payload
+			ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+			b.push_back(ref);
+			(*ref.iostream()) << "Hallo Welt" << std::endl;
+
+			storage.store(b);
+			ids.push_back(b);
+		}
+
+		// wait until all bundles are stored
+		storage.wait();
+
+		CPPUNIT_ASSERT_EQUAL((dtn::data::Size)num, storage.count());
+
+		for (size_t i = 0; i < lookups; ++i)
+		{
+			const dtn::data::BundleID &id = ids[(i * 7919) % num];
+			const dtn::data::Bundle b = storage.get(id);
+			CPPUNIT_ASSERT_EQUAL(id, (const dtn::data::BundleID&)b);
+			CPPUNIT_ASSERT(storage.contains(id));
+		}
+
+		for (size_t i = 0; i < lookups; ++i)
+		{
+			storage.remove(ids[i]);
+		}
+
+		// wait until all bundles are removed
+		storage.wait();
+
+		CPPUNIT_ASSERT_EQUAL((dtn::data::Size)(num - lookups), storage.count());
+
+		// removed bundles are gone, all others are still there
+		for (size_t i = 0; i < num; i += 7)
+		{
+			CPPUNIT_ASSERT_EQUAL(i >= lookups, storage.contains(ids[i]));
+		}
+
+		CPPUNIT_ASSERT_THROW(storage.get(ids[0]), dtn::storage::NoBundleFoundException);
+		CPPUNIT_ASSERT_EQUAL(ids[lookups], (const dtn::data::BundleID&)storage.get(ids[lookups]));
+
+		storage.clear();
+
+		// wait until all bundles are removed
+		storage.wait();
+
+		CPPUNIT_ASSERT_EQUAL((dtn::data::Size)0, storage.count());
+	}
+}
+
+void BundleStorageTest::testPerformance()
+{
+	STORAGE_TEST(testPerformance);
+}
+
+void BundleStorageTest::testPerformance(dtn::storage::BundleStorage &storage)
+{
+	// the benchmark is only run on request, testManyBundles checks the results
+	if (::getenv("IBRDTN_BENCHMARK") == NULL) return;
+
+	// number of lookups per measurement
+	const size_t lookups = 200;
+
+	std::cout << std::endl;
+
+	for (size_t num = 250; num <= 4000; num *= 4)
+	{
+		std::vector<dtn::data::BundleID> ids;
+
+		ibrcommon::TimeMeasurement tm_store;
+		tm_store.start();
+
+		for (size_t i = 0; i < num; ++i)
+		{
+			dtn::data::Bundle b;
+			b.source = dtn::data::EID("dtn://node-one/test");
+			b.destination = dtn::data::EID("dtn://node-two/test");
+			b.lifetime = 3600;
+			b.sequencenumber = i;
+
+			// add some payload
+			ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+			b.push_back(ref);
+			(*ref.iostream()) << "Hallo Welt" << std::endl;
+
+			storage.store(b);
+			ids.push_back(b);
+		}
+
+		// wait until all bundles are stored
+		storage.wait();
+
+		tm_store.stop();
+
+		CPPUNIT_ASSERT_EQUAL((dtn::data::Size)num, storage.count());
+
+		ibrcommon::TimeMeasurement tm_get, tm_contains, tm_remove;
+
+		tm_get.start();
+		for (size_t i = 0; i < lookups; ++i)
+		{
+			const dtn::data::BundleID &id = ids[(i * 7919) % num];
+			const dtn::data::Bundle b = storage.get(id);
+			CPPUNIT_ASSERT_EQUAL(id, (const dtn::data::BundleID&)b);
+		}
+		tm_get.stop();
+
+		tm_contains.start();
+		for (size_t i = 0; i < lookups; ++i)
+		{
+			CPPUNIT_ASSERT(storage.contains(ids[(i * 7919) % num]));
+		}
+		tm_contains.stop();
+
+		tm_remove.start();
+		for (size_t i = 0; i < lookups; ++i)
+		{
+			storage.remove(ids[i]);
+		}
+		tm_remove.stop();
+
+		CPPUNIT_ASSERT_EQUAL((dtn::data::Size)(num - lookups), storage.count());
+
+		std::cout << num << " bundles: store " << (tm_store.getMicroseconds() / num) << " us"
+				<< ", get " << (tm_get.getMicroseconds() / lookups) << " us"
+				<< ", contains " << (tm_contains.getMicroseconds() / lookups) << " us"
+				<< ", remove " << (tm_remove.getMicroseconds() / lookups) << " us" << std::endl;
+
+		storage.clear();
+
+		// wait until all bundles are removed
+		storage.wait();
+	}
+}
+
+void BundleStorageTest::testConstrainedSelector()
+{
+	STORAGE_TEST(testConstrainedSelector);
+}
+
+void BundleStorageTest::testConstrainedSelector(dtn::storage::BundleStorage &storage)
+{
+	class BundleFilter : public dtn::storage::BundleSelector, public dtn::storage::IndexedBundleQuery
+	{
+	public:
+		BundleFilter(const dtn::storage::BundleConstraints &constraints)
+		 : _constraints(constraints)
+		{};
+
+		virtual ~BundleFilter() {};
+
+		virtual dtn::data::Size limit() const throw () { return 0; };
+
+		virtual bool shouldAdd(const dtn::data::MetaBundle&) const throw (dtn::storage::BundleSelectorException)
+		{
+			// the constraints are evaluated by the storage
+			return true;
+		};
+
+		virtual const dtn::storage::BundleConstraints& getConstraints() const throw () { return _constraints; };
+
+	private:
+		const dtn::storage::BundleConstraints &_constraints;
+	};
+
+	ibrcommon::BloomFilter known;
+
+	for (int i = 0; i < 30; ++i)
+	{
+		dtn::data::Bundle b;
+		b.source = dtn::data::EID("dtn://node-one/test");
+		b.lifetime = 3600;
+		b.sequencenumber = i;
+
+		// distribute the bundles over three destination nodes
+		std::stringstream ss; ss << "dtn://node-" << (i % 3) << "/app" << (i % 2);
+		b.destination = dtn::data::EID(ss.str());
+
+		// assign a priority to the bundle
+		b.setPriority(dtn::data::PrimaryBlock::PRIORITY((i / 3) % 3));
+
+		// add some payload
+		ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+		b.push_back(ref);
+		(*ref.iostream()) << "Hallo Welt" << std::endl;
+
+		// mark every fifth bundle as known
+		if (i % 5 == 0) b.addTo(known);
+
+		// every tenth bundle has no hops left
+		if (i % 10 == 0) b.push_front<dtn::data::ScopeControlHopLimitBlock>().setLimit(0);
+
+		storage.store(b);
+	}
+
+	// wait until all bundles are stored
+	storage.wait();
+
+	{
+		dtn::storage::BundleConstraints c;
+		c.setDestinationNode(dtn::data::EID("dtn://node-1"));
+		BundleFilter filter(c);
+
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		CPPUNIT_ASSERT_EQUAL((size_t)10, list.size());
+
+		for (dtn::storage::BundleResultList::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			CPPUNIT_ASSERT_EQUAL(dtn::data::EID("dtn://node-1"), (*iter).destination.getNode());
+		}
+	}
+
+	{
+		dtn::storage::BundleConstraints c;
+		c.setDestination(dtn::data::EID("dtn://node-2/app1"));
+		BundleFilter filter(c);
+
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		CPPUNIT_ASSERT_EQUAL((size_t)5, list.size());
+
+		for (dtn::storage::BundleResultList::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			CPPUNIT_ASSERT_EQUAL(dtn::data::EID("dtn://node-2/app1"), (*iter).destination);
+		}
+	}
+
+	{
+		dtn::storage::BundleConstraints c;
+		c.setMinimumPriority(1);
+		c.setExcludeFilter(known);
+		BundleFilter filter(c);
+
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		// 9 bundles with high priority, two of them are in the bloom filter
+		CPPUNIT_ASSERT_EQUAL((size_t)7, list.size());
+
+		for (dtn::storage::BundleResultList::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			CPPUNIT_ASSERT_EQUAL(1, (*iter).getPriority());
+			CPPUNIT_ASSERT(!(*iter).isIn(known));
+		}
+	}
+
+	{
+		// without an exclude filter an empty filter is returned
+		dtn::storage::BundleConstraints c;
+		CPPUNIT_ASSERT(!c.has(dtn::storage::BundleConstraints::CONSTRAINT_NOT_IN_FILTER));
+		CPPUNIT_ASSERT(!c.getExcludeFilter().contains(std::string("dtn://node-one/test")));
+	}
+
+	{
+		dtn::storage::BundleConstraints c;
+		c.setDestinationNode(dtn::data::EID("dtn://node-9"));
+		BundleFilter filter(c);
+
+		dtn::storage::BundleResultList list;
+		CPPUNIT_ASSERT_THROW(storage.get(filter, list), dtn::storage::NoBundleFoundException);
+	}
+
+	{
+		dtn::storage::BundleConstraints c;
+		c.setExcludeDestinationNode(dtn::data::EID("dtn://node-1/app1"));
+		c.setForwardable();
+		BundleFilter filter(c);
+
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		// 20 bundles for other nodes, two of them have no hops left
+		CPPUNIT_ASSERT_EQUAL((size_t)18, list.size());
+
+		for (dtn::storage::BundleResultList::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			CPPUNIT_ASSERT((*iter).destination.getNode() != dtn::data::EID("dtn://node-1"));
+			CPPUNIT_ASSERT((*iter).hopcount != 0);
+		}
+	}
+}
+
+void BundleStorageTest::testSelectorPaging()
+{
+	STORAGE_TEST(testSelectorPaging);
+}
+
+void BundleStorageTest::testSelectorPaging(dtn::storage::BundleStorage &storage)
+{
+	class BundleFilter : public dtn::storage::BundleSelector
+	{
+	public:
+		BundleFilter(dtn::data::Size limit)
+		 : _limit(limit)
+		{};
+
+		virtual ~BundleFilter() {};
+
+		virtual dtn::data::Size limit() const throw () { return _limit; };
+
+		virtual bool shouldAdd(const dtn::data::MetaBundle&) const throw (dtn::storage::BundleSelectorException)
+		{
+			return true;
+		};
+
+	private:
+		const dtn::data::Size _limit;
+	};
+
+	// use the same timestamp for all bundles to page through bundles with equal keys
+	const dtn::data::Timestamp timestamp = dtn::utils::Clock::getTime();
+
+	for (int i = 0; i < 230; ++i)
+	{
+		dtn::data::Bundle b;
+		b.source = dtn::data::EID((i % 2) ? "dtn://node-one/test" : "dtn://node-two/test");
+		b.destination = dtn::data::EID("dtn://node-three/test");
+		b.timestamp = timestamp;
+		b.lifetime = 3600;
+		b.sequencenumber = i / 2;
+		b.setPriority(dtn::data::PrimaryBlock::PRIORITY(i % 3));
+
+		ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+		b.push_back(ref);
+		(*ref.iostream()) << "Hallo Welt" << std::endl;
+
+		storage.store(b);
+	}
+
+	// wait until all bundles are stored
+	storage.wait();
+
+	{
+		BundleFilter filter(0);
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		// each bundle is returned exactly once
+		CPPUNIT_ASSERT_EQUAL((size_t)230, list.size());
+
+		std::set<dtn::data::BundleID> ids;
+		int priority = 1;
+
+		for (dtn::storage::BundleResultList::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			CPPUNIT_ASSERT(ids.insert(*iter).second);
+
+			// bundles with higher priority come first
+			CPPUNIT_ASSERT((*iter).getPriority() <= priority);
+			priority = (*iter).getPriority();
+		}
+	}
+
+	{
+		BundleFilter filter(100);
+		dtn::storage::BundleResultList list;
+		storage.get(filter, list);
+
+		CPPUNIT_ASSERT_EQUAL((size_t)100, list.size());
+
+		// the high priority bundles are returned first
+		CPPUNIT_ASSERT_EQUAL(1, list.front().getPriority());
+		CPPUNIT_ASSERT_EQUAL(0, list.back().getPriority());
+	}
+}
+
 void BundleStorageTest::testQueryBloomFilter()
 {
 	STORAGE_TEST(testQueryBloomFilter);
@@ -1043,3 +1468,154 @@ void BundleStorageTest::testQueryBloomFilter(dtn::storage::BundleStorage &storag
 
 	CPPUNIT_ASSERT_EQUAL((size_t)0, list.size());
 }
+
+void BundleStorageTest::testGroupCommit()
+{
+	STORAGE_TEST(testGroupCommit);
+}
+
+void BundleStorageTest::testGroupCommit(dtn::storage::BundleStorage &storage)
+{
+#ifdef HAVE_SQLITE
+	dtn::storage::SQLiteBundleStorage *sqlite = dynamic_cast<dtn::storage::SQLiteBundleStorage*>(&storage);
+
+	// this test is only applicable to the sqlite storage
+	if (sqlite == NULL) return;
+
+	// use a long window to commit groups only on the limit
+	sqlite->setGroupCommit(60000, 4);
+
+	const dtn::storage::SQLiteBundleStorage::GroupCommitStats before = sqlite->getGroupCommitStats();
+
+	std::vector<dtn::data::BundleID> ids;
+
+	for (size_t i = 0; i < 10; ++i)
+	{
+		dtn::data::Bundle b;
+		b.source = dtn::data::EID("dtn://node-one/test");
+		b.destination = dtn::data::EID("dtn://node-two/test");
+		b.lifetime = 3600;
+		b.sequencenumber = i;
+
+		ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+		b.push_back(ref);
+		(*ref.iostream()) << "Hallo Welt" << std::endl;
+
+		storage.store(b);
+		ids.push_back(b);
+	}
+
+	// uncommitted bundles are visible to the storage
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)10, storage.count());
+	CPPUNIT_ASSERT(storage.contains(ids[9]));
+
+	// two groups are committed due to the limit
+	dtn::storage::SQLiteBundleStorage::GroupCommitStats stats = sqlite->getGroupCommitStats();
+	CPPUNIT_ASSERT_EQUAL(before.commits + 2, stats.commits);
+	CPPUNIT_ASSERT_EQUAL(before.operations + 8, stats.operations);
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)4, stats.last_size);
+
+	const dtn::data::Length size = storage.size();
+
+	// remove a committed and an uncommitted bundle, this fills the third group
+	storage.remove(ids[0]);
+
+	// the space of a committed bundle is released after the commit of the removal
+	CPPUNIT_ASSERT_EQUAL(size, storage.size());
+
+	storage.remove(ids[9]);
+
+	// nothing left to commit
+	storage.wait();
+
+	CPPUNIT_ASSERT(storage.size() < size);
+
+	stats = sqlite->getGroupCommitStats();
+	CPPUNIT_ASSERT_EQUAL(before.commits + 3, stats.commits);
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)4, stats.last_size);
+	CPPUNIT_ASSERT(stats.total_latency >= stats.last_latency);
+
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)8, storage.count());
+	CPPUNIT_ASSERT(!storage.contains(ids[0]));
+	CPPUNIT_ASSERT(!storage.contains(ids[9]));
+
+	// committed bundles are still available
+	const dtn::data::Bundle b = storage.get(ids[5]);
+	CPPUNIT_ASSERT_EQUAL(ids[5], (const dtn::data::BundleID&)b);
+#endif
+}
+
+void BundleStorageTest::testCompaction()
+{
+	STORAGE_TEST(testCompaction);
+}
+
+void BundleStorageTest::testCompaction(dtn::storage::BundleStorage &storage)
+{
+	dtn::storage::LogBundleStorage *log = dynamic_cast<dtn::storage::LogBundleStorage*>(&storage);
+
+	// this test is only applicable to the log-structured storage
+	if (log == NULL) return;
+
+	std::vector<dtn::data::BundleID> ids;
+
+	// fill several segments
+	for (size_t i = 0; i < 500; ++i)
+	{
+		dtn::data::Bundle b;
+		b.source = dtn::data::EID("dtn://node-one/test");
+		b.destination = dtn::data::EID("dtn://node-two/test");
+		b.lifetime = 3600;
+		b.sequencenumber = i;
+
+		ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+		b.push_back(ref);
+		(*ref.iostream()) << std::string(1000, static_cast<char>('a' + (i % 26)));
+
+		storage.store(b);
+		ids.push_back(b);
+	}
+
+	const dtn::data::Size segments = log->getSegmentCount();
+	CPPUNIT_ASSERT(segments > 4);
+
+	// remove nine of ten bundles
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		if (i % 10 != 0) storage.remove(ids[i]);
+	}
+
+	// wait until the compaction is done
+	storage.wait();
+
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)50, storage.count());
+	CPPUNIT_ASSERT(log->getSegmentCount() < segments);
+
+	// all remaining bundles are still readable
+	for (size_t i = 0; i < ids.size(); i += 10)
+	{
+		const dtn::data::Bundle b = storage.get(ids[i]);
+		CPPUNIT_ASSERT_EQUAL(ids[i], (const dtn::data::BundleID&)b);
+
+		const dtn::data::PayloadBlock &p = b.find<dtn::data::PayloadBlock>();
+		ibrcommon::BLOB::iostream stream = p.getBLOB().iostream();
+		CPPUNIT_ASSERT_EQUAL((std::streamsize)1000, stream.size());
+
+		char c = 0;
+		(*stream).get(c);
+		CPPUNIT_ASSERT_EQUAL(static_cast<char>('a' + (i % 26)), c);
+	}
+
+	// reboot the storage and restore the bundles from the segments
+	dtn::daemon::Component &c = dynamic_cast<dtn::daemon::Component&>(storage);
+	c.terminate();
+	c.initialize();
+	c.startup();
+
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)50, storage.count());
+	CPPUNIT_ASSERT(storage.contains(ids[490]));
+	CPPUNIT_ASSERT(!storage.contains(ids[491]));
+
+	const dtn::data::Bundle b = storage.get(ids[250]);
+	CPPUNIT_ASSERT_EQUAL(ids[250], (const dtn::data::BundleID&)b);
+}
@@ -51,6 +51,12 @@ class BundleStorageTest : public CppUnit::TestFixture {
 		void testFragment(dtn::storage::BundleStorage &storage);
 		void testContains(dtn::storage::BundleStorage &storage);
 		void testInfo(dtn::storage::BundleStorage &storage);
+		void testManyBundles(dtn::storage::BundleStorage &storage);
+		void testPerformance(dtn::storage::BundleStorage &storage);
+		void testConstrainedSelector(dtn::storage::BundleStorage &storage);
+		void testGroupCommit(dtn::storage::BundleStorage &storage);
+		void testCompaction(dtn::storage::BundleStorage &storage);
+		void testSelectorPaging(dtn::storage::BundleStorage &storage);
 
 	public:
 #define CPPUNIT_TEST_ALL_STORAGES(testMethod) \
@@ -86,6 +92,12 @@ class BundleStorageTest : public CppUnit::TestFixture {
 		void testFragment();
 		void testContains();
 		void testInfo();
+		void testManyBundles();
+		void testPerformance();
+		void testConstrainedSelector();
+		void testGroupCommit();
+		void testCompaction();
+		void testSelectorPaging();
 
 		void setUp();
 		void tearDown();
@@ -94,9 +106,11 @@ class BundleStorageTest : public CppUnit::TestFixture {
 
 		_storage_names.push_back("MemoryBundleStorage");
 		_storage_names.push_back("SimpleBundleStorage");
+		_storage_names.push_back("LogBundleStorage");
 
 #ifdef HAVE_SQLITE
 		_storage_names.push_back("SQLiteBundleStorage");
+		_storage_names.push_back("SQLiteBundleStorage with group commit");
 #endif
 
 		CPPUNIT_TEST_ALL_STORAGES(testStore);
@@ -122,6 +136,12 @@ class BundleStorageTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST_ALL_STORAGES(testFragment);
 		CPPUNIT_TEST_ALL_STORAGES(testContains);
 		CPPUNIT_TEST_ALL_STORAGES(testInfo);
+		CPPUNIT_TEST_ALL_STORAGES(testManyBundles);
+		CPPUNIT_TEST_ALL_STORAGES(testPerformance);
+		CPPUNIT_TEST_ALL_STORAGES(testConstrainedSelector);
+		CPPUNIT_TEST_ALL_STORAGES(testGroupCommit);
+		CPPUNIT_TEST_ALL_STORAGES(testCompaction);
+		CPPUNIT_TEST_ALL_STORAGES(testSelectorPaging);
 		CPPUNIT_TEST_SUITE_END();
 
 		static size_t testCounter;
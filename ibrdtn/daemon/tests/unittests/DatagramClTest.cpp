@@ -119,6 +119,10 @@ void DatagramClTest::discoveryTest() {
 	const std::set<dtn::core::Node> pre_disco_nodes = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
 	CPPUNIT_ASSERT_EQUAL((size_t)0, pre_disco_nodes.size());
 
+	// the snapshot is shared as long as the neighbors do not change
+	const dtn::net::ConnectionManager::neighbor_snapshot pre_snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+	CPPUNIT_ASSERT(pre_snapshot == dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot());
+
 	// send fake discovery beacon
 	_fake_service->fakeDiscovery();
 
@@ -128,6 +132,14 @@ void DatagramClTest::discoveryTest() {
 
 	const std::set<dtn::core::Node> post_disco_nodes = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighbors();
 	CPPUNIT_ASSERT_EQUAL((size_t)1, post_disco_nodes.size());
+
+	// a new snapshot has been published for the discovered node
+	const dtn::net::ConnectionManager::neighbor_snapshot post_snapshot = dtn::core::BundleCore::getInstance().getConnectionManager().getNeighborSnapshot();
+	CPPUNIT_ASSERT(pre_snapshot->getVersion() < post_snapshot->getVersion());
+
+	const dtn::data::EID &peer = (*post_disco_nodes.begin()).getEID();
+	CPPUNIT_ASSERT(post_snapshot->isNeighbor(peer));
+	CPPUNIT_ASSERT(!post_snapshot->getSupportedProtocols(peer).empty());
 }
 
 void DatagramClTest::queueTest() {
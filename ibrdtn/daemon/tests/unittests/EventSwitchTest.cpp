@@ -0,0 +1,295 @@
+/*
+ * EventSwitchTest.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EventSwitchTest.h"
+#include "core/Event.h"
+#include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/thread/Conditional.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Atomic.h>
+#include <vector>
+#include <sstream>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EventSwitchTest);
+
+/**
+ * Event with a sequence number, counts its destruction
+ */
+class SequenceEvent : public dtn::core::Event
+{
+public:
+	SequenceEvent(int prio, size_t seq)
+	 : dtn::core::Event(prio), seq(seq)
+	{
+		setLoggable(false);
+	}
+
+	virtual ~SequenceEvent()
+	{
+		ibrcommon::atomic::add(destroyed, 1);
+	}
+
+	const std::string getName() const
+	{
+		return "SequenceEvent";
+	}
+
+	std::string getMessage() const
+	{
+		std::stringstream ss;
+		ss << "sequence " << seq;
+		return ss.str();
+	}
+
+	const size_t seq;
+
+	static volatile size_t destroyed;
+};
+
+volatile size_t SequenceEvent::destroyed = 0;
+
+/**
+ * Records the events in the order of processing. The first events
+ * block until they are released to keep the processing threads busy.
+ */
+class SequenceProcessor : public dtn::core::EventProcessor
+{
+public:
+	SequenceProcessor(size_t blocking = 0)
+	 : _blocking(blocking), _blocked(0), _released(0)
+	{
+	}
+
+	virtual ~SequenceProcessor()
+	{
+	}
+
+	void process(const dtn::core::Event *evt)
+	{
+		const SequenceEvent &e = dynamic_cast<const SequenceEvent&>(*evt);
+
+		ibrcommon::MutexLock l(_cond);
+
+		if (_blocking > 0)
+		{
+			_blocking--;
+			_blocked++;
+			_cond.signal(true);
+
+			while (_released == 0) _cond.wait();
+			_released--;
+			return;
+		}
+
+		prio.push_back(e.prio);
+		seq.push_back(e.seq);
+		_cond.signal(true);
+	}
+
+	/**
+	 * Wait until the given number of events is blocked
+	 */
+	void waitBlocked(size_t count)
+	{
+		ibrcommon::MutexLock l(_cond);
+		while (_blocked < count) _cond.wait();
+	}
+
+	/**
+	 * Release one of the blocked events
+	 */
+	void release()
+	{
+		ibrcommon::MutexLock l(_cond);
+		_released++;
+		_cond.signal(true);
+	}
+
+	/**
+	 * Wait until the given number of events is recorded
+	 */
+	void waitRecorded(size_t count)
+	{
+		ibrcommon::MutexLock l(_cond);
+		while (seq.size() < count) _cond.wait();
+	}
+
+	std::vector<int> prio;
+	std::vector<size_t> seq;
+
+private:
+	ibrcommon::Conditional _cond;
+	size_t _blocking;
+	size_t _blocked;
+	size_t _released;
+};
+
+/**
+ * Records the sequence numbers of the events of one processor
+ */
+class ForwardProcessor : public dtn::core::EventProcessor
+{
+public:
+	ForwardProcessor(SequenceProcessor &recorder)
+	 : _recorder(recorder)
+	{
+	}
+
+	virtual ~ForwardProcessor()
+	{
+	}
+
+	void process(const dtn::core::Event *evt)
+	{
+		seq.push_back(dynamic_cast<const SequenceEvent&>(*evt).seq);
+		_recorder.process(evt);
+	}
+
+	std::vector<size_t> seq;
+
+private:
+	SequenceProcessor &_recorder;
+};
+
+/**
+ * Runs the event switch with additional worker threads
+ */
+class EventSwitchThreads : public ibrcommon::JoinableThread
+{
+public:
+	EventSwitchThreads(size_t threads)
+	 : _threads(threads)
+	{
+		dtn::core::EventSwitch::getInstance().initialize();
+	}
+
+	virtual ~EventSwitchThreads()
+	{
+		dtn::core::EventSwitch::getInstance().terminate();
+		join();
+	}
+
+protected:
+	void run() throw ()
+	{
+		dtn::core::EventSwitch::getInstance().loop(_threads);
+	}
+
+	void __cancellation() throw ()
+	{
+		dtn::core::EventSwitch::getInstance().shutdown();
+	}
+
+private:
+	const size_t _threads;
+};
+
+void EventSwitchTest::setUp()
+{
+}
+
+void EventSwitchTest::tearDown()
+{
+}
+
+void EventSwitchTest::testOrder()
+{
+	const size_t processors = 7;
+	const size_t events = 3003;
+
+	// one worker and the loop thread, thus two shards
+	EventSwitchThreads es(1);
+	es.start();
+
+	// block both threads
+	SequenceProcessor gate(2);
+	dtn::core::EventSwitch::queue(gate, new SequenceEvent(0, 0));
+	dtn::core::EventSwitch::queue(gate, new SequenceEvent(0, 0));
+	gate.waitBlocked(2);
+
+	// queue events of all priorities to several processors
+	SequenceProcessor recorder;
+	std::vector<ForwardProcessor*> procs;
+	for (size_t i = 0; i < processors; ++i) procs.push_back(new ForwardProcessor(recorder));
+
+	for (size_t i = 0; i < events; ++i)
+	{
+		const int prio = static_cast<int>(i % 3) - 1;
+		dtn::core::EventSwitch::queue(*procs[i % processors], new SequenceEvent(prio, i));
+	}
+
+	// one thread processes all queued events, the other one is still blocked
+	gate.release();
+	recorder.waitRecorded(events);
+	gate.release();
+
+	// higher priorities are processed first
+	for (size_t i = 1; i < events; ++i)
+	{
+		CPPUNIT_ASSERT(recorder.prio[i - 1] >= recorder.prio[i]);
+	}
+
+	// the events of each processor are processed in the order of queuing
+	// within each priority class, the priority cycles with the processors
+	for (size_t p = 0; p < processors; ++p)
+	{
+		const std::vector<size_t> &seq = procs[p]->seq;
+		CPPUNIT_ASSERT_EQUAL(events / processors, seq.size());
+
+		for (size_t i = 1; i < seq.size(); ++i)
+		{
+			if ((seq[i - 1] % 3) != (seq[i] % 3)) continue;
+			CPPUNIT_ASSERT(seq[i - 1] < seq[i]);
+		}
+
+		delete procs[p];
+	}
+}
+
+void EventSwitchTest::testShutdown()
+{
+	SequenceProcessor recorder;
+
+	{
+		EventSwitchThreads es(2);
+		es.start();
+
+		for (size_t i = 0; i < 100; ++i)
+		{
+			dtn::core::EventSwitch::queue(recorder, new SequenceEvent(0, i));
+		}
+
+		// queued events are processed before the shutdown completes
+	}
+
+	CPPUNIT_ASSERT_EQUAL((size_t)100, recorder.seq.size());
+
+	// events queued after the shutdown are deleted immediately
+	const size_t destroyed = ibrcommon::atomic::load(SequenceEvent::destroyed);
+
+	for (size_t i = 0; i < 100; ++i)
+	{
+		dtn::core::EventSwitch::queue(recorder, new SequenceEvent(0, i));
+	}
+
+	CPPUNIT_ASSERT_EQUAL(destroyed + 100, ibrcommon::atomic::load(SequenceEvent::destroyed));
+	CPPUNIT_ASSERT(dtn::core::EventSwitch::getInstance().empty());
+}
@@ -0,0 +1,44 @@
+/*
+ * EventSwitchTest.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "core/EventSwitch.h"
+
+#ifndef EVENTSWITCHTEST_H_
+#define EVENTSWITCHTEST_H_
+
+class EventSwitchTest : public CppUnit::TestFixture
+{
+public:
+	void testOrder();
+	void testShutdown();
+
+	void setUp();
+	void tearDown();
+
+	CPPUNIT_TEST_SUITE(EventSwitchTest);
+	CPPUNIT_TEST(testOrder);
+	CPPUNIT_TEST(testShutdown);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+#endif /* EVENTSWITCHTEST_H_ */
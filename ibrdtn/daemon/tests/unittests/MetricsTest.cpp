@@ -0,0 +1,201 @@
+/*
+ * MetricsTest.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MetricsTest.h"
+#include <ibrcommon/thread/Thread.h>
+#include <sstream>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MetricsTest);
+
+void MetricsTest::setUp()
+{
+}
+
+void MetricsTest::tearDown()
+{
+}
+
+dtn::core::Metrics::Sample MetricsTest::get(const std::string &name, const std::string &labels)
+{
+	dtn::core::Metrics::sample_list samples;
+	dtn::core::Metrics::getInstance().collect(samples);
+
+	for (dtn::core::Metrics::sample_list::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+	{
+		if ((iter->name == name) && (iter->labels == labels)) return (*iter);
+	}
+
+	CPPUNIT_FAIL("metric not found");
+	return dtn::core::Metrics::Sample();
+}
+
+void MetricsTest::testCounter()
+{
+	dtn::core::Metrics &m = dtn::core::Metrics::getInstance();
+	const std::string labels = dtn::core::Metrics::label("test", "counter");
+
+	dtn::core::Metrics::Counter c = m.getCounter("test_counter_total", labels);
+	c.add();
+	c.add(41);
+
+	// a second lookup returns the same counter
+	m.getCounter("test_counter_total", labels).add(8);
+
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)50, get("test_counter_total", labels).value);
+
+	// a metric can not be registered with another type
+	m.getGauge("test_counter_total", labels).add(1);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)50, get("test_counter_total", labels).value);
+}
+
+void MetricsTest::testGauge()
+{
+	dtn::core::Metrics::Gauge g = dtn::core::Metrics::getInstance().getGauge("test_gauge");
+	g.add(5);
+	g.add(-2);
+
+	dtn::core::Metrics::Sample s = get("test_gauge");
+	CPPUNIT_ASSERT_EQUAL((int64_t)3, static_cast<int64_t>(s.value));
+}
+
+void MetricsTest::testHistogram()
+{
+	dtn::core::Metrics::Histogram h = dtn::core::Metrics::getInstance().getHistogram("test_histogram_microseconds");
+
+	// values up to 16 are exact
+	for (dtn::core::Metrics::value_type i = 1; i <= 10; ++i) h.record(i);
+
+	dtn::core::Metrics::Sample s = get("test_histogram_microseconds");
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)10, s.value);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)55, s.sum);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)5, s.percentile(0.5));
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)10, s.percentile(1.0));
+
+	// larger values are within 12.5% of the recorded value
+	h.record(100000);
+	s = get("test_histogram_microseconds");
+	CPPUNIT_ASSERT(s.percentile(1.0) >= 100000);
+	CPPUNIT_ASSERT(s.percentile(1.0) < 112500);
+
+	// very large values are put into the last bucket
+	h.record(static_cast<dtn::core::Metrics::value_type>(1) << 40);
+	s = get("test_histogram_microseconds");
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)12, s.value);
+}
+
+void MetricsTest::testConcurrentCounter()
+{
+	class CountingThread : public ibrcommon::JoinableThread
+	{
+	public:
+		CountingThread() { };
+		virtual ~CountingThread() { join(); };
+
+		void __cancellation() throw () { };
+
+	protected:
+		void run() throw ()
+		{
+			dtn::core::Metrics &m = dtn::core::Metrics::getInstance();
+			dtn::core::Metrics::Counter c = m.getCounter("test_concurrent_total");
+			dtn::core::Metrics::Histogram h = m.getHistogram("test_concurrent_microseconds");
+
+			for (int i = 0; i < 10000; ++i)
+			{
+				c.add();
+				h.record(i % 100);
+			}
+		}
+	};
+
+	CountingThread threads[4];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		threads[i].start();
+	}
+
+	// the values of terminated threads are kept
+	for (int i = 0; i < 4; ++i)
+	{
+		threads[i].join();
+	}
+
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)40000, get("test_concurrent_total").value);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)40000, get("test_concurrent_microseconds").value);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)(4 * 100 * 4950), get("test_concurrent_microseconds").sum);
+}
+
+void MetricsTest::testPrometheus()
+{
+	dtn::core::Metrics &m = dtn::core::Metrics::getInstance();
+	const std::string labels = dtn::core::Metrics::label("peer", "dtn://node\"1\"");
+
+	m.getHistogram("test_prometheus_microseconds", labels, "A test histogram").record(20);
+
+	std::stringstream ss;
+	m.writePrometheus(ss);
+	const std::string data = ss.str();
+
+	CPPUNIT_ASSERT(data.find("# HELP test_prometheus_microseconds A test histogram\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("# TYPE test_prometheus_microseconds histogram\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("test_prometheus_microseconds_bucket{peer=\"dtn://node\\\"1\\\"\",le=\"15\"} 0\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("test_prometheus_microseconds_bucket{peer=\"dtn://node\\\"1\\\"\",le=\"63\"} 1\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("test_prometheus_microseconds_bucket{peer=\"dtn://node\\\"1\\\"\",le=\"+Inf\"} 1\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("test_prometheus_microseconds_sum{peer=\"dtn://node\\\"1\\\"\"} 20\n") != std::string::npos);
+	CPPUNIT_ASSERT(data.find("# TYPE test_counter_total counter\n") != std::string::npos);
+}
+
+void MetricsTest::testRemove()
+{
+	dtn::core::Metrics &m = dtn::core::Metrics::getInstance();
+	const std::string labels = dtn::core::Metrics::label("peer", "dtn://node");
+
+	m.getHistogram("test_remove_microseconds", labels).record(10);
+	m.getCounter("test_remove_total", labels).add(5);
+
+	m.remove("test_remove_microseconds", labels);
+
+	// the removed metric is not collected anymore
+	dtn::core::Metrics::sample_list samples;
+	m.collect(samples);
+
+	for (dtn::core::Metrics::sample_list::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+	{
+		CPPUNIT_ASSERT(iter->name != "test_remove_microseconds");
+	}
+
+	// other metrics with the same labels are kept
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)5, get("test_remove_total", labels).value);
+
+	// the cached lookup of this thread is invalidated, thus a metric
+	// with the same name starts again at zero
+	dtn::core::Metrics::Histogram h = m.getHistogram("test_remove_microseconds", labels);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)0, get("test_remove_microseconds", labels).value);
+
+	h.record(20);
+	dtn::core::Metrics::Sample s = get("test_remove_microseconds", labels);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)1, s.value);
+	CPPUNIT_ASSERT_EQUAL((dtn::core::Metrics::value_type)20, s.sum);
+
+	// removing an unknown metric is ignored
+	m.remove("test_remove_unknown");
+}
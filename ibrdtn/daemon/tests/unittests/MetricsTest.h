@@ -0,0 +1,58 @@
+/*
+ * MetricsTest.h
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "core/Metrics.h"
+
+#ifndef METRICSTEST_H_
+#define METRICSTEST_H_
+
+class MetricsTest : public CppUnit::TestFixture
+{
+public:
+	void testCounter();
+	void testGauge();
+	void testHistogram();
+	void testConcurrentCounter();
+	void testPrometheus();
+	void testRemove();
+
+	void setUp();
+	void tearDown();
+
+	CPPUNIT_TEST_SUITE(MetricsTest);
+	CPPUNIT_TEST(testCounter);
+	CPPUNIT_TEST(testGauge);
+	CPPUNIT_TEST(testHistogram);
+	CPPUNIT_TEST(testConcurrentCounter);
+	CPPUNIT_TEST(testPrometheus);
+	CPPUNIT_TEST(testRemove);
+	CPPUNIT_TEST_SUITE_END();
+
+private:
+	/**
+	 * Returns the collected sample of a metric
+	 */
+	static dtn::core::Metrics::Sample get(const std::string &name, const std::string &labels = "");
+};
+
+#endif /* METRICSTEST_H_ */
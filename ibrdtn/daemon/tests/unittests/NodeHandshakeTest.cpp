@@ -0,0 +1,212 @@
+/*
+ * NodeHandshakeTest.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NodeHandshakeTest.hh"
+#include "routing/NodeHandshake.h"
+#include "routing/HandshakeHistory.h"
+#include "routing/prophet/DeliveryPredictabilityDelta.h"
+#include <sstream>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NodeHandshakeTest);
+
+using namespace dtn::routing;
+
+void NodeHandshakeTest::setUp()
+{
+}
+
+void NodeHandshakeTest::tearDown()
+{
+}
+
+void NodeHandshakeTest::testRequestVersion()
+{
+	NodeHandshake request(NodeHandshake::HANDSHAKE_REQUEST);
+	request.addRequest(BloomFilterSummaryVector::identifier);
+	request.addRequest(BloomFilterSummaryDelta::identifier, 4711);
+
+	std::stringstream ss;
+	ss << request;
+
+	NodeHandshake hs;
+	ss >> hs;
+
+	CPPUNIT_ASSERT(hs.hasRequest(BloomFilterSummaryVector::identifier));
+	CPPUNIT_ASSERT(hs.hasRequest(BloomFilterSummaryDelta::identifier));
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(4711), hs.getRequestVersion(BloomFilterSummaryDelta::identifier));
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(0), hs.getRequestVersion(BloomFilterSummaryVector::identifier));
+}
+
+void NodeHandshakeTest::testRequestWithoutVersion()
+{
+	// a request in the format of peers without support for versions
+	std::stringstream ss;
+	ss << dtn::data::Number((size_t)NodeHandshake::HANDSHAKE_REQUEST);
+	ss << dtn::data::Number(1);
+	ss << BloomFilterSummaryVector::identifier;
+
+	NodeHandshake hs;
+	ss >> hs;
+
+	CPPUNIT_ASSERT(hs.hasRequest(BloomFilterSummaryVector::identifier));
+	CPPUNIT_ASSERT(!hs.hasRequest(BloomFilterSummaryDelta::identifier));
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(0), hs.getRequestVersion(BloomFilterSummaryVector::identifier));
+}
+
+void NodeHandshakeTest::testHistory()
+{
+	HandshakeHistory<int> history(2);
+
+	const dtn::data::Number v1 = history.put(1);
+	CPPUNIT_ASSERT(v1 > 0);
+
+	// the same state keeps its version
+	CPPUNIT_ASSERT_EQUAL(v1, history.put(1));
+
+	const dtn::data::Number v2 = history.put(2);
+	CPPUNIT_ASSERT(v1 != v2);
+
+	int state = 0;
+	CPPUNIT_ASSERT(history.get(v1, state));
+	CPPUNIT_ASSERT_EQUAL(1, state);
+
+	// the oldest version gets dropped
+	history.put(3);
+	CPPUNIT_ASSERT(!history.get(v1, state));
+	CPPUNIT_ASSERT(history.get(v2, state));
+	CPPUNIT_ASSERT_EQUAL(2, state);
+}
+
+void NodeHandshakeTest::testSummaryDelta()
+{
+	ibrcommon::BloomFilter bf(1024);
+	for (int i = 0; i < 100; ++i)
+	{
+		std::stringstream key; key << "bundle-" << i;
+		bf.insert(key.str());
+	}
+	const std::vector<unsigned char> base_table(bf.table(), bf.table() + bf.size());
+
+	for (int i = 100; i < 105; ++i)
+	{
+		std::stringstream key; key << "bundle-" << i;
+		bf.insert(key.str());
+	}
+	const std::vector<unsigned char> table(bf.table(), bf.table() + bf.size());
+
+	// the receiver knows the complete base version
+	BloomFilterSummaryDelta previous;
+	{
+		std::stringstream ss;
+		BloomFilterSummaryDelta(10, base_table).serialize(ss);
+		previous.deserialize(ss);
+	}
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(10), previous.getVersion());
+	CPPUNIT_ASSERT(previous.getTable() == base_table);
+
+	const BloomFilterSummaryDelta full(11, table);
+	const BloomFilterSummaryDelta delta(11, table, 10, base_table);
+
+	// the difference is much smaller than the complete vector
+	CPPUNIT_ASSERT(delta.getLength() < (full.getLength() / 10));
+
+	std::stringstream ss;
+	delta.serialize(ss);
+	CPPUNIT_ASSERT_EQUAL(delta.getLength(), (dtn::data::Length)ss.str().length());
+
+	BloomFilterSummaryDelta received;
+	received.deserialize(ss);
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(10), received.getBase());
+	CPPUNIT_ASSERT(received.apply(previous));
+
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(0), received.getBase());
+	CPPUNIT_ASSERT(received.getTable() == table);
+
+	const ibrcommon::BloomFilter filter = received.getFilter();
+	CPPUNIT_ASSERT(filter.contains(std::string("bundle-1")));
+	CPPUNIT_ASSERT(filter.contains(std::string("bundle-104")));
+}
+
+void NodeHandshakeTest::testSummaryDeltaMismatch()
+{
+	std::vector<unsigned char> base_table(128, 0);
+	std::vector<unsigned char> table(128, 0);
+	table[5] = 0x10;
+	table[100] = 0x01;
+
+	const BloomFilterSummaryDelta delta(3, table, 2, base_table);
+
+	std::stringstream ss;
+	delta.serialize(ss);
+
+	// wrong base version
+	{
+		std::stringstream data(ss.str());
+		BloomFilterSummaryDelta received;
+		received.deserialize(data);
+		CPPUNIT_ASSERT(!received.apply(BloomFilterSummaryDelta(1, base_table)));
+	}
+
+	// same version but different content
+	{
+		std::stringstream data(ss.str());
+		std::vector<unsigned char> other_table(128, 0xff);
+		BloomFilterSummaryDelta received;
+		received.deserialize(data);
+		CPPUNIT_ASSERT(!received.apply(BloomFilterSummaryDelta(2, other_table)));
+	}
+
+	// different size leads to a complete vector
+	const BloomFilterSummaryDelta grown(4, std::vector<unsigned char>(256, 0), 3, table);
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(0), grown.getBase());
+}
+
+void NodeHandshakeTest::testDeliveryPredictabilityDelta()
+{
+	DeliveryPredictabilityDelta::predictmap base_map;
+	base_map[dtn::data::EID("dtn://node-a")] = 0.5f;
+	base_map[dtn::data::EID("dtn://node-b")] = 0.25f;
+	base_map[dtn::data::EID("dtn://node-c")] = 0.75f;
+
+	DeliveryPredictabilityDelta::predictmap map = base_map;
+	map[dtn::data::EID("dtn://node-b")] = 0.5f;
+	map.erase(dtn::data::EID("dtn://node-c"));
+	map[dtn::data::EID("dtn://node-d")] = 0.125f;
+
+	const DeliveryPredictabilityDelta previous(20, base_map);
+	const DeliveryPredictabilityDelta delta(21, map, 20, base_map);
+
+	// only two entries and one removal are transferred
+	CPPUNIT_ASSERT_EQUAL((size_t)2, delta.getMap().size());
+
+	std::stringstream ss;
+	delta.serialize(ss);
+	CPPUNIT_ASSERT_EQUAL(delta.getLength(), (dtn::data::Length)ss.str().length());
+
+	DeliveryPredictabilityDelta received;
+	received.deserialize(ss);
+	CPPUNIT_ASSERT_EQUAL(dtn::data::Number(21), received.getVersion());
+	CPPUNIT_ASSERT(!received.apply(DeliveryPredictabilityDelta(19, base_map)));
+	CPPUNIT_ASSERT(received.apply(previous));
+
+	CPPUNIT_ASSERT(received.getMap() == map);
+}
@@ -0,0 +1,49 @@
+/*
+ * NodeHandshakeTest.hh
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#ifndef NODEHANDSHAKETEST_HH
+#define NODEHANDSHAKETEST_HH
+class NodeHandshakeTest : public CppUnit::TestFixture {
+	private:
+	public:
+		void testRequestVersion();
+		void testRequestWithoutVersion();
+		void testHistory();
+		void testSummaryDelta();
+		void testSummaryDeltaMismatch();
+		void testDeliveryPredictabilityDelta();
+
+		void setUp();
+		void tearDown();
+
+		CPPUNIT_TEST_SUITE(NodeHandshakeTest);
+			CPPUNIT_TEST(testRequestVersion);
+			CPPUNIT_TEST(testRequestWithoutVersion);
+			CPPUNIT_TEST(testHistory);
+			CPPUNIT_TEST(testSummaryDelta);
+			CPPUNIT_TEST(testSummaryDeltaMismatch);
+			CPPUNIT_TEST(testDeliveryPredictabilityDelta);
+		CPPUNIT_TEST_SUITE_END();
+};
+#endif /* NODEHANDSHAKETEST_HH */
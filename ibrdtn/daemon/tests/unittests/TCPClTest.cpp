@@ -0,0 +1,668 @@
+/*
+ * TCPClTest.cpp
+ *
+ *  Created on: 21.06.2013
+ *      Author: morgenro
+ */
+
+#include "TCPClTest.h"
+#include "../tools/TestEventListener.h"
+#include "storage/MemoryBundleStorage.h"
+#include "routing/QueueBundleEvent.h"
+#include "net/TransferCompletedEvent.h"
+#include "net/TCPEventLoop.h"
+#include "net/CutThroughBuffer.h"
+
+#include <ibrdtn/data/Bundle.h>
+#include <ibrdtn/data/EID.h>
+#include <ibrdtn/data/Serializer.h>
+#include <ibrdtn/streams/StreamContactHeader.h>
+#include <ibrdtn/streams/StreamDataSegment.h>
+#include "core/BundleCore.h"
+#include <ibrcommon/data/File.h>
+#include <ibrcommon/data/BLOB.h>
+#include <ibrcommon/thread/MutexLock.h>
+#include <ibrcommon/thread/Conditional.h>
+#include <ibrcommon/thread/Thread.h>
+#include <ibrcommon/net/socket.h>
+#include <ibrcommon/net/vsocket.h>
+#include <ibrcommon/net/socketstream.h>
+#include <ibrcommon/TimeMeasurement.h>
+#include "Component.h"
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TCPClTest);
+
+dtn::storage::BundleStorage* TCPClTest::_storage = NULL;
+
+/**
+ * Minimal TCP convergence layer peer speaking the protocol
+ * on a blocking socket stream
+ */
+class TCPClPeer
+{
+public:
+	TCPClPeer(int port)
+	 : _stream(new ibrcommon::tcpsocket(ibrcommon::vaddress("127.0.0.1", port)))
+	{
+		timeval tv;
+		tv.tv_sec = 20;
+		tv.tv_usec = 0;
+		_stream.setTimeout(tv);
+	}
+
+	virtual ~TCPClPeer()
+	{
+		_stream.close();
+	}
+
+	void handshake(const dtn::data::EID &eid)
+	{
+		dtn::streams::StreamContactHeader header(eid);
+		header._keepalive = 10;
+		header._flags.setBit(dtn::streams::StreamContactHeader::REQUEST_ACKNOWLEDGMENTS, true);
+		header._flags.setBit(dtn::streams::StreamContactHeader::REQUEST_NEGATIVE_ACKNOWLEDGMENTS, true);
+
+		_stream << header << std::flush;
+		_stream >> peer;
+	}
+
+	void send(const dtn::data::Bundle &b)
+	{
+		std::stringstream ss;
+		dtn::data::DefaultSerializer(ss) << b;
+		const std::string data = ss.str();
+
+		dtn::streams::StreamDataSegment seg(dtn::streams::StreamDataSegment::MSG_DATA_SEGMENT, data.size());
+		seg._flags = dtn::streams::StreamDataSegment::MSG_MARK_BEGINN | dtn::streams::StreamDataSegment::MSG_MARK_END;
+
+		_stream << seg;
+		_stream.write(data.c_str(), data.size());
+		_stream << std::flush;
+	}
+
+	dtn::data::Bundle receive()
+	{
+		std::stringstream ss;
+		dtn::data::Number received = 0;
+
+		while (true)
+		{
+			dtn::streams::StreamDataSegment seg;
+			_stream >> seg;
+
+			if (!_stream.good()) throw ibrcommon::IOException("connection lost");
+
+			// skip keepalives
+			if (seg._type != dtn::streams::StreamDataSegment::MSG_DATA_SEGMENT) continue;
+
+			std::vector<char> buf(seg._value.get<size_t>());
+			_stream.read(&buf[0], buf.size());
+			ss.write(&buf[0], buf.size());
+			received += seg._value;
+
+			// acknowledge the segment
+			_stream << dtn::streams::StreamDataSegment(dtn::streams::StreamDataSegment::MSG_ACK_SEGMENT, received) << std::flush;
+
+			if (seg._flags & dtn::streams::StreamDataSegment::MSG_MARK_END) break;
+		}
+
+		dtn::data::Bundle b;
+		dtn::data::DefaultDeserializer(ss) >> b;
+		return b;
+	}
+
+	dtn::streams::StreamDataSegment segment()
+	{
+		dtn::streams::StreamDataSegment seg;
+		do {
+			_stream >> seg;
+			if (!_stream.good()) throw ibrcommon::IOException("connection lost");
+		} while (seg._type == dtn::streams::StreamDataSegment::MSG_KEEPALIVE);
+		return seg;
+	}
+
+	dtn::streams::StreamContactHeader peer;
+
+private:
+	ibrcommon::socketstream _stream;
+};
+
+/**
+ * Read a value of /proc/self/status
+ */
+static size_t proc_status(const std::string &key)
+{
+	std::ifstream f("/proc/self/status");
+	std::string line;
+
+	while (std::getline(f, line))
+	{
+		if (line.compare(0, key.size() + 1, key + ":") != 0) continue;
+
+		std::stringstream ss(line.substr(key.size() + 1));
+		size_t value = 0;
+		ss >> value;
+		return value;
+	}
+
+	return 0;
+}
+
+/**
+ * CPU time (user + system) of this process in microseconds
+ */
+static size_t cpu_time()
+{
+	struct rusage usage;
+	::getrusage(RUSAGE_SELF, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static dtn::data::Bundle create_bundle(const dtn::data::EID &source, const dtn::data::EID &destination)
+{
+	dtn::data::Bundle b;
+	b.source = source;
+	b.destination = destination;
+	b.lifetime = 3600;
+
+	// add some payload
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	b.push_back(ref);
+
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		for (int i = 0; i < 1000; ++i)
+			(*io) << "Hallo Welt" << std::endl;
+	}
+
+	return b;
+}
+
+void TCPClTest::setUp() {
+	_tcpcl = NULL;
+
+	// create a new event switch
+	_esl = new ibrtest::EventSwitchLoop();
+
+	// enable blob path
+	ibrcommon::File blob_path("/tmp/blobs");
+
+	// check if the BLOB path exists
+	if (!blob_path.exists()) {
+		// try to create the BLOB path
+		ibrcommon::File::createDirectory(blob_path);
+	}
+
+	// enable the blob provider
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(blob_path), true);
+
+	// add standard memory base storage
+	_storage = new dtn::storage::MemoryBundleStorage();
+
+	// make storage globally available
+	dtn::core::BundleCore::getInstance().setStorage(_storage);
+	dtn::core::BundleCore::getInstance().setSeeker(_storage);
+
+	// the router keeps track of known bundles
+	_router = new dtn::routing::BaseRouter();
+	dtn::core::BundleCore::getInstance().setRouter(_router);
+
+	// initialize BundleCore
+	dtn::core::BundleCore::getInstance().initialize();
+
+	// start-up event switch
+	_esl->start();
+
+	try {
+		dtn::daemon::Component &c = dynamic_cast<dtn::daemon::Component&>(*_storage);
+		c.initialize();
+	} catch (const std::bad_cast&) {
+	}
+
+	// startup BundleCore
+	dtn::core::BundleCore::getInstance().startup();
+
+	try {
+		dtn::daemon::Component &c = dynamic_cast<dtn::daemon::Component&>(*_storage);
+		c.startup();
+	} catch (const std::bad_cast&) {
+	}
+}
+
+void TCPClTest::tearDown() {
+	shutdown();
+
+	_esl->stop();
+
+	try {
+		dtn::daemon::Component &c = dynamic_cast<dtn::daemon::Component&>(*_storage);
+		c.terminate();
+	} catch (const std::bad_cast&) {
+	}
+
+	// shutdown BundleCore
+	dtn::core::BundleCore::getInstance().terminate();
+
+	_esl->join();
+	delete _esl;
+	_esl = NULL;
+
+	dtn::core::BundleCore::getInstance().setRouter(NULL);
+	delete _router;
+
+	// delete storage
+	delete _storage;
+}
+
+void TCPClTest::startup(size_t io_threads) {
+	// use a new port for each convergence layer instance
+	static int port = 4600;
+	_port = ++port;
+
+	_tcpcl = new dtn::net::TCPConvergenceLayer(io_threads);
+	_tcpcl->add(ibrcommon::vinterface("lo"), _port);
+
+	// add convergence layer to bundle core
+	dtn::core::BundleCore::getInstance().getConnectionManager().add(_tcpcl);
+
+	_tcpcl->initialize();
+	_tcpcl->startup();
+}
+
+void TCPClTest::shutdown() {
+	if (_tcpcl == NULL) return;
+
+	_tcpcl->terminate();
+
+	// remove convergence layer from bundle core
+	dtn::core::BundleCore::getInstance().getConnectionManager().remove(_tcpcl);
+
+	delete _tcpcl;
+	_tcpcl = NULL;
+}
+
+void TCPClTest::receive() {
+	TestEventListener<dtn::routing::QueueBundleEvent> queued_evtl;
+
+	const dtn::data::Bundle b = create_bundle(dtn::data::EID("dtn://tcpcl-peer/test"), dtn::data::EID("dtn://tcpcl-other/test"));
+
+	TCPClPeer peer(_port);
+	peer.handshake(dtn::data::EID("dtn://tcpcl-peer"));
+
+	CPPUNIT_ASSERT_EQUAL(dtn::core::BundleCore::local, peer.peer._localeid);
+	CPPUNIT_ASSERT(peer.peer._flags.getBit(dtn::streams::StreamContactHeader::REQUEST_ACKNOWLEDGMENTS));
+
+	peer.send(b);
+
+	// the bundle has to be acknowledged as a whole
+	const dtn::streams::StreamDataSegment ack = peer.segment();
+	CPPUNIT_ASSERT_EQUAL(dtn::streams::StreamDataSegment::MSG_ACK_SEGMENT, ack._type);
+	CPPUNIT_ASSERT_EQUAL(dtn::data::DefaultSerializer(std::cout).getLength(b), ack._value.get<dtn::data::Length>());
+
+	// wait until the bundle has been queued
+	try {
+		ibrcommon::MutexLock l(queued_evtl.event_cond);
+		while (queued_evtl.event_counter == 0) queued_evtl.event_cond.wait(20000);
+	} catch (const ibrcommon::Conditional::ConditionalAbortException&) {
+		CPPUNIT_FAIL("queued - timeout reached");
+	}
+
+	CPPUNIT_ASSERT(_storage->contains(b));
+}
+
+void TCPClTest::transmit() {
+	TestEventListener<dtn::net::TransferCompletedEvent> completed_evtl;
+
+	const dtn::data::EID peer_eid("dtn://tcpcl-peer");
+	const dtn::data::Bundle b = create_bundle(dtn::data::EID("dtn://tcpcl-other/test"), dtn::data::EID("dtn://tcpcl-peer/test"));
+
+	// store the bundle
+	_storage->store(b);
+	_storage->wait();
+
+	TCPClPeer peer(_port);
+	peer.handshake(peer_eid);
+
+	// wait until the connection is known to the convergence layer
+	ibrcommon::Thread::sleep(200);
+
+	// create BundleTransfer in a separate scope because the
+	// TransferCompletedEvent is only raised after all objects
+	// are destroyed
+	{
+		const dtn::net::BundleTransfer job(peer_eid, dtn::data::MetaBundle::create(b), dtn::core::Node::CONN_TCPIP);
+		_tcpcl->queue(dtn::core::Node(peer_eid), job);
+	}
+
+	const dtn::data::Bundle recv = peer.receive();
+	CPPUNIT_ASSERT_EQUAL((const dtn::data::BundleID&)b, (const dtn::data::BundleID&)recv);
+
+	// wait until the bundle has been acknowledged
+	try {
+		ibrcommon::MutexLock l(completed_evtl.event_cond);
+		while (completed_evtl.event_counter == 0) completed_evtl.event_cond.wait(20000);
+	} catch (const ibrcommon::Conditional::ConditionalAbortException&) {
+		CPPUNIT_FAIL("completed - timeout reached");
+	}
+
+	CPPUNIT_ASSERT_EQUAL((unsigned int)1, completed_evtl.event_counter);
+}
+
+void TCPClTest::receiveThreadedTest() {
+	startup(0);
+	receive();
+}
+
+void TCPClTest::receiveEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(2);
+	receive();
+}
+
+void TCPClTest::transmitThreadedTest() {
+	startup(0);
+	transmit();
+}
+
+void TCPClTest::transmitEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(2);
+	transmit();
+}
+
+void TCPClTest::connectEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(2);
+
+	// a peer waiting for the connection of the convergence layer
+	const int port = _port + 1000;
+	ibrcommon::vsocket sock;
+	sock.add(new ibrcommon::tcpserversocket(port));
+	sock.up();
+
+	// the hostname is resolved by a worker of the event loop
+	std::stringstream uri;
+	uri << "ip=localhost;port=" << port << ";";
+
+	dtn::core::Node n(dtn::data::EID("dtn://tcpcl-peer"));
+	n.add(dtn::core::Node::URI(dtn::core::Node::NODE_STATIC_LOCAL, dtn::core::Node::CONN_TCPIP, uri.str()));
+	_tcpcl->open(n);
+
+	// wait for the incoming connection, throws vsocket_timeout if none arrives
+	ibrcommon::socketset fds;
+	struct timeval tv;
+	tv.tv_sec = 5;
+	tv.tv_usec = 0;
+	sock.select(&fds, NULL, NULL, &tv);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, fds.size());
+
+	ibrcommon::serversocket &server = dynamic_cast<ibrcommon::serversocket&>(**fds.begin());
+	ibrcommon::vaddress addr;
+	ibrcommon::socketstream stream(server.accept(addr));
+
+	dtn::streams::StreamContactHeader header;
+	stream >> header;
+
+	CPPUNIT_ASSERT(stream.good());
+	CPPUNIT_ASSERT_EQUAL(dtn::core::BundleCore::local, header._localeid);
+
+	stream.close();
+	sock.destroy();
+}
+
+void TCPClTest::shutdownEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(2);
+
+	TCPClPeer peer(_port);
+	peer.handshake(dtn::data::EID("dtn://tcpcl-peer"));
+
+	// wait until the connection is known to the convergence layer
+	ibrcommon::Thread::sleep(200);
+
+	shutdown();
+
+	// the session announces the shutdown before closing the connection
+	const dtn::streams::StreamDataSegment seg = peer.segment();
+	CPPUNIT_ASSERT_EQUAL(dtn::streams::StreamDataSegment::MSG_SHUTDOWN, seg._type);
+}
+
+/**
+ * Task which blocks the worker until it is released
+ */
+class BlockingTask : public dtn::net::TCPSession::Task
+{
+public:
+	BlockingTask(const size_t session)
+	 : dtn::net::TCPSession::Task(session), released(false), completed(false)
+	{
+	}
+
+	virtual ~BlockingTask()
+	{
+	}
+
+	virtual void run() throw ()
+	{
+		ibrcommon::MutexLock l(cond);
+		while (!released) cond.wait();
+	}
+
+	virtual void complete(dtn::net::TCPSession&) throw ()
+	{
+		completed = true;
+	}
+
+	void release()
+	{
+		ibrcommon::MutexLock l(cond);
+		released = true;
+		cond.signal(true);
+	}
+
+	ibrcommon::Conditional cond;
+	bool released;
+	bool completed;
+};
+
+/**
+ * Accept a connection of a new peer and hand it to the event loop
+ * @return The id of the new session
+ */
+static size_t accept_session(dtn::net::TCPEventLoop &loop, ibrcommon::vsocket &sock, int port, TCPClPeer* &peer)
+{
+	peer = new TCPClPeer(port);
+
+	ibrcommon::socketset fds;
+	struct timeval tv;
+	tv.tv_sec = 5;
+	tv.tv_usec = 0;
+	sock.select(&fds, NULL, NULL, &tv);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, fds.size());
+
+	ibrcommon::serversocket &server = dynamic_cast<ibrcommon::serversocket&>(**fds.begin());
+	ibrcommon::vaddress addr;
+	return loop.accept(server.accept(addr), dtn::core::Node(dtn::data::EID("dtn://tcpcl-peer")));
+}
+
+void TCPClTest::staleTaskEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(0);
+
+	const int port = _port + 1000;
+	ibrcommon::vsocket sock;
+	sock.add(new ibrcommon::tcpserversocket(port));
+	sock.up();
+
+	dtn::net::TCPEventLoop loop(*_tcpcl, 1, 10);
+	loop.start();
+
+	TCPClPeer *peer = NULL;
+	const size_t first = accept_session(loop, sock, port, peer);
+
+	// a task of the first session is in progress
+	BlockingTask *task = new BlockingTask(first);
+	const dtn::net::TCPSession::task_ref ref(task);
+	loop.submit(ref);
+
+	// the peer goes away and the first session is removed
+	delete peer;
+	for (size_t i = 0; (i < 100) && (loop.size() > 0); ++i) ibrcommon::Thread::sleep(50);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, loop.size());
+
+	// the next session is likely located at the address of the first one
+	const size_t second = accept_session(loop, sock, port, peer);
+	CPPUNIT_ASSERT(first != second);
+
+	// the result of the task must not be handed to the second session
+	task->release();
+	ibrcommon::Thread::sleep(200);
+	CPPUNIT_ASSERT(!task->completed);
+
+	delete peer;
+	loop.stop();
+	sock.destroy();
+}
+
+void TCPClTest::timeoutEventTest() {
+	if (!dtn::net::TCPEventLoop::isSupported()) return;
+	startup(0);
+
+	const int port = _port + 1000;
+	ibrcommon::vsocket sock;
+	sock.add(new ibrcommon::tcpserversocket(port));
+	sock.up();
+
+	// sessions without a contact header time out after one second
+	dtn::net::TCPEventLoop loop(*_tcpcl, 1, 1);
+	loop.start();
+
+	// the peer never sends its contact header
+	TCPClPeer *peer = NULL;
+	accept_session(loop, sock, port, peer);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, loop.size());
+
+	// the timer of the session has to close it
+	for (size_t i = 0; (i < 100) && (loop.size() > 0); ++i) ibrcommon::Thread::sleep(50);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, loop.size());
+
+	delete peer;
+	loop.stop();
+	sock.destroy();
+}
+
+void TCPClTest::connectionPerfTest() {
+	const size_t num = 100;
+
+	for (size_t io_threads = 0; io_threads <= 2; io_threads += 2)
+	{
+		if ((io_threads > 0) && !dtn::net::TCPEventLoop::isSupported()) break;
+
+		startup(io_threads);
+
+		const size_t threads_before = proc_status("Threads");
+		const size_t rss_before = proc_status("VmRSS");
+
+		std::vector<TCPClPeer*> peers;
+
+		ibrcommon::TimeMeasurement tm_setup;
+		tm_setup.start();
+		for (size_t i = 0; i < num; ++i)
+		{
+			std::stringstream ss;
+			ss << "dtn://tcpcl-peer-" << i;
+
+			TCPClPeer *peer = new TCPClPeer(_port);
+			peers.push_back(peer);
+			peer->handshake(dtn::data::EID(ss.str()));
+		}
+		tm_setup.stop();
+
+		// measure the idle load of all connections
+		const size_t cpu_before = cpu_time();
+		ibrcommon::Thread::sleep(2000);
+		const size_t cpu_idle = cpu_time() - cpu_before;
+
+		const size_t threads_after = proc_status("Threads");
+		const size_t rss_after = proc_status("VmRSS");
+
+		for (std::vector<TCPClPeer*>::iterator it = peers.begin(); it != peers.end(); ++it)
+		{
+			delete (*it);
+		}
+
+		shutdown();
+
+		std::cout << num << " connections (" << ((io_threads == 0) ? "thread per connection" : "event loop") << "): "
+				<< "setup " << (tm_setup.getMicroseconds() / num) << " us"
+				<< ", threads " << (threads_after - threads_before)
+				<< ", memory " << ((rss_after > rss_before) ? (rss_after - rss_before) : 0) << " kB"
+				<< ", idle cpu " << (cpu_idle / 2) << " us/s" << std::endl;
+	}
+}
+
+void TCPClTest::cutThroughBufferTest() {
+	const std::string payload_data = "Hello World, this payload is forwarded while it is received.";
+
+	dtn::data::Bundle b;
+	b.source = dtn::data::EID("dtn://source/app");
+	b.destination = dtn::data::EID("dtn://destination/app");
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	dtn::data::PayloadBlock &payload = b.push_back(ref);
+
+	// the encoded header has to match the encoding of the whole bundle
+	std::stringstream ss;
+	dtn::data::DefaultSerializer(ss, dtn::data::Dictionary(b)) << (dtn::data::PrimaryBlock&)b;
+	{
+		ibrcommon::BLOB::iostream io = ref.iostream();
+		(*io) << payload_data;
+	}
+	dtn::data::DefaultSerializer(ss, dtn::data::Dictionary(b)) << (dtn::data::Block&)payload;
+
+	// use a small capacity to wrap around the buffer
+	dtn::net::CutThroughBuffer buffer(b, payload, payload_data.length(), 16);
+	CPPUNIT_ASSERT_EQUAL(ss.str(), buffer.getHeader() + payload_data);
+
+	CPPUNIT_ASSERT(buffer.attach());
+
+	std::string received;
+	char data[8];
+
+	for (size_t pos = 0; pos < payload_data.length(); pos += 5)
+	{
+		buffer.write(payload_data.c_str() + pos, std::min<size_t>(5, payload_data.length() - pos));
+
+		// drain the buffer, the last byte is held back until the commit
+		while (received.length() + 1 < std::min<size_t>(pos + 5, payload_data.length()))
+		{
+			received.append(data, buffer.read(data, sizeof(data)));
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL(payload_data.substr(0, payload_data.length() - 1), received);
+
+	buffer.commit();
+	received.append(data, buffer.read(data, sizeof(data)));
+	CPPUNIT_ASSERT_EQUAL(payload_data, received);
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Length)0, buffer.read(data, sizeof(data)));
+
+	// an aborted reception fails the forwarding
+	dtn::net::CutThroughBuffer aborted(b, payload, payload_data.length());
+	aborted.write(payload_data.c_str(), payload_data.length());
+	aborted.abort();
+	CPPUNIT_ASSERT(!aborted.attach());
+	CPPUNIT_ASSERT_THROW(aborted.read(data, sizeof(data)), dtn::net::CutThroughBuffer::AbortedException);
+
+	// an incomplete payload is never committed
+	dtn::net::CutThroughBuffer incomplete(b, payload, payload_data.length());
+	incomplete.write(payload_data.c_str(), 10);
+	incomplete.commit();
+	CPPUNIT_ASSERT_THROW(incomplete.read(data, sizeof(data)), dtn::net::CutThroughBuffer::AbortedException);
+}
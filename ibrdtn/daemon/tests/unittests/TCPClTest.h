@@ -0,0 +1,61 @@
+/*
+ * TCPClTest.h
+ *
+ *  Created on: 21.06.2013
+ *      Author: morgenro
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "storage/BundleStorage.h"
+#include "net/TCPConvergenceLayer.h"
+#include "routing/BaseRouter.h"
+
+#include "../tools/EventSwitchLoop.h"
+
+#ifndef TCPCLTEST_H_
+#define TCPCLTEST_H_
+
+class TCPClTest : public CppUnit::TestFixture {
+	static dtn::storage::BundleStorage *_storage;
+	ibrtest::EventSwitchLoop *_esl;
+	dtn::routing::BaseRouter *_router;
+	dtn::net::TCPConvergenceLayer *_tcpcl;
+	int _port;
+
+	void startup(size_t io_threads);
+	void shutdown();
+
+	void receive();
+	void transmit();
+
+	void receiveThreadedTest();
+	void receiveEventTest();
+	void transmitThreadedTest();
+	void transmitEventTest();
+	void connectEventTest();
+	void shutdownEventTest();
+	void staleTaskEventTest();
+	void timeoutEventTest();
+	void connectionPerfTest();
+	void cutThroughBufferTest();
+
+public:
+	void setUp();
+	void tearDown();
+
+	CPPUNIT_TEST_SUITE(TCPClTest);
+	CPPUNIT_TEST(receiveThreadedTest);
+	CPPUNIT_TEST(receiveEventTest);
+	CPPUNIT_TEST(transmitThreadedTest);
+	CPPUNIT_TEST(transmitEventTest);
+	CPPUNIT_TEST(connectEventTest);
+	CPPUNIT_TEST(shutdownEventTest);
+	CPPUNIT_TEST(staleTaskEventTest);
+	CPPUNIT_TEST(timeoutEventTest);
+	CPPUNIT_TEST(connectionPerfTest);
+	CPPUNIT_TEST(cutThroughBufferTest);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+#endif /* TCPCLTEST_H_ */
@@ -33,6 +33,8 @@ namespace dtn
 {
 	namespace api
 	{
+		const size_t PlainSerializer::RAW_BUFFER_SIZE = 0x10000;
+
 		PlainSerializer::Encoding PlainSerializer::parseEncoding(const std::string &data)
 		{
 			if (data == "raw") return PlainSerializer::RAW;
@@ -177,7 +179,7 @@ namespace dtn
 						}
 
 						case RAW:
-							obj.serialize(_stream, slength);
+							writeRaw(obj);
 							_stream << std::flush;
 							break;
 
@@ -481,7 +483,7 @@ namespace dtn
 						break;
 					}
 				case PlainSerializer::RAW:
-					ibrcommon::BLOB::copy(*obj, _stream, blocksize);
+					ibrcommon::BLOB::copy(*obj, _stream, blocksize, PlainSerializer::RAW_BUFFER_SIZE);
 					break;
 
 				default:
@@ -525,7 +527,7 @@ namespace dtn
 				}
 
 				case RAW:
-					block.serialize(_stream, slength);
+					writeRaw(block);
 					break;
 
 				default:
@@ -551,7 +553,7 @@ namespace dtn
 				}
 
 				case RAW:
-					ibrcommon::BLOB::copy(_stream, stream, len);
+					ibrcommon::BLOB::copy(_stream, stream, len, RAW_BUFFER_SIZE);
 					_stream << std::flush;
 					break;
 
@@ -561,6 +563,20 @@ namespace dtn
 			_stream << std::endl;
 		}
 
+		void PlainSerializer::writeRaw(const dtn::data::Block &block)
+		{
+			try {
+				// copy the payload directly out of the BLOB
+				const dtn::data::PayloadBlock &payload = dynamic_cast<const dtn::data::PayloadBlock&>(block);
+				ibrcommon::BLOB::Reference ref = payload.getBLOB();
+				ibrcommon::BLOB::iostream io = ref.iostream();
+				ibrcommon::BLOB::copy(_stream, *io, io.size(), RAW_BUFFER_SIZE);
+			} catch (const std::bad_cast&) {
+				dtn::data::Length slength = 0;
+				block.serialize(_stream, slength);
+			}
+		}
+
 		void PlainDeserializer::readData(std::ostream &stream)
 		{
 			std::string data;
@@ -618,7 +634,7 @@ namespace dtn
 
 				b64 << std::flush;
 			} else if (enc == PlainSerializer::RAW) {
-				ibrcommon::BLOB::copy(stream, _stream, len);
+				ibrcommon::BLOB::copy(stream, _stream, len, PlainSerializer::RAW_BUFFER_SIZE);
 			}
 		}
 
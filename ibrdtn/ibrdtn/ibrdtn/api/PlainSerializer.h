@@ -44,6 +44,13 @@ namespace dtn
 			static Encoding parseEncoding(const std::string &data);
 			static std::string printEncoding(const Encoding &enc);
 
+			/**
+			 * Size of the copy buffer for raw encoded data. Raw transfers
+			 * are used for bulk payload, thus the buffer is larger than the
+			 * default buffer of BLOB::copy().
+			 */
+			static const size_t RAW_BUFFER_SIZE;
+
 			PlainSerializer(std::ostream &stream, Encoding enc = BASE64);
 			virtual ~PlainSerializer();
 
@@ -59,6 +66,11 @@ namespace dtn
 			dtn::data::Length getLength(const dtn::data::Block &obj) const;
 
 		private:
+			/**
+			 * write the data of a block without any encoding
+			 */
+			void writeRaw(const dtn::data::Block &block);
+
 			std::ostream &_stream;
 			Encoding _encoding;
 		};
@@ -31,7 +31,7 @@ namespace dtn
 	namespace data
 	{
 		Bundle::Bundle(bool zero_timestamp)
-		 : PrimaryBlock(zero_timestamp)
+		 : PrimaryBlock(zero_timestamp), _blocks(new block_list())
 		{
 			// if the timestamp is not set, add a ageblock
 			if (timestamp == 0)
@@ -43,27 +43,46 @@ namespace dtn
 
 		Bundle::~Bundle()
 		{
-			clear();
+		}
+
+		Bundle::block_list& Bundle::blocks()
+		{
+			// copy the list if it is shared with other bundles, the blocks are still shared
+			if (!_blocks.unique()) _blocks = refcnt_ptr<block_list>(new block_list(*_blocks));
+			return *_blocks;
+		}
+
+		Bundle::block_list& Bundle::blocks(iterator &it)
+		{
+			if (_blocks.unique()) return *_blocks;
+
+			const block_list::difference_type pos = std::distance(_blocks->begin(), it);
+			block_list &list = blocks();
+
+			it = list.begin();
+			std::advance(it, pos);
+
+			return list;
 		}
 
 		Bundle::iterator Bundle::begin()
 		{
-			return _blocks.begin();
+			return _blocks->begin();
 		}
 
 		Bundle::iterator Bundle::end()
 		{
-			return _blocks.end();
+			return _blocks->end();
 		}
 
 		Bundle::const_iterator Bundle::begin() const
 		{
-			return _blocks.begin();
+			return _blocks->begin();
 		}
 
 		Bundle::const_iterator Bundle::end() const
 		{
-			return _blocks.end();
+			return _blocks->end();
 		}
 
 		bool Bundle::operator==(const BundleID& other) const
@@ -111,9 +130,12 @@ namespace dtn
 
 		void Bundle::erase(Bundle::iterator b, Bundle::iterator e)
 		{
-			for (iterator it = b; it != e;)
+			const block_list::difference_type len = std::distance(b, e);
+			block_list &list = blocks(b);
+
+			for (block_list::difference_type i = 0; i < len; ++i)
 			{
-				_blocks.erase(it++);
+				list.erase(b++);
 			}
 
 			if (size() > 0) {
@@ -126,7 +148,7 @@ namespace dtn
 
 		void Bundle::erase(iterator it)
 		{
-			_blocks.erase(it);
+			blocks(it).erase(it);
 
 			if (size() > 0) {
 				// set the last block bit
@@ -138,11 +160,18 @@ namespace dtn
 
 		void Bundle::clear()
 		{
-			_blocks.clear();
+			if (_blocks.unique()) {
+				_blocks->clear();
+			} else {
+				// do not copy a list which is going to be cleared
+				_blocks = refcnt_ptr<block_list>(new block_list());
+			}
 		}
 
 		dtn::data::PayloadBlock& Bundle::insert(iterator before, ibrcommon::BLOB::Reference &ref)
 		{
+			block_list &list = blocks(before);
+
 			if (size() > 0) {
 				// remove the last block bit
 				iterator last = end();
@@ -153,7 +182,7 @@ namespace dtn
 			dtn::data::PayloadBlock *tmpblock = new dtn::data::PayloadBlock(ref);
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
 
-			_blocks.insert(before, block);
+			list.insert(before, block);
 
 			// set the last block bit
 			iterator last = end();
@@ -167,7 +196,7 @@ namespace dtn
 		{
 			dtn::data::PayloadBlock *tmpblock = new dtn::data::PayloadBlock(ref);
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
-			_blocks.push_front(block);
+			blocks().push_front(block);
 
 			// if this was the first element
 			if (size() == 1)
@@ -192,7 +221,7 @@ namespace dtn
 
 			dtn::data::PayloadBlock *tmpblock = new dtn::data::PayloadBlock(ref);
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
-			_blocks.push_back(block);
+			blocks().push_back(block);
 
 			// set the last block bit
 			block->set(dtn::data::Block::LAST_BLOCK, true);
@@ -203,7 +232,7 @@ namespace dtn
 		dtn::data::Block& Bundle::push_front(dtn::data::ExtensionBlock::Factory &factory)
 		{
 			block_elem block( factory.create() );
-			_blocks.push_front(block);
+			blocks().push_front(block);
 
 			// if this was the first element
 			if (size() == 1)
@@ -227,7 +256,7 @@ namespace dtn
 			}
 
 			block_elem block( factory.create() );
-			_blocks.push_back(block);
+			blocks().push_back(block);
 
 			// set the last block bit
 			block->set(dtn::data::Block::LAST_BLOCK, true);
@@ -237,6 +266,8 @@ namespace dtn
 		
 		Block& Bundle::insert(iterator before, dtn::data::ExtensionBlock::Factory& factory)
 		{
+			block_list &list = blocks(before);
+
 			if (size() > 0) {
 				// remove the last block bit
 				iterator last = end();
@@ -245,7 +276,7 @@ namespace dtn
 			}
 
 			block_elem block( factory.create() );
-			_blocks.insert(before, block);
+			list.insert(before, block);
 
 			// set the last block bit
 			iterator last = end();
@@ -257,7 +288,7 @@ namespace dtn
 
 		Size Bundle::size() const
 		{
-			return _blocks.size();
+			return _blocks->size();
 		}
 
 		bool Bundle::allEIDsInCBHE() const
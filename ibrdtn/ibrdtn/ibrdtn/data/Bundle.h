@@ -79,6 +79,14 @@ namespace dtn
 			typedef ibrcommon::find_iterator<iterator, block_t> find_iterator;
 			typedef ibrcommon::find_iterator<const_iterator, block_t> const_find_iterator;
 
+			/**
+			 * The list of blocks is shared between copies of a bundle and
+			 * detached by the first modification (push, insert, erase, remove,
+			 * clear). Iterators do not detach the list, so iterators of a
+			 * bundle and its copies stay comparable. An iterator passed to a
+			 * modifying method is moved to the detached list, all other
+			 * iterators of the bundle are invalidated by a modification.
+			 */
 			iterator begin();
 			iterator end();
 			const_iterator begin() const;
@@ -138,7 +146,19 @@ namespace dtn
 			dtn::data::Length getPayloadLength() const;
 
 		private:
-			block_list _blocks;
+			/**
+			 * Get exclusive access to the list of blocks. The list is shared
+			 * between copies of the bundle until one of them is modified.
+			 */
+			block_list& blocks();
+
+			/**
+			 * Get exclusive access to the list of blocks and move the given
+			 * iterator of the shared list to the exclusive one.
+			 */
+			block_list& blocks(iterator &it);
+
+			refcnt_ptr<block_list> _blocks;
 		};
 
 		template<class T>
@@ -162,7 +182,7 @@ namespace dtn
 		{
 			T *tmpblock = new T();
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
-			_blocks.push_front(block);
+			blocks().push_front(block);
 
 			// if this was the first element
 			if (size() == 1)
@@ -188,7 +208,7 @@ namespace dtn
 
 			T *tmpblock = new T();
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
-			_blocks.push_back(block);
+			blocks().push_back(block);
 
 			// set the last block bit
 			block->set(dtn::data::Block::LAST_BLOCK, true);
@@ -199,6 +219,8 @@ namespace dtn
 		template<class T>
 		T& Bundle::insert(iterator before)
 		{
+			block_list &list = blocks(before);
+
 			if (size() > 0) {
 				// remove the last block bit
 				iterator last = end();
@@ -208,7 +230,7 @@ namespace dtn
 
 			T *tmpblock = new T();
 			block_elem block( static_cast<dtn::data::Block*>(tmpblock) );
-			_blocks.insert(before, block);
+			list.insert(before, block);
 
 			// set the last block bit
 			iterator last = end();
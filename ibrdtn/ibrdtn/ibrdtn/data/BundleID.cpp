@@ -175,7 +175,7 @@ namespace dtn
 			data += sizeof(tmp);
 
 			// get source endpoint string
-			const std::string s = source.getString();
+			const std::string &s = source.getString();
 
 			// copy source endpoint into data array
 			::strncpy((char*)data, s.c_str(), len - 33);
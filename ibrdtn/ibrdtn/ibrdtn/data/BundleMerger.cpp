@@ -26,6 +26,7 @@
 #include "ibrdtn/data/Exceptions.h"
 #include <ibrcommon/thread/MutexLock.h>
 #include <ibrcommon/Logger.h>
+#include <vector>
 
 namespace dtn
 {
@@ -53,26 +54,39 @@ namespace dtn
 
 		bool BundleMerger::Container::contains(Length offset, Length length) const
 		{
-			// check if the offered payload is already in the chunk list
-			for (std::set<Chunk>::const_iterator iter = _chunks.begin(); iter != _chunks.end(); ++iter)
-			{
-				const Chunk &chunk = (*iter);
+			// get the last chunk starting at or before the offset
+			std::set<Chunk>::const_iterator iter = _chunks.upper_bound(Chunk(offset, 0));
+			if (iter != _chunks.end() && iter->offset == offset) ++iter;
+			if (iter == _chunks.begin()) return false;
+			--iter;
+
+			// chunks are merged, thus one chunk has to cover the whole range
+			return ((offset + length) <= (iter->offset + iter->length));
+		}
 
-				if (offset < chunk.offset) break;
+		void BundleMerger::Container::add(Length offset, Length length)
+		{
+			Length begin = offset;
+			Length end = offset + length;
 
-				if ( (offset >= chunk.offset) && (offset < (chunk.offset + chunk.length)) )
-				{
-					if ((offset + length) <= (chunk.offset + chunk.length)) return true;
-				}
+			// start with the chunk before the new one, if it touches the new one
+			std::set<Chunk>::iterator iter = _chunks.lower_bound(Chunk(begin, 0));
+			if (iter != _chunks.begin())
+			{
+				std::set<Chunk>::iterator prev = iter;
+				--prev;
+				if ((prev->offset + prev->length) >= begin) iter = prev;
 			}
 
-			return false;
-		}
+			// merge all overlapping or adjacent chunks into one
+			while ((iter != _chunks.end()) && (iter->offset <= end))
+			{
+				if (iter->offset < begin) begin = iter->offset;
+				if ((iter->offset + iter->length) > end) end = iter->offset + iter->length;
+				_chunks.erase(iter++);
+			}
 
-		void BundleMerger::Container::add(Length offset, Length length)
-		{
-			BundleMerger::Chunk chunk(offset, length);
-			_chunks.insert(chunk);
+			_chunks.insert(Chunk(begin, end - begin));
 		}
 
 		BundleMerger::Container &operator<<(BundleMerger::Container &c, const dtn::data::Bundle &obj)
@@ -112,23 +126,41 @@ namespace dtn
 				// add a new payloadblock
 				c._bundle.push_back(c._blob);
 
+				// allocate the whole payload, thus fragments can be written at any offset
+				ibrcommon::BLOB::iostream stream = c._blob.iostream();
+				const Length size = stream.size();
+
+				if (size < c._appdatalength)
+				{
+					(*stream).seekp(0, std::ios::end);
+
+					const std::vector<char> zero(4096, 0);
+					for (Length remain = c._appdatalength - size; remain > 0;)
+					{
+						const Length chunk = (remain > zero.size()) ? zero.size() : remain;
+						(*stream).write(&zero[0], chunk);
+						remain -= chunk;
+					}
+					(*stream) << std::flush;
+				}
+
 				c._hasFirstFragBlocksAdded = false;
 				c._hasLastFragBlocksAdded = false;
 
 				c._initialized = true;
 			}
 
-			ibrcommon::BLOB::iostream stream = c._blob.iostream();
-			(*stream).seekp(obj.fragmentoffset.get<std::streampos>());
-
 			const dtn::data::PayloadBlock &p = obj.find<dtn::data::PayloadBlock>();
 			const Length plength = p.getLength();
 
 			// skip write operation if chunk is already in the merged bundle
 			if (c.contains(obj.fragmentoffset.get<dtn::data::Length>(), plength)) return c;
 
-			// copy payload of the fragment into the new blob
+			// copy payload of the fragment into the new blob at its offset
 			{
+				ibrcommon::BLOB::iostream stream = c._blob.iostream();
+				(*stream).seekp(obj.fragmentoffset.get<std::streampos>());
+
 				ibrcommon::BLOB::Reference ref = p.getBLOB();
 				ibrcommon::BLOB::iostream s = ref.iostream();
 				(*stream) << (*s).rdbuf() << std::flush;
@@ -264,7 +296,8 @@ namespace dtn
 				// if the next offset is too small, we do not got all fragments
 				if (chunk.offset > position) return false;
 
-				position = chunk.offset + chunk.length;
+				// a chunk may be covered by a previous one
+				if ((chunk.offset + chunk.length) > position) position = chunk.offset + chunk.length;
 			}
 
 			// return true, if we reached the application data length
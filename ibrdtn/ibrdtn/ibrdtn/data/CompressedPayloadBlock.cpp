@@ -99,12 +99,28 @@ namespace dtn
 
 			// lock the BLOBs while we are compress the payload
 			{
-				// get streams of both containers
-				ibrcommon::BLOB::iostream is = p.getBLOB().iostream();
 				ibrcommon::BLOB::iostream os = ref.iostream();
+				bool compressed = false;
 
-				// compress the payload
-				CompressedPayloadBlock::compress(alg, *is, *os);
+				{
+					// compress the payload directly from memory if it can be mapped
+					const ibrcommon::BLOB::span data(p.getBLOB());
+
+					if (data.valid())
+					{
+						CompressedPayloadBlock::compress(alg, data.data(), data.size(), *os);
+						compressed = true;
+					}
+				}
+
+				if (!compressed)
+				{
+					// get the stream of the payload
+					ibrcommon::BLOB::iostream is = p.getBLOB().iostream();
+
+					// compress the payload
+					CompressedPayloadBlock::compress(alg, *is, *os);
+				}
 			}
 
 			// add a compressed payload block in front of the old payload block
@@ -221,6 +237,78 @@ namespace dtn
 			}
 		}
 
+		void CompressedPayloadBlock::compress(CompressedPayloadBlock::COMPRESS_ALGS alg, const char *data, const dtn::data::Length &length, std::ostream &os)
+		{
+			switch (alg)
+			{
+				case COMPRESSION_ZLIB:
+				{
+#ifdef HAVE_ZLIB
+					const uInt CHUNK_SIZE = 16384;
+
+					// zlib counts the input in uInt, hence very large inputs are split
+					const dtn::data::Length PIECE_SIZE = 0x40000000;
+
+					int ret, flush;
+					uInt have;
+					unsigned char out[CHUNK_SIZE];
+					z_stream strm;
+
+					/* allocate deflate state */
+					strm.zalloc = Z_NULL;
+					strm.zfree = Z_NULL;
+					strm.opaque = Z_NULL;
+					ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+
+					// exit if something is wrong
+					if (ret != Z_OK) throw ibrcommon::Exception("initialization of zlib failed");
+
+					dtn::data::Length remain = length;
+					strm.next_in = (Bytef*)data;
+
+					do {
+						const dtn::data::Length piece = (remain > PIECE_SIZE) ? PIECE_SIZE : remain;
+						strm.avail_in = static_cast<uInt>(piece);
+						remain -= piece;
+
+						flush = (remain == 0) ? Z_FINISH : Z_NO_FLUSH;
+
+						do {
+							strm.avail_out = CHUNK_SIZE;
+							strm.next_out = out;
+
+							ret = deflate(&strm, flush);    /* no bad return value */
+							assert(ret != Z_STREAM_ERROR);  /* state not clobbered */
+
+							// determine how many bytes are available
+							have = CHUNK_SIZE - strm.avail_out;
+
+							// write the buffer to the output stream
+							os.write((char*)&out, have);
+
+							if (!os.good())
+							{
+								(void)deflateEnd(&strm);
+								throw ibrcommon::Exception("decompression failed. output stream went wrong.");
+							}
+
+						} while (strm.avail_out == 0);
+						assert(strm.avail_in == 0);     /* all input will be used */
+					} while (flush != Z_FINISH);
+					assert(ret == Z_STREAM_END);        /* stream will be complete */
+
+					(void)deflateEnd(&strm);
+#else
+					throw ibrcommon::Exception("zlib is not supported");
+#endif
+					break;
+				}
+
+				default:
+					throw ibrcommon::Exception("compression mode is not supported");
+			}
+		}
+
 		void CompressedPayloadBlock::extract(CompressedPayloadBlock::COMPRESS_ALGS alg, std::istream &is, std::ostream &os)
 		{
 			switch (alg)
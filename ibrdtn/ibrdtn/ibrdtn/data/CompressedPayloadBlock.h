@@ -69,6 +69,7 @@ namespace dtn
 
 		private:
 			static void compress(CompressedPayloadBlock::COMPRESS_ALGS alg, std::istream &is, std::ostream &os);
+			static void compress(CompressedPayloadBlock::COMPRESS_ALGS alg, const char *data, const dtn::data::Length &length, std::ostream &os);
 			static void extract(CompressedPayloadBlock::COMPRESS_ALGS alg, std::istream &is, std::ostream &os);
 
 			dtn::data::Number _algorithm;
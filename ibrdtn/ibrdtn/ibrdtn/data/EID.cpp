@@ -26,6 +26,7 @@
 #include <iostream>
 
 #include <ibrcommon/ibrcommon.h>
+#include <ibrcommon/thread/MutexLock.h>
 #ifdef IBRCOMMON_SUPPORT_SSL
 #include <ibrcommon/ssl/MD5Stream.h>
 #endif
@@ -185,48 +186,224 @@ namespace dtn
 #endif
 		}
 
+		/**
+		 * The values of an EID shared by all copies of it
+		 */
+		class EID::Handle
+		{
+		public:
+			Handle(const Scheme t, const std::string &s, const std::string &p, const std::string &a, const Number &n, const Number &c, const std::string &v)
+			 : scheme_type(t), scheme(s), ssp(p), application(a), cbhe_node(n), cbhe_application(c), value(v), hash(0), refcnt(0)
+			{
+				// FNV-1a hash of the string representation
+				hash = static_cast<size_t>(2166136261UL);
+				for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+				{
+					hash = (hash ^ static_cast<unsigned char>(*it)) * static_cast<size_t>(16777619UL);
+				}
+			}
+
+			// abstract values
+			const Scheme scheme_type;
+			const std::string scheme;
+
+			// DTN scheme
+			// the ssp carries the node part
+			const std::string ssp;
+			const std::string application;
+
+			// CBHE scheme
+			const Number cbhe_node;
+			const Number cbhe_application;
+
+			// string representation
+			const std::string value;
+			size_t hash;
+
+			int refcnt;
+		};
+
+		bool EID::HandleLess::operator()(const Handle *a, const Handle *b) const
+		{
+			// equal values have an equal string representation and hash
+			if (a->hash != b->hash) return (a->hash < b->hash);
+
+			if (a->scheme_type != b->scheme_type) return (a->scheme_type < b->scheme_type);
+			if (a->cbhe_node != b->cbhe_node) return (a->cbhe_node < b->cbhe_node);
+			if (a->cbhe_application != b->cbhe_application) return (a->cbhe_application < b->cbhe_application);
+			if (a->ssp != b->ssp) return (a->ssp < b->ssp);
+			if (a->application != b->application) return (a->application < b->application);
+			return (a->scheme < b->scheme);
+		}
+
+		static ibrcommon::Mutex& getHandleLock()
+		{
+			// never deleted, because static EIDs may be destroyed after this lock
+			static ibrcommon::Mutex *lock = new ibrcommon::Mutex();
+			return *lock;
+		}
+
+		EID::handle_set& EID::getHandles()
+		{
+			// never deleted, because static EIDs may be destroyed after this set
+			static handle_set *handles = new handle_set();
+			return *handles;
+		}
+
+		EID::Handle* EID::intern(const Scheme scheme_type, const std::string &scheme, const std::string &ssp, const std::string &application, const Number &cbhe_node, const Number &cbhe_application)
+		{
+			// create the string representation of the EID, only the values
+			// used by the scheme are kept, all others are reset
+			std::string value;
+			std::string key_scheme;
+			std::string key_ssp;
+			std::string key_application;
+			Number key_node = 0;
+			Number key_app = 0;
+
+			switch (scheme_type) {
+			case SCHEME_CBHE:
+			{
+				std::stringstream ss;
+				ss << getSchemeName(SCHEME_CBHE) << ":" << cbhe_node.get<size_t>();
+				ss << "." << cbhe_application.get<size_t>();
+				value = ss.str();
+				key_node = cbhe_node;
+				key_app = cbhe_application;
+				break;
+			}
+
+			case SCHEME_DTN:
+				// split the node and application like a parsed EID, thus an
+				// ssp containing a '/' gets the same handle as the EID with a
+				// separate application
+				if (application.length() > 0) {
+					extractDTN(ssp + "/" + application, key_ssp, key_application);
+				} else {
+					extractDTN(ssp, key_ssp, key_application);
+				}
+
+				value = getSchemeName(SCHEME_DTN) + ":" + key_ssp;
+
+				if (key_application.length() > 0) {
+					value += "/" + key_application;
+				}
+				break;
+
+			default:
+				value = scheme + ":" + ssp;
+				key_scheme = scheme;
+				key_ssp = ssp;
+				break;
+			}
+
+			// look up the handle by all values, not only by the string representation
+			const Handle key(scheme_type, key_scheme, key_ssp, key_application, key_node, key_app, value);
+
+			ibrcommon::MutexLock l(getHandleLock());
+			handle_set &handles = getHandles();
+
+			handle_set::iterator it = handles.find(const_cast<Handle*>(&key));
+			if (it == handles.end())
+			{
+				it = handles.insert(new Handle(key)).first;
+			}
+
+			// new references are only created with the lock held
+			__sync_add_and_fetch(&(*it)->refcnt, 1);
+			return (*it);
+		}
+
+		void EID::release(Handle *h) throw ()
+		{
+			// drop the reference without locking if it is not the last one
+			for (int refcnt = h->refcnt; refcnt > 1; refcnt = h->refcnt)
+			{
+				if (__sync_bool_compare_and_swap(&h->refcnt, refcnt, refcnt - 1)) return;
+			}
+
+			ibrcommon::MutexLock l(getHandleLock());
+
+			// the handle may have been picked up again in the meantime
+			if (__sync_sub_and_fetch(&h->refcnt, 1) > 0) return;
+
+			getHandles().erase(h);
+			delete h;
+		}
+
+		size_t EID::getInternedCount()
+		{
+			ibrcommon::MutexLock l(getHandleLock());
+			return getHandles().size();
+		}
+
 		EID::EID()
-		: _scheme_type(SCHEME_DTN), _scheme(), _ssp("none"), _application(), _cbhe_node(0), _cbhe_application(0), _regex(NULL)
+		 : _handle(NULL), _hash(0), _regex(NULL)
 		{
+			// the handle of dtn:none is created once and never released
+			static Handle * const none = intern(SCHEME_DTN, "", "none", "", 0, 0);
+
+			_handle = none;
+			_hash = none->hash;
+			__sync_add_and_fetch(&_handle->refcnt, 1);
 		}
 
 		EID::EID(const Scheme scheme_type, const std::string &scheme, const std::string &ssp, const std::string &application)
-		: _scheme_type(scheme_type), _scheme(scheme), _ssp(ssp), _application(application), _cbhe_node(0), _cbhe_application(0), _regex(NULL)
+		 : _handle(NULL), _hash(0), _regex(NULL)
 		{
 			if (scheme_type == SCHEME_CBHE) {
 				throw dtn::InvalidDataException("This constructor does not work for CBHE schemes");
 			}
+
+			_handle = intern(scheme_type, scheme, ssp, application, 0, 0);
+			_hash = _handle->hash;
 		}
 
 		EID::EID(const std::string &scheme, const std::string &ssp)
-		 : _scheme_type(SCHEME_EXTENDED), _scheme(), _ssp(ssp), _application(), _cbhe_node(0), _cbhe_application(0), _regex(NULL)
+		 : _handle(NULL), _hash(0), _regex(NULL)
 		{
 			// resolve scheme
-			_scheme_type = resolveScheme(scheme);
-
-			switch (_scheme_type) {
+			Scheme scheme_type = resolveScheme(scheme);
+			std::string scheme_name;
+			std::string ssp_value = ssp;
+			std::string application;
+			Number cbhe_node = 0;
+			Number cbhe_application = 0;
+
+			switch (scheme_type) {
 			case SCHEME_CBHE:
 				// extract CBHE numbers
-				extractCBHE(ssp, _cbhe_node, _cbhe_application);
-				if (_cbhe_node == 0) {
-					_scheme_type = SCHEME_DTN;
-					_ssp = "none";
+				extractCBHE(ssp, cbhe_node, cbhe_application);
+				if (cbhe_node == 0) {
+					scheme_type = SCHEME_DTN;
+					ssp_value = "none";
+					cbhe_application = 0;
 				}
 				break;
 
 			case SCHEME_DTN:
-				extractDTN(ssp, _ssp, _application);
+				extractDTN(ssp, ssp_value, application);
 				break;
 
 			default:
-				_scheme = scheme;
+				scheme_name = scheme;
 				break;
 			}
+
+			_handle = intern(scheme_type, scheme_name, ssp_value, application, cbhe_node, cbhe_application);
+			_hash = _handle->hash;
 		}
 
 		EID::EID(const std::string &orig_value)
-		: _scheme_type(SCHEME_DTN), _scheme(), _ssp("none"), _application(), _cbhe_node(0), _cbhe_application(0), _regex(NULL)
+		 : _handle(NULL), _hash(0), _regex(NULL)
 		{
+			Scheme scheme_type = SCHEME_DTN;
+			std::string scheme_name;
+			std::string ssp_value = "none";
+			std::string application;
+			Number cbhe_node = 0;
+			Number cbhe_application = 0;
+
 			try {
 				if (orig_value.length() == 0) {
 					throw dtn::InvalidDataException("given EID is empty!");
@@ -259,52 +436,55 @@ namespace dtn
 				}
 
 				// resolve scheme
-				_scheme_type = resolveScheme(scheme);
+				scheme_type = resolveScheme(scheme);
 
-				switch (_scheme_type) {
+				switch (scheme_type) {
 				case SCHEME_CBHE:
 					// extract CBHE numbers
-					extractCBHE(ssp, _cbhe_node, _cbhe_application);
+					extractCBHE(ssp, cbhe_node, cbhe_application);
 					break;
 
 				case SCHEME_DTN:
 					// extract DTN scheme node/application
-					extractDTN(ssp, _ssp, _application);
+					extractDTN(ssp, ssp_value, application);
 					break;
 
 				default:
-					_scheme = scheme;
-					_ssp = ssp;
+					scheme_name = scheme;
+					ssp_value = ssp;
 					break;
 				}
 			} catch (const std::exception&) {
-				_scheme_type = SCHEME_DTN;
-				_ssp = "none";
+				scheme_type = SCHEME_DTN;
+				scheme_name = "";
+				ssp_value = "none";
+				application = "";
+				cbhe_node = 0;
+				cbhe_application = 0;
 			}
+
+			_handle = intern(scheme_type, scheme_name, ssp_value, application, cbhe_node, cbhe_application);
+			_hash = _handle->hash;
 		}
 
 		EID::EID(const dtn::data::Number &node, const dtn::data::Number &application)
-		 : _scheme_type(SCHEME_CBHE), _scheme(), _ssp(), _application(), _cbhe_node(node), _cbhe_application(application), _regex(NULL)
+		 : _handle(NULL), _hash(0), _regex(NULL)
 		{
 			// set dtn:none if the node is zero
 			if (node == 0) {
-				_scheme_type = SCHEME_DTN;
-				_ssp = "none";
+				_handle = intern(SCHEME_DTN, "", "none", "", 0, 0);
+			} else {
+				_handle = intern(SCHEME_CBHE, "", "", "", node, application);
 			}
+
+			_hash = _handle->hash;
 		}
 
 		EID::EID(const EID &other)
+		 : _handle(other._handle), _hash(other._hash), _regex(NULL)
 		{
-			_scheme_type = other._scheme_type;
-			_scheme = other._scheme;
-			_ssp = other._ssp;
-
-			_application = other._application;
-
-			_cbhe_node = other._cbhe_node;
-			_cbhe_application = other._cbhe_application;
-
-			_regex = NULL;
+			// the other EID holds a reference, so the handle can not vanish
+			__sync_add_and_fetch(&_handle->refcnt, 1);
 
 			if(other._regex != NULL)
 			{
@@ -321,22 +501,39 @@ namespace dtn
 				_regex = NULL;
 			}
 #endif
+			release(_handle);
 		}
 
-		bool EID::operator==(const EID &other) const
+		EID& EID::operator=(const EID &other)
 		{
-			if (_scheme_type != other._scheme_type) return false;
-
-			switch (_scheme_type) {
-			case SCHEME_CBHE:
-				return (_cbhe_node == other._cbhe_node) && (_cbhe_application == other._cbhe_application);
+			if (_handle != other._handle)
+			{
+				__sync_add_and_fetch(&other._handle->refcnt, 1);
+				release(_handle);
+				_handle = other._handle;
+				_hash = other._hash;
+			}
 
-			case SCHEME_DTN:
-				return (_ssp == other._ssp) && (_application == other._application);
+#ifdef HAVE_REGEX_H
+			if (_regex != NULL) {
+				regfree((regex_t*)_regex);
+				delete (regex_t*)_regex;
+				_regex = NULL;
+			}
+#endif
 
-			default:
-				return (_scheme == other._scheme) && (_ssp == other._ssp);
+			if (other._regex != NULL)
+			{
+				prepare();
 			}
+
+			return (*this);
+		}
+
+		bool EID::operator==(const EID &other) const
+		{
+			// equal EIDs share the same handle
+			return (_handle == other._handle);
 		}
 
 		bool EID::operator==(const std::string &other) const
@@ -356,44 +553,32 @@ namespace dtn
 
 		bool EID::sameHost(const EID &other) const
 		{
-			if (_scheme_type != other._scheme_type) return false;
+			if (_handle == other._handle) return true;
+
+			const Handle &h = *_handle;
+			const Handle &o = *other._handle;
+
+			if (h.scheme_type != o.scheme_type) return false;
 
-			switch (_scheme_type) {
+			switch (h.scheme_type) {
 			case SCHEME_CBHE:
-				return _cbhe_node == other._cbhe_node;
+				return h.cbhe_node == o.cbhe_node;
 
 			case SCHEME_DTN:
-				return _ssp == other._ssp;
+				return h.ssp == o.ssp;
 
 			default:
-				return (_scheme == other._scheme) && (_ssp == other._ssp);
+				return (h.scheme == o.scheme) && (h.ssp == o.ssp);
 			}
 		}
 
 		bool EID::operator<(const EID &other) const
 		{
-			if (_scheme_type < other._scheme_type) return true;
-			if (_scheme_type != other._scheme_type) return false;
+			// order by the hash value first to avoid string comparisons
+			if (_hash != other._hash) return (_hash < other._hash);
+			if (_handle == other._handle) return false;
 
-			switch (_scheme_type) {
-			case SCHEME_CBHE:
-				if (_cbhe_node < other._cbhe_node) return true;
-				if (_cbhe_node != other._cbhe_node) return false;
-
-				return (_cbhe_application < other._cbhe_application);
-
-			case SCHEME_DTN:
-				if (_ssp < other._ssp) return true;
-				if (_ssp != other._ssp) return false;
-
-				return (_application < other._application);
-
-			default:
-				if (_scheme < other._scheme) return true;
-				if (_scheme != other._scheme) return false;
-
-				return (_ssp < other._ssp);
-			}
+			return HandleLess()(_handle, other._handle);
 		}
 
 		bool EID::operator>(const EID &other) const
@@ -401,41 +586,28 @@ namespace dtn
 			return other < (*this);
 		}
 
-		std::string EID::getString() const
+		const std::string& EID::getString() const
 		{
-			std::stringstream ss;
-
-			switch (_scheme_type) {
-			case SCHEME_CBHE:
-				ss << getSchemeName(SCHEME_CBHE) << ":" << _cbhe_node.get<size_t>();
-				ss << "." << _cbhe_application.get<size_t>();
-				break;
-
-			case SCHEME_DTN:
-				ss << getSchemeName(SCHEME_DTN) << ":" << _ssp;
-
-				if (_application.length() > 0) {
-					ss << "/" << _application;
-				}
-				break;
-
-			default:
-				ss << _scheme << ":" << _ssp;
-				break;
-			}
+			return _handle->value;
+		}
 
-			return ss.str();
+		size_t EID::getHash() const throw ()
+		{
+			return _hash;
 		}
 
 		void EID::setApplication(const Number &app) throw ()
 		{
-			switch (_scheme_type) {
+			const Handle &h = *_handle;
+			Handle *n = NULL;
+
+			switch (h.scheme_type) {
 			case SCHEME_CBHE:
-				_cbhe_application = app;
+				n = intern(h.scheme_type, h.scheme, h.ssp, h.application, h.cbhe_node, app);
 				break;
 
 			case SCHEME_DTN:
-				_application = app.toString();
+				n = intern(h.scheme_type, h.scheme, h.ssp, app.toString(), h.cbhe_node, h.cbhe_application);
 				break;
 
 			default:
@@ -443,6 +615,12 @@ namespace dtn
 				break;
 			}
 
+			if (n != NULL) {
+				release(_handle);
+				_handle = n;
+				_hash = n->hash;
+			}
+
 #ifdef HAVE_REGEX_H
 			if (_regex != NULL) {
 				regfree((regex_t*)_regex);
@@ -454,14 +632,17 @@ namespace dtn
 
 		void EID::setApplication(const std::string &app) throw ()
 		{
-			switch (_scheme_type) {
+			const Handle &h = *_handle;
+			Handle *n = NULL;
+
+			switch (h.scheme_type) {
 			case SCHEME_CBHE:
 				// get CBHE Number for the application string
-				_cbhe_application = EID::getApplicationNumber(app);
+				n = intern(h.scheme_type, h.scheme, h.ssp, h.application, h.cbhe_node, EID::getApplicationNumber(app));
 				break;
 
 			case SCHEME_DTN:
-				_application = app;
+				n = intern(h.scheme_type, h.scheme, h.ssp, app, h.cbhe_node, h.cbhe_application);
 				break;
 
 			default:
@@ -469,6 +650,12 @@ namespace dtn
 				break;
 			}
 
+			if (n != NULL) {
+				release(_handle);
+				_handle = n;
+				_hash = n->hash;
+			}
+
 #ifdef HAVE_REGEX_H
 			if (_regex != NULL) {
 				regfree((regex_t*)_regex);
@@ -480,110 +667,115 @@ namespace dtn
 
 		std::string EID::getApplication() const throw ()
 		{
-			switch (_scheme_type) {
+			switch (_handle->scheme_type) {
 			case SCHEME_CBHE:
-				if (_cbhe_application > 0) {
-					return _cbhe_application.toString();
+				if (_handle->cbhe_application > 0) {
+					return _handle->cbhe_application.toString();
 				}
 				return "";
 
 			case SCHEME_DTN:
-				return _application;
+				return _handle->application;
 
 			default:
-				return _ssp;
+				return _handle->ssp;
 			}
 		}
 
 		bool EID::isApplication(const dtn::data::Number &app) const throw ()
 		{
-			if (_scheme_type != SCHEME_CBHE) return false;
-			return (_cbhe_application == app);
+			if (_handle->scheme_type != SCHEME_CBHE) return false;
+			return (_handle->cbhe_application == app);
 		}
 
 		bool EID::isApplication(const std::string &app) const throw ()
 		{
-			switch (_scheme_type) {
+			switch (_handle->scheme_type) {
 			case SCHEME_CBHE:
-				return (_cbhe_application == getApplicationNumber(app));
+				return (_handle->cbhe_application == getApplicationNumber(app));
 
 			case SCHEME_DTN:
-				return (_application == app);
+				return (_handle->application == app);
 
 			default:
-				return (app == _ssp);
+				return (app == _handle->ssp);
 			}
 		}
 
 		std::string EID::getHost() const throw ()
 		{
-			switch (_scheme_type) {
+			switch (_handle->scheme_type) {
 			case SCHEME_CBHE:
-				return _cbhe_node.toString();
+				return _handle->cbhe_node.toString();
 			case SCHEME_DTN:
-				return _ssp;
+				return _handle->ssp;
 			default:
-				return _ssp;
+				return _handle->ssp;
 			}
 		}
 
 		const std::string EID::getScheme() const
 		{
-			switch (_scheme_type) {
+			switch (_handle->scheme_type) {
 			case SCHEME_CBHE:
 				return getSchemeName(SCHEME_CBHE);
 			case SCHEME_DTN:
 				return getSchemeName(SCHEME_DTN);
 			default:
-				return _scheme;
+				return _handle->scheme;
 			}
 		}
 
 		const std::string EID::getSSP() const
 		{
-			switch (_scheme_type) {
+			const Handle &h = *_handle;
+
+			switch (h.scheme_type) {
 			case SCHEME_CBHE:
 			{
 				std::stringstream ss;
-				ss << _cbhe_node.get<size_t>();
-				ss << "." << _cbhe_application.get<size_t>();
+				ss << h.cbhe_node.get<size_t>();
+				ss << "." << h.cbhe_application.get<size_t>();
 
 				return ss.str();
 			}
 
 			case SCHEME_DTN:
-				if (_application.length() > 0) {
+				if (h.application.length() > 0) {
 					std::stringstream ss;
-					ss << _ssp << "/" << _application;
+					ss << h.ssp << "/" << h.application;
 					return ss.str();
 				} else {
-					return _ssp;
+					return h.ssp;
 				}
 
 			default:
-				return _ssp;
+				return h.ssp;
 			}
 		}
 
 		EID EID::getNode() const throw ()
 		{
-			switch (_scheme_type) {
+			const Handle &h = *_handle;
+
+			switch (h.scheme_type) {
 			case SCHEME_CBHE:
-				return EID(_cbhe_node, 0);
+				return EID(h.cbhe_node, 0);
 			case SCHEME_DTN:
-				return EID(_scheme_type, "", _ssp, "");
+				if (h.application.length() == 0) return (*this);
+				return EID(h.scheme_type, "", h.ssp, "");
 			default:
-				return EID(_scheme_type, _scheme, _ssp, "");
+				return EID(h.scheme_type, h.scheme, h.ssp, "");
 			}
 		}
 
 		bool EID::hasApplication() const
 		{
-			switch (_scheme_type) {
+			switch (_handle->scheme_type) {
 			case SCHEME_CBHE:
-				return (_cbhe_application > 0);
+				return (_handle->cbhe_application > 0);
 			case SCHEME_DTN:
-				return _application != "";
+				return _handle->application != "";
 			default:
 				return true;
 			}
@@ -591,17 +783,17 @@ namespace dtn
 
 		bool EID::isCompressable() const
 		{
-			return ((_scheme_type == SCHEME_CBHE) || ((_scheme_type == SCHEME_DTN) && (_ssp == "none")));
+			return ((_handle->scheme_type == SCHEME_CBHE) || ((_handle->scheme_type == SCHEME_DTN) && (_handle->ssp == "none")));
 		}
 
 		bool EID::isNone() const
 		{
-			return (_scheme_type == SCHEME_DTN) && (_ssp == "none");
+			return (_handle->scheme_type == SCHEME_DTN) && (_handle->ssp == "none");
 		}
 
 		std::string EID::getDelimiter() const
 		{
-			if (_scheme_type == EID::SCHEME_CBHE) {
+			if (_handle->scheme_type == EID::SCHEME_CBHE) {
 				return ".";
 			} else {
 				return "/";
@@ -612,7 +804,7 @@ namespace dtn
 		{
 			if (isCompressable())
 			{
-				return std::make_pair(_cbhe_node, _cbhe_application);
+				return std::make_pair(_handle->cbhe_node, _handle->cbhe_application);
 			}
 
 			return std::make_pair(0, 0);
@@ -636,7 +828,7 @@ namespace dtn
 		{
 #ifdef HAVE_REGEX_H
 			if (_regex != NULL) {
-				const std::string data = other.getString();
+				const std::string &data = other.getString();
 
 				// test against the regular expression
 				return regexec((regex_t*)_regex, data.c_str(), 0, NULL, 0) == 0;
@@ -26,6 +26,7 @@
 #include <ibrcommon/Exceptions.h>
 #include <ibrdtn/data/Number.h>
 #include <map>
+#include <set>
 
 namespace dtn
 {
@@ -70,6 +71,8 @@ namespace dtn
 
 			virtual ~EID();
 
+			EID& operator=(const EID &other);
+
 			bool operator==(const EID &other) const;
 
 			bool operator==(const std::string &other) const;
@@ -79,10 +82,20 @@ namespace dtn
 			bool sameHost(const std::string &other) const;
 			bool sameHost(const EID &other) const;
 
+			/**
+			 * Defines a strict order of EIDs for sorted containers. The order
+			 * is based on the hash value and is not alphabetical.
+			 */
 			bool operator<(const EID &other) const;
 			bool operator>(const EID &other) const;
 
-			std::string getString() const;
+			const std::string& getString() const;
+
+			/**
+			 * Returns a hash value of this EID. The value is computed once
+			 * per distinct EID and equal EIDs always return the same value.
+			 */
+			size_t getHash() const throw ();
 
 			void setApplication(const dtn::data::Number &app) throw ();
 			void setApplication(const std::string &app) throw ();
@@ -140,7 +153,14 @@ namespace dtn
 			 */
 			bool match(const dtn::data::EID &other) const;
 
+			/**
+			 * Returns the number of distinct EIDs currently known in this process
+			 */
+			static size_t getInternedCount();
+
 		private:
+			class Handle;
+
 			/**
 			 * private constructor to create a modified EID
 			 */
@@ -156,18 +176,37 @@ namespace dtn
 			 */
 			static void extractDTN(const std::string &ssp, std::string &node, std::string &application);
 
-			// abstract values
-			Scheme _scheme_type;
-			std::string _scheme;
-			std::string _ssp;
+			/**
+			 * Returns the shared handle for the given values. All EIDs with the same
+			 * scheme, ssp, application and CBHE numbers use the same handle, thus EIDs
+			 * can be compared by their handles.
+			 */
+			static Handle* intern(const Scheme scheme_type, const std::string &scheme, const std::string &ssp, const std::string &application, const Number &cbhe_node, const Number &cbhe_application);
+
+			/**
+			 * Drop a reference to a handle and free it if it is not used anymore
+			 */
+			static void release(Handle *h) throw ();
+
+			/**
+			 * Orders handles by their hash value and their structured values
+			 */
+			struct HandleLess
+			{
+				bool operator()(const Handle *a, const Handle *b) const;
+			};
+
+			// all handles indexed by their structured values, the string
+			// representation is not unique (e.g. dtn://node/app with or
+			// without a separate application)
+			typedef std::set<Handle*, HandleLess> handle_set;
+			static handle_set& getHandles();
 
-			// DTN scheme
-			// the ssp carries the node part
-			std::string _application;
+			// interned values of this EID
+			Handle *_handle;
 
-			// CBHE scheme
-			Number _cbhe_node;
-			Number _cbhe_application;
+			// copy of the hash value of the handle
+			size_t _hash;
 
 			// regex structure
 			void *_regex;
@@ -56,6 +56,19 @@ namespace dtn
 
 		std::ostream& PayloadBlock::serialize(std::ostream &stream, Length &length) const
 		{
+			{
+				// write the payload in one piece if it is accessible as contiguous memory
+				const ibrcommon::BLOB::span data(_blobref);
+
+				if (data.valid())
+				{
+					stream.write(data.data(), data.size());
+					if (stream.bad()) throw dtn::SerializationFailedException("output stream went bad");
+					length += data.size();
+					return stream;
+				}
+			}
+
 			ibrcommon::BLOB::Reference blobref = _blobref;
 			ibrcommon::BLOB::iostream io = blobref.iostream();
 
@@ -71,6 +84,20 @@ namespace dtn
 
 		std::ostream& PayloadBlock::serialize(std::ostream &stream, const Length &clip_offset, const Length &clip_length) const
 		{
+			{
+				const ibrcommon::BLOB::span data(_blobref);
+
+				if (data.valid())
+				{
+					if (clip_offset + clip_length > static_cast<Length>(data.size()))
+						throw dtn::SerializationFailedException("clipped range exceeds the payload");
+
+					stream.write(data.data() + clip_offset, clip_length);
+					if (stream.bad()) throw dtn::SerializationFailedException("output stream went bad");
+					return stream;
+				}
+			}
+
 			ibrcommon::BLOB::Reference blobref = _blobref;
 			ibrcommon::BLOB::iostream io = blobref.iostream();
 
@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <limits>
 #include <cstdlib>
+#include <cstring>
 
 #ifndef _SDNV_H_
 #define _SDNV_H_
@@ -98,6 +99,11 @@ namespace dtn
 			 */
 			size_t getLength() const
 			{
+#ifdef __GNUC__
+				// count the significant bits and round up to a multiple of seven
+				const uint64_t val = static_cast<uint64_t>(_value) | 1;
+				return (64 - __builtin_clzll(val) + 6) / 7;
+#else
 				size_t val_len = 0;
 				E tmp = _value;
 
@@ -107,6 +113,7 @@ namespace dtn
 				} while (tmp != 0);
 
 				return val_len;
+#endif
 			}
 
 			template<typename T>
@@ -426,19 +433,30 @@ namespace dtn
 				stream >> _value;
 			}
 
-			void encode(std::ostream &stream) const
+			/**
+			 * Encode the value into a buffer.
+			 * @param data The buffer to write the encoded value to
+			 * @param len The number of bytes available in the buffer
+			 * @return The number of bytes written
+			 */
+			size_t encode(char *data, const size_t len) const
 			{
-				unsigned char buffer[10];
-				unsigned char *bp = &buffer[0];
 				uint64_t val = _value;
 
+				// fast path for values below 128
+				if ((val < 0x80) && (len > 0))
+				{
+					data[0] = static_cast<char>(val);
+					return 1;
+				}
+
 				const size_t val_len = getLength();
 
-				if (!(val_len > 0)) throw ValueOutOfRangeException("ERROR(SDNV): !(val_len > 0)");
 				if (!(val_len <= SDNV::MAX_LENGTH)) throw ValueOutOfRangeException("ERROR(SDNV): !(val_len <= MAX_LENGTH)");
+				if (!(val_len <= len)) throw ValueOutOfRangeException("ERROR(SDNV): !(val_len <= len)");
 
-				// Now advance bp to the last byte and fill it in backwards with the value bytes.
-				bp += val_len;
+				// fill in the buffer backwards with the value bytes
+				unsigned char *bp = reinterpret_cast<unsigned char*>(data) + val_len;
 				unsigned char high_bit = 0; // for the last octet
 				do {
 					--bp;
@@ -447,23 +465,152 @@ namespace dtn
 					val = val >> 7;
 				} while (val != 0);
 
-				if (!(bp == &buffer[0])) throw ValueOutOfRangeException("ERROR(SDNV): !(bp == buffer)");
+				return val_len;
+			}
+
+			/**
+			 * Decode the value from a buffer.
+			 * @param data The buffer holding the encoded value
+			 * @param len The number of bytes available in the buffer
+			 * @return The number of bytes read or zero if the buffer ends
+			 *         before the value is complete
+			 */
+			size_t decode(const char *data, const size_t len)
+			{
+				if (len == 0) return 0;
+
+				// fast path for values below 128
+				if ((data[0] & 0x80) == 0)
+				{
+					_value = static_cast<E>(static_cast<unsigned char>(data[0]));
+					return 1;
+				}
+
+				size_t val_len = 0;
+				unsigned char start = 0;
+				int carry = 0;
+				E value = 0;
+
+				while (val_len < len)
+				{
+					const unsigned char bp = static_cast<unsigned char>(data[val_len]);
+
+					value = (value << 7) | (bp & 0x7f);
+					++val_len;
+
+					if ((bp & (1 << 7)) == 0)
+					{
+						if ((val_len > SDNV::MAX_LENGTH) || ((val_len == SDNV::MAX_LENGTH) && (start != 0x81)))
+							throw ValueOutOfRangeException("ERROR(SDNV): overflow value in sdnv");
+
+						_value = value;
+						return val_len;
+					}
+
+					// check if the value fits into sizeof(E)
+					if ((val_len % 8) == 0) ++carry;
+
+					if ((sizeof(E) + carry) < val_len)
+						throw ValueOutOfRangeException("ERROR(SDNV): overflow value in sdnv");
+
+					if (start == 0) start = bp;
+				}
+
+				// the value is not complete
+				return 0;
+			}
+
+			/**
+			 * Encode a sequence of values into a buffer.
+			 * @return The number of bytes written
+			 */
+			static size_t encode(char *data, const size_t len, const SDNV<E> *values, const size_t count)
+			{
+				size_t pos = 0;
+				for (size_t i = 0; i < count; ++i)
+				{
+					pos += values[i].encode(data + pos, len - pos);
+				}
+				return pos;
+			}
+
+			/**
+			 * Decode a sequence of values from a buffer. Runs of values below
+			 * 128 are detected eight bytes at once and copied without any
+			 * further inspection.
+			 * @return The number of bytes read or zero if the buffer ends
+			 *         before all values are complete
+			 */
+			static size_t decode(const char *data, const size_t len, SDNV<E> *values, const size_t count)
+			{
+				size_t pos = 0;
+				size_t i = 0;
+
+				while (i < count)
+				{
+					if ((count - i >= 8) && (len - pos >= 8))
+					{
+						uint64_t word;
+						::memcpy(&word, data + pos, sizeof(word));
+
+						// none of the next eight bytes has the continuation bit set
+						if ((word & 0x8080808080808080ULL) == 0)
+						{
+							const unsigned char *bp = reinterpret_cast<const unsigned char*>(data + pos);
+							for (size_t j = 0; j < 8; ++j)
+							{
+								values[i + j]._value = static_cast<E>(bp[j]);
+							}
+
+							i += 8;
+							pos += 8;
+							continue;
+						}
+					}
+
+					const size_t val_len = values[i].decode(data + pos, len - pos);
+					if (val_len == 0) return 0;
+
+					pos += val_len;
+					++i;
+				}
+
+				return pos;
+			}
+
+			void encode(std::ostream &stream) const
+			{
+				char buffer[SDNV::MAX_LENGTH];
 
 				// write encoded value to the stream
-				stream.write((const char*)&buffer[0], val_len);
+				stream.write(buffer, encode(buffer, SDNV::MAX_LENGTH));
 			}
 
 			void decode(std::istream &stream)
 			{
 				size_t val_len = 0;
-				unsigned char bp = 0;
 				unsigned char start = 0;
 
 				int carry = 0;
 
 				_value = 0;
+
+				// read the first byte using istream::get() to check the state of the
+				// stream, map errors to the stream state and update gcount()
+				std::char_traits<char>::int_type c = stream.get();
+
+				// read the remaining bytes directly from the buffer of the stream
+				std::streambuf &sb = *stream.rdbuf();
+
 				do {
-					stream.get((char&)bp);
+					if (std::char_traits<char>::eq_int_type(c, std::char_traits<char>::eof()))
+					{
+						// incomplete value
+						if (val_len > 0) stream.setstate(std::ios::eofbit | std::ios::failbit);
+						return;
+					}
+
+					const unsigned char bp = static_cast<unsigned char>(std::char_traits<char>::to_char_type(c));
 
 					_value = (_value << 7) | (bp & 0x7f);
 					++val_len;
@@ -478,6 +625,18 @@ namespace dtn
 						throw ValueOutOfRangeException("ERROR(SDNV): overflow value in sdnv");
 
 					if (start == 0) start = bp;
+
+					try {
+						c = sb.sbumpc();
+					} catch (...) {
+						// errors of the stream buffer set the badbit as in istream::get()
+						try {
+							stream.setstate(std::ios::badbit);
+						} catch (const std::ios::failure&) { }
+
+						if (stream.exceptions() & std::ios::badbit) throw;
+						return;
+					}
 				} while (1);
 
 				if ((val_len > SDNV::MAX_LENGTH) || ((val_len == SDNV::MAX_LENGTH) && (start != 0x81)))
@@ -170,9 +170,6 @@ namespace dtn
 
 		Serializer& DefaultSerializer::operator <<(const dtn::data::PrimaryBlock& obj)
 		{
-			_stream << dtn::data::BUNDLE_VERSION;		// bundle version
-			_stream << obj.procflags;	// processing flags
-
 			// predict the block length
 			Number len = 0;
 			dtn::data::Number primaryheader[14];
@@ -249,42 +246,53 @@ namespace dtn
 				len += primaryheader[13].getLength();
 			}
 
-			// write the block length
-			_stream << len;
+			// encode all header fields into one buffer to write them at once
+			char header[1 + (16 * Number::MAX_LENGTH)];
+			size_t pos = 0;
+
+			header[pos++] = dtn::data::BUNDLE_VERSION;		// bundle version
+			pos += obj.procflags.encode(header + pos, sizeof(header) - pos);	// processing flags
+			pos += len.encode(header + pos, sizeof(header) - pos);	// block length
 
 			/*
 			 * write the ref block of the dictionary
 			 * this includes scheme and ssp for destination, source, reportto and custodian.
 			 */
-			for (int i = 0; i < 11; ++i)
-			{
-				_stream << primaryheader[i];
-			}
+			pos += Number::encode(header + pos, sizeof(header) - pos, primaryheader, 11);
 
 			if (_compressable)
 			{
 				// write the size of the dictionary (always zero here)
-				_stream << primaryheader[11];
+				pos += primaryheader[11].encode(header + pos, sizeof(header) - pos);
 			}
 			else
 			{
+				_stream.write(header, pos);
+				pos = 0;
+
 				// write size of dictionary + bytearray
 				_stream << _dictionary;
 			}
 
 			if (obj.get(dtn::data::Bundle::FRAGMENT))
 			{
-				_stream << primaryheader[12]; // FRAGMENTATION_OFFSET
-				_stream << primaryheader[13]; // APPLICATION_DATA_LENGTH
+				// FRAGMENTATION_OFFSET and APPLICATION_DATA_LENGTH
+				pos += Number::encode(header + pos, sizeof(header) - pos, &primaryheader[12], 2);
 			}
-			
+
+			_stream.write(header, pos);
+
 			return (*this);
 		}
 
-		Serializer& DefaultSerializer::operator <<(const dtn::data::Block& obj)
+		void DefaultSerializer::writeBlockHeader(const dtn::data::Block &obj, const Length &length)
 		{
-			_stream.put((char&)obj.getType());
-			_stream << obj.getProcessingFlags();
+			// encode the header fields into a buffer to write them at once
+			char header[8 * Number::MAX_LENGTH];
+			size_t pos = 0;
+
+			header[pos++] = obj.getType();
+			pos += obj.getProcessingFlags().encode(header + pos, sizeof(header) - pos);
 
 			const Block::eid_list &eids = obj.getEIDList();
 
@@ -295,7 +303,7 @@ namespace dtn
 
 			if (obj.get(Block::BLOCK_CONTAINS_EIDS))
 			{
-				_stream << Number(eids.size());
+				pos += Number(eids.size()).encode(header + pos, sizeof(header) - pos);
 				for (Block::eid_list::const_iterator it = eids.begin(); it != eids.end(); ++it)
 				{
 					dtn::data::Dictionary::Reference offsets;
@@ -309,13 +317,34 @@ namespace dtn
 						offsets = _dictionary.getRef(*it);
 					}
 
-					_stream << offsets.first;
-					_stream << offsets.second;
+					// write the buffer if there is not enough space left for the reference
+					if (sizeof(header) - pos < 2 * Number::MAX_LENGTH)
+					{
+						_stream.write(header, pos);
+						pos = 0;
+					}
+
+					pos += offsets.first.encode(header + pos, sizeof(header) - pos);
+					pos += offsets.second.encode(header + pos, sizeof(header) - pos);
 				}
 			}
 
+			if (sizeof(header) - pos < Number::MAX_LENGTH)
+			{
+				_stream.write(header, pos);
+				pos = 0;
+			}
+
 			// write size of the payload in the block
-			_stream << Number(obj.getLength());
+			pos += Number(length).encode(header + pos, sizeof(header) - pos);
+
+			_stream.write(header, pos);
+		}
+
+		Serializer& DefaultSerializer::operator <<(const dtn::data::Block& obj)
+		{
+			// write the block header
+			writeBlockHeader(obj, obj.getLength());
 
 			// write the payload of the block
 			Length slength = 0;
@@ -326,37 +355,6 @@ namespace dtn
 
 		Serializer& DefaultSerializer::serialize(const dtn::data::PayloadBlock& obj, const Length &clip_offset, const Length &clip_length)
 		{
-			_stream.put((char&)obj.getType());
-			_stream << obj.getProcessingFlags();
-
-			const Block::eid_list &eids = obj.getEIDList();
-
-#ifdef __DEVELOPMENT_ASSERTIONS__
-			// test: BLOCK_CONTAINS_EIDS => (eids.size() > 0)
-			assert(!obj.get(Block::BLOCK_CONTAINS_EIDS) || (eids.size() > 0));
-#endif
-
-			if (obj.get(Block::BLOCK_CONTAINS_EIDS))
-			{
-				_stream << Number(eids.size());
-				for (Block::eid_list::const_iterator it = eids.begin(); it != eids.end(); ++it)
-				{
-					dtn::data::Dictionary::Reference offsets;
-
-					if (_compressable)
-					{
-						offsets = (*it).getCompressed();
-					}
-					else
-					{
-						offsets = _dictionary.getRef(*it);
-					}
-
-					_stream << offsets.first;
-					_stream << offsets.second;
-				}
-			}
-
 			// get the remaining payload size
 			Length payload_size = obj.getLength();
 
@@ -367,8 +365,8 @@ namespace dtn
 			if (frag_len > clip_length) frag_len = clip_length;
 
 			// set the real predicted payload length
-			// write size of the payload in the block
-			_stream << Number(frag_len);
+			// write the block header with the size of the payload in the block
+			writeBlockHeader(obj, frag_len);
 
 			if (frag_len > 0)
 			{
@@ -823,6 +821,72 @@ namespace dtn
 
 		}
 
+		BufferStream::BufferStream(char *data, const Length &length)
+		 : _buffer(data, length)
+		{
+		}
+
+		BufferStream::BufferStream(const char *data, const Length &length)
+		 : _buffer(data, length)
+		{
+		}
+
+		BufferStream::~BufferStream()
+		{
+		}
+
+		BufferSerializer::BufferSerializer(char *data, const Length &length)
+		 : BufferStream(data, length), DefaultSerializer(_buffer)
+		{
+		}
+
+		BufferSerializer::BufferSerializer(char *data, const Length &length, const Dictionary &d)
+		 : BufferStream(data, length), DefaultSerializer(_buffer, d)
+		{
+		}
+
+		BufferSerializer::~BufferSerializer()
+		{
+		}
+
+		Serializer& BufferSerializer::operator<<(const dtn::data::Bundle &obj)
+		{
+			DefaultSerializer::operator<<(obj);
+			if (_buffer.bad()) throw dtn::SerializationFailedException("buffer too small for the bundle");
+			return (*this);
+		}
+
+		Serializer& BufferSerializer::operator<<(const dtn::data::BundleFragment &obj)
+		{
+			DefaultSerializer::operator<<(obj);
+			if (_buffer.bad()) throw dtn::SerializationFailedException("buffer too small for the fragment");
+			return (*this);
+		}
+
+		Length BufferSerializer::getWritten() const
+		{
+			return _buffer.getWritten();
+		}
+
+		BufferDeserializer::BufferDeserializer(const char *data, const Length &length)
+		 : BufferStream(data, length), DefaultDeserializer(_buffer)
+		{
+		}
+
+		BufferDeserializer::BufferDeserializer(const char *data, const Length &length, Validator &v)
+		 : BufferStream(data, length), DefaultDeserializer(_buffer, v)
+		{
+		}
+
+		BufferDeserializer::~BufferDeserializer()
+		{
+		}
+
+		Length BufferDeserializer::getRead() const
+		{
+			return _buffer.getRead();
+		}
+
 		SeparateSerializer::SeparateSerializer(std::ostream& stream)
 		 : DefaultSerializer(stream)
 		{
@@ -27,6 +27,7 @@
 #include "ibrdtn/data/PrimaryBlock.h"
 #include "ibrdtn/data/Exceptions.h"
 #include "ibrdtn/data/BundleFragment.h"
+#include <ibrcommon/data/MemoryStream.h>
 
 namespace dtn
 {
@@ -124,7 +125,14 @@ namespace dtn
 			virtual Length getLength(const dtn::data::Block &obj) const;
 
 		protected:
-			Serializer &serialize(const dtn::data::PayloadBlock& obj, const Length &clip_offset, const Length &clip_length);
+			virtual Serializer &serialize(const dtn::data::PayloadBlock& obj, const Length &clip_offset, const Length &clip_length);
+
+			/**
+			 * Write the header of a block, the data of the block has to
+			 * follow with the given length.
+			 */
+			void writeBlockHeader(const dtn::data::Block &obj, const Length &length);
+
 			void rebuildDictionary(const dtn::data::Bundle &obj);
 			bool isCompressable(const dtn::data::Bundle &obj) const;
 			std::ostream &_stream;
@@ -181,6 +189,59 @@ namespace dtn
 			bool _fragmentation;
 		};
 
+		/**
+		 * Holds the stream of the buffer (de-)serializers. As a base class it is
+		 * constructed before the (de-)serializer which keeps a reference to the stream.
+		 */
+		class BufferStream
+		{
+		protected:
+			BufferStream(char *data, const Length &length);
+			BufferStream(const char *data, const Length &length);
+			~BufferStream();
+
+			ibrcommon::MemoryStream _buffer;
+		};
+
+		/**
+		 * This serializer writes bundles into a pre-sized buffer instead of a stream.
+		 * The buffer should have the length returned by getLength(). If the buffer is
+		 * too small a SerializationFailedException is thrown.
+		 */
+		class BufferSerializer : private BufferStream, public DefaultSerializer
+		{
+		public:
+			BufferSerializer(char *data, const Length &length);
+			BufferSerializer(char *data, const Length &length, const Dictionary &d);
+			virtual ~BufferSerializer();
+
+			using DefaultSerializer::operator<<;
+			virtual Serializer &operator<<(const dtn::data::Bundle &obj);
+			virtual Serializer &operator<<(const dtn::data::BundleFragment &obj);
+
+			/**
+			 * Returns the number of bytes written to the buffer
+			 */
+			Length getWritten() const;
+		};
+
+		/**
+		 * This deserializer reads bundles directly from a buffer without
+		 * copying the data into a stream first.
+		 */
+		class BufferDeserializer : private BufferStream, public DefaultDeserializer
+		{
+		public:
+			BufferDeserializer(const char *data, const Length &length);
+			BufferDeserializer(const char *data, const Length &length, Validator &v);
+			virtual ~BufferDeserializer();
+
+			/**
+			 * Returns the number of bytes read from the buffer
+			 */
+			Length getRead() const;
+		};
+
 		class SeparateSerializer : public DefaultSerializer
 		{
 		public:
@@ -41,6 +41,7 @@ namespace dtn
 		{
 			// stop the idle timer
 			_idle_timer.stop();
+			_idle_timer.join();
 		}
 
 		bool StreamConnection::StreamBuffer::get(const StateBits bit) const
@@ -655,10 +656,9 @@ namespace dtn
 
 		size_t StreamConnection::StreamBuffer::timeout(ibrcommon::Timer*)
 		{
-			if (__good())
-			{
-				shutdown(StreamDataSegment::MSG_SHUTDOWN_IDLE_TIMEOUT);
-			}
+			// do not send anything here, a blocked socket would stall all timers
+			if (__good()) set(STREAM_IDLE);
+
 			throw ibrcommon::Timer::StopTimerException();
 		}
 
@@ -159,5 +159,10 @@ namespace dtn
 		{
 			_buf.enableIdleTimeout(seconds);
 		}
+
+		bool StreamConnection::isIdle() const
+		{
+			return _buf.get(StreamBuffer::STREAM_IDLE);
+		}
 	}
 }
@@ -212,6 +212,12 @@ namespace dtn
 			 */
 			void enableIdleTimeout(const dtn::data::Timeout &seconds);
 
+			/**
+			 * Returns true, if the idle timeout has been expired. The owner of the
+			 * connection is responsible to shutdown the connection in this case.
+			 */
+			bool isIdle() const;
+
 		private:
 			/**
 			 * stream buffer class
@@ -270,7 +276,8 @@ namespace dtn
 				void keepalive();
 
 				/**
-				 * Idle timeout timer callback
+				 * Idle timeout timer callback. It runs on the shared timer thread
+				 * and thus only marks the stream as idle.
 				 * @param timer
 				 * @return
 				 */
@@ -317,7 +324,8 @@ namespace dtn
 					STREAM_ACK_SUPPORT = 1 << 8,
 					STREAM_NACK_SUPPORT = 1 << 9,
 					STREAM_SOB = 1 << 10,			// start of bundle
-					STREAM_TIMER_SUPPORT = 1 << 11
+					STREAM_TIMER_SUPPORT = 1 << 11,
+					STREAM_IDLE = 1 << 12
 				};
 
 				void skipData(dtn::data::Length &size);
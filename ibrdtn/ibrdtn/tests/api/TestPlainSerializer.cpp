@@ -31,6 +31,7 @@
 #include <ibrdtn/data/Serializer.h>
 #include <ibrdtn/data/BundleFragment.h>
 #include <ibrdtn/data/BundleBuilder.h>
+#include <ibrcommon/TimeMeasurement.h>
 #include <iostream>
 #include <sstream>
 
@@ -112,3 +113,33 @@ void TestPlainSerializer::plain_serializer_inversion(void)
 	/* compare strings */
 	CPPUNIT_ASSERT_EQUAL( 0, ss1.str().compare(ss2.str()) );
 }
+
+void TestPlainSerializer::plain_serializer_throughput(void)
+{
+	const size_t length = 8 * 1024 * 1024;
+
+	// generate some payload
+	std::string payload(length, '\0');
+	for (size_t i = 0; i < length; ++i) payload[i] = static_cast<char>(i % 251);
+
+	const dtn::api::PlainSerializer::Encoding encodings[] = { dtn::api::PlainSerializer::BASE64, dtn::api::PlainSerializer::RAW };
+
+	for (size_t i = 0; i < 2; ++i)
+	{
+		std::stringstream api, input(payload), output;
+		ibrcommon::TimeMeasurement tm;
+
+		tm.start();
+		dtn::api::PlainSerializer(api, encodings[i]).writeData(input, length);
+		api << std::endl;
+		dtn::api::PlainDeserializer(api).readData(output);
+		tm.stop();
+
+		CPPUNIT_ASSERT(output.str() == payload);
+
+		const double seconds = tm.getMicroseconds() / 1000000.0;
+		std::cout << dtn::api::PlainSerializer::printEncoding(encodings[i]) << ": "
+				<< (api.str().length() / 1024) << " kB transferred, "
+				<< ((seconds > 0) ? (static_cast<double>(length) / (1024 * 1024) / seconds) : 0) << " MB/s" << std::endl;
+	}
+}
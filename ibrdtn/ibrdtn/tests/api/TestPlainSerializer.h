@@ -29,6 +29,7 @@ class TestPlainSerializer : public CPPUNIT_NS :: TestFixture
 {
 	CPPUNIT_TEST_SUITE (TestPlainSerializer);
 	CPPUNIT_TEST (plain_serializer_inversion);
+	CPPUNIT_TEST (plain_serializer_throughput);
 	CPPUNIT_TEST_SUITE_END ();
 
 	static void hexdump(char c);
@@ -39,6 +40,7 @@ public:
 
 protected:
 	void plain_serializer_inversion(void);
+	void plain_serializer_throughput(void);
 };
 
 #endif /* TESTPLAINSERIALIZER_H_ */
@@ -0,0 +1,129 @@
+/*
+ * TestBundle.cpp
+ *
+ * Copyright (C) 2014 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "data/TestBundle.h"
+#include <ibrdtn/data/Bundle.h>
+#include <ibrdtn/data/PayloadBlock.h>
+#include <ibrdtn/data/AgeBlock.h>
+#include <ibrcommon/data/BLOB.h>
+#include <list>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestBundle);
+
+void TestBundle::setUp()
+{
+}
+
+void TestBundle::tearDown()
+{
+}
+
+void TestBundle::copyOnWriteTest()
+{
+	dtn::data::Bundle b;
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	b.push_back(ref);
+
+	const dtn::data::Size size = b.size();
+
+	// a modified copy does not change the origin
+	dtn::data::Bundle copy = b;
+	copy.push_back<dtn::data::AgeBlock>();
+	CPPUNIT_ASSERT_EQUAL(size, b.size());
+	CPPUNIT_ASSERT_EQUAL(size + 1, copy.size());
+
+	// the blocks itself are still shared
+	const dtn::data::PayloadBlock &p1 = b.find<dtn::data::PayloadBlock>();
+	const dtn::data::PayloadBlock &p2 = copy.find<dtn::data::PayloadBlock>();
+	CPPUNIT_ASSERT(&p1 == &p2);
+
+	// a cleared copy does not change the origin
+	dtn::data::Bundle empty = b;
+	empty.clear();
+	CPPUNIT_ASSERT_EQUAL((dtn::data::Size)0, empty.size());
+	CPPUNIT_ASSERT_EQUAL(size, b.size());
+
+	// a modified origin does not change the copy
+	dtn::data::Bundle copy2 = b;
+	b.clear();
+	CPPUNIT_ASSERT_EQUAL(size, copy2.size());
+}
+
+void TestBundle::eraseSharedTest()
+{
+	dtn::data::Bundle b;
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	b.push_back(ref);
+
+	const dtn::data::Size size = b.size();
+
+	// the iterator is taken before the bundle is copied
+	dtn::data::Bundle::iterator it = b.find(dtn::data::PayloadBlock::BLOCK_TYPE);
+	dtn::data::Bundle copy = b;
+
+	b.erase(it);
+	CPPUNIT_ASSERT_EQUAL(size - 1, b.size());
+	CPPUNIT_ASSERT_EQUAL(size, copy.size());
+	CPPUNIT_ASSERT(b.find(dtn::data::PayloadBlock::BLOCK_TYPE) == b.end());
+	CPPUNIT_ASSERT(copy.find(dtn::data::PayloadBlock::BLOCK_TYPE) != copy.end());
+
+	// insert a block in front of a shared iterator
+	dtn::data::Bundle::iterator front = copy.begin();
+	dtn::data::Bundle copy2 = copy;
+	copy.insert<dtn::data::AgeBlock>(front);
+	CPPUNIT_ASSERT_EQUAL(size + 1, copy.size());
+	CPPUNIT_ASSERT_EQUAL(size, copy2.size());
+	CPPUNIT_ASSERT_EQUAL(dtn::data::AgeBlock::BLOCK_TYPE, (**copy.begin()).getType());
+}
+
+void TestBundle::iterateSharedTest()
+{
+	dtn::data::Bundle b;
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	b.push_back(ref);
+	b.push_back<dtn::data::AgeBlock>();
+
+	const dtn::data::Size size = b.size();
+
+	// copy the bundle while it is iterated
+	std::list<dtn::data::Bundle> copies;
+	dtn::data::Size count = 0;
+
+	for (dtn::data::Bundle::iterator it = b.begin(); it != b.end(); ++it)
+	{
+		copies.push_back(b);
+		count++;
+	}
+
+	CPPUNIT_ASSERT_EQUAL(size, count);
+
+	// reading does not detach the shared list
+	dtn::data::Bundle &copy = copies.front();
+	CPPUNIT_ASSERT(&(*b.begin()) == &(*copy.begin()));
+	CPPUNIT_ASSERT(b.find(dtn::data::AgeBlock::BLOCK_TYPE) == copy.find(dtn::data::AgeBlock::BLOCK_TYPE));
+
+	// a modification detaches the list of the modified bundle only
+	copy.push_front<dtn::data::AgeBlock>();
+	CPPUNIT_ASSERT(&(*b.begin()) != &(*copy.begin()));
+	CPPUNIT_ASSERT_EQUAL(size, b.size());
+	CPPUNIT_ASSERT_EQUAL(size + 1, copy.size());
+	CPPUNIT_ASSERT(&(*b.begin()) == &(*copies.back().begin()));
+}
@@ -0,0 +1,112 @@
+/*
+ * TestBundleMerger.cpp
+ *
+ * Copyright (C) 2013 IBR, TU Braunschweig
+ *
+ * Written-by: Johannes Morgenroth <morgenroth@ibr.cs.tu-bs.de>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "data/TestBundleMerger.h"
+#include <ibrdtn/data/BundleMerger.h>
+#include <ibrdtn/data/PayloadBlock.h>
+#include <ibrcommon/data/BLOB.h>
+#include <sstream>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestBundleMerger);
+
+void TestBundleMerger::setUp()
+{
+}
+
+void TestBundleMerger::tearDown()
+{
+}
+
+dtn::data::Bundle TestBundleMerger::createFragment(const std::string &payload, const dtn::data::Length offset, const dtn::data::Length length)
+{
+	dtn::data::Bundle b;
+	b.source = dtn::data::EID("dtn://test/app");
+	b.destination = dtn::data::EID("dtn://dest/app");
+	b.timestamp = 1;
+	b.sequencenumber = 1;
+
+	b.set(dtn::data::PrimaryBlock::FRAGMENT, true);
+	b.fragmentoffset = offset;
+	b.appdatalength = payload.length();
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream stream = ref.iostream();
+		(*stream) << payload.substr(offset, length) << std::flush;
+	}
+	b.push_back(ref);
+
+	return b;
+}
+
+void TestBundleMerger::chunkTest(void)
+{
+	std::set<dtn::data::BundleMerger::Chunk> chunks;
+	chunks.insert(dtn::data::BundleMerger::Chunk(0, 100));
+	chunks.insert(dtn::data::BundleMerger::Chunk(10, 20));
+	CPPUNIT_ASSERT(!dtn::data::BundleMerger::Chunk::isComplete(150, chunks));
+
+	// a chunk covered by a previous one must not hide a gap
+	chunks.insert(dtn::data::BundleMerger::Chunk(110, 40));
+	CPPUNIT_ASSERT(!dtn::data::BundleMerger::Chunk::isComplete(150, chunks));
+
+	chunks.insert(dtn::data::BundleMerger::Chunk(90, 30));
+	CPPUNIT_ASSERT(dtn::data::BundleMerger::Chunk::isComplete(150, chunks));
+}
+
+void TestBundleMerger::mergeTest(void)
+{
+	std::stringstream ss;
+	for (int i = 0; i < 1000; ++i) ss << (i % 10);
+	const std::string payload = ss.str();
+
+	dtn::data::BundleMerger::Container c = dtn::data::BundleMerger::getContainer();
+
+	// out of order and overlapping fragments
+	c << createFragment(payload, 600, 400);
+	CPPUNIT_ASSERT(!c.isComplete());
+
+	c << createFragment(payload, 100, 300);
+	CPPUNIT_ASSERT(!c.isComplete());
+
+	c << createFragment(payload, 350, 300);
+	CPPUNIT_ASSERT(!c.isComplete());
+
+	// duplicate
+	c << createFragment(payload, 100, 300);
+	CPPUNIT_ASSERT(!c.isComplete());
+
+	c << createFragment(payload, 0, 100);
+	CPPUNIT_ASSERT(c.isComplete());
+
+	dtn::data::Bundle &merged = c.getBundle();
+	CPPUNIT_ASSERT(!merged.get(dtn::data::PrimaryBlock::FRAGMENT));
+
+	const dtn::data::PayloadBlock &p = merged.find<dtn::data::PayloadBlock>();
+	CPPUNIT_ASSERT_EQUAL(payload.length(), p.getLength());
+
+	ibrcommon::BLOB::Reference ref = p.getBLOB();
+	ibrcommon::BLOB::iostream stream = ref.iostream();
+
+	std::stringstream data;
+	data << (*stream).rdbuf();
+	CPPUNIT_ASSERT_EQUAL(payload, data.str());
+}
@@ -22,6 +22,7 @@
 #include "data/TestCompressedPayloadBlock.h"
 #include <ibrdtn/data/Bundle.h>
 #include <ibrdtn/data/PayloadBlock.h>
+#include <ibrdtn/data/Serializer.h>
 #include <ibrcommon/data/BLOB.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (TestCompressedPayloadBlock);
@@ -94,3 +95,53 @@ void TestCompressedPayloadBlock::extractTest(void)
 		}
 	}
 }
+
+void TestCompressedPayloadBlock::fileTest(void)
+{
+	// use file based BLOBs which are mapped into memory for compression and serialization
+	ibrcommon::BLOB::changeProvider(new ibrcommon::FileBLOBProvider(ibrcommon::File("/tmp")), true);
+
+	dtn::data::Bundle b;
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+
+	// generate some test data
+	{
+		ibrcommon::BLOB::iostream stream = ref.iostream();
+		for (int i = 0; i < 10000; ++i)
+		{
+			(*stream) << "0123456789";
+		}
+	}
+
+	// add a payload block
+	const dtn::data::Length origin_psize = b.push_back(ref).getLength();
+
+	dtn::data::CompressedPayloadBlock::compress(b, dtn::data::CompressedPayloadBlock::COMPRESSION_ZLIB);
+	CPPUNIT_ASSERT(origin_psize > b.find<dtn::data::PayloadBlock>().getLength());
+
+	// serialize and deserialize the compressed bundle
+	std::stringstream ss;
+	dtn::data::DefaultSerializer(ss) << b;
+
+	dtn::data::Bundle b2;
+	dtn::data::DefaultDeserializer(ss) >> b2;
+
+	dtn::data::CompressedPayloadBlock::extract(b2);
+
+	dtn::data::PayloadBlock &p = b2.find<dtn::data::PayloadBlock>();
+	CPPUNIT_ASSERT_EQUAL(origin_psize, p.getLength());
+
+	// detailed check of the payload
+	{
+		ibrcommon::BLOB::iostream stream = p.getBLOB().iostream();
+		for (int i = 0; i < 10000; ++i)
+		{
+			char buf[10];
+			(*stream).read(buf, 10);
+			CPPUNIT_ASSERT_EQUAL((*stream).gcount(), (std::streamsize)10);
+			CPPUNIT_ASSERT_EQUAL(std::string(buf, 10), std::string("0123456789"));
+		}
+	}
+
+	ibrcommon::BLOB::changeProvider(new ibrcommon::MemoryBLOBProvider(), true);
+}
@@ -31,6 +31,7 @@ class TestCompressedPayloadBlock : public CPPUNIT_NS :: TestFixture
 	CPPUNIT_TEST_SUITE (TestCompressedPayloadBlock);
 	CPPUNIT_TEST (compressTest);
 	CPPUNIT_TEST (extractTest);
+	CPPUNIT_TEST (fileTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -40,6 +41,7 @@ public:
 protected:
 	void compressTest(void);
 	void extractTest(void);
+	void fileTest(void);
 };
 
 #endif /* TESTCOMPRESSEDPAYLOADBLOCK_H_ */
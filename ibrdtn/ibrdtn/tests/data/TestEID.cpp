@@ -21,7 +21,12 @@
 
 #include "data/TestEID.h"
 #include <ibrdtn/data/EID.h>
+#include <ibrcommon/TimeMeasurement.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (TestEID);
 
@@ -87,3 +92,134 @@ void TestEID::testCBHEHost(void)
 	CPPUNIT_ASSERT_EQUAL(std::string("12"), a.getHost());
 	CPPUNIT_ASSERT_EQUAL(std::string("ipn:12.0"), a.getNode().getString());
 }
+
+void TestEID::testIntern(void)
+{
+	const size_t count = dtn::data::EID::getInternedCount();
+
+	{
+		dtn::data::EID a("dtn://intern-test/app");
+		dtn::data::EID b("dtn", "//intern-test/app");
+		dtn::data::EID c = a;
+
+		// all three share one entry
+		CPPUNIT_ASSERT_EQUAL(count + 1, dtn::data::EID::getInternedCount());
+		CPPUNIT_ASSERT(a == b);
+		CPPUNIT_ASSERT(a == c);
+		CPPUNIT_ASSERT_EQUAL(a.getHash(), b.getHash());
+
+		dtn::data::EID d("dtn://intern-test/other");
+		CPPUNIT_ASSERT(a != d);
+		CPPUNIT_ASSERT(a < d);
+		CPPUNIT_ASSERT(a.sameHost(d));
+
+		// assign a different value
+		c = d;
+		CPPUNIT_ASSERT(c == d);
+		CPPUNIT_ASSERT(c != a);
+		CPPUNIT_ASSERT_EQUAL(std::string("dtn://intern-test/other"), c.getString());
+		CPPUNIT_ASSERT_EQUAL(count + 2, dtn::data::EID::getInternedCount());
+	}
+
+	// entries are removed with the last reference
+	CPPUNIT_ASSERT_EQUAL(count, dtn::data::EID::getInternedCount());
+}
+
+void TestEID::testInternSetApplication(void)
+{
+	dtn::data::EID a("dtn://intern-test/app");
+	dtn::data::EID b = a;
+
+	b.setApplication("other");
+
+	// the copy is not affected
+	CPPUNIT_ASSERT_EQUAL(std::string("dtn://intern-test/app"), a.getString());
+	CPPUNIT_ASSERT_EQUAL(std::string("dtn://intern-test/other"), b.getString());
+	CPPUNIT_ASSERT(b == dtn::data::EID("dtn://intern-test/other"));
+	CPPUNIT_ASSERT(a.getNode() == b.getNode());
+
+	dtn::data::EID c(12, 34);
+	c.setApplication(dtn::data::Number(56));
+	CPPUNIT_ASSERT(c == dtn::data::EID("ipn:12.56"));
+}
+
+void TestEID::testInternSplit(void)
+{
+	// dtn:none is interned once by the default constructor
+	const dtn::data::EID none;
+	const size_t count = dtn::data::EID::getInternedCount();
+
+	// intern the parsed form first and the composed form second, then the other way round
+	for (int i = 0; i < 2; ++i)
+	{
+		dtn::data::EID parsed;
+		dtn::data::EID composed("dtn://intern-split");
+
+		if (i == 0) {
+			parsed = dtn::data::EID("dtn://intern-split/app/sub");
+			composed.setApplication("app/sub");
+		} else {
+			composed.setApplication("app/sub");
+			parsed = dtn::data::EID("dtn://intern-split/app/sub");
+		}
+
+		// both forms share one entry with the same node and application
+		CPPUNIT_ASSERT(parsed == composed);
+		CPPUNIT_ASSERT_EQUAL(count + 1, dtn::data::EID::getInternedCount());
+		CPPUNIT_ASSERT_EQUAL(std::string("app/sub"), parsed.getApplication());
+		CPPUNIT_ASSERT_EQUAL(std::string("app/sub"), composed.getApplication());
+		CPPUNIT_ASSERT_EQUAL(std::string("dtn://intern-split"), parsed.getNode().getString());
+		CPPUNIT_ASSERT_EQUAL(std::string("dtn://intern-split"), composed.getNode().getString());
+		CPPUNIT_ASSERT(parsed.getNode() == composed.getNode());
+	}
+
+	CPPUNIT_ASSERT_EQUAL(count, dtn::data::EID::getInternedCount());
+}
+
+void TestEID::testComparePerformance(void)
+{
+	ibrcommon::TimeMeasurement tm;
+
+	// a network with many endpoints
+	std::vector<dtn::data::EID> eids;
+	for (int i = 0; i < 50000; ++i)
+	{
+		std::stringstream ss; ss << "dtn://node-" << i << "/routing";
+		eids.push_back(dtn::data::EID(ss.str()));
+	}
+
+	std::map<dtn::data::EID, int> map;
+	for (size_t i = 0; i < eids.size(); ++i) map[eids[i]] = static_cast<int>(i);
+
+	// copies of the EIDs as they are extracted from bundles
+	std::vector<dtn::data::EID> lookups;
+	for (size_t i = 0; i < eids.size(); i += 7) lookups.push_back(dtn::data::EID(eids[i].getString()));
+
+	size_t found = 0;
+	tm.start();
+	for (int round = 0; round < 20; ++round)
+	{
+		for (std::vector<dtn::data::EID>::const_iterator it = lookups.begin(); it != lookups.end(); ++it)
+		{
+			if (map.find(*it) != map.end()) found++;
+		}
+	}
+	tm.stop();
+
+	CPPUNIT_ASSERT_EQUAL(lookups.size() * 20, found);
+	std::cout << std::endl << "EID map lookup: " << (tm.getMicroseconds() * 1000 / found) << " ns";
+
+	size_t equal = 0;
+	tm.start();
+	for (int round = 0; round < 20; ++round)
+	{
+		for (size_t i = 0; i < lookups.size(); ++i)
+		{
+			if (lookups[i] == eids[i * 7]) equal++;
+		}
+	}
+	tm.stop();
+
+	CPPUNIT_ASSERT_EQUAL(lookups.size() * 20, equal);
+	std::cout << ", compare: " << (tm.getMicroseconds() * 1000 / equal) << " ns, " << std::flush;
+}
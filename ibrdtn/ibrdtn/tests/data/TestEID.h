@@ -34,6 +34,10 @@ class TestEID : public CPPUNIT_NS :: TestFixture
 	CPPUNIT_TEST (testCBHEConstructorSchemeSsp);
 	CPPUNIT_TEST (testCBHEEquals);
 	CPPUNIT_TEST (testCBHEHost);
+	CPPUNIT_TEST (testIntern);
+	CPPUNIT_TEST (testInternSetApplication);
+	CPPUNIT_TEST (testInternSplit);
+	CPPUNIT_TEST (testComparePerformance);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -48,6 +52,11 @@ protected:
 	void testCBHEEquals(void);
 	void testCBHEHost(void);
 
+	void testIntern(void);
+	void testInternSetApplication(void);
+	void testInternSplit(void);
+	void testComparePerformance(void);
+
 };
 
 #endif /* TESTEID_H_ */
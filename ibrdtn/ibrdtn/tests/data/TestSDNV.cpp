@@ -23,7 +23,10 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <ibrdtn/data/Number.h>
+#include <ibrcommon/TimeMeasurement.h>
 #include <sstream>
+#include <vector>
+#include <stdexcept>
 #include <stdint.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (TestSDNV);
@@ -147,3 +150,231 @@ void TestSDNV::testBitset(void)
 	dtn::data::SDNV<uint32_t> dst;
 	CPPUNIT_ASSERT_NO_THROW( ss >> dst );
 }
+
+/**
+ * A stream buffer which provides some data and fails on the
+ * next read like a broken connection.
+ */
+class FailingStreamBuf : public std::streambuf
+{
+public:
+	FailingStreamBuf(const std::string &data)
+	 : _data(data)
+	{
+		setg(&_data[0], &_data[0], &_data[0] + _data.size());
+	}
+
+protected:
+	virtual int_type underflow()
+	{
+		throw std::runtime_error("connection lost");
+	}
+
+private:
+	std::string _data;
+};
+
+void TestSDNV::testStreamState(void)
+{
+	dtn::data::Number dst;
+
+	// an empty stream sets eof and fail
+	{
+		std::stringstream ss;
+		CPPUNIT_ASSERT_NO_THROW( ss >> dst );
+		CPPUNIT_ASSERT(ss.eof());
+		CPPUNIT_ASSERT(ss.fail());
+	}
+
+	// an incomplete value sets eof and fail
+	{
+		std::stringstream ss;
+		ss << dtn::data::Number(8388608);
+
+		std::string data = ss.str();
+		std::stringstream truncated(data.substr(0, data.size() - 1));
+
+		CPPUNIT_ASSERT_NO_THROW( truncated >> dst );
+		CPPUNIT_ASSERT(truncated.eof());
+		CPPUNIT_ASSERT(truncated.fail());
+		CPPUNIT_ASSERT(!truncated.bad());
+	}
+
+	// errors of the stream buffer set the badbit
+	{
+		FailingStreamBuf buf("\x81");
+		std::istream is(&buf);
+
+		CPPUNIT_ASSERT_NO_THROW( is >> dst );
+		CPPUNIT_ASSERT(is.bad());
+	}
+
+	// if requested, the error of the stream buffer is passed to the caller
+	{
+		FailingStreamBuf buf("\x81");
+		std::istream is(&buf);
+		is.exceptions(std::ios::badbit);
+
+		CPPUNIT_ASSERT_THROW( is >> dst, std::runtime_error );
+		CPPUNIT_ASSERT(is.bad());
+	}
+
+	// a failing stream is not read
+	{
+		FailingStreamBuf buf("\x01");
+		std::istream is(&buf);
+		is.setstate(std::ios::failbit);
+
+		is >> dst;
+		CPPUNIT_ASSERT_EQUAL((std::streamsize)0, is.gcount());
+		CPPUNIT_ASSERT_EQUAL((size_t)0, dst.get<size_t>());
+	}
+}
+
+void TestSDNV::testBuffer(void)
+{
+	const uint64_t values[] = { 0, 1, 127, 128, 700, 16383, 16384, 32896, 8388608, 0xffffffffULL, 0x100000000ULL, static_cast<uint64_t>(-1) };
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(uint64_t); ++i)
+	{
+		const dtn::data::SDNV<uint64_t> src(values[i]);
+		dtn::data::SDNV<uint64_t> dst;
+
+		char buf[dtn::data::SDNV<uint64_t>::MAX_LENGTH];
+		const size_t len = src.encode(buf, sizeof(buf));
+		CPPUNIT_ASSERT_EQUAL(src.getLength(), len);
+
+		// the buffer encoding has to match the stream encoding
+		std::stringstream ss;
+		ss << src;
+		CPPUNIT_ASSERT_EQUAL(ss.str(), std::string(buf, len));
+
+		// incomplete values are not decoded
+		CPPUNIT_ASSERT_EQUAL((size_t)0, dst.decode(buf, len - 1));
+
+		CPPUNIT_ASSERT_EQUAL(len, dst.decode(buf, len));
+		CPPUNIT_ASSERT_EQUAL(src, dst);
+	}
+
+	// the buffer is too small
+	char small[2];
+	CPPUNIT_ASSERT_THROW( dtn::data::Number(8388608).encode(small, sizeof(small)), dtn::data::ValueOutOfRangeException );
+
+	// the value does not fit into the target type
+	char buf[dtn::data::SDNV<uint64_t>::MAX_LENGTH];
+	const size_t len = dtn::data::SDNV<uint64_t>(static_cast<uint64_t>(-1)).encode(buf, sizeof(buf));
+	dtn::data::SDNV<uint32_t> dst;
+	CPPUNIT_ASSERT_THROW( dst.decode(buf, len), dtn::data::ValueOutOfRangeException );
+}
+
+void TestSDNV::testBufferSequence(void)
+{
+	std::vector<dtn::data::Number> src;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		// mix runs of small values with larger ones
+		src.push_back(dtn::data::Number((i % 13 == 0) ? i * 1000 : i % 100));
+	}
+
+	std::vector<char> buf(src.size() * dtn::data::Number::MAX_LENGTH);
+	const size_t len = dtn::data::Number::encode(&buf[0], buf.size(), &src[0], src.size());
+
+	// compare with the stream encoding
+	std::stringstream ss;
+	for (size_t i = 0; i < src.size(); ++i) ss << src[i];
+	CPPUNIT_ASSERT_EQUAL(ss.str(), std::string(&buf[0], len));
+
+	std::vector<dtn::data::Number> dst(src.size());
+	CPPUNIT_ASSERT_EQUAL(len, dtn::data::Number::decode(&buf[0], len, &dst[0], dst.size()));
+
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(src[i], dst[i]);
+	}
+
+	// an incomplete sequence is not decoded
+	CPPUNIT_ASSERT_EQUAL((size_t)0, dtn::data::Number::decode(&buf[0], len - 1, &dst[0], dst.size()));
+}
+
+/**
+ * Reference decoder reading each byte using istream::get()
+ * as the stream codec did before
+ */
+static size_t legacy_decode(std::istream &stream)
+{
+	size_t value = 0;
+	unsigned char bp = 0;
+
+	do {
+		stream.get((char&)bp);
+		value = (value << 7) | (bp & 0x7f);
+	} while (bp & 0x80);
+
+	return value;
+}
+
+void TestSDNV::testBufferPerformance(void)
+{
+	const size_t count = 1000000;
+
+	// values as found in primary blocks: mostly small offsets and flags, some timestamps
+	std::vector<dtn::data::Number> src;
+	for (size_t i = 0; i < count; ++i)
+	{
+		src.push_back(dtn::data::Number((i % 8 == 7) ? 400000000 + i : i % 64));
+	}
+
+	ibrcommon::TimeMeasurement tm;
+	std::vector<dtn::data::Number> dst(count);
+
+	// stream codec
+	std::stringstream ss;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) ss << src[i];
+	tm.stop();
+	const double stream_encode = tm.getMilliseconds();
+
+	tm.start();
+	for (size_t i = 0; i < count; ++i) ss >> dst[i];
+	tm.stop();
+	const double stream_decode = tm.getMilliseconds();
+
+	ss.clear();
+	ss.seekg(0);
+	size_t sum = 0;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) sum += legacy_decode(ss);
+	tm.stop();
+	const double legacy_stream_decode = tm.getMilliseconds();
+	CPPUNIT_ASSERT(sum > 0);
+
+	// buffer codec
+	std::vector<char> buf(count * dtn::data::Number::MAX_LENGTH);
+	size_t len = 0;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) len += src[i].encode(&buf[len], buf.size() - len);
+	tm.stop();
+	const double buffer_encode = tm.getMilliseconds();
+
+	size_t pos = 0;
+	tm.start();
+	for (size_t i = 0; i < count; ++i) pos += dst[i].decode(&buf[pos], len - pos);
+	tm.stop();
+	const double buffer_decode = tm.getMilliseconds();
+	CPPUNIT_ASSERT_EQUAL(len, pos);
+
+	// sequence decoder
+	tm.start();
+	pos = dtn::data::Number::decode(&buf[0], len, &dst[0], count);
+	tm.stop();
+	const double sequence_decode = tm.getMilliseconds();
+	CPPUNIT_ASSERT_EQUAL(len, pos);
+
+	CPPUNIT_ASSERT_EQUAL(ss.str(), std::string(&buf[0], len));
+	CPPUNIT_ASSERT_EQUAL(src[count - 1], dst[count - 1]);
+
+	std::cout << count << " SDNVs: istream::get decode " << legacy_stream_decode << " ms"
+			<< ", stream " << stream_encode << " / " << stream_decode << " ms"
+			<< ", buffer " << buffer_encode << " / " << buffer_decode << " ms"
+			<< ", sequence decode " << sequence_decode << " ms" << std::endl;
+}
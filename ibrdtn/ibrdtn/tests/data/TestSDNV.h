@@ -35,6 +35,10 @@ class TestSDNV : public CPPUNIT_NS :: TestFixture {
 	CPPUNIT_TEST (testOutOfRange);
 	CPPUNIT_TEST (testBitset);
 	CPPUNIT_TEST (testTrim);
+	CPPUNIT_TEST (testStreamState);
+	CPPUNIT_TEST (testBuffer);
+	CPPUNIT_TEST (testBufferSequence);
+	CPPUNIT_TEST (testBufferPerformance);
 	CPPUNIT_TEST_SUITE_END ();
 
 	static void hexdump(char c);
@@ -51,6 +55,10 @@ public:
 	void testMax32(void);
 	void testBitset(void);
 	void testTrim(void);
+	void testStreamState(void);
+	void testBuffer(void);
+	void testBufferSequence(void);
+	void testBufferPerformance(void);
 };
 
 #endif /* TESTSDNV_H_ */
@@ -400,3 +400,67 @@ void TestSerializer::serializer_outin_structure(void)
 	CPPUNIT_ASSERT_NO_THROW( b2.find<dtn::data::AgeBlock>() );
 	CPPUNIT_ASSERT_NO_THROW( b2.find<dtn::data::ScopeControlHopLimitBlock>() );
 }
+
+void TestSerializer::serializer_buffer_outin(void)
+{
+	dtn::data::Bundle b1, b2;
+	b1.source = dtn::data::EID("dtn://node1/app1");
+	b1.destination = dtn::data::EID("dtn://node2/app2");
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream stream = ref.iostream();
+		(*stream) << "Hello World" << std::flush;
+	}
+	b1.push_back(ref);
+	b1.push_front<dtn::data::ScopeControlHopLimitBlock>();
+
+	/* the buffer is sized by the exact length of the bundle */
+	const dtn::data::Length len = dtn::data::DefaultSerializer(std::cout).getLength(b1);
+	std::vector<char> buffer(len);
+
+	dtn::data::BufferSerializer serializer(&buffer[0], buffer.size());
+	serializer << b1;
+	CPPUNIT_ASSERT_EQUAL(len, serializer.getWritten());
+
+	/* compare with the stream based serializer */
+	std::stringstream ss;
+	dtn::data::DefaultSerializer(ss) << b1;
+	CPPUNIT_ASSERT(ss.str() == std::string(&buffer[0], buffer.size()));
+
+	dtn::data::BufferDeserializer deserializer(&buffer[0], buffer.size());
+	deserializer >> b2;
+	CPPUNIT_ASSERT_EQUAL(len, deserializer.getRead());
+
+	CPPUNIT_ASSERT(b1 == b2);
+	CPPUNIT_ASSERT_EQUAL(b1.size(), b2.size());
+	CPPUNIT_ASSERT_EQUAL(b1.find<dtn::data::PayloadBlock>().getLength(), b2.find<dtn::data::PayloadBlock>().getLength());
+}
+
+void TestSerializer::serializer_buffer_overflow(void)
+{
+	dtn::data::Bundle b;
+	b.source = dtn::data::EID("dtn://node1/app1");
+	b.destination = dtn::data::EID("dtn://node2/app2");
+
+	ibrcommon::BLOB::Reference ref = ibrcommon::BLOB::create();
+	{
+		ibrcommon::BLOB::iostream stream = ref.iostream();
+		(*stream) << "Hello World" << std::flush;
+	}
+	b.push_back(ref);
+
+	const dtn::data::Length len = dtn::data::DefaultSerializer(std::cout).getLength(b);
+	std::vector<char> buffer(len - 1);
+
+	dtn::data::BufferSerializer serializer(&buffer[0], buffer.size());
+	CPPUNIT_ASSERT_THROW(serializer << b, dtn::SerializationFailedException);
+
+	/* a truncated buffer can not be deserialized */
+	std::vector<char> data(len);
+	dtn::data::BufferSerializer(&data[0], data.size()) << b;
+
+	dtn::data::Bundle b2;
+	dtn::data::BufferDeserializer deserializer(&data[0], len - 4);
+	CPPUNIT_ASSERT_THROW(deserializer >> b2, dtn::InvalidDataException);
+}
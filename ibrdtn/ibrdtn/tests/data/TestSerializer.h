@@ -38,6 +38,8 @@ class TestSerializer : public CPPUNIT_NS :: TestFixture
 	CPPUNIT_TEST (serializer_ipn_compression_length);
 	CPPUNIT_TEST (serializer_outin_binary);
 	CPPUNIT_TEST (serializer_outin_structure);
+	CPPUNIT_TEST (serializer_buffer_outin);
+	CPPUNIT_TEST (serializer_buffer_overflow);
 	CPPUNIT_TEST_SUITE_END ();
 
 	static void hexdump(char c);
@@ -61,6 +63,9 @@ protected:
 
 	void serializer_outin_binary(void);
 	void serializer_outin_structure(void);
+
+	void serializer_buffer_outin(void);
+	void serializer_buffer_overflow(void);
 };
 
 #endif /* TESTSERIALIZER_H_ */